@@ -648,6 +648,64 @@ static void test_new_assembly(int N, int NX, int pK) {
 }
 
 
+/* Effect of the numbering of the convexes, points and dofs on the
+   assembly and on the sparse matrix-vector product. The convexes of a
+   regular mesh are first shuffled, as in a mesh produced by a mesher
+   without any renumbering. */
+static void test_renumbering(int N, int NX) {
+
+  cout << "\n\n-------------------------------------\n"
+       <<     "Renumbering tests in dimension " << N << " with P2 elements"
+       <<   "\n-------------------------------------"
+       << endl << endl;
+
+  getfem::mesh m0, m;
+  std::vector<size_type> nsubdiv(N, NX);
+  getfem::regular_unit_mesh(m0, nsubdiv, bgeot::simplex_geotrans(N, 1));
+  std::vector<size_type> cvs(m0.nb_convex());
+  for (size_type i = 0; i < cvs.size(); ++i) cvs[i] = i;
+  std::random_shuffle(cvs.begin(), cvs.end());
+  for (size_type cv : cvs)
+    m.add_convex_by_points(m0.trans_of_convex(cv),
+                           m0.points_of_convex(cv).begin());
+
+  for (int i = 0; i < 3; ++i) {
+    const char *names[3] = { "shuffled", "Cuthill-McKee", "Hilbert curve" };
+    chrono ch;
+    ch.init(); ch.tic();
+    if (i == 1) m.optimize_structure(true);
+    if (i == 2) m.renumber_along_curve();
+    ch.toc();
+    cout << names[i] << " ordering " << ch << endl;
+
+    getfem::mesh_fem mf_u(m, dim_type(N));
+    mf_u.set_classical_finite_element(2);
+    getfem::mesh_im mim(m);
+    mim.set_integration_method(m.convex_index(), 4);
+    size_type ndofu = mf_u.nb_dof();
+    std::vector<scalar_type> U(ndofu), V(ndofu);
+    gmm::fill_random(U);
+
+    getfem::ga_workspace workspace;
+    gmm::sub_interval Iu(0, ndofu);
+    workspace.add_fem_variable("u", mf_u, Iu, U);
+    workspace.add_expression("(Div_Test_u*Id(meshdim) + 2*Sym(Grad_Test_u))"
+                             ":Grad_Test2_u", mim);
+    getfem::model_real_sparse_matrix K(ndofu, ndofu);
+    workspace.set_assembled_matrix(K);
+    ch.init(); ch.tic();
+    workspace.assembly(2);
+    ch.toc();
+    cout << "  elasticity stiffness matrix assembly " << ch << endl;
+
+    gmm::csr_matrix<scalar_type> Kc; gmm::copy(K, Kc);
+    ch.init(); ch.tic();
+    for (int k = 0; k < 50; ++k) gmm::mult(Kc, U, V);
+    ch.toc();
+    cout << "  50 sparse matrix-vector products " << ch << endl;
+  }
+}
+
 int main(int /* argc */, char * /* argv */[]) {
 
   GMM_SET_EXCEPTION_DEBUG; // Exceptions make a memory fault, to debug.
@@ -712,6 +770,13 @@ int main(int /* argc */, char * /* argv */[]) {
   // Homogeneous elas     : 2.74 | 5.23 | 0.82 | 1.41 | 0.01 | 1.32 |
   // Non-homogeneous elast: 2.66 | 47.4 | 0.82 | 1.41 | 0.01 | 1.24 |
 
+  if (all || only_one == 6) // ndofu = 206763
+    test_renumbering(3, 20);
+  //                     shuffled | Cuthill-McKee | Hilbert curve |
+  // Renumbering        :         |     0.20      |     0.17      |
+  // Elasticity assembly:   4.5   |  3.0 - 4.0    |  2.7 - 3.9    |
+  // 50 SpMV            : 1.5-2.2 |  1.1 - 1.3    |  1.2 - 1.4    |
+
   // Conclusions :
   // - Deactivation of debug test has no sensible effect.
   // - Compile time of assembly strings is negligible (< 0.0004)
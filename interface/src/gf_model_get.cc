@@ -414,6 +414,16 @@ void gf_model_get(getfemint::mexargs_in& m_in,
        select explicitely the line search method used for the linear systems (the
        default value is 'default').
        Possible values are 'simplest', 'systematic', 'quadratic' or 'basic'.
+    - 'jacobian_reuse', @str STRATEGY
+       reuse the tangent matrix (and its factorization for direct solvers)
+       over several Newton iterations. Possible values are 'modified'
+       (modified Newton) and 'broyden' (Broyden updates of the inverse).
+    - 'reuse_max', @int NIT
+       maximal number of iterations with the same tangent matrix when
+       'jacobian_reuse' is set (default is 10).
+    - 'contraction_max', @float RATIO
+       the tangent matrix is recomputed when the ratio between two
+       consecutive residuals exceeds this value (default is 0.5).
 
       Return the number of iterations, if an iterative method is used.
       
@@ -425,10 +435,13 @@ void gf_model_get(getfemint::mexargs_in& m_in,
 
       @*/
     sub_command
-      ("solve", 0, 17, 0, 2,
+      ("solve", 0, 23, 0, 2,
        getfemint::interruptible_iteration iter;
        std::string lsolver = "auto";
        std::string lsearch = "default";
+       std::string jacobian_reuse = "none";
+       size_type reuse_max(10);
+       scalar_type contraction_max(0.5);
        scalar_type alpha_max_ratio(-1);
        scalar_type alpha_min(-1);
        scalar_type alpha_mult(-1);
@@ -465,6 +478,22 @@ void gf_model_get(getfemint::mexargs_in& m_in,
          } else if (cmd_strmatch(opt, "alpha threshold res")) {
            if (in.remaining()) alpha_threshold_res = in.pop().to_scalar();
            else THROW_BADARG("missing line search value for " << opt);
+         } else if (cmd_strmatch(opt, "jacobian reuse") ||
+                    cmd_strmatch(opt, "jacobian_reuse")) {
+           if (in.remaining()) jacobian_reuse = in.pop().to_string();
+           else THROW_BADARG("missing strategy name for " << opt);
+         } else if (cmd_strmatch(opt, "reuse max") ||
+                    cmd_strmatch(opt, "reuse_max")) {
+           if (in.remaining()) {
+             int rmax = in.pop().to_integer();
+             if (rmax < 0)
+               THROW_BADARG("invalid negative value for " << opt);
+             reuse_max = size_type(rmax);
+           } else THROW_BADARG("missing value for " << opt);
+         } else if (cmd_strmatch(opt, "contraction max") ||
+                    cmd_strmatch(opt, "contraction_max")) {
+           if (in.remaining()) contraction_max = in.pop().to_scalar();
+           else THROW_BADARG("missing value for " << opt);
          } else THROW_BADARG("bad option: " << opt);
        }
 
@@ -498,8 +527,25 @@ void gf_model_get(getfemint::mexargs_in& m_in,
          ls = &quadratic_ls;
        else GMM_ASSERT1(false, "unknown line search");
 
-
-       if (!md->is_complex()) {
+       getfem::newton_jacobian_reuse_policy reuse(getfem::newton_jacobian_reuse_policy::MODIFIED_NEWTON,
+                                                  contraction_max, reuse_max);
+       getfem::default_newton_line_search reuse_default_ls;
+       if (jacobian_reuse != "none") {
+         if (jacobian_reuse == "broyden")
+           reuse.update = getfem::newton_jacobian_reuse_policy::BROYDEN;
+         else if (jacobian_reuse != "modified")
+           THROW_BADARG("unknown jacobian reuse strategy: " << jacobian_reuse);
+         // the Newton with step control does not allow the reuse
+         if (lsearch == "default") ls = &reuse_default_ls;
+         if (!md->is_complex())
+           getfem::standard_solve(*md, iter,
+                                  getfem::rselect_linear_solver(*md, lsolver),
+                                  *ls, reuse);
+         else
+           getfem::standard_solve(*md, iter,
+                                  getfem::cselect_linear_solver(*md, lsolver),
+                                  *ls, reuse);
+       } else if (!md->is_complex()) {
          getfem::standard_solve(*md, iter,
                                 getfem::rselect_linear_solver(*md,
                                                               lsolver), *ls);
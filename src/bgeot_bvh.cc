@@ -0,0 +1,301 @@
+/*===========================================================================
+
+ Copyright (C) 2020 the GetFEM++ project
+
+ This file is a part of GetFEM++
+
+ GetFEM++  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+===========================================================================*/
+
+#include "getfem/bgeot_bvh.h"
+
+namespace bgeot {
+
+  size_type box_bvh::add_box(const base_node &min, const base_node &max,
+                             size_type id) {
+    if (ids.size() == 0 && !tree_built) N = min.size();
+    GMM_ASSERT1(min.size() == N && max.size() == N, "Dimensions mismatch");
+    if (tree_built && ids.size() >= box_order.size()) {
+      GMM_WARNING3("Add a box when the tree is already built cancel the "
+                   "tree. Unefficient operation.");
+      tree_built = false;
+    }
+    size_type i = ids.size();
+    ids.push_back((id + 1) ? id : i);
+    for (size_type k = 0; k < N; ++k)
+      { bmin.push_back(min[k]); bmax.push_back(max[k]); }
+    need_refit = true;
+    return i;
+  }
+
+  void box_bvh::set_box(size_type i, const base_node &min,
+                        const base_node &max) {
+    GMM_ASSERT1(i < ids.size(), "Box index out of range");
+    for (size_type k = 0; k < N; ++k)
+      { bmin[i*N+k] = min[k]; bmax[i*N+k] = max[k]; }
+    need_refit = true;
+  }
+
+  void box_bvh::clear() {
+    clear_boxes_only();
+    box_order.resize(0); nodes.resize(0); nmin.resize(0); nmax.resize(0);
+    tree_built = need_refit = false;
+  }
+
+  void box_bvh::update_node(size_type i) {
+    scalar_type *pmin = &(nmin[i*N]), *pmax = &(nmax[i*N]);
+    const bvh_node &nd = nodes[i];
+    if (nd.is_leaf()) {
+      for (size_type k = 0; k < N; ++k)
+        { pmin[k] = 1E300; pmax[k] = -1E300; }
+      for (size_type j = nd.first; j < nd.first + nd.nb; ++j) {
+        const scalar_type *qmin = box_min(box_order[j]);
+        const scalar_type *qmax = box_max(box_order[j]);
+        for (size_type k = 0; k < N; ++k) {
+          pmin[k] = std::min(pmin[k], qmin[k]);
+          pmax[k] = std::max(pmax[k], qmax[k]);
+        }
+      }
+    } else {
+      const scalar_type *lmin = &(nmin[(i+1)*N]), *lmax = &(nmax[(i+1)*N]);
+      const scalar_type *rmin = &(nmin[nd.right*N]);
+      const scalar_type *rmax = &(nmax[nd.right*N]);
+      for (size_type k = 0; k < N; ++k) {
+        pmin[k] = std::min(lmin[k], rmin[k]);
+        pmax[k] = std::max(lmax[k], rmax[k]);
+      }
+    }
+  }
+
+  /* Split the boxes at the median of their centers along the direction
+     of largest extent of the centers. The depth of the tree is then
+     bounded by log2(nb_boxes/BOXES_PER_LEAF) + 1. */
+  size_type box_bvh::build_node(size_type first, size_type nb,
+                                std::vector<scalar_type> &centers) {
+    size_type inode = nodes.size();
+    nodes.push_back(bvh_node());
+    nodes[inode].first = first; nodes[inode].nb = nb;
+    nodes[inode].right = size_type(-1);
+    if (nb > BOXES_PER_LEAF) {
+      base_node cmin(N), cmax(N);
+      for (size_type k = 0; k < N; ++k) { cmin[k] = 1E300; cmax[k] = -1E300; }
+      for (size_type j = first; j < first + nb; ++j)
+        for (size_type k = 0; k < N; ++k) {
+          scalar_type c = centers[box_order[j]*N+k];
+          cmin[k] = std::min(cmin[k], c); cmax[k] = std::max(cmax[k], c);
+        }
+      size_type dir = 0;
+      for (size_type k = 1; k < N; ++k)
+        if (cmax[k] - cmin[k] > cmax[dir] - cmin[dir]) dir = k;
+      size_type nb1 = nb / 2;
+      std::nth_element(box_order.begin() + first,
+                       box_order.begin() + first + nb1,
+                       box_order.begin() + first + nb,
+                       [&centers, dir, this](size_type a, size_type b)
+                       { return centers[a*N+dir] < centers[b*N+dir]; });
+      build_node(first, nb1, centers);
+      size_type iright = build_node(first + nb1, nb - nb1, centers);
+      nodes[inode].right = iright;
+    }
+    return inode;
+  }
+
+  void box_bvh::build_tree() {
+    size_type nb = ids.size();
+    nodes.resize(0);
+    box_order.resize(nb);
+    for (size_type i = 0; i < nb; ++i) box_order[i] = i;
+    if (nb) {
+      std::vector<scalar_type> centers(nb*N);
+      for (size_type i = 0; i < nb*N; ++i)
+        centers[i] = (bmin[i] + bmax[i]) * scalar_type(0.5);
+      nodes.reserve(2 * (nb / BOXES_PER_LEAF + 1));
+      build_node(0, nb, centers);
+    }
+    tree_built = true;
+    refit();
+    built_extent = leaves_extent();
+  }
+
+  /* Sum of the extents of the leaves relatively to the extent of the
+     root. Measures the overlapping of the leaves. */
+  scalar_type box_bvh::leaves_extent() const {
+    if (nodes.empty()) return scalar_type(0);
+    scalar_type e(0), eroot(0);
+    for (size_type k = 0; k < N; ++k) eroot += nmax[k] - nmin[k];
+    for (size_type i = 0; i < nodes.size(); ++i)
+      if (nodes[i].is_leaf())
+        for (size_type k = 0; k < N; ++k) e += nmax[i*N+k] - nmin[i*N+k];
+    return (eroot > scalar_type(0)) ? e / eroot : scalar_type(0);
+  }
+
+  void box_bvh::update_tree() {
+    if (!tree_built || box_order.size() != ids.size()) { build_tree(); return; }
+    refit();
+    if (leaves_extent() > scalar_type(2) * built_extent) build_tree();
+  }
+
+  void box_bvh::refit() {
+    if (!tree_built) { build_tree(); return; }
+    GMM_ASSERT1(box_order.size() == ids.size(), "The number of boxes has "
+                "changed since the construction of the tree, cannot refit");
+    nmin.resize(nodes.size()*N); nmax.resize(nodes.size()*N);
+    // children always have a greater index than their parent.
+    for (size_type i = nodes.size(); i > 0; --i) update_node(i-1);
+    need_refit = false;
+  }
+
+  template <typename PRED>
+  void box_bvh::find_matching_boxes(const PRED &p,
+                                    std::vector<size_type> &idvec) const {
+    idvec.resize(0);
+    GMM_ASSERT1(tree_built && !need_refit, "Box tree not initialised or "
+                "not refitted.");
+    if (nodes.size() == 0) return;
+    size_type stack[128], nstack = 0;
+    stack[nstack++] = 0;
+    while (nstack) {
+      size_type i = stack[--nstack];
+      if (!p.accept(&(nmin[i*N]), &(nmax[i*N]))) continue;
+      const bvh_node &nd = nodes[i];
+      if (nd.is_leaf()) {
+        for (size_type j = nd.first; j < nd.first + nd.nb; ++j) {
+          size_type ib = box_order[j];
+          if (p(box_min(ib), box_max(ib))) idvec.push_back(ids[ib]);
+        }
+      } else {
+        GMM_ASSERT1(nstack+2 <= 128, "internal error");
+        stack[nstack++] = nd.right;
+        stack[nstack++] = i+1;
+      }
+    }
+    std::sort(idvec.begin(), idvec.end());
+  }
+
+  /* predicates for the searches, in the spirit of those of bgeot_rtree.cc */
+  struct bvh_intersection_p {
+    const base_node &min, &max;
+    scalar_type EPS;
+    bool operator()(const scalar_type *min2, const scalar_type *max2) const {
+      for (size_type i = 0; i < min.size(); ++i)
+        if ((max[i] < min2[i]-EPS) || (min[i] > max2[i]+EPS)) return false;
+      return true;
+    }
+    bool accept(const scalar_type *min2, const scalar_type *max2) const
+    { return operator()(min2, max2); }
+    bvh_intersection_p(const base_node &min_, const base_node &max_,
+                       scalar_type EPS_) : min(min_), max(max_), EPS(EPS_) {}
+  };
+
+  /* match boxes containing [min..max] */
+  struct bvh_contains_p : public bvh_intersection_p {
+    bool operator()(const scalar_type *min2, const scalar_type *max2) const {
+      for (size_type i = 0; i < min.size(); ++i)
+        if ((min2[i] > min[i]+EPS) || (max2[i] < max[i]-EPS)) return false;
+      return true;
+    }
+    bvh_contains_p(const base_node &min_, const base_node &max_,
+                   scalar_type EPS_) : bvh_intersection_p(min_, max_, EPS_) {}
+  };
+
+  /* match boxes contained in [min..max] */
+  struct bvh_contained_p : public bvh_intersection_p {
+    bool operator()(const scalar_type *min2, const scalar_type *max2) const {
+      for (size_type i = 0; i < min.size(); ++i)
+        if ((min[i] > min2[i]+EPS) || (max[i] < max2[i]-EPS)) return false;
+      return true;
+    }
+    bvh_contained_p(const base_node &min_, const base_node &max_,
+                    scalar_type EPS_) : bvh_intersection_p(min_, max_, EPS_) {}
+  };
+
+  /* match boxes containing P */
+  struct bvh_has_point_p {
+    const base_node &P;
+    scalar_type EPS;
+    bool operator()(const scalar_type *min2, const scalar_type *max2) const {
+      for (size_type i = 0; i < P.size(); ++i)
+        if (P[i] < min2[i]-EPS || P[i] > max2[i]+EPS) return false;
+      return true;
+    }
+    bool accept(const scalar_type *min2, const scalar_type *max2) const
+    { return operator()(min2, max2); }
+    bvh_has_point_p(const base_node &P_, scalar_type EPS_)
+      : P(P_), EPS(EPS_) {}
+  };
+
+  /* match boxes intersecting the line passing through org and of
+     direction vector dirv and intersecting [min..max].*/
+  struct bvh_intersect_line_and_box_p : public bvh_intersection_p {
+    const base_node &org;
+    const base_small_vector &dirv;
+    bool operator()(const scalar_type *min2, const scalar_type *max2) const {
+      if (!bvh_intersection_p::operator()(min2, max2)) return false;
+      size_type N = org.size();
+      for (size_type i = 0; i < N; ++i)
+        if (dirv[i] != scalar_type(0)) {
+          scalar_type a1=(min2[i]-org[i])/dirv[i], a2=(max2[i]-org[i])/dirv[i];
+          bool interf1 = true, interf2 = true;
+          for (size_type j = 0; j < N; ++j)
+            if (j != i) {
+              scalar_type y1 = org[j] + a1*dirv[j], y2 = org[j] + a2*dirv[j];
+              if (y1 < min2[j] || y1 > max2[j]) interf1 = false;
+              if (y2 < min2[j] || y2 > max2[j]) interf2 = false;
+            }
+          if (interf1 || interf2) return true;
+        }
+      return false;
+    }
+    bool accept(const scalar_type *min2, const scalar_type *max2) const
+    { return operator()(min2, max2); }
+    bvh_intersect_line_and_box_p(const base_node &org_,
+                                 const base_small_vector &dirv_,
+                                 const base_node &min_, const base_node &max_,
+                                 scalar_type EPS_)
+      : bvh_intersection_p(min_, max_, EPS_), org(org_), dirv(dirv_) {}
+  };
+
+  void box_bvh::find_boxes_at_point(const base_node &P,
+                                    std::vector<size_type> &idvec) const {
+    GMM_ASSERT2(P.size() == N || nodes.size() == 0, "Dimensions mismatch");
+    find_matching_boxes(bvh_has_point_p(P, EPS), idvec);
+  }
+
+  void box_bvh::find_intersecting_boxes(const base_node &min,
+                                        const base_node &max,
+                                        std::vector<size_type> &idvec) const
+  { find_matching_boxes(bvh_intersection_p(min, max, EPS), idvec); }
+
+  void box_bvh::find_containing_boxes(const base_node &min,
+                                      const base_node &max,
+                                      std::vector<size_type> &idvec) const
+  { find_matching_boxes(bvh_contains_p(min, max, EPS), idvec); }
+
+  void box_bvh::find_contained_boxes(const base_node &min,
+                                     const base_node &max,
+                                     std::vector<size_type> &idvec) const
+  { find_matching_boxes(bvh_contained_p(min, max, EPS), idvec); }
+
+  void box_bvh::find_line_intersecting_boxes(const base_node &org,
+                                             const base_small_vector &dirv,
+                                             const base_node &min,
+                                             const base_node &max,
+                                             std::vector<size_type> &idvec)
+    const {
+    find_matching_boxes(bvh_intersect_line_and_box_p(org, dirv, min, max,
+                                                     EPS), idvec);
+  }
+
+}
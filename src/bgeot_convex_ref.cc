@@ -29,10 +29,25 @@ namespace bgeot {
   // ******************************************************************
   //    Interface with qhull
   // ******************************************************************
-  
+
+  /* In dimension one, the Delaunay triangulation joins the consecutive
+     points, qhull is not needed. */
+  static void delaunay_1d(const std::vector<base_node> &pts,
+                          gmm::dense_matrix<size_type>& simplexes) {
+    std::vector<size_type> ord(pts.size());
+    for (size_type i = 0; i < pts.size(); ++i) ord[i] = i;
+    std::sort(ord.begin(), ord.end(), [&pts](size_type i, size_type j)
+              { return pts[i][0] < pts[j][0]; });
+    gmm::resize(simplexes, 2, pts.size() ? pts.size()-1 : 0);
+    for (size_type i = 1; i < pts.size(); ++i)
+      { simplexes(0, i-1) = ord[i-1]; simplexes(1, i-1) = ord[i]; }
+  }
+
 # ifndef GETFEM_HAVE_LIBQHULL_QHULL_A_H
-  void qhull_delaunay(const std::vector<base_node> &,
-                gmm::dense_matrix<size_type>&) {
+  void qhull_delaunay(const std::vector<base_node> &pts,
+                gmm::dense_matrix<size_type>& simplexes) {
+    if (pts.size() && pts[0].size() == 1)
+      { delaunay_1d(pts, simplexes); return; }
     GMM_ASSERT1(false, "Qhull header files not installed. "
                 "Install qhull library and reinstall GetFEM++ library.");
   }
@@ -57,6 +72,7 @@ namespace bgeot {
 		      gmm::dense_matrix<size_type>& simplexes) {
     // cout << "running delaunay with " << pts.size() << " points\n";
     size_type dim = pts[0].size();   /* points dimension.           */
+    if (dim == 1) { delaunay_1d(pts, simplexes); return; }
     if (pts.size() <= dim) { gmm::resize(simplexes, dim+1, 0); return; }
     if (pts.size() == dim+1) {
       gmm::resize(simplexes, dim+1, 1);
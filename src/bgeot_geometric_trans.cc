@@ -372,6 +372,18 @@ namespace bgeot {
     return K_;
   }
 
+  void geotrans_interpolation_context::set_K_B_J(const scalar_type *K,
+                                                 const scalar_type *B,
+                                                 scalar_type J) {
+    size_type P = pgt_->structure()->dim(), NN = N();
+    K_.base_resize(NN, P); B_.base_resize(NN, P);
+    std::copy(K, K + NN*P, K_.begin());
+    std::copy(B, B + NN*P, B_.begin());
+    J_ = J;
+    have_K_ = have_B_ = have_J_ = true;
+    have_B3_ = have_B32_ = false;
+  }
+
   const base_matrix& geotrans_interpolation_context::B() const {
     if (!have_B()) {
       const base_matrix &KK = K();
@@ -502,8 +514,8 @@ namespace bgeot {
 
     std::vector<FUNC> trans;
     mutable std::vector<std::vector<FUNC>> grad_, hess_;
-    mutable bool grad_computed_ = false;
-    mutable bool hess_computed_ = false;
+    mutable std::atomic_bool grad_computed_{false};
+    mutable std::atomic_bool hess_computed_{false};
 
     void compute_grad_() const {
       if (grad_computed_) return;
@@ -633,6 +645,145 @@ namespace bgeot {
     }
   };
 
+  /* ******************************************************************** */
+  /* Fixed size evaluation of the most common transformations.            */
+  /* ******************************************************************** */
+
+  /* Lagrange transformation of degree K = 1 or 2 in dimension N = 2 or 3
+     on a simplex (SIMPLEX = true) or on a parallelepiped. The shape
+     functions and their gradients are computed with fixed size loops on
+     the reference coordinates instead of the evaluation of the polynomials
+     of BASE, which are kept for the other uses (products of
+     transformations, Hessians). */
+  template <class BASE, dim_type N, short_type K, bool SIMPLEX>
+  struct fixed_lagrange_trans_ : public BASE {
+    enum { NBP = SIMPLEX ? (K == 1 ? N+1 : (N+1)*(N+2)/2)
+                         : (K == 1 ? (N == 2 ? 4 : 8) : (N == 2 ? 9 : 27)) };
+    // On a simplex, the two barycentric coordinates defining each shape
+    // function (the same one twice for a vertex). On a parallelepiped, the
+    // 1D shape function in each direction.
+    short_type ind[NBP][3];
+
+    void values_(const base_node &pt, scalar_type *v) const {
+      if (SIMPLEX) {
+        scalar_type l[N+1]; l[0] = scalar_type(1);
+        for (dim_type d = 0; d < N; ++d) { l[d+1] = pt[d]; l[0] -= pt[d]; }
+        for (size_type i = 0; i < NBP; ++i) {
+          short_type a = ind[i][0], b = ind[i][1];
+          if (K == 1) v[i] = l[a];
+          else if (a == b) v[i] = l[a] * (scalar_type(2)*l[a] - scalar_type(1));
+          else v[i] = scalar_type(4) * l[a] * l[b];
+        }
+      } else {
+        scalar_type lv[N][K+1];
+        for (dim_type d = 0; d < N; ++d) values_1d_(pt[d], lv[d]);
+        for (size_type i = 0; i < NBP; ++i) {
+          v[i] = lv[0][ind[i][0]];
+          for (dim_type d = 1; d < N; ++d) v[i] *= lv[d][ind[i][d]];
+        }
+      }
+    }
+
+    // g(i, n) = g[i + n*NBP]
+    void grads_(const base_node &pt, scalar_type *g) const {
+      if (SIMPLEX) {
+        scalar_type l[N+1]; l[0] = scalar_type(1);
+        for (dim_type d = 0; d < N; ++d) { l[d+1] = pt[d]; l[0] -= pt[d]; }
+        for (size_type i = 0; i < NBP; ++i) {
+          short_type a = ind[i][0], b = ind[i][1];
+          for (dim_type n = 0; n < N; ++n) {
+            scalar_type da = dbary_(a, n), db = dbary_(b, n);
+            if (K == 1) g[i+n*NBP] = da;
+            else if (a == b) g[i+n*NBP] = (scalar_type(4)*l[a]-scalar_type(1))*da;
+            else g[i+n*NBP] = scalar_type(4) * (l[b]*da + l[a]*db);
+          }
+        }
+      } else {
+        scalar_type lv[N][K+1], ld[N][K+1];
+        for (dim_type d = 0; d < N; ++d) {
+          values_1d_(pt[d], lv[d]); derivatives_1d_(pt[d], ld[d]);
+        }
+        for (size_type i = 0; i < NBP; ++i)
+          for (dim_type n = 0; n < N; ++n) {
+            scalar_type a = ld[n][ind[i][n]];
+            for (dim_type d = 0; d < N; ++d)
+              if (d != n) a *= lv[d][ind[i][d]];
+            g[i+n*NBP] = a;
+          }
+      }
+    }
+
+    // derivative of the barycentric coordinate a with respect to x_n
+    static scalar_type dbary_(short_type a, dim_type n)
+    { return (a == 0) ? scalar_type(-1) : scalar_type(a == n+1 ? 1 : 0); }
+
+    // 1D Lagrange functions on the nodes 0, 1 (K = 1) or 0, 1/2, 1 (K = 2)
+    static void values_1d_(scalar_type x, scalar_type *l) {
+      if (K == 1) { l[0] = scalar_type(1) - x; l[1] = x; }
+      else {
+        l[0] = (scalar_type(1) - x) * (scalar_type(1) - scalar_type(2)*x);
+        l[1] = scalar_type(4) * x * (scalar_type(1) - x);
+        l[K] = x * (scalar_type(2)*x - scalar_type(1));
+      }
+    }
+
+    static void derivatives_1d_(scalar_type x, scalar_type *l) {
+      if (K == 1) { l[0] = scalar_type(-1); l[1] = scalar_type(1); }
+      else {
+        l[0] = scalar_type(4)*x - scalar_type(3);
+        l[1] = scalar_type(4) - scalar_type(8)*x;
+        l[K] = scalar_type(4)*x - scalar_type(1);
+      }
+    }
+
+    virtual void poly_vector_val(const base_node &pt, base_vector &val) const
+    { val.resize(NBP); values_(pt, &(val[0])); }
+
+    virtual void poly_vector_val(const base_node &pt,
+                                 const convex_ind_ct &ind_ct,
+                                 base_vector &val) const {
+      scalar_type v[NBP];
+      values_(pt, v);
+      val.resize(ind_ct.size());
+      for (size_type k = 0; k < ind_ct.size(); ++k) val[k] = v[ind_ct[k]];
+    }
+
+    virtual void poly_vector_grad(const base_node &pt, base_matrix &pc) const
+    { pc.base_resize(NBP, N); grads_(pt, &(*(pc.begin()))); }
+
+    virtual void poly_vector_grad(const base_node &pt,
+                                  const convex_ind_ct &ind_ct,
+                                  base_matrix &pc) const {
+      scalar_type g[NBP*N];
+      grads_(pt, g);
+      pc.base_resize(ind_ct.size(), N);
+      for (size_type k = 0; k < ind_ct.size(); ++k)
+        for (dim_type n = 0; n < N; ++n) pc(k, n) = g[ind_ct[k]+n*NBP];
+    }
+
+    template <typename... ARGS> fixed_lagrange_trans_(ARGS... args)
+      : BASE(args...) {
+      GMM_ASSERT1(this->nb_points() == NBP && this->dim() == N,
+                  "Internal error");
+      for (size_type i = 0; i < NBP; ++i) {
+        const base_node &P = this->cvr->points()[i];
+        if (SIMPLEX) {
+          scalar_type l[N+1]; l[0] = scalar_type(1);
+          for (dim_type d = 0; d < N; ++d) { l[d+1] = P[d]; l[0] -= P[d]; }
+          short_type nb = 0;
+          for (short_type a = 0; a <= N; ++a) {
+            int c = int(::floor(0.5 + l[a] * scalar_type(K)));
+            for (int j = 0; j < c; ++j) ind[i][nb++] = a;
+          }
+          GMM_ASSERT1(nb == K, "Internal error");
+          if (K == 1) ind[i][1] = ind[i][0];
+        } else
+          for (dim_type d = 0; d < N; ++d)
+            ind[i][d] = short_type(::floor(0.5 + P[d] * scalar_type(K)));
+      }
+    }
+  };
+
   static pgeometric_trans
   PK_gt(gt_param_list &params,
         std::vector<dal::pstatic_stored_object> &dependencies) {
@@ -646,6 +797,15 @@ namespace bgeot {
                 double(n) == params[0].num() && double(k) == params[1].num(),
                 "Bad parameters");
     dependencies.push_back(simplex_of_reference(dim_type(n), dim_type(k)));
+    if (n == 2 && k == 1)
+      return std::make_shared<fixed_lagrange_trans_<simplex_trans_, 2, 1, true>>
+        (dim_type(2), short_type(1));
+    if (n == 3 && k == 1)
+      return std::make_shared<fixed_lagrange_trans_<simplex_trans_, 3, 1, true>>
+        (dim_type(3), short_type(1));
+    if (n == 3 && k == 2)
+      return std::make_shared<fixed_lagrange_trans_<simplex_trans_, 3, 2, true>>
+        (dim_type(3), short_type(2));
     return std::make_shared<simplex_trans_>(dim_type(n), dim_type(k));
   }
 
@@ -689,6 +849,26 @@ namespace bgeot {
       = dynamic_cast<const poly_geometric_trans *>(b.get());
     GMM_ASSERT1(aa && bb, "The product of geometric transformations "
                 "is only defined for polynomial ones");
+    // GT_QK(2,k) and GT_QK(3,k) for k = 1 or 2
+    if (dynamic_cast<const simplex_trans_ *>(bb) && b->dim() == 1) {
+      short_type k = short_type(b->complexity());
+      bool a_pk1 = dynamic_cast<const simplex_trans_ *>(aa) && a->dim() == 1
+        && a->complexity() == k;
+      if (a_pk1 && k == 1)
+        return std::make_shared<fixed_lagrange_trans_<cv_pr_t_, 2, 1, false>>
+          (aa, bb);
+      if (a_pk1 && k == 2)
+        return std::make_shared<fixed_lagrange_trans_<cv_pr_t_, 2, 2, false>>
+          (aa, bb);
+      if (k == 1 && dynamic_cast<const fixed_lagrange_trans_
+                                 <cv_pr_t_, 2, 1, false> *>(aa))
+        return std::make_shared<fixed_lagrange_trans_<cv_pr_t_, 3, 1, false>>
+          (aa, bb);
+      if (k == 2 && dynamic_cast<const fixed_lagrange_trans_
+                                 <cv_pr_t_, 2, 2, false> *>(aa))
+        return std::make_shared<fixed_lagrange_trans_<cv_pr_t_, 3, 2, false>>
+          (aa, bb);
+    }
     return std::make_shared<cv_pr_t_>(aa, bb);
   }
 
@@ -1340,37 +1520,50 @@ namespace bgeot {
   { DAL_STORED_OBJECT_DEBUG_CREATED(this, "Geotrans precomp"); }
 
   void geotrans_precomp_::init_val() const {
+    auto guard = locks_.get_lock();
+    if (c_ok) return;
     c.clear();
     c.resize(pspt->size(), base_vector(pgt->nb_points()));
     for (size_type j = 0; j < pspt->size(); ++j)
       pgt->poly_vector_val((*pspt)[j], c[j]);
+    multi_index sz(1); sz[0] = pgt->nb_points();
+    c_tab.init(c, sz);
+    c_ok = true;
   }
 
   void geotrans_precomp_::init_grad() const {
+    auto guard = locks_.get_lock();
+    if (pc_ok) return;
     dim_type N = pgt->dim();
     pc.clear();
     pc.resize(pspt->size(), base_matrix(pgt->nb_points() , N));
     for (size_type j = 0; j < pspt->size(); ++j)
       pgt->poly_vector_grad((*pspt)[j], pc[j]);
+    pc_tab.init(pc, multi_index(pgt->nb_points(), N));
+    pc_ok = true;
   }
 
   void geotrans_precomp_::init_hess() const {
+    auto guard = locks_.get_lock();
+    if (hpc_ok) return;
     base_poly P, Q;
     dim_type N = pgt->structure()->dim();
     hpc.clear();
     hpc.resize(pspt->size(), base_matrix(pgt->nb_points(), gmm::sqr(N)));
     for (size_type j = 0; j < pspt->size(); ++j)
       pgt->poly_vector_hess((*pspt)[j], hpc[j]);
+    hpc_ok = true;
   }
 
   base_node geotrans_precomp_::transform(size_type i,
                                          const base_matrix &G) const {
-    if (c.empty()) init_val();
+    if (!c_ok) init_val();
     size_type N = G.nrows(), k = pgt->nb_points();
     base_node P(N);
     base_matrix::const_iterator git = G.begin();
+    const scalar_type *ci = c_tab.data(i);
     for (size_type l = 0; l < k; ++l) {
-      scalar_type a = c[i][l];
+      scalar_type a = ci[l];
       base_node::iterator pit = P.begin(), pite = P.end();
       for (; pit != pite; ++git, ++pit) *pit += a * (*git);
     }
@@ -1381,7 +1574,7 @@ namespace bgeot {
                                      pstored_point_tab pspt,
                                      dal::pstatic_stored_object dep) {
     dal::pstatic_stored_object_key pk= std::make_shared<pre_geot_key_>(pg,pspt);
-    dal::pstatic_stored_object o = dal::search_stored_object(pk);
+    dal::pstatic_stored_object o = dal::search_stored_object_on_all_threads(pk);
     if (o) return std::dynamic_pointer_cast<const geotrans_precomp_>(o);
     pgeotrans_precomp p = std::make_shared<geotrans_precomp_>(pg, pspt);
     dal::add_stored_object(pk, p, pg, pspt, dal::AUTODELETE_STATIC_OBJECT);
@@ -81,22 +81,133 @@ namespace bgeot
     assert(pgt);
     n_ref.resize(pgt->structure()->dim());
     converged = true;
-    if (pgt->is_linear())
-      return invert_lin(n, n_ref, IN_EPS);
-    else
+    if (pgt->is_linear()) {
+      base_node y(N);
+      return invert_lin(n, n_ref, y, IN_EPS);
+    } else
       return invert_nonlin(n, n_ref, IN_EPS, converged, false,
                            project_into_element);
   }
 
-  /* inversion for linear geometric transformations */
+  size_type geotrans_inv_convex::invert_points(const kdtree_tab_type &ipts,
+                                               std::vector<base_node> &pts_ref,
+                                               std::vector<bool> &in_cv,
+                                               std::vector<bool> &converged,
+                                               scalar_type IN_EPS,
+                                               bool project_into_element) {
+    assert(pgt);
+    size_type nb = ipts.size(), nb_in = 0;
+    pts_ref.resize(nb); in_cv.resize(nb); converged.assign(nb, true);
+    if (pgt->is_linear()) {
+      base_node y(N);
+      for (size_type l = 0; l < nb; ++l) {
+        pts_ref[l].resize(P);
+        in_cv[l] = invert_lin(ipts[l].n, pts_ref[l], y, IN_EPS);
+      }
+    } else {
+      for (size_type l = 0; l < nb; ++l) {
+        bool conv = true;
+        pts_ref[l].resize(P);
+        in_cv[l] = invert_nonlin(ipts[l].n, pts_ref[l], IN_EPS, conv, false,
+                                 project_into_element);
+        converged[l] = conv;
+      }
+    }
+    for (size_type l = 0; l < nb; ++l) if (in_cv[l]) ++nb_in;
+    return nb_in;
+  }
+
+  /* inversion for linear geometric transformations. The map being
+     affine, n_ref is obtained in closed form and the residual is only
+     the distance to the affine hull of the element when P < N. */
   bool geotrans_inv_convex::invert_lin(const base_node& n, base_node& n_ref,
-                                       scalar_type IN_EPS) {
-    base_node y(n); for (size_type i=0; i < N; ++i) y[i] -= G(i,0);
+                                       base_node &y, scalar_type IN_EPS) {
+    for (size_type i=0; i < N; ++i) y[i] = n[i] - G(i,0);
     mult(transposed(B), y, n_ref);
-    y = pgt->transform(n_ref, G);
-    add(gmm::scaled(n, -1.0), y);
+    scalar_type res(0);
+    if (P != N) { // K is the gradient of the transformation (see update_B)
+      for (size_type i=0; i < N; ++i) {
+        scalar_type r = y[i];
+        for (size_type k=0; k < P; ++k) r -= K(i,k) * n_ref[k];
+        res += r * r;
+      }
+      res = gmm::sqrt(res);
+    }
+    return point_in_convex(*pgt, n_ref, res, IN_EPS);
+  }
 
-    return point_in_convex(*pgt, n_ref, gmm::vect_norm2(y), IN_EPS);
+  /* Solution of K d = r with Cramer's rule for small fixed sizes. */
+  static bool cramer_solve(const scalar_type (&K)[1][1],
+                           const base_node &r, base_node &d) {
+    if (K[0][0] == scalar_type(0)) return false;
+    d[0] = r[0] / K[0][0];
+    return true;
+  }
+
+  static bool cramer_solve(const scalar_type (&K)[2][2],
+                           const base_node &r, base_node &d) {
+    scalar_type det = K[0][0]*K[1][1] - K[0][1]*K[1][0];
+    if (det == scalar_type(0)) return false;
+    d[0] = (K[1][1]*r[0] - K[0][1]*r[1]) / det;
+    d[1] = (K[0][0]*r[1] - K[1][0]*r[0]) / det;
+    return true;
+  }
+
+  static bool cramer_solve(const scalar_type (&K)[3][3],
+                           const base_node &r, base_node &d) {
+    scalar_type c00 = K[1][1]*K[2][2] - K[1][2]*K[2][1];
+    scalar_type c01 = K[1][2]*K[2][0] - K[1][0]*K[2][2];
+    scalar_type c02 = K[1][0]*K[2][1] - K[1][1]*K[2][0];
+    scalar_type det = K[0][0]*c00 + K[0][1]*c01 + K[0][2]*c02;
+    if (det == scalar_type(0)) return false;
+    scalar_type c10 = K[0][2]*K[2][1] - K[0][1]*K[2][2];
+    scalar_type c11 = K[0][0]*K[2][2] - K[0][2]*K[2][0];
+    scalar_type c12 = K[0][1]*K[2][0] - K[0][0]*K[2][1];
+    scalar_type c20 = K[0][1]*K[1][2] - K[0][2]*K[1][1];
+    scalar_type c21 = K[0][2]*K[1][0] - K[0][0]*K[1][2];
+    scalar_type c22 = K[0][0]*K[1][1] - K[0][1]*K[1][0];
+    d[0] = (c00*r[0] + c10*r[1] + c20*r[2]) / det;
+    d[1] = (c01*r[0] + c11*r[1] + c21*r[2]) / det;
+    d[2] = (c02*r[0] + c12*r[1] + c22*r[2]) / det;
+    return true;
+  }
+
+  /* Newton direction d = (G pc)^{-1} r for square transformations of
+     dimension D <= 3, with fixed size arrays instead of the dynamic
+     matrices and the LU inversion of update_B().
+     Returns false if the gradient is singular. */
+  template <size_type D>
+  static bool small_newton_direction(const base_matrix &G,
+                                     const base_matrix &pc,
+                                     const base_node &r, base_node &d) {
+    scalar_type K[D][D];
+    size_type nbpt = pc.nrows();
+    const scalar_type *pG = &(*(G.begin())), *ppc = &(*(pc.begin()));
+    for (size_type i = 0; i < D; ++i)
+      for (size_type j = 0; j < D; ++j) {
+        scalar_type a(0);
+        for (size_type k = 0; k < nbpt; ++k) a += pG[i+k*D] * ppc[k+j*nbpt];
+        K[i][j] = a;
+      }
+    return cramer_solve(K, r, d);
+  }
+
+  /* Newton direction B^T diff, with a fixed size computation when
+     possible. */
+  void geotrans_inv_convex::newton_direction(const base_node &diff,
+                                             base_node &d) {
+    bool ok = false;
+    if (N == P) {
+      switch (N) {
+      case 1: ok = small_newton_direction<1>(G, pc, diff, d); break;
+      case 2: ok = small_newton_direction<2>(G, pc, diff, d); break;
+      case 3: ok = small_newton_direction<3>(G, pc, diff, d); break;
+      }
+    }
+    if (!ok) {
+      update_B();
+      mult(transposed(B), diff, d);
+    }
   }
 
   void geotrans_inv_convex::update_B() {
@@ -243,8 +354,7 @@ namespace bgeot
         res0 = res;
       }
       pgt->poly_vector_grad(x, pc);
-      update_B();
-      mult(transposed(B), diff, x0_ref);
+      newton_direction(diff, x0_ref);
       add(gmm::scaled(x0_ref, -1.0 * factor), x);
       if (project_into_element) project_into_convex(x, pgt);
       x0_real = pgt->transform(x, G);
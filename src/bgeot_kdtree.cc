@@ -21,252 +21,306 @@
 
 
 #include "getfem/bgeot_kdtree.h"
+#include "getfem/getfem_omp.h"
 
 namespace bgeot {
-  
-  /* leafs contains a list of points */
-  struct kdtree_leaf : public kdtree_elt_base {
-    kdtree_tab_type::const_iterator it;
-    kdtree_leaf(kdtree_tab_type::const_iterator begin, 
-		kdtree_tab_type::const_iterator end) : 
-      kdtree_elt_base(unsigned(std::distance(begin,end))) { it = begin; }
-  };
-  
-  struct kdtree_node : public kdtree_elt_base {
-    scalar_type split_v;
-    std::unique_ptr<kdtree_elt_base> left, right; /* left: <=v, right: >v */
-    kdtree_node(scalar_type v, std::unique_ptr<kdtree_elt_base> &&left_,
-		std::unique_ptr<kdtree_elt_base> &&right_) : 
-      kdtree_elt_base(0), split_v(v),
-      left(std::move(left_)), right(std::move(right_)) {}
-  };
 
-  typedef kdtree_tab_type::iterator ITER;
-  
-  /* sorting of kdtree_tab_type with respect to a component of the points */
-  struct component_sort {
-    unsigned dir; 
-    component_sort(unsigned d) : dir(d) {}
-    bool operator()(const index_node_pair& a, const index_node_pair& b) 
-    { return a.n.at(dir) < b.n.at(dir); }
-  };
-  /* splitting of kdtree_tab_type with respect to a given value */
-  /*struct component_split { 
-    unsigned dir; scalar_type v;
-    component_split(unsigned d, scalar_type v_) : dir(d), v(v_) {}
-    bool operator()(const index_node_pair& a) 
-    { return (a.n.at(dir) <= v); }
-  };
-  */
+  void kdtree::clear_tree() {
+    coords = std::vector<scalar_type>();
+    split_v = std::vector<scalar_type>();
+    split_dir = std::vector<unsigned char>();
+    tree_built = false;
+  }
 
-  static ITER partition(ITER begin, ITER end, unsigned dir, scalar_type median) {
-    --end;
-    do {
-      while (begin <= end && (*begin).n.at(dir) <= median) ++begin; 
-      while (begin <= end && (*end).n.at(dir) > median) --end;
-      if (begin < end) { begin->swap(*end); ++begin; --end; } else break;
-    } while (1);
-    return begin;
+  /* number of nodes of the implicit tree over n points, i.e. one plus
+     the largest index of a splitting node. */
+  static size_type kdtree_nb_nodes(size_type inode, size_type n) {
+    if (n <= kdtree::PTS_PER_LEAF) return 0;
+    return std::max(inode+1,
+                    std::max(kdtree_nb_nodes(2*inode+1, n/2),
+                             kdtree_nb_nodes(2*inode+2, n - n/2)));
   }
-  /* 
-     build (recursively) a complete tree for points in the interval
-     [begin, end[ dir is the splitting direction.
-     (may be ameliorated doing a single sort on each component at the begining)
-  */
-  static std::unique_ptr<kdtree_elt_base> build_tree_(ITER begin,
-						      ITER end, unsigned dir) {
-    if (begin == end) return 0;
-    size_type npts = std::distance(begin,end);
-    if (npts > kdtree_elt_base::PTS_PER_LEAF) {
-      ITER itmedian;
-      scalar_type median;
-      size_type N = begin->n.size();
-      unsigned ndir_tests = unsigned(dir/N); dir = unsigned(dir % N);
-      if (npts > 50) {
-	/* too much points for an exact median: estimation of the median .. */
-        std::vector<index_node_pair> v(30);
-        //random_sample(begin,end,v.begin(),v.end());
-	for (size_type i=0; i < v.size(); ++i) 
-	  v[i] = begin[rand() % npts];
-        std::sort(v.begin(), v.end(), component_sort(dir));
-        median = (v[v.size()/2-1].n.at(dir)+v[v.size()/2].n.at(dir))/2;
-        //itmedian = std::partition(begin,end,component_split(dir, median));
-	itmedian = partition(begin,end,dir,median);
-	/*ITER it = begin; cout << "}"; while (it < end) { 
-	  if (it == itmedian) cout << "<|>"; else cout << " ";
-	  cout << (*it).n[dir];
-	  ++it;
-	  } cout << "}\n";*/
 
-      } else {
-	/* exact median computation */
-        std::sort(begin, end, component_sort(dir));
-        itmedian = begin + npts/2 - 1;
-        median = (*itmedian).n[dir];
-        while (itmedian < end && (*itmedian).n[dir] == median) itmedian++;
-      }
-      if (itmedian == end) /* could not split the set (all points have same value for component 'dir' !) */
-	if (ndir_tests == N-1) /* tested all N direction ? so all points are strictly the same */
-	  return std::make_unique<kdtree_leaf>(begin,end); 
-        else return std::make_unique<kdtree_node>
-	       (median, 
-		build_tree_(begin, itmedian, unsigned((dir+1)%N + (ndir_tests+1)*N)), std::unique_ptr<kdtree_node>());
-      else { /* the general case */
-	assert((*itmedian).n[dir] >= median && median >= (*(itmedian-1)).n[dir]);
-	return std::make_unique<kdtree_node>
-	  (median, build_tree_(begin, itmedian, unsigned((dir+1)%N)), 
-	   build_tree_(itmedian,end, unsigned((dir+1)%N)));
+  /* splits the node inode for the points in [b, e[ of perm. The
+     splitting direction is the one of largest extent of the points and
+     the splitting value is the exact median, so that the depth of the
+     tree is log2(nb_points/PTS_PER_LEAF). coords contains the
+     coordinates of the points in their original order. */
+  void kdtree::split_node(size_type inode, size_type b, size_type e,
+                          std::vector<size_type> &perm) {
+    const scalar_type *c = coords.data();
+    unsigned dir = 0;
+    scalar_type ext(-1);
+    for (unsigned k = 0; k < N; ++k) {
+      scalar_type vmin = c[perm[b]*N+k], vmax = vmin;
+      for (size_type j = b+1; j < e; ++j) {
+        scalar_type v = c[perm[j]*N+k];
+        vmin = std::min(vmin, v); vmax = std::max(vmax, v);
       }
-    } else {
-      return std::make_unique<kdtree_leaf>(begin,end);
+      if (vmax - vmin > ext) { ext = vmax - vmin; dir = k; }
     }
+    size_type m = b + (e - b) / 2, NN = N;
+    std::nth_element(perm.begin() + b, perm.begin() + m, perm.begin() + e,
+                     [c, dir, NN](size_type i, size_type j)
+                     { return c[i*NN+dir] < c[j*NN+dir]; });
+    split_v[inode] = c[perm[m]*N+dir];
+    split_dir[inode] = (unsigned char)(dir);
   }
 
-  /* avoid pushing too much arguments on the stack for points_in_box_ */
-  struct points_in_box_data_ {
-    base_node::const_iterator bmin;
-    base_node::const_iterator bmax;
-    kdtree_tab_type *ipts;
-    size_type N;
-  };
+  /* build (recursively) the subtree of the node inode. The subtrees
+     of depth "depth" are not built but stored in subtrees (as triplets
+     inode, b, e), to be built concurrently. The subtrees correspond to
+     disjoint ranges of perm and of the nodes. */
+  void kdtree::build_node(size_type inode, size_type b, size_type e,
+                          std::vector<size_type> &perm, size_type depth,
+                          std::vector<size_type> &subtrees) {
+    if (e - b <= PTS_PER_LEAF) return;
+    if (depth == 0) {
+      subtrees.push_back(inode); subtrees.push_back(b);
+      subtrees.push_back(e);
+      return;
+    }
+    split_node(inode, b, e, perm);
+    size_type m = b + (e - b) / 2;
+    build_node(2*inode+1, b, m, perm, depth-1, subtrees);
+    build_node(2*inode+2, m, e, perm, depth-1, subtrees);
+  }
 
-  /* recursive lookup for points inside a given box */
-  static void points_in_box_(const points_in_box_data_& p,
-			     const kdtree_elt_base *t, unsigned dir) {
-    if (!t->isleaf()) {
-      const kdtree_node *tn = static_cast<const kdtree_node*>(t);
-      if (p.bmin[dir] <= tn->split_v && tn->left.get())
-        points_in_box_(p, tn->left.get(), unsigned((dir+1)%p.N));
-      if (p.bmax[dir] > tn->split_v && tn->right)
-        points_in_box_(p, tn->right.get(), unsigned((dir+1)%p.N));
+  void kdtree::build_node(size_type inode, size_type b, size_type e,
+                          std::vector<size_type> &perm) {
+    if (e - b <= PTS_PER_LEAF) return;
+    split_node(inode, b, e, perm);
+    size_type m = b + (e - b) / 2;
+    build_node(2*inode+1, b, m, perm);
+    build_node(2*inode+2, m, e, perm);
+  }
+
+  void kdtree::build_tree() {
+    if (tree_built) return;
+    GMM_ASSERT1(N < 256, "kdtree dimension too large");
+    size_type nb = pts.size();
+    size_type nb_th = getfem::me_is_multithreaded_now()
+                    ? 1 : getfem::true_thread_policy::num_threads();
+    coords.resize(nb * N);
+    for (size_type j = 0; j < nb; ++j) {
+      base_node::const_iterator it = pts[j].n.const_begin();
+      for (size_type k = 0; k < N; ++k) coords[j*N+k] = it[k];
+    }
+    std::vector<size_type> perm(nb);
+    for (size_type j = 0; j < nb; ++j) perm[j] = j;
+    size_type nb_nodes = kdtree_nb_nodes(0, nb);
+    split_v.assign(nb_nodes, scalar_type(0));
+    split_dir.assign(nb_nodes, 0);
+
+    // The top levels are built sequentially, until there are at least
+    // as many subtrees as threads. The subtrees are then shared between
+    // the threads. The result does not depend on the number of threads.
+    size_type depth = 0;
+    while ((size_type(1) << depth) < nb_th) ++depth;
+    std::vector<size_type> subtrees;
+    build_node(0, 0, nb, perm, depth, subtrees);
+    size_type nb_sub = subtrees.size() / 3;
+    if (nb_th == 1) {
+      for (size_type i = 0; i < nb_sub; ++i)
+        build_node(subtrees[3*i], subtrees[3*i+1], subtrees[3*i+2], perm);
     } else {
-      const kdtree_leaf *tl = static_cast<const kdtree_leaf*>(t);
-      kdtree_tab_type::const_iterator itpt = tl->it;
-      for (size_type i=tl->n;i; --i, ++itpt) {
-        bool is_in = true;
-        base_node::const_iterator it=itpt->n.const_begin();
-        for (size_type k=0; k < p.N; ++k) {
-	  //cout << "test: k=" << k << ", " << it[k] << ", p.bmin[k]=" << p.bmin[k] << ", p.bmax[k]=" << p.bmax[k] << "\n";
-          if (it[k] < p.bmin[k] || it[k] > p.bmax[k]) {
-	    is_in = false; break; 
-	  }
-        }
-        if (is_in) p.ipts->push_back(*itpt);
-      }
+      GETFEM_OMP_PARALLEL_NO_PARTITION(
+        size_type th = getfem::true_thread_policy::this_thread();
+        size_type i0 = (nb_sub * th) / nb_th;
+        size_type i1 = (nb_sub * (th+1)) / nb_th;
+        for (size_type i = i0; i < i1; ++i)
+          build_node(subtrees[3*i], subtrees[3*i+1], subtrees[3*i+2], perm);
+      )
     }
+
+    // points and coordinates stored in the order of the tree
+    kdtree_tab_type pts2(nb);
+    std::vector<scalar_type> coords2(nb * N);
+    for (size_type j = 0; j < nb; ++j) {
+      pts2[j].swap(pts[perm[j]]);
+      for (size_type k = 0; k < N; ++k) coords2[j*N+k] = coords[perm[j]*N+k];
+    }
+    pts.swap(pts2); coords.swap(coords2);
+    tree_built = true;
   }
 
-  /* avoid pushing too much arguments on the stack for nearest_neighbor_ */
-  struct nearest_neighbor_data_ {
-    base_node::const_iterator pos;
-    index_node_pair *ipt;
+  /* Depth first traversal of the tree. The visitor gives the child to
+     be visited first and decides, just before visiting it, whether a
+     child has to be visited. */
+  template <typename VISITOR>
+  void kdtree::visit_(VISITOR &v, size_type inode,
+                      size_type b, size_type e) const {
+    if (e - b <= PTS_PER_LEAF) { v.leaf(coords.data(), b, e); return; }
+    size_type m = b + (e - b) / 2;
+    unsigned dir = split_dir[inode];
+    scalar_type split = split_v[inode];
+    int first = v.first(dir, split);
+    for (int side = first, c = 0; c < 2; ++c, side = 1 - side)
+      if (v.visit(dir, split, side)) {
+        if (side == 0) visit_(v, 2*inode+1, b, m);
+        else visit_(v, 2*inode+2, m, e);
+      }
+  }
+
+  /* the left child contains values <= split and the right one values
+     >= split. */
+  struct kdtree_box_visitor {
+    base_node::const_iterator bmin, bmax;
+    const kdtree_tab_type &pts;
+    kdtree_tab_type &ipts;
     size_type N;
-    mutable scalar_type dist2;
-    base_node::iterator vec_to_tree_elm;
+    int first(unsigned, scalar_type) const { return 0; }
+    bool visit(unsigned dir, scalar_type split, int side) const
+    { return side ? (bmax[dir] >= split) : (bmin[dir] <= split); }
+    void leaf(const scalar_type *coords, size_type b, size_type e) {
+      for (size_type j = b; j < e; ++j) {
+        const scalar_type *it = coords + j*N;
+        bool is_in = true;
+        for (size_type k = 0; k < N; ++k)
+          if (it[k] < bmin[k] || it[k] > bmax[k]) { is_in = false; break; }
+        if (is_in) ipts.push_back(pts[j]);
+      }
+    }
+    kdtree_box_visitor(const base_node &bmin_, const base_node &bmax_,
+                       const kdtree_tab_type &pts_, kdtree_tab_type &ipts_,
+                       size_type N_)
+      : bmin(bmin_.const_begin()), bmax(bmax_.const_begin()), pts(pts_),
+        ipts(ipts_), N(N_) {}
   };
 
-  /* recursive lookup for the nearest neighbor point at a given position */
-  static void nearest_neighbor_assist(const nearest_neighbor_data_& p,
-			              const kdtree_elt_base *t, unsigned dir) {
-    scalar_type dist2(0);
-    for (size_type k=0; k < p.N; ++k)
-      dist2 += p.vec_to_tree_elm[k] * p.vec_to_tree_elm[k];
-    if (dist2 > p.dist2 && p.dist2 > scalar_type(0)) return;
-
-    if (!t->isleaf()) {
-      const kdtree_node *tn = static_cast<const kdtree_node*>(t);
-      scalar_type tmp = p.vec_to_tree_elm[dir];
-      scalar_type dist = p.pos[dir] - tn->split_v;
-      if (tn->left.get()) {
-        if (dist > tmp) p.vec_to_tree_elm[dir] = dist;
-        nearest_neighbor_assist(p, tn->left.get(), unsigned((dir+1)%p.N));
-        p.vec_to_tree_elm[dir] = tmp;
-      }
-      if (tn->right) {
-        if (-dist > tmp) p.vec_to_tree_elm[dir] = -dist;
-        nearest_neighbor_assist(p, tn->right.get(), unsigned((dir+1)%p.N));
-        p.vec_to_tree_elm[dir] = tmp;
-      }
-    } else {
-      // find the nearest neighbor inside the leaf
-      const kdtree_leaf *tl = static_cast<const kdtree_leaf*>(t);
-      kdtree_tab_type::const_iterator itpt = tl->it;
-      for (size_type i=tl->n;i; --i, ++itpt) {
-        dist2 = scalar_type(0);
-        base_node::const_iterator it=itpt->n.const_begin();
-        for (size_type k=0; k < p.N; ++k) {
-          scalar_type dist = it[k] - p.pos[k];
-          dist2 += dist * dist;
-        }
-        if (dist2 < p.dist2 || p.dist2 < scalar_type(0)){
-          *(p.ipt) = *itpt;
-          p.dist2 = dist2;
-        }
+  struct kdtree_ball_visitor {
+    base_node::const_iterator pos;
+    scalar_type r;
+    const kdtree_tab_type &pts;
+    kdtree_tab_type &ipts;
+    size_type N;
+    int first(unsigned, scalar_type) const { return 0; }
+    bool visit(unsigned dir, scalar_type split, int side) const
+    { return side ? (pos[dir] + r >= split) : (pos[dir] - r <= split); }
+    void leaf(const scalar_type *coords, size_type b, size_type e) {
+      for (size_type j = b; j < e; ++j) {
+        const scalar_type *it = coords + j*N;
+        scalar_type d2(0);
+        for (size_type k = 0; k < N; ++k)
+          d2 += (it[k] - pos[k]) * (it[k] - pos[k]);
+        if (d2 <= r*r) ipts.push_back(pts[j]);
       }
     }
-  }
+    kdtree_ball_visitor(const base_node &pos_, scalar_type r_,
+                        const kdtree_tab_type &pts_, kdtree_tab_type &ipts_,
+                        size_type N_)
+      : pos(pos_.const_begin()), r(r_), pts(pts_), ipts(ipts_), N(N_) {}
+  };
 
-  static void nearest_neighbor_main(const nearest_neighbor_data_& p,
-			            const kdtree_elt_base *t, unsigned dir) {
-    if (!t->isleaf()) {
-      const kdtree_node *tn = static_cast<const kdtree_node*>(t);
-      scalar_type dist = p.pos[dir] - tn->split_v;
-      if ((dist <= scalar_type(0) && tn->left.get()) || !tn->right.get()) {
-        nearest_neighbor_main(p, tn->left.get(), unsigned((dir+1)%p.N));
-      } else if (tn->right.get()) {
-        nearest_neighbor_main(p, tn->right.get(), unsigned((dir+1)%p.N));
-      } else {
-        assert(false);
-      }
-      // check the possibility of points at the opposite side of the current
-      // tree node which are closer to pos as the current minimum distance
-      if (dist * dist <= p.dist2) {
-        for (size_type k=0; k < p.N; ++k) p.vec_to_tree_elm[k] = 0.;
-        if ((dist <= scalar_type(0) && tn->right.get()) || !tn->left.get()) {
-          p.vec_to_tree_elm[dir] = -dist;
-          nearest_neighbor_assist(p, tn->right.get(), unsigned((dir+1)%p.N));
-        } else if (tn->left.get()) {
-          p.vec_to_tree_elm[dir] = dist;
-          nearest_neighbor_assist(p, tn->left.get(), unsigned((dir+1)%p.N));
+  /* the k nearest points are kept in a max heap on the distance. */
+  struct kdtree_knn_visitor {
+    typedef std::pair<scalar_type, size_type> dist_index;
+    base_node::const_iterator pos;
+    size_type k, N;
+    std::vector<dist_index> heap;
+    int first(unsigned dir, scalar_type split) const
+    { return (pos[dir] <= split) ? 0 : 1; }
+    bool visit(unsigned dir, scalar_type split, int side) const {
+      scalar_type d = pos[dir] - split;
+      if ((side == 0) == (d <= scalar_type(0))) return true; // near side
+      return heap.size() < k || d*d <= heap.front().first;
+    }
+    void leaf(const scalar_type *coords, size_type b, size_type e) {
+      for (size_type j = b; j < e; ++j) {
+        const scalar_type *it = coords + j*N;
+        scalar_type d2(0);
+        for (size_type l = 0; l < N; ++l)
+          d2 += (it[l] - pos[l]) * (it[l] - pos[l]);
+        if (heap.size() < k) {
+          heap.push_back(dist_index(d2, j));
+          std::push_heap(heap.begin(), heap.end());
+        } else if (d2 < heap.front().first) {
+          std::pop_heap(heap.begin(), heap.end());
+          heap.back() = dist_index(d2, j);
+          std::push_heap(heap.begin(), heap.end());
         }
       }
-    } else {
-      // find the nearest neighbor inside the leaf which contains pos
-      nearest_neighbor_assist(p, t, dir);
     }
-  }
-
-  void kdtree::clear_tree() { tree = std::unique_ptr<kdtree_elt_base>(); }
+    kdtree_knn_visitor(const base_node &pos_, size_type k_, size_type N_)
+      : pos(pos_.const_begin()), k(k_), N(N_) { heap.reserve(k); }
+  };
 
   void kdtree::points_in_box(kdtree_tab_type &ipts,
-			     const base_node &min, 
+			     const base_node &min,
 			     const base_node &max) {
     ipts.resize(0);
-    if (tree == 0) { tree = build_tree_(pts.begin(), pts.end(), 0); if (!tree) return; }
-    base_node bmin(min), bmax(max);
-    for (size_type i=0; i < bmin.size(); ++i) if (bmin[i] > bmax[i]) return;
-    points_in_box_data_ p; 
-    p.bmin = bmin.const_begin(); p.bmax = bmax.const_begin();
-    p.ipts = &ipts; p.N = N; 
-    points_in_box_(p, tree.get(), 0);
+    build_tree();
+    if (pts.size() == 0) return;
+    for (size_type i=0; i < min.size(); ++i) if (min[i] > max[i]) return;
+    kdtree_box_visitor v(min, max, pts, ipts, N);
+    visit_(v, 0, 0, pts.size());
+  }
+
+  void kdtree::points_in_ball(kdtree_tab_type &ipts,
+                              const base_node &pos, scalar_type r) {
+    ipts.resize(0);
+    build_tree();
+    if (pts.size() == 0 || r < scalar_type(0)) return;
+    kdtree_ball_visitor v(pos, r, pts, ipts, N);
+    visit_(v, 0, 0, pts.size());
   }
 
   scalar_type kdtree::nearest_neighbor(index_node_pair &ipt,
                                        const base_node &pos) {
-    
     ipt.i = size_type(-1);
-    if (tree == 0) {
-      tree = build_tree_(pts.begin(), pts.end(), 0);
-      if (!tree) return scalar_type(-1);
-    }
-    nearest_neighbor_data_ p;
-    p.pos = pos.const_begin();
-    p.ipt = &ipt;
-    p.N = N;
-    p.dist2 = scalar_type(-1);
-    base_node tmp(N);
-    p.vec_to_tree_elm = tmp.begin();
-    nearest_neighbor_main(p, tree.get(), 0);
-    return p.dist2;
+    build_tree();
+    if (pts.size() == 0) return scalar_type(-1);
+    kdtree_knn_visitor v(pos, 1, N);
+    visit_(v, 0, 0, pts.size());
+    ipt.i = pts[v.heap[0].second].i; ipt.n = pts[v.heap[0].second].n;
+    return v.heap[0].first;
+  }
+
+  void kdtree::k_nearest_neighbors(kdtree_tab_type &ipts,
+                                   std::vector<scalar_type> &dist2,
+                                   const base_node &pos, size_type k) {
+    ipts.resize(0); dist2.resize(0);
+    build_tree();
+    if (pts.size() == 0 || k == 0) return;
+    kdtree_knn_visitor v(pos, k, N);
+    visit_(v, 0, 0, pts.size());
+    std::sort_heap(v.heap.begin(), v.heap.end());
+    for (const auto &di : v.heap)
+      { ipts.push_back(pts[di.second]); dist2.push_back(di.first); }
+  }
+
+  void kdtree::points_in_ball(std::vector<kdtree_tab_type> &ipts,
+                              const std::vector<base_node> &pos,
+                              scalar_type r) {
+    ipts.resize(pos.size());
+    build_tree(); // before the concurrent queries
+    size_type nb_th = getfem::me_is_multithreaded_now()
+                    ? 1 : getfem::true_thread_policy::num_threads();
+    GETFEM_OMP_PARALLEL_NO_PARTITION(
+      size_type th = (nb_th == 1)
+                   ? 0 : getfem::true_thread_policy::this_thread();
+      size_type i0 = (pos.size() * th) / nb_th;
+      size_type i1 = (pos.size() * (th+1)) / nb_th;
+      for (size_type i = i0; i < i1; ++i)
+        points_in_ball(ipts[i], pos[i], r);
+    )
+  }
+
+  void kdtree::k_nearest_neighbors(std::vector<kdtree_tab_type> &ipts,
+                                   const std::vector<base_node> &pos,
+                                   size_type k) {
+    ipts.resize(pos.size());
+    build_tree(); // before the concurrent queries
+    size_type nb_th = getfem::me_is_multithreaded_now()
+                    ? 1 : getfem::true_thread_policy::num_threads();
+    GETFEM_OMP_PARALLEL_NO_PARTITION(
+      size_type th = (nb_th == 1)
+                   ? 0 : getfem::true_thread_policy::this_thread();
+      std::vector<scalar_type> dist2;
+      size_type i0 = (pos.size() * th) / nb_th;
+      size_type i1 = (pos.size() * (th+1)) / nb_th;
+      for (size_type i = i0; i < i1; ++i)
+        k_nearest_neighbors(ipts[i], dist2, pos[i], k);
+    )
   }
 }
@@ -22,6 +22,7 @@
 
 
 #include "getfem/bgeot_mesh_structure.h"
+#include "getfem/getfem_omp.h"
 
 namespace bgeot {
 
@@ -46,6 +47,7 @@ namespace bgeot {
 
   void mesh_structure::swap_points(size_type i, size_type j) {
     if (i == j) return;
+    compact.reset();
     std::vector<size_type> doubles;
 
     for (size_type k = 0; k < points_tab[i].size(); ++k) {
@@ -68,6 +70,7 @@ namespace bgeot {
 
   void mesh_structure::swap_convex(size_type i, size_type j) {
     if (i == j) return;
+    compact.reset();
     std::vector<size_type> doubles;
 
     if (is_convex_valid(i))
@@ -99,6 +102,7 @@ namespace bgeot {
 
   void mesh_structure::sup_convex(size_type ic) {
     if (!(is_convex_valid(ic))) return;
+    compact.reset();
     for (size_type l = 0; l < convex_tab[ic].pts.size(); ++l) {
       size_type &ind = convex_tab[ic].pts[l];
       std::vector<size_type>::iterator it1= points_tab[ind].begin(), it2 = it1;
@@ -185,9 +189,134 @@ namespace bgeot {
       mems += convex_tab[i].pts.size() * sizeof(size_type);
     for (size_type i = 0; i < points_tab.size(); ++i)
       mems += points_tab[i].size() * sizeof(size_type);
+    if (compact) mems += compact->memsize();
     return mems;
   }
 
+  size_type mesh_structure_compact::memsize() const {
+    return sizeof(mesh_structure_compact)
+      + structures.size() * sizeof(pconvex_structure)
+      + cv_block.size() * sizeof(unsigned)
+      + (block_first.size() + cv_order.size() + cv_first.size()
+         + cv_points.size() + face_first.size() + face_neighbour.size()
+         + pt_first.size() + pt_convexes.size()) * sizeof(size_type);
+  }
+
+  /* Call f for each convex other than ic having the nb points ipts (and
+     of the same dimension than ic if same_dim is true), in the order of
+     the list of convexes of ipts[0], until f returns true. */
+  template <typename F>
+  static void compact_convexes_having_points(const mesh_structure_compact &c,
+                                             size_type ic,
+                                             const size_type *ipts,
+                                             size_type nb, bool same_dim,
+                                             F f) {
+    dim_type d = c.structure_of_convex(ic)->dim();
+    for (const size_type *it = c.convexes_of_point_begin(ipts[0]),
+           *ite = c.convexes_of_point_end(ipts[0]); it != ite; ++it) {
+      size_type icv = *it;
+      if (icv == ic) continue;
+      pconvex_structure cs = c.structure_of_convex(icv);
+      if (same_dim && cs->dim() != d) continue;
+      const size_type *p = c.points_of_convex(icv), *pe = p + cs->nb_points();
+      size_type k = 1;
+      for (; k < nb; ++k) if (std::find(p, pe, ipts[k]) == pe) break;
+      if (k == nb && f(icv)) return;
+    }
+  }
+
+  void mesh_structure::freeze() {
+    build_compact();
+    for (size_type ip = 0; ip < points_tab.size(); ++ip)
+      points_tab[ip].shrink_to_fit();
+  }
+
+  /* The compact copy costs about as much as a neighbour query per face
+     of each convex, so that building it after nb_allocated_convex()
+     queries at most multiplies their cost by the number of faces, even
+     when the structure is modified between the queries. The lists of
+     convexes of the points are not trimmed here since the caller may
+     be iterating on one of them. */
+  void mesh_structure::freeze_on_demand() const {
+    if (compact || getfem::me_is_multithreaded_now()) return;
+    if (++nb_unfrozen_queries > nb_allocated_convex()) build_compact();
+  }
+
+  void mesh_structure::build_compact() const {
+    std::shared_ptr<mesh_structure_compact>
+      pc = std::make_shared<mesh_structure_compact>();
+    mesh_structure_compact &c = *pc;
+    size_type nbcv = nb_allocated_convex(), nbpt = points_tab.size();
+
+    /* convexes grouped by structure, the blocks being in the order of the
+       first convex of each structure. */
+    std::vector<std::vector<size_type> > lists;
+    c.cv_block.assign(nbcv, unsigned(-1));
+    unsigned b = 0;
+    for (dal::bv_visitor ic(convex_index()); !ic.finished(); ++ic) {
+      pconvex_structure cs = convex_tab[ic].cstruct;
+      if (b >= c.structures.size() || c.structures[b] != cs) {
+        b = unsigned(std::find(c.structures.begin(), c.structures.end(), cs)
+                     - c.structures.begin());
+        if (b == c.structures.size())
+          { c.structures.push_back(cs); lists.push_back(ind_set()); }
+      }
+      lists[b].push_back(ic); c.cv_block[ic] = b;
+    }
+    c.block_first.push_back(0);
+    c.cv_first.assign(nbcv, 0); c.face_first.assign(nbcv, 0);
+    size_type nbf = 0;
+    for (b = 0; b < c.structures.size(); ++b) {
+      for (size_type ic : lists[b]) {
+        const ind_set &pts = convex_tab[ic].pts;
+        c.cv_order.push_back(ic);
+        c.cv_first[ic] = c.cv_points.size();
+        c.cv_points.insert(c.cv_points.end(), pts.begin(), pts.end());
+        c.face_first[ic] = nbf;
+        nbf += c.structures[b]->nb_faces();
+      }
+      c.block_first.push_back(c.cv_order.size());
+      ind_set().swap(lists[b]);
+    }
+
+    /* convexes of each point, in the same order as in points_tab */
+    c.pt_first.resize(nbpt+1, 0);
+    for (size_type ip = 0; ip < nbpt; ++ip)
+      c.pt_first[ip+1] = c.pt_first[ip] + points_tab[ip].size();
+    c.pt_convexes.resize(c.pt_first[nbpt]);
+    for (size_type ip = 0; ip < nbpt; ++ip) {
+      std::copy(points_tab[ip].begin(), points_tab[ip].end(),
+                c.pt_convexes.begin() + c.pt_first[ip]);
+    }
+
+    /* first neighbour of each face, as given by neighbour_of_convex */
+    c.face_neighbour.assign(nbf, size_type(-1));
+    size_type nb_th = getfem::me_is_multithreaded_now()
+                    ? 1 : getfem::true_thread_policy::num_threads();
+    GETFEM_OMP_PARALLEL_NO_PARTITION(
+      size_type th = (nb_th == 1)
+                   ? 0 : getfem::true_thread_policy::this_thread();
+      std::vector<size_type> fpts;
+      for (size_type i = (c.cv_order.size() * th) / nb_th;
+           i < (c.cv_order.size() * (th+1)) / nb_th; ++i) {
+        size_type ic = c.cv_order[i];
+        pconvex_structure cs = c.structure_of_convex(ic);
+        const size_type *pts = c.points_of_convex(ic);
+        for (short_type f = 0; f < cs->nb_faces(); ++f) {
+          const convex_ind_ct &ind = cs->ind_points_of_face(f);
+          fpts.resize(ind.size());
+          for (size_type k = 0; k < ind.size(); ++k) fpts[k] = pts[ind[k]];
+          size_type &nf = c.face_neighbour[c.face_first[ic] + f];
+          compact_convexes_having_points(c, ic, fpts.data(), fpts.size(),
+                                         true, [&nf](size_type icv)
+                                         { nf = icv; return true; });
+        }
+      }
+    )
+    compact = pc;
+    nb_unfrozen_queries = 0;
+  }
+
   void mesh_structure::optimize_structure() {
     size_type i, j = nb_convex();
     for (i = 0; i < j; i++)
@@ -203,6 +332,7 @@ namespace bgeot {
   }
 
   void mesh_structure::clear(void) {
+    compact.reset();
     points_tab = dal::dynamic_tas<ind_cv_ct, 8>();
     convex_tab = dal::dynamic_tas<mesh_convex_structure, 8>();
 
@@ -217,6 +347,19 @@ namespace bgeot {
   void mesh_structure::neighbours_of_convex(size_type ic, short_type iff,
                                             ind_set &s) const {
     s.resize(0);
+    freeze_on_demand();
+    if (compact) {
+      const mesh_structure_compact &c = *compact;
+      const convex_ind_ct &ind
+        = c.structure_of_convex(ic)->ind_points_of_face(iff);
+      const size_type *pts = c.points_of_convex(ic);
+      std::vector<size_type> ipts(ind.size());
+      for (size_type k = 0; k < ind.size(); ++k) ipts[k] = pts[ind[k]];
+      compact_convexes_having_points(c, ic, ipts.data(), ipts.size(), true,
+                                     [&s](size_type icv)
+                                     { s.push_back(icv); return false; });
+      return;
+    }
     ind_pt_face_ct pt = ind_points_of_face_of_convex(ic, iff);
 
     for (size_type i = 0; i < points_tab[pt[0]].size(); ++i) {
@@ -233,6 +376,7 @@ namespace bgeot {
                                             const std::vector<short_type> &ftab,
                                             ind_set &s) const {
     s.resize(0);
+    freeze_on_demand();
     std::vector<size_type> ipts;
 
     switch (ftab.size()) {
@@ -268,6 +412,13 @@ namespace bgeot {
       return; // Should we return the all the neighbours ?
     }
 
+    if (compact) {
+      compact_convexes_having_points(*compact, ic, ipts.data(), ipts.size(),
+                                     false, [&s](size_type icv)
+                                     { s.push_back(icv); return false; });
+      return;
+    }
+
     auto ipt0 = ipts.cbegin();
     auto ipt1 = ipt0 + 1;
     short_type nbpts = short_type(ipts.size()-1);
@@ -279,7 +430,18 @@ namespace bgeot {
 
   void mesh_structure::neighbours_of_convex(size_type ic, ind_set &s) const {
     s.resize(0);
+    freeze_on_demand();
     unsigned nbf = nb_faces_of_convex(ic);
+    if (compact) {
+      ind_set sf;
+      for (short_type iff = 0; iff < nbf; ++iff) {
+        neighbours_of_convex(ic, iff, sf);
+        for (size_type icv : sf)
+          if (std::find(s.begin(), s.end(), icv) == s.end())
+            s.push_back(icv);
+      }
+      return;
+    }
     for (short_type iff = 0; iff < nbf; ++iff) {
       ind_pt_face_ct pt = ind_points_of_face_of_convex(ic, iff);
 
@@ -296,6 +458,8 @@ namespace bgeot {
 
   size_type mesh_structure::neighbour_of_convex(size_type ic,
                                                 short_type iff) const {
+    freeze_on_demand();
+    if (compact) return compact->neighbour_of_convex(ic, iff);
     ind_pt_face_ct pt = ind_points_of_face_of_convex(ic, iff);
 
     for (size_type i = 0; i < points_tab[pt[0]].size(); ++i) {
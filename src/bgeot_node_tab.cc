@@ -21,6 +21,7 @@
 
 
 #include "getfem/bgeot_node_tab.h"
+#include "getfem/getfem_omp.h"
 
 namespace bgeot {
 
@@ -117,6 +118,137 @@ namespace bgeot {
     return id;
   }
 
+  void node_tab::add_nodes(const std::vector<base_node> &pts,
+                           std::vector<size_type> &ids) {
+    ids.resize(pts.size());
+    if (pts.empty()) return;
+    if (this->card() == 0) dim_ = pts[0].size();
+    // Rebuilding the sorters at the next search is cheaper than updating
+    // them for a large number of points.
+    if (pts.size() > this->card() / 4) resort();
+    for (size_type i = 0; i < pts.size(); ++i) {
+      GMM_ASSERT1(dim_ == pts[i].size(), "Nodes should have the same dimension");
+      max_radius = std::max(max_radius, gmm::vect_norm2(pts[i]));
+      ids[i] = dal::dynamic_tas<base_node>::add(pts[i]);
+      for (size_type is = 0; is < sorters.size(); ++is)
+        sorters[is].insert(ids[i]);
+    }
+    eps = max_radius * prec_factor;
+  }
+
+  /* Spatial hash of the points on a grid. Any step greater than the
+     merge distance h is valid. A larger one avoids the visit of the
+     neighbouring cells for most of the points, the points of a mesh
+     being usually far apart compared to h. */
+  struct node_tab_hash {
+    typedef std::pair<size_type, size_type> cell_point; // (hash, point)
+    const dal::dynamic_tas<base_node> &pts;
+    unsigned N;
+    scalar_type h, step;
+    std::vector<cell_point> cells;   // sorted by hash.
+    std::vector<size_type> table;    // open addressing: hash -> first cell.
+    size_type mask;
+
+    size_type cell_hash(const long long *c) const {
+      size_type hh(0);
+      for (unsigned k = 0; k < N; ++k)
+        hh = (hh ^ size_type(c[k])) * size_type(0x9E3779B97F4A7C15ULL);
+      return hh;
+    }
+
+    long long cell_coord(scalar_type x) const
+    { return (long long)(std::floor(x / step)); }
+
+    size_type first_cell(size_type hh) const {
+      for (size_type k = (hh >> 20) & mask; ; k = (k+1) & mask) {
+        if (table[k] == size_type(-1)) return size_type(-1);
+        if (cells[table[k]].first == hh) return table[k];
+      }
+    }
+
+    /* Smallest index j of a point at a distance smaller than h from the
+       point i, for which accept(j) is true, or i if there is none. */
+    template <typename ACCEPT>
+    size_type smallest_close_point(size_type i, const ACCEPT &accept) const {
+      const base_node &P = pts[i];
+      long long c0[8], c1[8], c[8];
+      for (unsigned k = 0; k < N; ++k) {
+        c[k] = c0[k] = cell_coord(P[k] - h);
+        c1[k] = cell_coord(P[k] + h);
+      }
+      size_type res = i;
+      for (;;) {
+        size_type hh = cell_hash(c);
+        for (size_type l = first_cell(hh);
+             l < cells.size() && cells[l].first == hh; ++l) {
+          size_type j = cells[l].second;
+          if (j < res && accept(j) && gmm::vect_dist2(P, pts[j]) < h)
+            res = j;
+        }
+        unsigned k = 0;
+        for (; k < N && c[k] == c1[k]; ++k) c[k] = c0[k];
+        if (k == N) break;
+        ++(c[k]);
+      }
+      return res;
+    }
+
+    node_tab_hash(const dal::dynamic_tas<base_node> &pts_, unsigned N_,
+                  scalar_type h_)
+      : pts(pts_), N(N_), h(h_), step(h_ * scalar_type(64)) {
+      GMM_ASSERT1(N <= 8, "Dimension too large for the merge of nodes");
+      long long c[8];
+      cells.reserve(pts.card());
+      for (dal::bv_visitor i(pts.index()); !i.finished(); ++i) {
+        for (unsigned k = 0; k < N; ++k) c[k] = cell_coord(pts[i][k]);
+        cells.push_back(cell_point(cell_hash(c), i));
+      }
+      std::sort(cells.begin(), cells.end());
+      size_type ts = 16;
+      while (ts < 2 * cells.size()) ts *= 2;
+      table.assign(ts, size_type(-1)); mask = ts - 1;
+      for (size_type l = 0; l < cells.size(); ++l)
+        if (l == 0 || cells[l].first != cells[l-1].first) {
+          size_type k = (cells[l].first >> 20) & mask;
+          while (table[k] != size_type(-1)) k = (k+1) & mask;
+          table[k] = l;
+        }
+    }
+  };
+
+  size_type node_tab::merge_duplicated_nodes(std::vector<size_type> &rep,
+                                             const scalar_type radius) {
+    rep.assign(index().card() ? index().last_true()+1 : 0, size_type(-1));
+    if (card() == 0) return 0;
+    node_tab_hash hash(*this, dim_, std::max(eps, radius));
+
+    // For each point, the closest one of smaller index, computed in parallel.
+    std::vector<size_type> ipts, lower(rep.size());
+    for (dal::bv_visitor i(index()); !i.finished(); ++i) ipts.push_back(i);
+    size_type nb_th = getfem::me_is_multithreaded_now()
+                    ? 1 : getfem::true_thread_policy::num_threads();
+    GETFEM_OMP_PARALLEL_NO_PARTITION(
+      size_type th = (nb_th == 1) ? 0 : getfem::true_thread_policy::this_thread();
+      for (size_type k = (ipts.size()*th)/nb_th;
+           k < (ipts.size()*(th+1))/nb_th; ++k)
+        lower[ipts[k]] = hash.smallest_close_point
+          (ipts[k], [](size_type) { return true; });
+    )
+
+    // Sequential resolution: a point is merged with the kept point of
+    // smallest index which is close to it.
+    size_type nbm = 0;
+    for (size_type i : ipts) {
+      size_type j = lower[i];
+      if (j != i && rep[j] != j)
+        j = hash.smallest_close_point
+          (i, [&rep](size_type l) { return rep[l] == l; });
+      rep[i] = j;
+      if (j != i) { sup_node(i); ++nbm; }
+    }
+    return nbm;
+  }
+
   void node_tab::swap_points(size_type i, size_type j) {
     if (i != j) {
       bool existi = index().is_in(i), existj = index().is_in(j);
@@ -25,6 +25,7 @@
 #include "getfem/bgeot_small_vector.h"
 #include "getfem/bgeot_ftool.h"
 #include "getfem/getfem_locale.h"
+#include "getfem/getfem_omp.h"
 
 namespace bgeot {
 
@@ -250,5 +251,110 @@ namespace bgeot {
     return read_base_poly(n, f);
   }
 
+  /* ******************************************************************** */
+  /*   Compiled families of polynomials.                                  */
+  /* ******************************************************************** */
+
+  void polynomial_family::init(const std::vector<polynomial<scalar_type> > &P) {
+    nbp = P.size();
+    n = nbp ? P[0].dim() : short_type(0);
+    short_type deg = 0;
+    for (const polynomial<scalar_type> &p : P) {
+      GMM_ASSERT1(p.dim() == n, "Polynomials of different dimensions");
+      deg = std::max(deg, p.degree());
+    }
+    nbm = alpha(n, deg);
+
+    // monomials in the order of the global index, each one being obtained
+    // from a monomial of lower degree.
+    parent.assign(nbm, 0); var.assign(nbm, 0);
+    power_index mi(n);
+    std::vector<power_index> mis(nbm);
+    for (size_type m = 0; m < nbm; ++m, ++mi) {
+      mis[m] = mi;
+      if (m == 0) continue;
+      short_type j = 0;
+      while (mi[j] == 0) ++j;
+      power_index mj(mi); mj[j]--;
+      parent[m] = mj.global_index(); var[m] = j;
+    }
+
+    val_rows.start.assign(1, 0); val_rows.col.resize(0);
+    val_rows.coef.resize(0);
+    for (const polynomial<scalar_type> &p : P) {
+      for (size_type m = 0; m < p.size(); ++m)
+        if (p[m] != scalar_type(0))
+          { val_rows.col.push_back(m); val_rows.coef.push_back(p[m]); }
+      val_rows.start.push_back(val_rows.col.size());
+    }
+
+    // the derivative of x^a with respect to x_j is a_j x^(a-e_j).
+    grad_rows.start.assign(1, 0); grad_rows.col.resize(0);
+    grad_rows.coef.resize(0);
+    for (short_type j = 0; j < n; ++j)
+      for (const polynomial<scalar_type> &p : P) {
+        for (size_type m = 0; m < p.size(); ++m)
+          if (p[m] != scalar_type(0) && mis[m][j] > 0) {
+            power_index mj(mis[m]); mj[j]--;
+            grad_rows.col.push_back(mj.global_index());
+            grad_rows.coef.push_back(p[m] * scalar_type(mis[m][j]));
+          }
+        grad_rows.start.push_back(grad_rows.col.size());
+      }
+  }
+
+  template <size_type B>
+  void polynomial_family::eval_block_(const scalar_type *pts,
+                                      const sparse_rows &rows,
+                                      scalar_type *res,
+                                      scalar_type *mon) const {
+    // mon[m*B + p] is the value of the monomial m at the point p.
+    for (size_type p = 0; p < B; ++p) mon[p] = scalar_type(1);
+    for (size_type m = 1; m < nbm; ++m) {
+      const scalar_type *mp = mon + parent[m]*B, *x = pts + var[m];
+      scalar_type *mm = mon + m*B;
+      for (size_type p = 0; p < B; ++p) mm[p] = mp[p] * x[p*n];
+    }
+    size_type nbr = rows.start.size() - 1;
+    for (size_type r = 0; r < nbr; ++r) {
+      scalar_type acc[B];
+      for (size_type p = 0; p < B; ++p) acc[p] = scalar_type(0);
+      for (size_type e = rows.start[r]; e < rows.start[r+1]; ++e) {
+        scalar_type c = rows.coef[e];
+        const scalar_type *mm = mon + rows.col[e]*B;
+        for (size_type p = 0; p < B; ++p) acc[p] += c * mm[p];
+      }
+      for (size_type p = 0; p < B; ++p) res[p*nbr + r] = acc[p];
+    }
+  }
+
+  void polynomial_family::eval_(const scalar_type *pts, size_type npt,
+                                const sparse_rows &rows,
+                                scalar_type *res) const {
+    THREAD_SAFE_STATIC std::vector<scalar_type> mon;
+    if (mon.size() < nbm * BLOCK) mon.resize(nbm * BLOCK);
+    size_type nbr = rows.start.size() - 1, i = 0;
+    for (; i + BLOCK <= npt; i += BLOCK)
+      eval_block_<BLOCK>(pts + i*n, rows, res + i*nbr, mon.data());
+    for (; i < npt; ++i)
+      eval_block_<1>(pts + i*n, rows, res + i*nbr, mon.data());
+  }
+
+  void polynomial_family::eval(const scalar_type *pts, size_type npt,
+                               scalar_type *val) const
+  { eval_(pts, npt, val_rows, val); }
+
+  void polynomial_family::eval_grad(const scalar_type *pts, size_type npt,
+                                    scalar_type *grad) const
+  { eval_(pts, npt, grad_rows, grad); }
+
+  bool compile_polynomials(polynomial_family &F,
+                           const std::vector<polynomial<scalar_type> > &P) {
+    for (const polynomial<scalar_type> &p : P)
+      if (p.dim() != P[0].dim()) return false;
+    F.init(P);
+    return true;
+  }
+
 
 }  /* end of namespace bgeot.                                             */
@@ -27,6 +27,9 @@
 #include <set>
 #include <algorithm>
 #include <deque>
+#ifdef GETFEM_HAS_OPENMP
+# include <shared_mutex>
+#endif
 
 
 namespace dal {
@@ -139,6 +142,73 @@ namespace dal {
   #define ON_STORED_DEBUG(expression)
 #endif
 
+  /* Process wide index of the objects stored by all the threads. It is
+     split in shards according to the type and the hash of the value of
+     the key, each one protected by a readers-writer lock, so that the
+     searches of different threads do not block each other. The keys of
+     a type which do not define a hash all go to the same shard. The
+     index refers to the objects with weak pointers: they are owned by
+     the table of the thread which has stored them and removed from the
+     index when they are deleted from it. */
+  class shared_stored_object_index {
+    typedef std::map<enr_static_stored_object_key,
+                     std::weak_ptr<const static_stored_object> > shard_map;
+    struct shard {
+      shard_map objects;
+#ifdef GETFEM_HAS_OPENMP
+      mutable std::shared_timed_mutex mutex;
+#endif
+    };
+    enum { NB_SHARDS = 32 };
+    shard shards[NB_SHARDS];
+
+    shard &shard_of(const static_stored_object_key &k) {
+      size_t h = typeid(k).hash_code()
+               ^ (k.hash() * size_t(0x9E3779B97F4A7C15ULL));
+      return shards[(h ^ (h >> 29)) % NB_SHARDS];
+    }
+
+  public:
+    pstatic_stored_object search(pstatic_stored_object_key k) {
+      shard &sh = shard_of(*k);
+#ifdef GETFEM_HAS_OPENMP
+      std::shared_lock<std::shared_timed_mutex> lock(sh.mutex);
+#endif
+      auto it = sh.objects.find(enr_static_stored_object_key(k));
+      return (it != sh.objects.end()) ? it->second.lock() : nullptr;
+    }
+
+    void add(pstatic_stored_object_key k, pstatic_stored_object o) {
+      shard &sh = shard_of(*k);
+#ifdef GETFEM_HAS_OPENMP
+      std::unique_lock<std::shared_timed_mutex> lock(sh.mutex);
+#endif
+      // an object already indexed for the same key is kept
+      auto res = sh.objects.insert(std::make_pair
+                                   (enr_static_stored_object_key(k), o));
+      if (!res.second && res.first->second.expired()) res.first->second = o;
+    }
+
+    void remove(pstatic_stored_object_key k, pstatic_stored_object o) {
+      shard &sh = shard_of(*k);
+#ifdef GETFEM_HAS_OPENMP
+      std::unique_lock<std::shared_timed_mutex> lock(sh.mutex);
+#endif
+      auto it = sh.objects.find(enr_static_stored_object_key(k));
+      if (it != sh.objects.end()) {
+        pstatic_stored_object p = it->second.lock();
+        if (!p || p == o) sh.objects.erase(it);
+      }
+    }
+  };
+
+  /* Never destroyed, since the thread tables may be destroyed after the
+     end of the program. */
+  static shared_stored_object_index &shared_index() {
+    static shared_stored_object_index *index = new shared_stored_object_index;
+    return *index;
+  }
+
   // Gives a pointer to a key of an object from its pointer, while looking in the storage of
   // a specific thread
   pstatic_stored_object_key key_of_stored_object(pstatic_stored_object o, size_t thread){
@@ -186,13 +256,7 @@ namespace dal {
     auto p = stored_objects.search_stored_object(k);
     if (p) return p;
     if (singleton<stored_object_tab>::num_threads() == 1) return nullptr;
-    for(size_t thread = 0; thread < singleton<stored_object_tab>::num_threads(); ++thread){
-      if (thread == singleton<stored_object_tab>::this_thread()) continue;
-      auto& other_objects = singleton<stored_object_tab>::instance(thread);
-      p = other_objects.search_stored_object(k);
-      if (p) return p;
-    }
-    return nullptr;
+    return shared_index().search(k);
   }
 
   std::pair<stored_object_tab::iterator, stored_object_tab::iterator>
@@ -449,6 +513,7 @@ namespace dal {
     stored_keys_[o] = k;
     insert(std::make_pair(enr_static_stored_object_key(k),
                           enr_static_stored_object(o, perm)));
+    shared_index().add(k, o);
     auto t = singleton<stored_object_tab>::this_thread();
     GMM_ASSERT2(stored_keys_.size() == size() && t != size_t(-1),
       "stored_keys are not consistent with stored_object tab");
@@ -518,6 +583,7 @@ namespace dal {
       auto ito = end();
       if (itk != stored_keys_.end()){
           ito = find(itk->second);
+          shared_index().remove(itk->second, *it);
           stored_keys_.erase(itk);
       }
       if (ito != end()){
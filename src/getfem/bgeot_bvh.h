@@ -0,0 +1,137 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*===========================================================================
+
+ Copyright (C) 2020 the GetFEM++ project
+
+ This file is a part of GetFEM++
+
+ GetFEM++  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+ As a special exception, you  may use  this file  as it is a part of a free
+ software  library  without  restriction.  Specifically,  if   other  files
+ instantiate  templates  or  use macros or inline functions from this file,
+ or  you compile this  file  and  link  it  with other files  to produce an
+ executable, this file  does  not  by itself cause the resulting executable
+ to be covered  by the GNU Lesser General Public License.  This   exception
+ does not  however  invalidate  any  other  reasons why the executable file
+ might be covered by the GNU Lesser General Public License.
+
+===========================================================================*/
+
+#ifndef BGEOT_BVH_H
+#define BGEOT_BVH_H
+
+/** @file bgeot_bvh.h
+    @date 2020.
+    @brief Refittable bounding volume hierarchy of n-dimensional boxes.
+*/
+
+#include "bgeot_small_vector.h"
+
+namespace bgeot {
+
+  /** Bounding volume hierarchy of n-dimensional boxes stored in flat arrays.
+   *
+   * Contrary to bgeot::rtree, the extents of the boxes may be modified
+   * once the tree is built (with set_box) and the node boxes updated with
+   * refit(), without rebuilding the topology of the tree. This is adapted
+   * to the influence boxes of the elements of a deforming mesh. Of course,
+   * the efficiency of the queries decreases if the boxes move a lot with
+   * respect to each other, in which case build_tree() should be called
+   * again.
+   *
+   * The queries fill a vector of box ids, sorted in increasing order,
+   * given by the caller. No allocation occurs when this vector is reused
+   * between the queries.
+   */
+  class box_bvh {
+  public:
+    enum { BOXES_PER_LEAF = 8 };
+
+    /** Add a box and return its index. If no id is given, the id is
+        the index of the box. The tree has to be (re)built afterwards. */
+    size_type add_box(const base_node &min, const base_node &max,
+                      size_type id = size_type(-1));
+    /** Modify the extents of the box of index i. refit() has to be called
+        before the next query. */
+    void set_box(size_type i, const base_node &min, const base_node &max);
+    size_type nb_boxes() const { return ids.size(); }
+    size_type dim() const { return N; }
+    size_type id_of_box(size_type i) const { return ids[i]; }
+    const scalar_type *box_min(size_type i) const { return &(bmin[i*N]); }
+    const scalar_type *box_max(size_type i) const { return &(bmax[i*N]); }
+    /** Remove all the boxes. */
+    void clear();
+    /** Remove the boxes but keep the topology of the tree for a refit. */
+    void clear_boxes_only() { ids.resize(0); bmin.resize(0); bmax.resize(0); }
+
+    /** Build the topology of the tree and the node boxes. */
+    void build_tree();
+    /** Update the node boxes from the current box extents, keeping the
+        topology of the tree. */
+    void refit();
+    /** Refit the tree if the number of boxes has not changed and if the
+        quality of the tree is not too much degraded, rebuild it otherwise. */
+    void update_tree();
+    bool is_built() const { return tree_built; }
+    bool is_refitted() const { return tree_built && !need_refit; }
+
+    void find_boxes_at_point(const base_node &P,
+                             std::vector<size_type> &idvec) const;
+    void find_intersecting_boxes(const base_node &min, const base_node &max,
+                                 std::vector<size_type> &idvec) const;
+    void find_containing_boxes(const base_node &min, const base_node &max,
+                               std::vector<size_type> &idvec) const;
+    void find_contained_boxes(const base_node &min, const base_node &max,
+                              std::vector<size_type> &idvec) const;
+    /** Boxes intersecting both [min..max] and the line passing through
+        org and of direction vector dirv. */
+    void find_line_intersecting_boxes(const base_node &org,
+                                      const base_small_vector &dirv,
+                                      const base_node &min,
+                                      const base_node &max,
+                                      std::vector<size_type> &idvec) const;
+
+    box_bvh(scalar_type EPS_ = 0) : EPS(EPS_), N(0), built_extent(0),
+                                    tree_built(false), need_refit(false) {}
+
+  private:
+    struct bvh_node {
+      size_type first, nb; // range in box_order for a leaf.
+      size_type right;     // index of the right child (left one is next).
+      bool is_leaf() const { return right == size_type(-1); }
+    };
+
+    size_type build_node(size_type first, size_type nb,
+                         std::vector<scalar_type> &centers);
+    void update_node(size_type i);
+    scalar_type leaves_extent() const;
+    template <typename PRED>
+    void find_matching_boxes(const PRED &p,
+                             std::vector<size_type> &idvec) const;
+
+    scalar_type EPS;
+    size_type N;
+    std::vector<scalar_type> bmin, bmax;   // boxes, N values per box.
+    std::vector<size_type> ids;
+    std::vector<size_type> box_order;      // boxes sorted by leaves.
+    std::vector<bvh_node> nodes;           // depth-first ordering.
+    std::vector<scalar_type> nmin, nmax;   // node boxes, N values per node.
+    scalar_type built_extent;              // leaves_extent() after build.
+    bool tree_built, need_refit;
+  };
+
+}
+
+#endif
@@ -300,13 +300,26 @@ namespace bgeot {
                                          /* of the transformation.         */
     mutable std::vector<base_matrix> hpc; /* precomputed values for hessian*/
                                           /*  of the transformation.       */
+    mutable precomp_table c_tab, pc_tab;  /* values and gradients for all */
+                                          /* the points, contiguously.     */
+    /* The tables are computed at their first use. The flags allow the
+       object to be shared by several threads. */
+    mutable std::atomic_bool c_ok{false}, pc_ok{false}, hpc_ok{false};
+    getfem::lock_factory locks_;
   public:
     inline const base_vector &val(size_type i) const
-    { if (c.empty()) init_val(); return c[i]; }
+    { if (!c_ok) init_val(); return c[i]; }
     inline const base_matrix &grad(size_type i) const
-    { if (pc.empty()) init_grad(); return pc[i]; }
+    { if (!pc_ok) init_grad(); return pc[i]; }
     inline const base_matrix &hessian(size_type i) const
-    { if (hpc.empty()) init_hess(); return hpc[i]; }
+    { if (!hpc_ok) init_hess(); return hpc[i]; }
+    /** Values of the shape functions on all the points ([npt][nb_points]).*/
+    inline const precomp_table &val_table() const
+    { if (!c_ok) init_val(); return c_tab; }
+    /** Gradients of the shape functions on all the points
+        ([npt][dim][nb_points]). */
+    inline const precomp_table &grad_table() const
+    { if (!pc_ok) init_grad(); return pc_tab; }
 
     /**
      *  Apply the geometric transformation from the reference convex to
@@ -355,10 +368,11 @@ namespace bgeot {
                                     VEC& pt) const {
     size_type k = 0;
     gmm::clear(pt);
-    if (c.empty()) init_val();
+    if (!c_ok) init_val();
+    const scalar_type *cj = c_tab.data(j);
     for (typename CONT::const_iterator itk = G.begin();
          itk != G.end(); ++itk, ++k)
-      gmm::add(gmm::scaled(*itk, c[j][k]), pt);
+      gmm::add(gmm::scaled(*itk, cj[k]), pt);
     GMM_ASSERT1(k == pgt->nb_points(),
                 "Wrong number of points in transformation");
   }
@@ -366,7 +380,7 @@ namespace bgeot {
   template <typename CONT>
   void geotrans_precomp_::transform(const CONT& G,
                                     stored_point_tab& pt_tab) const {
-    if (c.empty()) init_val();
+    if (!c_ok) init_val();
     pt_tab.clear(); pt_tab.resize(c.size(), base_node(G[0].size()));
     for (size_type j = 0; j < c.size(); ++j) {
       transform(G, j, pt_tab[j]);
@@ -470,6 +484,9 @@ namespace bgeot {
     }
     /** change the current point (coordinates given in the reference convex) */
     void set_xref(const base_node& P);
+    /** Set the matrices K and B (stored column by column) and the Jacobian
+        of the current point to known values instead of computing them. */
+    void set_K_B_J(const scalar_type *K, const scalar_type *B, scalar_type J);
     void change(bgeot::pgeotrans_precomp pgp__,
                 size_type ii__,
                 const base_matrix& G__) {
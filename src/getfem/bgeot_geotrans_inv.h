@@ -133,12 +133,41 @@ namespace bgeot {
     */
     bool invert(const base_node& n, base_node& n_ref, bool &converged, 
                 scalar_type IN_EPS=1e-12, bool project_into_element=false);
+
+    /**
+       given a set of nodes on the real element, computes the
+       corresponding nodes on the reference element, as invert() does
+       for each of them, sharing the work buffers between the points.
+
+       @return the number of nodes inside the convex
+
+       @param ipts nodes on the real element (as given by
+       kdtree::points_in_box)
+
+       @param pts_ref computed nodes on the reference convex
+
+       @param in_cv on output, in_cv[l] is true if ipts[l] is inside the
+       convex.
+
+       @param converged on output, converged[l] is true if the
+       geometric transformation could be inverted at ipts[l].
+
+       @param IN_EPS a threshold.
+    */
+    size_type invert_points(const kdtree_tab_type &ipts,
+                            std::vector<base_node> &pts_ref,
+                            std::vector<bool> &in_cv,
+                            std::vector<bool> &converged,
+                            scalar_type IN_EPS=1e-12,
+                            bool project_into_element=false);
   private:
-    bool invert_lin(const base_node& n, base_node& n_ref, scalar_type IN_EPS);
+    bool invert_lin(const base_node& n, base_node& n_ref, base_node &y,
+                    scalar_type IN_EPS);
     bool invert_nonlin(const base_node& n, base_node& n_ref,
                        scalar_type IN_EPS, bool &converged, bool throw_except,
                        bool project_into_element);
     void update_B();
+    void newton_direction(const base_node &diff, base_node &d);
     void update_linearization();
 
     friend class geotrans_inv_convex_bfgs;
@@ -254,9 +283,12 @@ namespace bgeot {
     else boxpts = tree.points();
     /* and invert the geotrans, and check if the obtained point is 
        inside the reference convex */
+    std::vector<base_node> pts_ref;
+    std::vector<bool> in_cv, converged;
+    gic.invert_points(boxpts, pts_ref, in_cv, converged, EPS);
     for (size_type l = 0; l < boxpts.size(); ++l) {
-      // base_node pt_ref;
-      if (gic.invert(boxpts[l].n, pftab[nbpt], EPS)) {
+      if (in_cv[l]) {
+        pftab[nbpt] = pts_ref[l];
         itab[nbpt++] = boxpts[l].i;
       }
     }
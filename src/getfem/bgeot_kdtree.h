@@ -43,15 +43,6 @@
 
 namespace bgeot {
 
-  /* generic node for the kdtree */
-  struct kdtree_elt_base {
-    enum { PTS_PER_LEAF=8 };
-    unsigned n; /* 0 => is a tree node, != 0 => tree leaf storing n points */
-    bool isleaf() const { return (n != 0); }
-    kdtree_elt_base(unsigned n_) : n(n_) {}
-    virtual ~kdtree_elt_base() {}
-  };
-
   /// store a point and the associated index for the kdtree.
   /* std::pair<size_type,base_node> is not ok since it does not
      have a suitable overloaded swap function ...
@@ -102,10 +93,20 @@ namespace bgeot {
   */
   class kdtree {
     dim_type N; /* dimension of points */
-    std::unique_ptr<kdtree_elt_base> tree;
     kdtree_tab_type pts;
+    /* The tree is implicit: the children of the node i are the nodes 2i+1
+       and 2i+2 and each node corresponds to a contiguous range of pts,
+       the range [b, e[ being split at b + (e-b)/2. Only the splitting
+       direction and value of the nodes are stored. The coordinates of
+       the points are copied in a flat array, in the order of pts. */
+    std::vector<scalar_type> coords;
+    std::vector<scalar_type> split_v;
+    std::vector<unsigned char> split_dir;
+    bool tree_built;
   public:
-    kdtree() : N(0) {}
+    enum { PTS_PER_LEAF=8 };
+
+    kdtree() : N(0), tree_built(false) {}
 
     kdtree(const kdtree&) = delete;
     kdtree &operator = (const kdtree&) = delete;
@@ -123,23 +124,55 @@ namespace bgeot {
         N = n.size();
       else
         GMM_ASSERT2(N == n.size(), "invalid dimension");
-      if (tree) clear_tree();
+      if (tree_built) clear_tree();
       pts.push_back(index_node_pair(i, n));
     }
     size_type nb_points() const { return pts.size(); }
     const kdtree_tab_type &points() const { return pts; }
+    /* builds the tree if it is not already done, the lower levels of
+       the tree being built by several threads. Once the tree is built,
+       the queries can be called concurrently by several threads. */
+    void build_tree();
     /* fills ipts with the indexes of points in the box
        [min,max] */
     void points_in_box(kdtree_tab_type &ipts,
                        const base_node &min,
                        const base_node &max);
+    /* fills ipts with the points at a distance lower or equal to r
+       of pos */
+    void points_in_ball(kdtree_tab_type &ipts,
+                        const base_node &pos, scalar_type r);
+    /* points at a distance lower or equal to r of a set of positions.
+       The positions are distributed between the threads. */
+    void points_in_ball(std::vector<kdtree_tab_type> &ipts,
+                        const std::vector<base_node> &pos, scalar_type r);
     /* assigns at ipt the index of the nearest neighbor at location
        pos and returns the square of the distance to this point*/
     scalar_type nearest_neighbor(index_node_pair &ipt,
                                  const base_node &pos);
+    /* fills ipts with the k nearest neighbors of pos, sorted by
+       increasing distance, and dist2 with the square of their distances
+       to pos. Less than k points are returned if the tree contains less
+       than k points. */
+    void k_nearest_neighbors(kdtree_tab_type &ipts,
+                             std::vector<scalar_type> &dist2,
+                             const base_node &pos, size_type k);
+    /* k nearest neighbors of a set of positions. The positions are
+       distributed between the threads. */
+    void k_nearest_neighbors(std::vector<kdtree_tab_type> &ipts,
+                             const std::vector<base_node> &pos,
+                             size_type k);
   private:
-    typedef std::vector<size_type>::const_iterator ITER;
     void clear_tree();
+    void split_node(size_type inode, size_type b, size_type e,
+                    std::vector<size_type> &perm);
+    void build_node(size_type inode, size_type b, size_type e,
+                    std::vector<size_type> &perm);
+    void build_node(size_type inode, size_type b, size_type e,
+                    std::vector<size_type> &perm, size_type depth,
+                    std::vector<size_type> &subtrees);
+    template <typename VISITOR>
+    void visit_(VISITOR &v, size_type inode, size_type b, size_type e) const;
   };
 }
 
@@ -39,6 +39,7 @@
 #define BGEOT_MESH_STRUCTURE_H__
 
 #include <set>
+#include <memory>
 #include "bgeot_convex_structure.h"
 #include "dal_tree_sorted.h"
 
@@ -64,6 +65,39 @@ namespace bgeot {
     static convex_face invalid_face() {return {size_type(-1), short_type(-1)};}
   };
 
+  /** Compact and read-only copy of the connectivity of a mesh_structure,
+   *  built by mesh_structure::freeze(). The points of the convexes are
+   *  stored in a single array, the convexes being grouped by structure,
+   *  the convexes attached to each point are stored in the same way (CSR
+   *  format) and the first neighbour through each face is precomputed.
+   */
+  struct APIDECL mesh_structure_compact {
+    /* The valid convexes sorted by structure, block b being the range
+       [block_first[b], block_first[b+1]) of cv_order. */
+    std::vector<pconvex_structure> structures;
+    std::vector<size_type> block_first, cv_order;
+    std::vector<unsigned> cv_block; // block of each convex.
+    /* Points and face neighbours (size_type(-1) for a boundary face) of
+       convex ic in the ranges starting at cv_first[ic] and face_first[ic],
+       convexes of point ip in [pt_first[ip], pt_first[ip+1]). */
+    std::vector<size_type> cv_first, cv_points;
+    std::vector<size_type> face_first, face_neighbour;
+    std::vector<size_type> pt_first, pt_convexes;
+
+    size_type nb_blocks() const { return structures.size(); }
+    pconvex_structure structure_of_convex(size_type ic) const
+    { return structures[cv_block[ic]]; }
+    const size_type *points_of_convex(size_type ic) const
+    { return cv_points.data() + cv_first[ic]; }
+    size_type neighbour_of_convex(size_type ic, short_type f) const
+    { return face_neighbour[face_first[ic] + f]; }
+    const size_type *convexes_of_point_begin(size_type ip) const
+    { return pt_convexes.data() + pt_first[std::min(ip, pt_first.size()-1)]; }
+    const size_type *convexes_of_point_end(size_type ip) const
+    { return pt_convexes.data()+pt_first[std::min(ip+1, pt_first.size()-1)]; }
+    size_type memsize() const;
+  };
+
   /**@addtogroup mesh */
   ///@{
   /** Mesh structure definition.
@@ -84,6 +118,10 @@ namespace bgeot {
 
     dal::dynamic_tas<mesh_convex_structure, 8> convex_tab;
     point_ct points_tab;
+    mutable std::shared_ptr<const mesh_structure_compact> compact;
+    mutable size_type nb_unfrozen_queries = 0;
+    void build_compact() const;
+    void freeze_on_demand() const;
 
   public :
 
@@ -186,6 +224,20 @@ namespace bgeot {
                                                 short_type f) const;
 
     size_type memsize() const;
+    /** Build a compact copy of the connectivity, used by the neighbour
+        and face queries until the next modification of the structure.
+        The copy is also built by the neighbour queries themselves, out
+        of the parallel regions, once they have been called more times
+        than the number of convexes since the last build. freeze() also
+        trims the capacity of the lists of convexes of each point. */
+    void freeze();
+    /** Discard the compact copy of the connectivity. */
+    void unfreeze() { compact.reset(); }
+    bool is_frozen() const { return compact.get() != 0; }
+    /** The compact copy of the connectivity (the structure should be
+        frozen). */
+    const mesh_structure_compact &compact_structure() const
+    { GMM_ASSERT1(compact.get(), "mesh structure not frozen"); return *compact; }
     /** Reorder the convex IDs and point IDs, such that there is no
         hole in their numbering. */
     void optimize_structure();
@@ -279,6 +331,7 @@ namespace bgeot {
                                                ITER ipts, size_type is) {
     mesh_convex_structure s; s.cstruct = cs;
     size_type nb = cs->nb_points();
+    compact.reset();
 
     if (is != size_type(-1)) { sup_convex(is); convex_tab.add_to_index(is,s); }
     else is = convex_tab.add(s);
@@ -90,6 +90,23 @@ namespace bgeot {
     size_type add_node(const base_node &pt, const scalar_type radius=0,
                        bool remove_duplicated_nodes = true);
     size_type add(const base_node &pt) { return add_node(pt); }
+    /** Add a set of points to the array without any search of existing
+        points, returning their indices in ids. This is much faster than
+        successive calls to add_node. The duplicated points may be merged
+        afterwards with merge_duplicated_nodes.
+    */
+    void add_nodes(const std::vector<base_node> &pts,
+                   std::vector<size_type> &ids);
+    /** Merge the points located within a distance smaller than radius (or
+        than the precision of the array if it is greater), with the same
+        semantics as add_node. The kept point is the one of smallest index
+        and the other ones are removed from the array. On return, rep[i]
+        is the index of the point kept for the point i (rep[i] == i if the
+        point is kept, size_type(-1) for the unused indices). Return the
+        number of removed points.
+    */
+    size_type merge_duplicated_nodes(std::vector<size_type> &rep,
+                                     const scalar_type radius=0);
     void sup_node(size_type i);
     void sup(size_type i) { sup_node(i); }
     void resort(void) { sorters = std::vector<sorter>(); }
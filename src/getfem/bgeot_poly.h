@@ -613,6 +613,65 @@ namespace bgeot
 
   typedef polynomial<opt_long_scalar_type> base_poly;
 
+  /** Compiled form of a family of polynomials of the same dimension (for
+   *  instance the base functions of a polynomial fem), evaluated all
+   *  together at one or several points.
+   *
+   *  The values of the monomials are computed once for each point, each one
+   *  being the product of a monomial of lower degree with a variable, and
+   *  each polynomial is stored as the list of its non-zero coefficients.
+   *  The points are processed by blocks of BLOCK points, so that the inner
+   *  loops are on contiguous values and can be vectorized by the compiler.
+   */
+  class polynomial_family {
+  public:
+    enum { BLOCK = 8 };
+
+    void init(const std::vector<polynomial<scalar_type> > &P);
+    size_type nb_polynomials() const { return nbp; }
+    short_type dim() const { return n; }
+    /** Values of the polynomials at the npt points of coordinates
+        pts[i*dim() .. (i+1)*dim()-1]. The value of the polynomial k at the
+        point i is stored in val[i*nb_polynomials() + k]. */
+    void eval(const scalar_type *pts, size_type npt, scalar_type *val) const;
+    /** Gradients of the polynomials at the npt points. The derivative of
+        the polynomial k with respect to the variable j at the point i is
+        stored in grad[(i*dim() + j)*nb_polynomials() + k]. */
+    void eval_grad(const scalar_type *pts, size_type npt,
+                   scalar_type *grad) const;
+
+    polynomial_family() : n(0), nbp(0), nbm(1) {}
+
+  private:
+    // rows of a sparse matrix applied to the vector of the monomials.
+    struct sparse_rows {
+      std::vector<size_type> start, col;
+      std::vector<scalar_type> coef;
+    };
+
+    template <size_type B>
+    void eval_block_(const scalar_type *pts, const sparse_rows &rows,
+                     scalar_type *res, scalar_type *mon) const;
+    void eval_(const scalar_type *pts, size_type npt,
+               const sparse_rows &rows, scalar_type *res) const;
+
+    short_type n;
+    size_type nbp, nbm;
+    // the monomial m > 0 is the monomial parent[m] times the variable var[m].
+    std::vector<size_type> parent;
+    std::vector<short_type> var;
+    sparse_rows val_rows, grad_rows;
+  };
+
+  /** Compile the polynomials P into F when this is possible (i.e. for
+      polynomials with double coefficients of the same dimension) and
+      return true in that case. */
+  bool compile_polynomials(polynomial_family &F,
+                           const std::vector<polynomial<scalar_type> > &P);
+  template <typename FUNC>
+  bool compile_polynomials(polynomial_family &, const std::vector<FUNC> &)
+  { return false; }
+
   /* usual constant polynomials  */
 
   inline base_poly null_poly(short_type n) { return base_poly(n, 0); }
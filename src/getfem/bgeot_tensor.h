@@ -556,6 +556,58 @@ namespace bgeot {
   typedef tensor<scalar_type> base_tensor;
   typedef tensor<complex_type> base_complex_tensor;
 
+  /* ********************************************************************* */
+  /*                Class precomp_table.                                   */
+  /* ********************************************************************* */
+
+  /** Tensors of the same sizes, one for each point of a set, stored in a
+      single array, point after point. The values of the point i start at
+      data(i) and are ordered as those of a tensor of sizes sizes(). The
+      beginning of the array is aligned on a cache line, and the values
+      of consecutive points are contiguous, so that a loop on the points
+      reads the memory linearly. */
+  class precomp_table {
+    enum { ALIGN = 64 / sizeof(scalar_type) };
+    std::vector<scalar_type> values;
+    size_type offset, stride_, nb_points_;
+    multi_index sizes_;
+
+  public:
+    void init(size_type npt, const multi_index &sz) {
+      sizes_ = sz; nb_points_ = npt; stride_ = sz.total_size();
+      values.assign(npt * stride_ + ALIGN, scalar_type(0));
+      size_type a = reinterpret_cast<size_type>(values.data())
+                    / sizeof(scalar_type);
+      offset = (ALIGN - a % ALIGN) % ALIGN;
+    }
+    /** Initialize the table with the values of v[i] for each point i, v[i]
+        being a tensor, a vector or a dense matrix of sz.total_size()
+        components. */
+    template <typename VECT>
+    void init(const std::vector<VECT> &v, const multi_index &sz) {
+      init(v.size(), sz);
+      for (size_type i = 0; i < v.size(); ++i) {
+        GMM_ASSERT1(v[i].size() == stride_, "Inconsistent sizes");
+        std::copy(v[i].begin(), v[i].end(), data(i));
+      }
+    }
+    const scalar_type *data(size_type i) const
+    { return values.data() + offset + i * stride_; }
+    scalar_type *data(size_type i)
+    { return values.data() + offset + i * stride_; }
+    /** Copy the values of the point i into t, which is resized if needed. */
+    void copy_to(size_type i, base_tensor &t) const {
+      if (t.size() != stride_ || !(t.sizes().is_equal(sizes_)))
+        t.adjust_sizes(sizes_);
+      std::copy(data(i), data(i) + stride_, t.begin());
+    }
+    const multi_index &sizes() const { return sizes_; }
+    size_type stride() const { return stride_; }
+    size_type nb_points() const { return nb_points_; }
+
+    precomp_table() : offset(0), stride_(0), nb_points_(0) {}
+  };
+
 
 }  /* end of namespace bgeot.                                              */
 
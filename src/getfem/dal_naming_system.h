@@ -100,6 +100,8 @@ namespace dal {
 	      return name == o.name;
       }
 
+      size_t hash() const override { return key_value_hash(name); }
+
       method_key(const std::string &name_) : name(name_) {}
     };
 
@@ -78,6 +78,8 @@ std::shared_ptr are used.
 #include "getfem/getfem_arch_config.h"
 
 #include <atomic>
+#include <functional>
+#include <type_traits>
 
 #define DAL_STORED_OBJECT_DEBUG 0
 
@@ -124,6 +126,11 @@ namespace dal {
     virtual bool equal(const static_stored_object_key &) const = 0;
 
   public :
+    /** Hash of the value of the key. Two keys of the same type which are
+        equivalent for compare() have the same hash. The default, 0, is
+        valid for any key. */
+    virtual size_t hash() const { return 0; }
+
     bool operator < (const static_stored_object_key &o) const {
       // comparaison des noms d'objet
       if (typeid(*this).before(typeid(o))) return true;
@@ -143,10 +150,31 @@ namespace dal {
     virtual ~static_stored_object_key() {}
   };
 
+  /* Hash of the values stored in the keys: the numbers, the strings and
+     the pointers (compared by address). The other types have the valid
+     but useless hash 0. */
+  template <typename T> inline typename std::enable_if
+  <std::is_arithmetic<T>::value || std::is_enum<T>::value, size_t>::type
+  key_value_hash(const T &a) { return std::hash<T>()(a); }
+  template <typename T> inline typename std::enable_if
+  <!(std::is_arithmetic<T>::value || std::is_enum<T>::value), size_t>::type
+  key_value_hash(const T &) { return 0; }
+  inline size_t key_value_hash(const std::string &a)
+  { return std::hash<std::string>()(a); }
+  template <typename T> inline size_t key_value_hash(T *const &p)
+  { return std::hash<const void *>()(p); }
+  template <typename T>
+  inline size_t key_value_hash(const std::shared_ptr<T> &p)
+  { return std::hash<const void *>()(p.get()); }
+  template <typename T1, typename T2>
+  inline size_t key_value_hash(const std::pair<T1, T2> &p)
+  { return key_value_hash(p.first) * 31 + key_value_hash(p.second); }
+
   template <typename var_type>
   class simple_key : virtual public static_stored_object_key {
     var_type a;
   public :
+    size_t hash() const override { return key_value_hash(a); }
      bool compare(const static_stored_object_key &oo) const override {
       auto &o = dynamic_cast<const simple_key &>(oo);
       return a < o.a;
@@ -212,6 +240,10 @@ namespace dal {
   /** Gives a pointer to an object from a key pointer. */
   pstatic_stored_object search_stored_object(pstatic_stored_object_key k);
 
+  /** Gives a pointer to an object from a key pointer, the object being
+      possibly stored by another thread. This is done through a process
+      wide index of the stored objects, whose searches do not block each
+      other. The found object has to be thread safe. */
   pstatic_stored_object search_stored_object_on_all_threads(pstatic_stored_object_key k);
 
   /** Test if an object is stored*/
@@ -0,0 +1,154 @@
+/* -*- c++ -*- (enables emacs c++ mode) */
+/*===========================================================================
+
+ Copyright (C) 2020 the GetFEM++ project
+
+ This file is a part of GetFEM++
+
+ GetFEM++  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+ As a special exception, you  may use  this file  as it is a part of a free
+ software  library  without  restriction.  Specifically,  if   other  files
+ instantiate  templates  or  use macros or inline functions from this file,
+ or  you compile this  file  and  link  it  with other files  to produce an
+ executable, this file  does  not  by itself cause the resulting executable
+ to be covered  by the GNU Lesser General Public License.  This   exception
+ does not  however  invalidate  any  other  reasons why the executable file
+ might be covered by the GNU Lesser General Public License.
+
+===========================================================================*/
+
+/**@file getfem_binary_io.h
+   @date 2020.
+   @brief Versioned binary container for meshes, mesh_fems, mesh_ims and
+          model variables.
+
+   A binary file is a list of named sections, each one being a raw array
+   of fixed size values (64 bits unsigned integers, doubles or characters)
+   aligned on 8 bytes, followed by a directory of the sections. The file is
+   mapped in memory when it is read (when the system allows it), so that
+   the arrays are directly accessed without any parsing.
+
+   Typical use for a restart:
+   @code
+   {
+     getfem::binary_ofile f("restart.gfb");
+     mesh.write_to_binary(f);
+     mf_u.write_to_binary(f, "mf_u");
+     mim.write_to_binary(f, "mim");
+     getfem::write_model_variables_to_binary(f, md, {"u", "lambda"});
+   }
+   getfem::binary_ifile f("restart.gfb");
+   mesh.read_from_binary(f);
+   mf_u.read_from_binary(f, "mf_u");
+   ...
+   @endcode
+*/
+#ifndef GETFEM_BINARY_IO_H__
+#define GETFEM_BINARY_IO_H__
+
+#include "getfem_config.h"
+#include <fstream>
+#include <map>
+
+namespace getfem {
+
+  class model;
+
+  /** Type of the integers stored in the binary files. */
+  typedef gmm::uint64_type binary_index_type;
+
+  /** Writing of a binary file. The directory of the sections is written
+      by close(), which is called by the destructor. */
+  class APIDECL binary_ofile {
+    struct section_info {
+      std::string name;
+      binary_index_type offset, size;
+    };
+    std::ofstream f;
+    std::string fname;
+    std::vector<section_info> sections;
+    binary_index_type pos;
+
+    void write_padded(const void *data, size_type nbytes);
+
+  public:
+    /** Add a section containing nbytes bytes of data. */
+    void add_section(const std::string &name, const void *data,
+                     size_type nbytes);
+    template <typename T>
+    void add_section(const std::string &name, const std::vector<T> &v)
+    { add_section(name, v.data(), v.size()*sizeof(T)); }
+    /** Add a section containing a list of strings separated by '\0'. */
+    void add_string_section(const std::string &name,
+                            const std::vector<std::string> &strs);
+    void close();
+
+    explicit binary_ofile(const std::string &name);
+    ~binary_ofile();
+  };
+
+  /** Reading of a binary file. The file is mapped in memory, or read in
+      a buffer on systems without mmap. The pointers returned by section()
+      remain valid as long as the binary_ifile object exists. */
+  class APIDECL binary_ifile {
+    std::string fname;
+    const char *data;
+    size_type length;
+    bool mapped;
+    std::vector<binary_index_type> buffer;
+    std::map<std::string, std::pair<size_type, size_type> > sections;
+    unsigned version_;
+
+    const char *raw_section(const std::string &name, size_type &nbytes) const;
+
+  public:
+    bool has_section(const std::string &name) const
+    { return sections.find(name) != sections.end(); }
+    /** Return a pointer on the values of the section and their number in n.
+        An error is thrown if the section does not exist. */
+    template <typename T>
+    const T *section(const std::string &name, size_type &n) const {
+      size_type nbytes;
+      const char *p = raw_section(name, nbytes);
+      GMM_ASSERT1(nbytes % sizeof(T) == 0, "Section " << name
+                  << " has a wrong size");
+      n = nbytes / sizeof(T);
+      return reinterpret_cast<const T *>(p);
+    }
+    std::vector<std::string> string_section(const std::string &name) const;
+    unsigned version() const { return version_; }
+    const std::string &file_name() const { return fname; }
+
+    explicit binary_ifile(const std::string &name);
+    ~binary_ifile();
+
+  private:
+    binary_ifile(const binary_ifile &);
+    binary_ifile &operator =(const binary_ifile &);
+  };
+
+  /** Store the values of the given variables (or data) of the model. */
+  void write_model_variables_to_binary(binary_ofile &f, const model &md,
+                                       const std::vector<std::string> &vl,
+                                       const std::string &prefix="model");
+
+  /** Set the values of the variables of the model from a binary file.
+      The variables have to exist in the model with the same size. */
+  void read_model_variables_from_binary(const binary_ifile &f, model &md,
+                                        const std::string &prefix="model");
+
+}  /* end of namespace getfem.                                             */
+
+#endif /* GETFEM_BINARY_IO_H__ */
@@ -41,6 +41,7 @@
 #include "getfem_models.h"
 #include "getfem_assembling_tensors.h"
 #include "getfem/bgeot_rtree.h"
+#include "getfem/bgeot_bvh.h"
 #include <getfem/getfem_mesher.h>
 
 
@@ -489,7 +490,7 @@ namespace getfem {
         : ind_boundary(ib), ind_element(ie), ind_face(iff), mean_normal(n) {}
     };
 
-    bgeot::rtree element_boxes;                  // influence boxes
+    bgeot::box_bvh element_boxes;                // influence boxes
     std::vector<influence_box> element_boxes_info;
 
     //
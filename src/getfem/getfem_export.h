@@ -41,6 +41,10 @@
 #include "getfem_interpolation.h"
 #include "getfem_mesh_slice.h"
 #include <list>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 namespace getfem {
 
@@ -287,6 +291,285 @@ namespace getfem {
   }
 
 
+  /** @brief Writing of export files by a background thread.
+
+      The content of a file is prepared in memory by the calling thread
+      (for instance with a vtk_export, a dx_export or a pos_export on a
+      std::stringstream, which copies the exported fields) and handed to
+      the writer, which returns immediately while a background thread
+      writes the file. The number of files waiting to be written is
+      bounded: write() blocks while max_pending files are queued, so that
+      a slow disk cannot accumulate an unbounded amount of memory.
+
+      An error occurring in the background thread is thrown by the next
+      call to write() or flush(). The destructor waits for all the
+      queued files to be written.
+
+      @code
+      getfem::async_file_writer writer;
+      for (...) {
+        ... // time step
+        std::stringstream s;
+        getfem::vtk_export exp(s);
+        exp.exporting(mf_u);
+        exp.write_point_data(mf_u, U, "displacement");
+        writer.write("u_" + std::to_string(it) + ".vtk", s);
+      }
+      writer.flush();
+      @endcode
+  */
+  class async_file_writer {
+    struct pending_file {
+      std::string fname, content;
+    };
+    std::deque<pending_file> queue;
+    size_type max_pending;
+    bool busy, stopping;
+    std::exception_ptr error;
+    mutable std::mutex mtx;
+    std::condition_variable cv_queued, cv_written;
+    std::thread writer;
+
+    void run();
+    void check_error();
+
+  public:
+    /** Queue the content of the file fname. The content is moved. */
+    void write(const std::string &fname, std::string &&content);
+    /** Queue the content of a stringstream (which is emptied). */
+    void write(const std::string &fname, std::stringstream &s);
+    /** Wait for all the queued files to be written. */
+    void flush();
+    /** Number of files queued or being written. */
+    size_type nb_pending() const;
+
+    explicit async_file_writer(size_type max_pending_ = 2);
+    ~async_file_writer();
+
+  private:
+    async_file_writer(const async_file_writer &);
+    async_file_writer &operator =(const async_file_writer &);
+  };
+
+  /** @brief VTK XML export (".vtu" and ".pvtu" files).
+
+      Export of a mesh, a mesh_fem or a slice, with its fields, to the XML
+      unstructured grid format of VTK. The data arrays are stored in binary
+      form in the appended section of the file, without any conversion,
+      and compressed with zlib when it is available and compression is
+      asked for. Contrary to the legacy format of vtk_export, any number of
+      scalar, vector and tensor fields can be written, in any order.
+
+      If the file name ends with ".pvtu", the exported mesh is split into
+      pieces which are built and written in parallel, each one in its own
+      ".vtu" file (name_0.vtu, name_1.vtu ...), the ".pvtu" file referencing
+      all of them. The default number of pieces is the number of threads.
+      With MPI (GETFEM_PARA_LEVEL > 1), each process writes the piece of its
+      region get_mpi_region() and the master process writes the ".pvtu"
+      file.
+
+      The files are written by close(), which is called by the destructor.
+      They can be gathered in a time series with pvd_export. If
+      write_in_background() has been called, close() only prepares the
+      content of the files, which are then written by an
+      async_file_writer.
+  */
+  class vtu_export {
+  protected:
+    struct vtu_piece {
+      size_type num;                 // number of the piece.
+      std::vector<size_type> items;  // exported convexes of pmf or psl.
+      std::vector<size_type> points; // global index of the points.
+      std::vector<size_type> cells;  // global index of the cells.
+      size_type nb_cells;
+      std::string structure, point_data, cell_data; // XML descriptions.
+      std::vector<char> appended;    // appended binary data.
+    };
+    struct vtu_array_info {
+      std::string name;
+      size_type nb_comp;
+    };
+
+    std::string fname;
+    bool compressed;
+    size_type nb_pieces;
+    const stored_mesh_slice *psl;
+    std::unique_ptr<mesh_fem> pmf;
+    dal::bit_vector pmf_dof_used;
+    std::vector<unsigned> pmf_mapping_type;
+    dim_type dim_;
+    size_type nb_points_, nb_cells_, nb_total_pieces;
+    std::vector<vtu_piece> pieces;
+    std::vector<vtu_array_info> point_arrays, cell_arrays;
+    bool closed;
+    async_file_writer *pwriter;
+
+  public:
+    /** If compressed_ is false, or if GetFEM has been built without zlib,
+        the data arrays are not compressed. nb_pieces_ is the number of
+        pieces of a ".pvtu" export (0 for the number of threads). */
+    vtu_export(const std::string& fname_, bool compressed_ = true,
+               size_type nb_pieces_ = 0);
+    ~vtu_export();
+
+    /** should be called before write_*_data */
+    void exporting(const mesh& m);
+    void exporting(const mesh_fem& mf);
+    void exporting(const stored_mesh_slice& sl);
+
+    /** append a new scalar, vector or tensor field defined on mf. If you
+        are exporting a slice, or if mf != get_exported_mesh_fem(), U will
+        be interpolated on the slice, or on get_exported_mesh_fem(). */
+    template<class VECT> void write_point_data(const getfem::mesh_fem &mf,
+                                               const VECT& U0,
+                                               const std::string& name);
+
+    /** append a new field interpolated on the exported mesh_slice. */
+    template<class VECT> void write_sliced_point_data(const VECT& Uslice,
+                                                      const std::string& name,
+                                                      size_type qdim=1);
+
+    /** export data which is constant over each element. You should not use
+        this function if you are exporting a slice. U should have
+        convex_index().card() elements. */
+    template<class VECT> void write_cell_data(const VECT& U,
+                                              const std::string& name,
+                                              size_type qdim = 1);
+
+    /** write the files. No data can be added afterwards. */
+    void close();
+    /** the files will be written by w, which has to exist until close()
+        is called. */
+    void write_in_background(async_file_writer &w) { pwriter = &w; }
+
+    const stored_mesh_slice& get_exported_slice() const;
+    const mesh_fem& get_exported_mesh_fem() const;
+
+  private:
+    void init_pieces();
+    void build_piece_structure(vtu_piece &pc,
+                               const std::vector<float> &coords,
+                               const std::vector<size_type> &first_point,
+                               const std::vector<size_type> &cell_rank);
+    void add_array(vtu_piece &pc, std::string &xml, const char *type,
+                   const std::string &name, size_type nb_comp,
+                   const void *data, size_type nbytes);
+    void write_float_array(const std::vector<float> &V,
+                           const std::string &name, size_type nb_comp,
+                           bool cell_data);
+    void write_piece(std::ostream &o, const vtu_piece &pc) const;
+    void write_pvtu(std::ostream &o) const;
+    std::string piece_file_name(size_type num) const;
+    template<class VECT> void write_dataset_(const VECT& U,
+                                             const std::string& name,
+                                             size_type qdim,
+                                             bool cell_data=false);
+  };
+
+  template<class VECT>
+  void vtu_export::write_point_data(const getfem::mesh_fem &mf, const VECT& U,
+                                    const std::string& name) {
+    size_type Q = (gmm::vect_size(U) / mf.nb_dof()) * mf.get_qdim();
+    size_type qdim = mf.get_qdim();
+    if (psl) {
+      std::vector<scalar_type> Uslice(Q*psl->nb_points());
+      psl->interpolate(mf, U, Uslice);
+      write_dataset_(Uslice, name, qdim);
+    } else {
+      GMM_ASSERT1(pmf.get(), "exporting() should be called first");
+      std::vector<scalar_type> V(pmf->nb_dof() * Q);
+      if (&mf != &(*pmf)) {
+        interpolation(mf, *pmf, U, V);
+      } else gmm::copy(U,V);
+      size_type cnt = 0;
+      for (dal::bv_visitor d(pmf_dof_used); !d.finished(); ++d, ++cnt) {
+        if (cnt != d)
+          for (size_type q=0; q < Q; ++q) {
+            V[cnt*Q + q] = V[d*Q + q];
+          }
+      }
+      V.resize(Q*pmf_dof_used.card());
+      write_dataset_(V, name, qdim);
+    }
+  }
+
+  template<class VECT>
+  void vtu_export::write_cell_data(const VECT& U, const std::string& name,
+                                   size_type qdim) {
+    write_dataset_(U, name, qdim, true);
+  }
+
+  template<class VECT>
+  void vtu_export::write_sliced_point_data(const VECT& U,
+                                           const std::string& name,
+                                           size_type qdim) {
+    write_dataset_(U, name, qdim, false);
+  }
+
+  template<class VECT>
+  void vtu_export::write_dataset_(const VECT& U, const std::string& name,
+                                  size_type qdim, bool cell_data) {
+    GMM_ASSERT1(!closed, "the vtu file is already written");
+    GMM_ASSERT1(psl || pmf.get(), "exporting() should be called first");
+    GMM_ASSERT1(!cell_data || !psl, "cell data cannot be exported on "
+                "a slice");
+    size_type nb_val = cell_data ? nb_cells_ : nb_points_;
+    size_type Q = qdim;
+    if (Q == 1 && nb_val) Q = gmm::vect_size(U) / nb_val;
+    GMM_ASSERT1(gmm::vect_size(U) == nb_val*Q,
+                "inconsistency in the size of the dataset: "
+                << gmm::vect_size(U) << " != " << nb_val << "*" << Q);
+    GMM_ASSERT1(Q <= 3 || Q == gmm::sqr(dim_),
+                "vtk does not accept vectors of dimension > 3");
+    /* vectors are completed to 3 components, tensors (stored in FORTRAN
+       order) are written as 3x3 tensors in C (row major) order. */
+    size_type nc = (Q == 1) ? 1 : ((Q <= 3) ? 3 : 9);
+    std::vector<float> V(nb_val*nc, 0.0f);
+    for (size_type i=0; i < nb_val; ++i) {
+      if (Q <= 3)
+        for (size_type k=0; k < Q; ++k) V[i*nc+k] = float(U[i*Q+k]);
+      else
+        for (size_type k=0; k < dim_; ++k)
+          for (size_type l=0; l < dim_; ++l)
+            V[i*nc+k*3+l] = float(U[i*Q+k+l*dim_]);
+    }
+    write_float_array(V, name, nc, cell_data);
+  }
+
+  /** @brief Time series of VTK files (".pvd" file, read by ParaView).
+
+      The index file is rewritten each time a step is added, so that it
+      remains valid if the computation is interrupted. With MPI, the file
+      is written by the master process only.
+
+      @code
+      getfem::pvd_export pvd("results.pvd");
+      for (...) {
+        std::string name = "results_" + std::to_string(it) + ".pvtu";
+        {
+          getfem::vtu_export exp(name);
+          exp.exporting(mf_u);
+          exp.write_point_data(mf_u, U, "displacement");
+        }
+        pvd.add_time_step(t, name);
+      }
+      @endcode
+  */
+  class pvd_export {
+    std::string fname;
+    std::vector<std::pair<scalar_type, std::string> > steps;
+    void write() const;
+
+  public:
+    /** Add the (.vtu, .pvtu or .vtk) file corresponding to time t. The
+        file name is stored relatively to the directory of the ".pvd" file
+        when it is in this directory. */
+    void add_time_step(scalar_type t, const std::string &file);
+    size_type nb_time_steps() const { return steps.size(); }
+    pvd_export(const std::string& fname_);
+  };
+
+
   /** @brief A (quite large) class for exportation of data to IBM OpenDX.
 
                      http://www.opendx.org/
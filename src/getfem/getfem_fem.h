@@ -438,6 +438,20 @@ namespace getfem {
      */
     virtual void hess_base_value(const base_node &x, base_tensor &t) const = 0;
 
+    /** Give the values (resp. the gradients) of all components of the base
+     *  functions at all the points pts of the reference element, in one
+     *  pass, in the table tab. Return false if the fem has no specific
+     *  evaluation on a set of points, in which case base_value (resp.
+     *  grad_base_value) has to be called for each point. Used by
+     *  fem_precomp.
+     */
+    virtual bool base_value_at_points(const std::vector<base_node> &,
+                                      bgeot::precomp_table &) const
+    { return false; }
+    virtual bool grad_base_value_at_points(const std::vector<base_node> &,
+                                           bgeot::precomp_table &) const
+    { return false; }
+
     /** Give the value of all components of the base functions at the
         current point of the fem_interpolation_context.  Used by
         elementary computations.  if withM is false the matrix M for
@@ -506,13 +520,46 @@ namespace getfem {
   protected :
     std::vector<FUNC> base_;
     mutable std::vector<std::vector<FUNC>> grad_, hess_;
-    mutable bool grad_computed_ = false;
-    mutable bool hess_computed_ = false;
+    mutable std::atomic_bool grad_computed_{false};
+    mutable std::atomic_bool hess_computed_{false};
+    // compiled form of the base functions, for polynomial fems.
+    mutable bgeot::polynomial_family compiled_;
+    // compiled_computed_ is set (release) once compiled_ and is_compiled_
+    // are filled, and read (acquire) before any use of them.
+    mutable std::atomic_bool compiled_computed_{false};
+    mutable std::atomic_bool is_compiled_{false};
+
+    // true if the compiled form of the base functions can be used.
+    bool compile_() const {
+      if (!compiled_computed_.load(std::memory_order_acquire)) {
+        GLOBAL_OMP_GUARD
+        if (!compiled_computed_.load(std::memory_order_relaxed)) {
+          is_compiled_.store(base_.size() == nb_base_components(0)
+                             && base_.size() > 0
+                             && bgeot::compile_polynomials(compiled_, base_)
+                             && compiled_.dim() == dim() && dim() > 0,
+                             std::memory_order_relaxed);
+          compiled_computed_.store(true, std::memory_order_release);
+        }
+      }
+      return is_compiled_.load(std::memory_order_relaxed);
+    }
+
+    // contiguous coordinates of the points, false if there is none.
+    bool copy_points_(const std::vector<base_node> &pts,
+                      std::vector<scalar_type> &x) const {
+      x.resize(0); x.reserve(pts.size() * dim());
+      for (const base_node &pt : pts) {
+        GMM_ASSERT1(pt.size() == dim(), "dimensions mismatch");
+        x.insert(x.end(), pt.begin(), pt.end());
+      }
+      return pts.size() > 0;
+    }
 
     void compute_grad_() const {
-      if (grad_computed_) return;
+      if (grad_computed_.load(std::memory_order_acquire)) return;
       GLOBAL_OMP_GUARD
-      if (grad_computed_) return;
+      if (grad_computed_.load(std::memory_order_relaxed)) return;
       size_type R = nb_base_components(0);
       dim_type n = dim();
       grad_.resize(R);
@@ -522,13 +569,13 @@ namespace getfem {
           grad_[i][j] = base_[i]; grad_[i][j].derivative(j);
         }
       }
-      grad_computed_ = true;
+      grad_computed_.store(true, std::memory_order_release);
     }
 
     void compute_hess_() const {
-      if (hess_computed_) return;
+      if (hess_computed_.load(std::memory_order_acquire)) return;
       GLOBAL_OMP_GUARD
-      if (hess_computed_) return;
+      if (hess_computed_.load(std::memory_order_relaxed)) return;
       size_type R = nb_base_components(0);
       dim_type n = dim();
       hess_.resize(R);
@@ -541,11 +588,15 @@ namespace getfem {
           }
         }
       }
-      hess_computed_ = true;
+      hess_computed_.store(true, std::memory_order_release);
     }
 
   public :
 
+    fem() {}
+    /// The lazily computed data are not copied but computed again on demand.
+    fem(const fem &f) : virtual_fem(f), base_(f.base_) {}
+
     /// Gives the array of basic functions (components).
     const std::vector<FUNC> &base() const { return base_; }
     std::vector<FUNC> &base() { return base_; }
@@ -555,6 +606,8 @@ namespace getfem {
       bgeot::multi_index mi(2);
       mi[1] = target_dim(); mi[0] = short_type(nb_base(0));
       t.adjust_sizes(mi);
+      if (compile_() && x.size() == compiled_.dim())
+        { compiled_.eval(&(*(x.begin())), 1, &(*(t.begin()))); return; }
       size_type R = nb_base_components(0);
       base_tensor::iterator it = t.begin();
       for (size_type  i = 0; i < R; ++i, ++it)
@@ -564,22 +617,46 @@ namespace getfem {
         reference element directions 0,..,dim-1 and returns the result in
         t(nb_base,target_dim,dim) */
     void grad_base_value(const base_node &x, base_tensor &t) const {
-      if (!grad_computed_) compute_grad_();
       bgeot::multi_index mi(3);
       dim_type n = dim();
       mi[2] = n; mi[1] = target_dim(); mi[0] = short_type(nb_base(0));
       t.adjust_sizes(mi);
+      if (compile_() && x.size() == compiled_.dim())
+        { compiled_.eval_grad(&(*(x.begin())), 1, &(*(t.begin()))); return; }
+      compute_grad_();
       size_type R = nb_base_components(0);
       base_tensor::iterator it = t.begin();
       for (dim_type j = 0; j < n; ++j)
         for (size_type i = 0; i < R; ++i, ++it)
 	  *it = bgeot::to_scalar(grad_[i][j].eval(x.begin()));
     }
+    bool base_value_at_points(const std::vector<base_node> &pts,
+                              bgeot::precomp_table &tab) const {
+      if (!compile_()) return false;
+      bgeot::multi_index mi(2);
+      mi[1] = target_dim(); mi[0] = short_type(nb_base(0));
+      tab.init(pts.size(), mi);
+      std::vector<scalar_type> x;
+      if (copy_points_(pts, x))
+        compiled_.eval(x.data(), pts.size(), tab.data(0));
+      return true;
+    }
+    bool grad_base_value_at_points(const std::vector<base_node> &pts,
+                                   bgeot::precomp_table &tab) const {
+      if (!compile_()) return false;
+      bgeot::multi_index mi(3);
+      mi[2] = dim(); mi[1] = target_dim(); mi[0] = short_type(nb_base(0));
+      tab.init(pts.size(), mi);
+      std::vector<scalar_type> x;
+      if (copy_points_(pts, x))
+        compiled_.eval_grad(x.data(), pts.size(), tab.data(0));
+      return true;
+    }
     /** Evaluates at point x, the hessian of all base functions w.r.t. the
         reference element directions 0,..,dim-1 and returns the result in
         t(nb_base,target_dim,dim,dim) */
     void hess_base_value(const base_node &x, base_tensor &t) const {
-      if (!hess_computed_) compute_hess_();
+      compute_hess_();
       bgeot::multi_index mi(4);
       dim_type n = dim();
       mi[3] = n; mi[2] = n; mi[1] = target_dim();
@@ -658,16 +735,30 @@ namespace getfem {
     mutable std::vector<base_tensor> c;   // stored values of base functions
     mutable std::vector<base_tensor> pc;  // stored gradients of base functions
     mutable std::vector<base_tensor> hpc; // stored hessians of base functions
+    // the same values for all the points in contiguous arrays
+    mutable bgeot::precomp_table c_tab, pc_tab, hpc_tab;
+    // the tables are computed at their first use, possibly by another thread
+    mutable std::atomic_bool c_ok{false}, pc_ok{false}, hpc_ok{false};
+    getfem::lock_factory locks_;
   public:
     /// returns values of the base functions
     inline const base_tensor &val(size_type i) const
-      { if (c.empty()) init_val(); return c[i]; }
+      { if (!c_ok) init_val(); return c[i]; }
     /// returns gradients of the base functions
     inline const base_tensor &grad(size_type i) const
-      { if (pc.empty()) init_grad(); return pc[i]; }
+      { if (!pc_ok) init_grad(); return pc[i]; }
     /// returns hessians of the base functions
     inline const base_tensor &hess(size_type i) const
-      { if (hpc.empty()) init_hess(); return hpc[i]; }
+      { if (!hpc_ok) init_hess(); return hpc[i]; }
+    /// values of the base functions on all the points, [npt][qdim][ndof]
+    inline const bgeot::precomp_table &val_table() const
+      { if (!c_ok) init_val(); return c_tab; }
+    /// gradients of the base functions on all the points, [npt][N][qdim][ndof]
+    inline const bgeot::precomp_table &grad_table() const
+      { if (!pc_ok) init_grad(); return pc_tab; }
+    /// hessians of the base functions on all the points
+    inline const bgeot::precomp_table &hess_table() const
+      { if (!hpc_ok) init_hess(); return hpc_tab; }
     inline pfem get_pfem() const { return pf; }
     // inline const bgeot::stored_point_tab& get_point_tab() const
     //  { return *pspt; }
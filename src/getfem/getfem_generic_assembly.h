@@ -373,6 +373,25 @@ namespace getfem {
     base_tensor assemb_t;
     bool include_empty_int_pts = false;
 
+  public:
+    /* Result of the comparison, done by ga_compile, between the estimated
+       polynomial degree of an integrand and the integration methods used
+       on its region (one entry per term and per integration method). */
+    struct quadrature_info {
+      std::string expr;         // Term (whole tree of the workspace)
+      std::string method;       // Name of the integration method
+      size_type nb_points;      // Its number of points
+      int method_degree;        // Its degree of exactness
+      int estimated_degree;     // Estimated degree of the integrand,
+                                // -1 if it cannot be estimated
+      std::string suggested_method; // Cheapest classical method exact for
+      size_type nb_suggested_points;// estimated_degree, if any
+    };
+
+  private:
+    int quad_reduction_level = 0;
+    std::vector<quadrature_info> quad_report;
+
   public:
     // setter functions
     void set_assembled_matrix(model_real_sparse_matrix &K_) {
@@ -553,6 +572,20 @@ namespace getfem {
     void set_include_empty_int_points(bool include);
     bool include_empty_int_points() const;
 
+    /* Estimation by ga_compile of the polynomial degree of the integrands
+       (from the degrees of the fems, for volume integrals on linear
+       geometric transformations only) in view of detecting an
+       over-integration. level = 0 : no estimation (default),
+       1 : the result is stored in quadrature_report() and a warning is
+       emitted for each over-integrated term, 2 : the integration methods
+       of a region are moreover replaced by the cheapest classical method
+       which is exact for all the terms assembled on this region. */
+    void set_quadrature_reduction(int level);
+    int quadrature_reduction() const;
+    const std::vector<quadrature_info> &quadrature_report() const
+    { return quad_report; }
+    std::vector<quadrature_info> &quadrature_report() { return quad_report; }
+
     size_type nb_primary_dof() const { return nb_prim_dof; }
     size_type nb_temporary_dof() const { return nb_tmp_dof; }
 
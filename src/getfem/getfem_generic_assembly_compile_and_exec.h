@@ -188,8 +188,35 @@ namespace getfem {
         instructions;        // Instructions executed on each
                              // integration/interpolation point
       std::map<scalar_type, std::list<pga_tree_node> > node_list;
-
-      region_mim_instructions(): m(0), im(0) {}
+      // Integration methods replaced by a cheaper one (see
+      // ga_workspace::set_quadrature_reduction)
+      std::map<pintegration_method, pintegration_method> reduced_ims;
+
+      // Terms integrated once on the reference element and scaled by the
+      // jacobian on each linear element having tau-equivalent fems (constant
+      // coefficients, values and gradients of test functions only, see
+      // ga_compile). With gradients, the integrals are polynomials of
+      // degree ref_degree in the components of B, stored by the
+      // coefficients of their nonzero monomials.
+      struct reference_integral {
+        // monomials B[i]*B[j], the index N*P standing for 1, the first
+        // one being the constant monomial
+        std::vector<std::array<size_type, 2>> monomials;
+        std::vector<base_tensor> coeffs;
+      };
+      bool reference_integration;
+      size_type ref_degree;
+      std::vector<pga_instruction> ref_instructions; // assembly instructions
+      std::vector<base_tensor *> ref_roots;          // and root tensors
+      std::vector<const mesh_fem *> ref_mfs;         // of the terms
+      std::map<std::pair<papprox_integration, std::vector<pfem>>,
+               std::vector<reference_integral>> ref_integrals;
+      std::vector<base_tensor> ref_saved_roots;
+      bool ref_roots_modified;
+
+      region_mim_instructions()
+        : m(0), im(0), reference_integration(false), ref_degree(0),
+          ref_roots_modified(false) {}
     };
 
     std::list<ga_tree> trees; // The trees are stored mainly because they
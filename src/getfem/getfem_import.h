@@ -80,6 +80,15 @@ namespace getfem {
        in Gmsh, that which does not occur in GetFEM++ since there is
        only one "type of region".
 
+       The versions 1, 2, 4.0 and 4.1 of the MSH format are read. For
+       the version 4.1, both ASCII and binary files are supported: the
+       region of an element is then the first physical tag of its entity
+       (or the entity tag if the entity has no physical tag), the node and
+       element blocks are parsed in parallel and the nodes are inserted
+       without search of duplicated nodes, except when
+       remove_duplicated_nodes is true (the default) where a merge pass
+       of the nodes having the same coordinates is done beforehand.
+
 
       - "cdb" for meshes generated by ANSYS (in blocked format).
 
@@ -349,6 +349,13 @@ namespace getfem
      max. error */
   scalar_type test_integration_error(papprox_integration pim, dim_type order);
 
+  /* return the largest degree d <= max_degree such that all the monomials
+     of degree <= d are integrated exactly (up to round-off errors) by pim
+     on its reference element, or -1 if pim is not even exact for the
+     constants. The result is cached for each method. */
+  int approx_im_exactness_degree(papprox_integration pim,
+                                 int max_degree = 30);
+
   papprox_integration get_approx_im_or_fail(pintegration_method pim);
 
   /* Function allowing the add of an integration method outwards
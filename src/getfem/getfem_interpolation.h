@@ -86,6 +86,10 @@ namespace getfem {
      * if rg_source is provided only the corresponding part of the mesh is
      * taken into account and extrapolation is done with respect to the
      * boundary of the specified region. rg_source must contain only convexes.
+     *
+     * When called outside a parallel section, the convexes are distributed
+     * between the threads. The result does not depend on the number of
+     * threads.
      */
     void distribute(int extrapolation = 0,
                     mesh_region rg_source=mesh_region::all_convexes());
@@ -54,6 +54,8 @@ namespace getfem {
 
   class integration_method;
   typedef std::shared_ptr<const integration_method> pintegration_method;
+  class binary_ofile;
+  class binary_ifile;
 
   /**@addtogroup mesh*/
   /**@{*/
@@ -122,6 +124,7 @@ namespace getfem {
     mutable bool cuthill_mckee_uptodate;
     dal::dynamic_array<gmm::uint64_type> cvs_v_num;
     mutable std::vector<size_type> cmk_order; // cuthill-mckee
+    std::vector<scalar_type> cvs_weights; // computational cost of convexes
     void init();
 
 #if GETFEM_PARA_LEVEL > 1
@@ -454,6 +457,32 @@ namespace getfem {
     /** Pack the mesh : renumber convexes and nodes such that there
         is no holes in their numbering. Do NOT do the Cuthill-McKee. */
     void optimize_structure(bool with_renumbering = true);
+    /** Pack the mesh and renumber the convexes following a space filling
+        curve passing through their centers (Hilbert curve, or Morton one
+        if hilbert is false), and the points in the order of their first
+        appearance in the renumbered convexes. The dofs of the mesh_fems
+        being enumerated in the order of the convexes, they follow the
+        same ordering. Besides, the contiguous parts of the regions
+        affected to the threads are then spatially compact. */
+    void renumber_along_curve(bool hilbert = true);
+    /** Set the relative computational costs of the convexes (indexed by
+        the convex numbers, see element_integration_costs). They are used
+        to balance the parts of the regions affected to the threads in
+        the parallel assemblies and the mpi partition when METIS is not
+        available. An empty vector means the same cost for all convexes.
+        The mesh itself is not modified: its version is unchanged and the
+        objects depending on it are not invalidated. */
+    void set_convex_weights(const std::vector<scalar_type> &w) {
+      cvs_weights = w;
+#if GETFEM_PARA_LEVEL > 1
+      modified = true; // only the mpi partition has to be recomputed
+#endif
+    }
+    const std::vector<scalar_type> &convex_weights() const
+    { return cvs_weights; }
+    /// Return the computational cost of the convex ic (1 by default).
+    scalar_type convex_weight(size_type ic) const
+    { return ic < cvs_weights.size() ? cvs_weights[ic] : scalar_type(1); }
     /// Return the list of convex IDs for a Cuthill-McKee ordering
     const std::vector<size_type> &cuthill_mckee_ordering() const;
     /// Erase the mesh.
@@ -476,6 +505,22 @@ namespace getfem {
         @see getfem::import_mesh.
     */
     void read_from_file(std::istream &ist);
+    /** Write the mesh in the sections prefix.* of a binary file (see
+        getfem_binary_io.h). The convexes are grouped by geometric
+        transformation. */
+    void write_to_binary(binary_ofile &f,
+                         const std::string &prefix = "mesh") const;
+    /** Load the mesh from the sections prefix.* of a binary file. If rg is
+        given, only the convexes of the region rg and their points are
+        loaded. The indices of the points and convexes are kept. */
+    void read_from_binary(const binary_ifile &f,
+                          const std::string &prefix = "mesh",
+                          size_type rg = size_type(-1));
+    /** Write the mesh to a binary file. */
+    void write_to_binary_file(const std::string &name) const;
+    /** Load the mesh (or only the region rg) from a binary file. */
+    void read_from_binary_file(const std::string &name,
+                               size_type rg = size_type(-1));
     /** Clone a mesh */
     void copy_from(const mesh& m); /* might be the copy constructor */
     size_type memsize() const;
@@ -586,6 +631,24 @@ namespace getfem {
     (dim_type di, const ITER &ps)
   { return add_convex_by_points(bgeot::prism_geotrans(di, 1), ps); }
 
+  /** Ordering of the convexes of the mesh following a Hilbert curve (or a
+      Morton one if hilbert is false) passing through the mean of their
+      vertices. Only the three first coordinates are taken into account. */
+  void APIDECL space_filling_curve_ordering(const mesh &m,
+                                            std::vector<size_type> &order,
+                                            bool hilbert = true);
+
+  /** Split the convexes of the mesh in nb_parts parts of equal total
+      weight (see mesh::set_convex_weights) made of consecutive convexes
+      along a space filling curve. On output, part[cv] is the part of the
+      convex cv (size_type(-1) for the unused convex numbers). This is
+      the partition used for the mpi distribution when METIS is not
+      available. */
+  void APIDECL space_filling_curve_partition(const mesh &m,
+                                             size_type nb_parts,
+                                             std::vector<size_type> &part,
+                                             bool hilbert = true);
+
   /** rough estimate of the convex area.
       @param pgt the geometric transformation.
       @param pts the convex nodes.
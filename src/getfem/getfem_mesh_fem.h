@@ -632,6 +632,15 @@ namespace getfem {
         saved to the file.
     */
     void write_to_file(const std::string &name, bool with_mesh=false) const;
+    /** Write the mesh_fem (finite element methods, dof enumeration and
+        reduction matrices) in the sections prefix.* of a binary file. */
+    void write_to_binary(binary_ofile &f,
+                         const std::string &prefix = "mesh_fem") const;
+    /** Read the mesh_fem from the sections prefix.* of a binary file. If
+        the linked mesh has been partially loaded, the convexes which are
+        not in the mesh are ignored and the dof are enumerated again. */
+    void read_from_binary(const binary_ifile &f,
+                          const std::string &prefix = "mesh_fem");
   };
 
   /** Gives the descriptor of a classical finite element method of degree K
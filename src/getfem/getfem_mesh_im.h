@@ -43,6 +43,55 @@
 
 namespace getfem {
 
+  class mesh_im;
+
+  /** Storage of the geometric quantities computed by the high-level
+      generic assembly on the integration points of the elements (or faces
+      of elements) of a mesh_im: the Jacobian, the matrices K and B, the
+      unit normal on a face and the size of the element. For a linear
+      transformation, the values are stored for the first point only.
+
+      The stored values are discarded when the version number of the
+      mesh_im changes (modification of the mesh or of the integration
+      methods). Their total size, including the index of the stored
+      values, is limited; the elements which do not fit have their
+      geometric quantities recomputed at each assembly.
+  */
+  class im_geometric_cache {
+    size_type max_size;                   // in number of scalars
+    std::atomic<size_type> cur_size;
+    gmm::uint64_type v_num;
+    size_type nb_slots_cv;                // number of faces + 1
+    std::vector<std::unique_ptr<scalar_type[]>> slots;
+    std::vector<char> ready;
+    getfem::lock_factory locks_;
+
+    size_type slot(size_type cv, short_type f) const
+    { return cv*nb_slots_cv + (f == short_type(-1) ? 0 : f+1); }
+
+  public:
+    /** Discard the stored values if mim has been modified. */
+    void check_version(const mesh_im &mim);
+    /** Values stored for the face f of cv (f = -1 for the element
+        itself), or 0 if there is none. */
+    const scalar_type *values(size_type cv, short_type f) const {
+      size_type i = slot(cv, f);
+      return (i < ready.size() && ready[i]) ? slots[i].get() : 0;
+    }
+    /** Reserve the storage of n scalars for the face f of cv. Return 0 if
+        the memory limit is reached. */
+    scalar_type *reserve(size_type cv, short_type f, size_type n);
+    /** Declare the values of the face f of cv as stored. */
+    void validate(size_type cv, short_type f) { ready[slot(cv, f)] = 1; }
+    size_type max_bytes() const { return max_size * sizeof(scalar_type); }
+    size_type memsize() const
+    { return sizeof(*this) + cur_size * sizeof(scalar_type); }
+
+    explicit im_geometric_cache(size_type max_bytes_)
+      : max_size(max_bytes_ / sizeof(scalar_type)), cur_size(0),
+        v_num(0), nb_slots_cv(1) {}
+  };
+
   /// Describe an integration method linked to a mesh.
   class mesh_im : public context_dependencies, virtual public dal::static_stored_object {
   private :
@@ -56,6 +105,7 @@ namespace getfem {
     mutable gmm::uint64_type v_num_update, v_num;
     pintegration_method auto_add_elt_pim; /* im for automatic addition     */
                           /* of element option. (0 = no automatic addition)*/
+    std::shared_ptr<im_geometric_cache> geo_cache;
 
   public :
     void update_from_context(void) const;
@@ -118,10 +168,32 @@ namespace getfem {
     { return  ims[cv]; }
     void clear(void);
 
+    /** Store the geometric quantities (Jacobian, K and B matrices, unit
+        normals) computed on the integration points by the high-level
+        generic assembly, using at most max_bytes bytes, to reuse them in
+        the next assemblies. This is useful when the same mesh is used by
+        many assemblies (Newton iterations, time steps). A value of 0
+        disables the storage.
+        The mesh has to be modified through its methods (which update the
+        version numbers), not by a direct access to the points.
+    */
+    void set_geometric_cache(size_type max_bytes) {
+      if (max_bytes) geo_cache = std::make_shared<im_geometric_cache>(max_bytes);
+      else geo_cache.reset();
+    }
+    /** The storage of geometric quantities, or 0 if it is disabled. */
+    const im_geometric_cache *geometric_cache() const
+    { return geo_cache.get(); }
+    /** The storage of geometric quantities, filled by the assemblies which
+        only have a const access to the mesh_im, or 0 if it is disabled. */
+    im_geometric_cache *mutable_geometric_cache() const
+    { return geo_cache.get(); }
+
     size_type memsize() const {
       return
         sizeof(mesh_im) +
-        ims.memsize() + im_convexes.memsize();
+        ims.memsize() + im_convexes.memsize() +
+        (geo_cache ? geo_cache->memsize() : 0);
     }
 
     void init_with_mesh(const mesh &me);
@@ -147,11 +219,27 @@ namespace getfem {
         saved to the file.
     */
     void write_to_file(const std::string &name, bool with_mesh=false) const;
+    /** Write the mesh_im in the sections prefix.* of a binary file. */
+    void write_to_binary(binary_ofile &f,
+                         const std::string &prefix = "mesh_im") const;
+    /** Read the mesh_im from the sections prefix.* of a binary file. The
+        convexes which are not in the linked mesh are ignored. */
+    void read_from_binary(const binary_ifile &f,
+                          const std::string &prefix = "mesh_im");
   };
 
   /** Dummy mesh_im for default parameter of functions. */
   const mesh_im &dummy_mesh_im();
 
+  class mesh_fem;
+
+  /** Estimate of the cost of an assembly on each convex: the number of
+      integration points of mim times the number of dofs of mf on the
+      convex (w is indexed by the convex numbers). It can be given to
+      mesh::set_convex_weights to balance the parallel assemblies. */
+  void element_integration_costs(const mesh_im &mim, const mesh_fem &mf,
+                                 std::vector<scalar_type> &w);
+
 }  /* end of namespace getfem.                                             */
 
 
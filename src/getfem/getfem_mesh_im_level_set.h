@@ -66,13 +66,27 @@ namespace getfem {
 				   ignored (for instance because
 				   INTEGRATE_INSIDE and the convex
 				   is outside etc.) */
-    std::vector<pintegration_method> build_methods;
+
+    /* integration method built for a cut convex, and the values of the
+       level sets on this convex when it was built. */
+    struct cut_method {
+      std::vector<scalar_type> ls_values;
+      pintegration_method pim;
+    };
+    std::map<size_type, cut_method> build_methods;
 
     mutable bool is_adapted;
     int integrate_where; // INTEGRATE_INSIDE or INTEGRATE_OUTSIDE
+    bool incremental;
+    scalar_type incremental_tol;
+    size_type nb_rebuilt;
 
     void clear_build_methods();
-    void build_method_of_convex(size_type cv);
+    papprox_integration build_method_of_convex(size_type cv);
+    void level_set_values_of_convex(size_type cv,
+                                    std::vector<scalar_type> &v) const;
+    bool same_cut(const std::vector<scalar_type> &v1,
+                  const std::vector<scalar_type> &v2) const;
 
     /* CSG (constructive solid geometry) description for the
        definition of the domain with respect to one or more levelsets.
@@ -110,9 +124,22 @@ namespace getfem {
 			pintegration_method sing = 0) {
       regular_simplex_pim = reg;
       base_singular_pim = sing;
+      clear_build_methods(); is_adapted = false;
     }
 
     int location() const { return integrate_where; }
+
+    /** Incremental adaptation: adapt() keeps the integration method of
+	a cut convex when the values of the level sets on this convex have
+	the same signs as at the previous adaptation and differ by at most
+	tol. With tol = 0, only the convexes whose level-set values are
+	unchanged keep their method. The other cut convexes are treated in
+	parallel. */
+    void set_incremental_adapt(bool inc, scalar_type tol = scalar_type(0))
+    { incremental = inc; incremental_tol = tol; }
+    /** Number of integration methods of cut convexes computed by the last
+	call to adapt(). */
+    size_type nb_rebuilt_methods() const { return nb_rebuilt; }
     
     size_type memsize() const {
       return mesh_im::memsize(); // + ... ;
@@ -172,6 +199,7 @@ namespace getfem {
     */
     void set_level_set_boolean_operations(const std::string description) {
       ls_csg_description = description;
+      clear_build_methods(); is_adapted = false;
     }
     void compute_normal_vector(const fem_interpolation_context &ctx,
 			       base_small_vector &vec) const;
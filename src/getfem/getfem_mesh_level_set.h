@@ -164,7 +164,8 @@ namespace getfem {
 
   private:
     void cut_element(size_type cv, const dal::bit_vector &primary,
-		     const dal::bit_vector &secondary, scalar_type radius);
+		     const dal::bit_vector &secondary, scalar_type radius,
+		     const std::vector<base_node> &curv_points);
     int is_not_crossed_by(size_type c, plevel_set ls, unsigned lsnum,
 			  scalar_type radius);
     int sub_simplex_is_not_crossed_by(size_type cv, plevel_set ls,
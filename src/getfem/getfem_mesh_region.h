@@ -40,7 +40,7 @@
 #include <atomic>
 #include <bitset>
 #include <iostream>
-#include <map>
+#include <vector>
 
 #include "dal_bit_vector.h"
 #include "bgeot_convex_structure.h"
@@ -55,16 +55,42 @@ namespace getfem {
   class APIDECL mesh_region {
   public:
     using face_bitset = std::bitset<MAX_FACES_PER_CV+1>;
-    using map_t = std::map<size_type, face_bitset>;
+    /** Flat map of the (convex, mask) pairs, sorted by convex number. Bit 0
+        of a mask stands for the convex itself and bit f+1 for its face f. */
+    using map_t = std::vector<std::pair<size_type, face_bitset>>;
 
   private:
 
     using const_iterator = map_t::const_iterator;
 
     struct impl {
+      /* m[0..nb_sorted) is sorted without duplicates, the remaining
+         entries have been appended by add() and are merged at the next
+         access to the region. */
       mutable map_t m;
+      mutable size_type nb_sorted = 0;
+      /* true if there is no pending entry. Read without lock by
+         entries(), so that concurrent readers do not race with the
+         merge. */
+      mutable std::atomic_bool sorted{true};
       mutable omp_distribute<dal::bit_vector> index_;
       mutable dal::bit_vector serial_index_;
+      mutable const mesh *pmesh = nullptr; /* mesh of the last from_mesh */
+
+      impl() {}
+      impl &operator=(const impl &o) {
+        m = o.m; nb_sorted = o.nb_sorted;
+        sorted.store(o.sorted.load(std::memory_order_acquire),
+                     std::memory_order_release);
+        index_ = o.index_; serial_index_ = o.serial_index_;
+        pmesh = o.pmesh;
+        return *this;
+      }
+      /* the n first entries are sorted without duplicates */
+      void sorted_up_to(size_type n) {
+        nb_sorted = n;
+        sorted.store(n == m.size(), std::memory_order_release);
+      }
     };
     std::shared_ptr<impl> p;  /* the real region data */
 
@@ -82,24 +108,21 @@ namespace getfem {
     mesh *parent_mesh; /* used for mesh_region "extracted" from
                           a mesh (to provide feedback) */
 
-
-    //cashing iterators for partitions
-    mutable omp_distribute<const_iterator> itbegin;
-    mutable omp_distribute<const_iterator> itend;
-
     //flags for all the cashes
     mutable omp_distribute<bool> index_updated;
-    mutable omp_distribute<bool> partitions_updated;
     mutable bool serial_index_updated;
 
     void mark_region_changed() const;
 
     void update_index() const;
 
-    void update_partition_iterators() const;
-
     impl &wp() { return *p.get(); }
     const impl &rp() const { return *p.get(); }
+    /** sorted content of the region, merging the pending added entries */
+    const map_t &entries() const;
+    map_t &wentries() { entries(); return wp().m; }
+    map_t::iterator find_entry(size_type cv);
+    const_iterator find_entry(size_type cv) const;
     void clean();
     /** tells the owner mesh that the region is valid */
     void touch_parent_mesh();
@@ -112,6 +135,12 @@ namespace getfem {
     for the end of the region partition for the current thread*/
     const_iterator partition_end() const;
 
+    /**when running while multithreaded, gives the range of the region
+    partition for the current thread, the partitions having the same
+    total weight of convexes if the mesh has convex weights
+    (see mesh::set_convex_weights)*/
+    void partition_range(const_iterator &b, const_iterator &e) const;
+
     /**begin iterator of the region depending if its partitioned or not*/
     const_iterator begin() const;
 
@@ -198,6 +227,9 @@ namespace getfem {
     /** Index of the region convexes, or the convexes from the partition on the
     current thread. */
     const dal::bit_vector& index() const;
+    /** Add convexes or faces to the region. The added entries are merged
+        at the next access to the region, which invalidates the iterators
+        held by the live mr_visitor on this region. */
     void add(const dal::bit_vector &bv);
     void add(size_type cv, short_type f = short_type(-1));
     void sup(size_type cv, short_type f = short_type(-1));
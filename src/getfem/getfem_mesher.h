@@ -83,6 +83,15 @@ namespace getfem {
     virtual void register_constraints(std::vector<const
 				      mesher_signed_distance*>& list) const=0;
     virtual scalar_type operator()(const base_node &P) const  = 0;
+    /** Evaluation on a set of points, d[i] being the distance of P[i].
+        The primitives and the boolean operations evaluate their operands
+        on the whole set at once, avoiding a virtual call per point and
+        per node of the expression tree. */
+    virtual void values(const std::vector<base_node> &P,
+			base_vector &d) const {
+      d.resize(P.size());
+      for (size_type i = 0; i < P.size(); ++i) d[i] = (*this)(P[i]);
+    }
   };
 
   typedef std::shared_ptr<const mesher_signed_distance> pmesher_signed_distance;
@@ -98,6 +107,12 @@ namespace getfem {
     { return false; }
     virtual scalar_type operator()(const base_node &P) const
     { return xon - gmm::vect_sp(P,n); }
+    virtual void values(const std::vector<base_node> &P,
+			base_vector &d) const {
+      d.resize(P.size());
+      for (size_type i = 0; i < P.size(); ++i)
+	d[i] = xon - gmm::vect_sp(P[i],n);
+    }
     virtual scalar_type operator()(const base_node &P,
 				   dal::bit_vector &bv) const {
       scalar_type d = xon - gmm::vect_sp(P,n);
@@ -202,6 +217,12 @@ namespace getfem {
     }
     virtual scalar_type operator()(const base_node &P) const
     { return gmm::vect_dist2(P,x0)-R; }
+    virtual void values(const std::vector<base_node> &P,
+			base_vector &d) const {
+      d.resize(P.size());
+      for (size_type i = 0; i < P.size(); ++i)
+	d[i] = gmm::vect_dist2(P[i],x0)-R;
+    }
     virtual void register_constraints(std::vector<const
 				      mesher_signed_distance*>& list) const {
       id = list.size(); list.push_back(this);
@@ -251,6 +272,12 @@ namespace getfem {
       }
       return d;
     }
+    virtual void values(const std::vector<base_node> &P,
+			base_vector &d) const {
+      d.resize(P.size());
+      for (size_type i = 0; i < P.size(); ++i)
+	d[i] = mesher_rectangle::operator()(P[i]);
+    }
 
     virtual scalar_type operator()(const base_node &P, dal::bit_vector &bv)
       const {
@@ -493,6 +520,16 @@ namespace getfem {
       }
       return d;
     }
+    virtual void values(const std::vector<base_node> &P,
+			base_vector &d) const {
+      if (!with_min) { mesher_signed_distance::values(P, d); return; }
+      base_vector dk;
+      dists[0]->values(P, d);
+      for (size_type k = 1; k < dists.size(); ++k) {
+	dists[k]->values(P, dk);
+	for (size_type i = 0; i < P.size(); ++i) d[i] = std::min(d[i], dk[i]);
+      }
+    }
     scalar_type operator()(const base_node &P, dal::bit_vector &bv) const {
       if (with_min) {
 	scalar_type d = vd[0] = (*(dists[0]))(P);
@@ -674,6 +711,15 @@ namespace getfem {
       return d;
 
     }
+    virtual void values(const std::vector<base_node> &P,
+			base_vector &d) const {
+      base_vector dk;
+      dists[0]->values(P, d);
+      for (size_type k = 1; k < dists.size(); ++k) {
+	dists[k]->values(P, dk);
+	for (size_type i = 0; i < P.size(); ++i) d[i] = std::max(d[i], dk[i]);
+      }
+    }
     scalar_type operator()(const base_node &P, dal::bit_vector &bv) const {
       scalar_type d = vd[0] = (*(dists[0]))(P);
       bool ok = (d < SEPS);
@@ -760,6 +806,12 @@ namespace getfem {
     }
     scalar_type operator()(const base_node &P) const
     { return std::max((*a)(P),-(*b)(P)); }
+    virtual void values(const std::vector<base_node> &P,
+			base_vector &d) const {
+      base_vector db;
+      a->values(P, d); b->values(P, db);
+      for (size_type i = 0; i < P.size(); ++i) d[i] = std::max(d[i], -db[i]);
+    }
     virtual void register_constraints(std::vector<const
 				      mesher_signed_distance*>& list) const {
       a->register_constraints(list); b->register_constraints(list);
@@ -795,6 +847,20 @@ namespace getfem {
       gmm::add(gmm::scaled(n, -gmm::vect_sp(v, n)), v);
       return gmm::vect_norm2(v) - R;
     }
+    virtual void values(const std::vector<base_node> &P,
+			base_vector &d) const {
+      d.resize(P.size());
+      for (size_type i = 0; i < P.size(); ++i) {
+	base_node::const_iterator itp = P[i].begin(), itx = x0.begin(),
+	  itn = n.begin();
+	scalar_type a(0), b(0);
+	for (size_type k = 0; k < x0.size(); ++k)
+	  b += (itp[k] - itx[k]) * itn[k];
+	for (size_type k = 0; k < x0.size(); ++k)
+	  a += gmm::sqr(itp[k] - itx[k] - b * itn[k]);
+	d[i] = gmm::sqrt(a) - R;
+      }
+    }
     virtual scalar_type operator()(const base_node &P,
 				   dal::bit_vector &bv) const {
       scalar_type d = (*this)(P);
@@ -849,6 +915,8 @@ namespace getfem {
       return true;
     }
     virtual scalar_type operator()(const base_node &P) const {return (*i1)(P); }
+    virtual void values(const std::vector<base_node> &P,
+			base_vector &d) const { i1->values(P, d); }
     virtual scalar_type operator()(const base_node &P,
 				   dal::bit_vector& bv) const
     { return (*i1)(P, bv); }
@@ -941,6 +1009,8 @@ namespace getfem {
       return true;
     }
     virtual scalar_type operator()(const base_node &P) const {return (*i1)(P); }
+    virtual void values(const std::vector<base_node> &P,
+			base_vector &d) const { i1->values(P, d); }
     virtual scalar_type operator()(const base_node &P,
 				   dal::bit_vector& bv) const
     { return (*i1)(P, bv); }
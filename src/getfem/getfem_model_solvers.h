@@ -84,6 +84,20 @@ namespace getfem {
     virtual ~abstract_linear_solver() {}
   };
 
+  /* Direct linear solvers able to keep the factorization of the matrix  */
+  /* alive between several solves (used by the Newton algorithms with    */
+  /* reuse of the tangent matrix).                                       */
+  template <typename MAT, typename VECT>
+  struct abstract_factorizing_linear_solver
+    : public abstract_linear_solver<MAT, VECT> {
+    /* Factorize M and keep the factors. Return false if M is singular.  */
+    virtual bool factorize(const MAT &) const = 0;
+    /* Solve with the last computed factorization. Return false if the
+       solve failed.                                                      */
+    virtual bool solve(VECT &, const VECT &) const = 0;
+    virtual void clear_factorization() const = 0;
+  };
+
   template <typename MAT, typename VECT>
   struct linear_solver_cg_preconditioned_ildlt
     : public abstract_linear_solver<MAT, VECT> {
@@ -141,7 +155,9 @@ namespace getfem {
 
   template <typename MAT, typename VECT>
   struct linear_solver_superlu
-    : public abstract_linear_solver<MAT, VECT> {
+    : public abstract_factorizing_linear_solver<MAT, VECT> {
+    typedef typename gmm::linalg_traits<MAT>::value_type T;
+    mutable std::unique_ptr<gmm::SuperLU_factor<T>> LU;
     void operator ()(const MAT &M, VECT &x, const VECT &b,
                      gmm::iteration &iter)  const {
       double rcond;
@@ -152,36 +168,78 @@ namespace getfem {
       iter.enforce_converged(info == 0);
       if (iter.get_noisy()) cout << "condition number: " << 1.0/rcond<< endl;
     }
+    bool factorize(const MAT &M) const {
+      LU = std::make_unique<gmm::SuperLU_factor<T>>();
+      try { LU->build_with(M); }
+      catch (const gmm::gmm_error &) { LU.reset(); return false; }
+      return true;
+    }
+    bool solve(VECT &x, const VECT &b) const {
+      GMM_ASSERT1(LU, "No available factorization");
+      LU->solve(x, b);
+      return true;
+    }
+    void clear_factorization() const { LU.reset(); }
   };
 
   template <typename MAT, typename VECT>
-  struct linear_solver_dense_lu : public abstract_linear_solver<MAT, VECT> {
+  struct linear_solver_dense_lu
+    : public abstract_factorizing_linear_solver<MAT, VECT> {
+    typedef typename gmm::linalg_traits<MAT>::value_type T;
+    mutable gmm::dense_matrix<T> LU;
+    mutable gmm::lapack_ipvt ipvt;
     void operator ()(const MAT &M, VECT &x, const VECT &b,
                      gmm::iteration &iter) const {
-      typedef typename gmm::linalg_traits<MAT>::value_type T;
       gmm::dense_matrix<T> MM(gmm::mat_nrows(M),gmm::mat_ncols(M));
       gmm::copy(M, MM);
       gmm::lu_solve(MM, x, b);
       iter.enforce_converged(true);
     }
+    bool factorize(const MAT &M) const {
+      gmm::resize(LU, gmm::mat_nrows(M), gmm::mat_ncols(M));
+      gmm::copy(M, LU);
+      ipvt = gmm::lapack_ipvt(gmm::mat_nrows(M));
+      if (gmm::lu_factor(LU, ipvt)) { clear_factorization(); return false; }
+      return true;
+    }
+    bool solve(VECT &x, const VECT &b) const {
+      GMM_ASSERT1(ipvt.size(), "No available factorization");
+      gmm::lu_solve(LU, ipvt, x, b);
+      return true;
+    }
+    void clear_factorization() const
+    { gmm::resize(LU, 0, 0); ipvt = gmm::lapack_ipvt(0); }
+    linear_solver_dense_lu() : ipvt(0) {}
   };
 
 #ifdef GMM_USES_MUMPS
   template <typename MAT, typename VECT>
-  struct linear_solver_mumps : public abstract_linear_solver<MAT, VECT> {
+  struct linear_solver_mumps
+    : public abstract_factorizing_linear_solver<MAT, VECT> {
+    typedef typename gmm::linalg_traits<MAT>::value_type T;
+    mutable gmm::MUMPS_factor<T> LU;
     void operator ()(const MAT &M, VECT &x, const VECT &b,
                      gmm::iteration &iter) const {
       bool ok = gmm::MUMPS_solve(M, x, b, false);
       iter.enforce_converged(ok);
     }
+    bool factorize(const MAT &M) const { return LU.build_with(M, false); }
+    bool solve(VECT &x, const VECT &b) const { return LU.solve(x, b); }
+    void clear_factorization() const { LU.clear(); }
   };
   template <typename MAT, typename VECT>
-  struct linear_solver_mumps_sym : public abstract_linear_solver<MAT, VECT> {
+  struct linear_solver_mumps_sym
+    : public abstract_factorizing_linear_solver<MAT, VECT> {
+    typedef typename gmm::linalg_traits<MAT>::value_type T;
+    mutable gmm::MUMPS_factor<T> LU;
     void operator ()(const MAT &M, VECT &x, const VECT &b,
                      gmm::iteration &iter) const {
       bool ok = gmm::MUMPS_solve(M, x, b, true);
       iter.enforce_converged(ok);
     }
+    bool factorize(const MAT &M) const { return LU.build_with(M, true); }
+    bool solve(VECT &x, const VECT &b) const { return LU.solve(x, b); }
+    void clear_factorization() const { LU.clear(); }
   };
 #endif
 
@@ -608,6 +666,171 @@ namespace getfem {
   }
 
 
+  /* ***************************************************************** */
+  /*     Reuse of the tangent matrix in Newton algorithms.             */
+  /* ***************************************************************** */
+  /* Policy deciding when the tangent matrix has to be recomputed and  */
+  /* refactorized. Between two refactorizations, either the same       */
+  /* factorization is used (modified Newton) or it is corrected by     */
+  /* rank-one Broyden updates of its inverse.                          */
+  /* The default policy refactorizes when the contraction rate of the  */
+  /* residual res_{k+1}/res_k exceeds contraction_max or after         */
+  /* reuse_max iterations with the same factorization.                 */
+  /*********************************************************************/
+
+  struct newton_jacobian_reuse_policy {
+    enum update_type { MODIFIED_NEWTON, BROYDEN };
+    update_type update;
+    double contraction_max;
+    size_type reuse_max, nb_reuse;
+
+    virtual void init() { nb_reuse = 0; }
+    virtual bool refactorize(double res, double res_prev) {
+      ++nb_reuse;
+      return (nb_reuse >= reuse_max || res > res_prev * contraction_max);
+    }
+    newton_jacobian_reuse_policy(update_type upd = MODIFIED_NEWTON,
+                                 double c_max = 0.5, size_type r_max = 10)
+      : update(upd), contraction_max(c_max), reuse_max(r_max), nb_reuse(0) {}
+    virtual ~newton_jacobian_reuse_policy() {}
+  };
+
+  /* Newton algorithm with reuse of the tangent matrix. If the linear     */
+  /* solver is an abstract_factorizing_linear_solver, its factorization   */
+  /* is kept between iterations, otherwise the linear solver is simply    */
+  /* called with the previously assembled tangent matrix.                 */
+  /* The Broyden update of the inverse of the tangent matrix is           */
+  /*   H_{k+1} = (I + a_k s_k^*) H_k, a_k = (s_k - H_k y_k)/(s_k^* H_k y_k) */
+  /* with s_k the step and y_k the variation of F = -residual.            */
+  template <typename PB>
+  void Newton_with_jacobian_reuse
+  (PB &pb, gmm::iteration &iter,
+   const abstract_linear_solver<typename PB::MATRIX,
+                                typename PB::VECTOR> &linear_solver,
+   newton_jacobian_reuse_policy &policy)
+  {
+    typedef typename PB::VECTOR VECTOR;
+    typedef typename gmm::linalg_traits<VECTOR>::value_type T;
+    typedef typename gmm::number_traits<T>::magnitude_type R;
+    gmm::iteration iter_linsolv0 = iter;
+    iter_linsolv0.reduce_noisy();
+    iter_linsolv0.set_resmax(iter.get_resmax()/20.0);
+    iter_linsolv0.set_maxiter(10000); // arbitrary
+
+    const abstract_factorizing_linear_solver<typename PB::MATRIX, VECTOR>
+      *fsolver = dynamic_cast<const abstract_factorizing_linear_solver
+                              <typename PB::MATRIX, VECTOR> *>(&linear_solver);
+
+    pb.compute_residual();
+    R approx_eln = pb.approx_external_load_norm();
+    if (approx_eln == R(0)) approx_eln = R(1);
+
+    size_type n = gmm::vect_size(pb.residual());
+    VECTOR dr(n), b(n), rhs_prev(n), hy(n);
+    std::vector<VECTOR> upd_a, upd_s; // Broyden updates of the inverse
+
+    // Application of the current approximation of the inverse of the
+    // tangent matrix.
+    auto apply_inverse = [&](VECTOR &x, const VECTOR &y, gmm::iteration &it) {
+      gmm::clear(x);
+      if (fsolver) it.enforce_converged(fsolver->solve(x, y));
+      else linear_solver(pb.tangent_matrix(), x, y, it);
+      for (size_type j = 0; j < upd_s.size(); ++j)
+        gmm::add(gmm::scaled(upd_a[j], gmm::vect_hp(x, upd_s[j])), x);
+    };
+
+    bool refactorize = true;
+    R res_prev = pb.residual_norm();
+    scalar_type crit = res_prev / approx_eln;
+    while (!iter.finished(crit)) {
+      gmm::iteration iter_linsolv = iter_linsolv0;
+
+      if (refactorize) {
+        if (iter.get_noisy() > 1)
+          cout << "starting computing tangent matrix" << endl;
+        int is_singular = 1;
+        while (is_singular) {
+          pb.compute_tangent_matrix();
+          bool ok = true;
+          if (fsolver) {
+            if (iter.get_noisy() > 1) cout << "starting factorization" << endl;
+            ok = fsolver->factorize(pb.tangent_matrix());
+          }
+          if (!ok) {
+            is_singular++;
+            if (is_singular <= 4) {
+              if (iter.get_noisy())
+                cout << "Singular tangent matrix:"
+                  " perturbation of the state vector." << endl;
+              pb.perturbation();
+              pb.compute_residual();
+            } else {
+              if (iter.get_noisy())
+                cout << "Singular tangent matrix: perturbation failed, "
+                     << "aborting." << endl;
+              return;
+            }
+          }
+          else is_singular = 0;
+        }
+        upd_a.clear(); upd_s.clear();
+        policy.init();
+        refactorize = false;
+      }
+
+      if (iter.get_noisy() > 1) cout << "starting linear solver" << endl;
+      gmm::copy(pb.residual(), b);
+      iter_linsolv.init();
+      apply_inverse(dr, b, iter_linsolv);
+      if (!iter_linsolv.converged()) {
+        if (policy.nb_reuse == 0) {
+          if (iter.get_noisy())
+            cout << "Linear solver failed with a fresh tangent matrix, "
+                 << "aborting." << endl;
+          return;
+        }
+        refactorize = true; continue;
+      }
+      if (iter.get_noisy() > 1) cout << "linear solver done" << endl;
+
+      gmm::copy(pb.residual(), rhs_prev);
+      R alpha = pb.line_search(dr, iter); //it is assumed that the linesearch
+                                          //executes a pb.compute_residual();
+      if (iter.get_noisy()) cout << "alpha = " << std::setw(6) << alpha << " ";
+      ++iter;
+      R res = pb.residual_norm();
+      crit = std::min(res / approx_eln,
+                      gmm::vect_norm1(dr) / std::max(1E-25, pb.state_norm()));
+      refactorize = policy.refactorize(res, res_prev);
+      res_prev = res;
+
+      if (!refactorize
+          && policy.update == newton_jacobian_reuse_policy::BROYDEN) {
+        // s = alpha*dr, H y = -H (rhs_{k+1} - rhs_k)
+        gmm::add(pb.residual(), gmm::scaled(rhs_prev, T(-1)), b);
+        iter_linsolv.init();
+        apply_inverse(hy, b, iter_linsolv);
+        gmm::scale(hy, T(-1));
+        VECTOR s(n), a(n);
+        gmm::copy(gmm::scaled(dr, alpha), s);
+        T shy = gmm::vect_hp(hy, s);
+        if (!iter_linsolv.converged()
+            || gmm::abs(shy) <= R(1E-14) * gmm::vect_norm2(s)
+                                         * gmm::vect_norm2(hy))
+          refactorize = true;
+        else {
+          gmm::add(s, gmm::scaled(hy, T(-1)), a);
+          gmm::scale(a, T(1)/shy);
+          upd_a.push_back(a); upd_s.push_back(s);
+        }
+      }
+      if (refactorize && iter.get_noisy() > 1)
+        cout << "tangent matrix reused " << policy.nb_reuse << " times" << endl;
+    }
+    if (fsolver) fsolver->clear_factorization();
+  }
+
+
   /* ***************************************************************** */
   /*  Intermediary structure for Newton algorithms with getfem::model. */
   /* ***************************************************************** */
@@ -870,6 +1093,22 @@ namespace getfem {
                       cmodel_plsolver_type lsolver,
                       abstract_newton_line_search &ls);
 
+  /** Same as above, but the tangent matrix (and its factorization when
+      a direct linear solver is used) is reused over several Newton
+      iterations, following the given reuse policy (modified Newton or
+      Broyden updates, see newton_jacobian_reuse_policy).
+      @ingroup bricks
+  */
+  void standard_solve(model &md, gmm::iteration &iter,
+                      rmodel_plsolver_type lsolver,
+                      abstract_newton_line_search &ls,
+                      newton_jacobian_reuse_policy &reuse);
+
+  void standard_solve(model &md, gmm::iteration &iter,
+                      cmodel_plsolver_type lsolver,
+                      abstract_newton_line_search &ls,
+                      newton_jacobian_reuse_policy &reuse);
+
   void standard_solve(model &md, gmm::iteration &iter,
                       rmodel_plsolver_type lsolver);
 
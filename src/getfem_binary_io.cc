@@ -0,0 +1,233 @@
+/*===========================================================================
+
+ Copyright (C) 2020 the GetFEM++ project
+
+ This file is a part of GetFEM++
+
+ GetFEM++  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+===========================================================================*/
+
+#include "getfem/getfem_binary_io.h"
+#include "getfem/getfem_models.h"
+#ifndef _WIN32
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+namespace getfem {
+
+  /* Layout of a binary file:
+     - header of 32 bytes: the magic string "GFBINARY", the version of the
+       format (32 bits), the value 0x01020304 (32 bits) to detect an
+       endianness mismatch, the number of sections and the offset of the
+       directory (64 bits each);
+     - the data of the sections, each one padded to a multiple of 8 bytes;
+     - the directory: for each section, the length of its name, the name
+       padded to 8 bytes, the offset and the size in bytes of the data.   */
+
+  static const char binary_magic[8] = {'G','F','B','I','N','A','R','Y'};
+  static const unsigned binary_version = 1;
+  static const gmm::uint32_type binary_endian_check = 0x01020304;
+  static const size_type binary_header_size = 32;
+
+  void binary_ofile::write_padded(const void *d, size_type nbytes) {
+    static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    if (nbytes) f.write(reinterpret_cast<const char *>(d), nbytes);
+    size_type pad = (8 - nbytes % 8) % 8;
+    if (pad) f.write(zeros, pad);
+    pos += nbytes + pad;
+  }
+
+  void binary_ofile::add_section(const std::string &name, const void *d,
+                                 size_type nbytes) {
+    GMM_ASSERT1(f.is_open(), "Binary file " << fname << " is closed");
+    for (const section_info &s : sections)
+      GMM_ASSERT1(s.name != name, "Section " << name << " already exists");
+    section_info s;
+    s.name = name; s.offset = pos; s.size = nbytes;
+    sections.push_back(s);
+    write_padded(d, nbytes);
+    GMM_ASSERT1(f.good(), "Error while writing file " << fname);
+  }
+
+  void binary_ofile::add_string_section(const std::string &name,
+                                        const std::vector<std::string> &strs) {
+    std::vector<char> v;
+    for (const std::string &s : strs) {
+      v.insert(v.end(), s.begin(), s.end());
+      v.push_back('\0');
+    }
+    add_section(name, v);
+  }
+
+  void binary_ofile::close() {
+    if (!f.is_open()) return;
+    binary_index_type dir_offset = pos;
+    for (const section_info &s : sections) {
+      binary_index_type l = s.name.size();
+      write_padded(&l, sizeof(l));
+      write_padded(s.name.data(), s.name.size());
+      write_padded(&(s.offset), sizeof(s.offset));
+      write_padded(&(s.size), sizeof(s.size));
+    }
+    binary_index_type nbs = sections.size();
+    f.seekp(std::streamoff(sizeof(binary_magic) + 2*sizeof(gmm::uint32_type)));
+    f.write(reinterpret_cast<const char *>(&nbs), sizeof(nbs));
+    f.write(reinterpret_cast<const char *>(&dir_offset), sizeof(dir_offset));
+    GMM_ASSERT1(f.good(), "Error while writing file " << fname);
+    f.close();
+  }
+
+  binary_ofile::binary_ofile(const std::string &name)
+    : f(name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc),
+      fname(name), pos(0) {
+    GMM_ASSERT1(f, "impossible to write to file '" << name << "'");
+    gmm::uint32_type h[2] = { binary_version, binary_endian_check };
+    binary_index_type z[2] = { 0, 0 };
+    f.write(binary_magic, sizeof(binary_magic));
+    f.write(reinterpret_cast<const char *>(h), sizeof(h));
+    f.write(reinterpret_cast<const char *>(z), sizeof(z));
+    pos = binary_header_size;
+  }
+
+  binary_ofile::~binary_ofile() {
+    try { close(); } catch (...) {}
+  }
+
+
+  const char *binary_ifile::raw_section(const std::string &name,
+                                        size_type &nbytes) const {
+    auto it = sections.find(name);
+    GMM_ASSERT1(it != sections.end(), "Section " << name
+                << " not found in binary file " << fname);
+    nbytes = it->second.second;
+    return data + it->second.first;
+  }
+
+  std::vector<std::string>
+  binary_ifile::string_section(const std::string &name) const {
+    size_type n;
+    const char *p = section<char>(name, n);
+    std::vector<std::string> strs;
+    for (size_type i = 0, b = 0; i < n; ++i)
+      if (p[i] == '\0') { strs.push_back(std::string(p+b, i-b)); b = i+1; }
+    return strs;
+  }
+
+  binary_ifile::binary_ifile(const std::string &name)
+    : fname(name), data(0), length(0), mapped(false), version_(0) {
+#ifndef _WIN32
+    int fd = open(name.c_str(), O_RDONLY);
+    GMM_ASSERT1(fd >= 0, "Binary file '" << name << "' does not exist");
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      length = size_type(st.st_size);
+      void *p = mmap(0, length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) { data = static_cast<const char *>(p); mapped=true; }
+    }
+    ::close(fd);
+#endif
+    if (!mapped) {
+      std::ifstream ist(name.c_str(), std::ios::in | std::ios::binary);
+      GMM_ASSERT1(ist, "Binary file '" << name << "' does not exist");
+      ist.seekg(0, std::ios::end);
+      length = size_type(ist.tellg());
+      ist.seekg(0, std::ios::beg);
+      // the buffer is made of 64 bits integers for the alignment
+      buffer.resize((length + 7) / 8);
+      ist.read(reinterpret_cast<char *>(buffer.data()),
+               std::streamsize(length));
+      GMM_ASSERT1(ist, "Error while reading file " << name);
+      data = reinterpret_cast<const char *>(buffer.data());
+    }
+
+    GMM_ASSERT1(length >= binary_header_size &&
+                std::equal(binary_magic, binary_magic+8, data),
+                "File " << name << " is not a GetFEM binary file");
+    const gmm::uint32_type *h
+      = reinterpret_cast<const gmm::uint32_type *>(data + 8);
+    GMM_ASSERT1(h[1] == binary_endian_check, "File " << name << " has been "
+                "written on a system with a different endianness");
+    version_ = unsigned(h[0]);
+    GMM_ASSERT1(version_ >= 1 && version_ <= binary_version, "File " << name
+                << " has an unsupported version number " << version_);
+    const binary_index_type *hd
+      = reinterpret_cast<const binary_index_type *>(data + 16);
+    size_type nbs = size_type(hd[0]), off = size_type(hd[1]);
+    for (size_type i = 0; i < nbs; ++i) {
+      GMM_ASSERT1(off + 8 <= length, "Corrupted binary file " << name);
+      size_type l = size_type(*reinterpret_cast<const binary_index_type *>
+                              (data + off));
+      off += 8;
+      GMM_ASSERT1(off + ((l + 7) / 8) * 8 + 16 <= length,
+                  "Corrupted binary file " << name);
+      std::string sname(data + off, l);
+      off += ((l + 7) / 8) * 8;
+      const binary_index_type *os
+        = reinterpret_cast<const binary_index_type *>(data + off);
+      GMM_ASSERT1(os[0] + os[1] <= length, "Corrupted binary file " << name);
+      sections[sname] = std::make_pair(size_type(os[0]), size_type(os[1]));
+      off += 16;
+    }
+  }
+
+  binary_ifile::~binary_ifile() {
+#ifndef _WIN32
+    if (mapped) munmap(const_cast<char *>(data), length);
+#endif
+  }
+
+
+  void write_model_variables_to_binary(binary_ofile &f, const model &md,
+                                       const std::vector<std::string> &vl,
+                                       const std::string &prefix) {
+    f.add_string_section(prefix + ".variable_names", vl);
+    for (const std::string &name : vl) {
+      if (md.is_complex())
+        f.add_section(prefix + ".variable." + name,
+                      md.complex_variable(name));
+      else
+        f.add_section(prefix + ".variable." + name, md.real_variable(name));
+    }
+  }
+
+  void read_model_variables_from_binary(const binary_ifile &f, model &md,
+                                        const std::string &prefix) {
+    std::vector<std::string> vl
+      = f.string_section(prefix + ".variable_names");
+    for (const std::string &name : vl) {
+      GMM_ASSERT1(md.variable_exists(name), "Variable " << name
+                  << " stored in file " << f.file_name()
+                  << " does not exist in the model");
+      size_type n;
+      if (md.is_complex()) {
+        const complex_type *p
+          = f.section<complex_type>(prefix + ".variable." + name, n);
+        model_complex_plain_vector &V = md.set_complex_variable(name);
+        GMM_ASSERT1(n == V.size(), "Wrong size for variable " << name);
+        std::copy(p, p+n, V.begin());
+      } else {
+        const scalar_type *p
+          = f.section<scalar_type>(prefix + ".variable." + name, n);
+        model_real_plain_vector &V = md.set_real_variable(name);
+        GMM_ASSERT1(n == V.size(), "Wrong size for variable " << name);
+        std::copy(p, p+n, V.begin());
+      }
+    }
+  }
+
+}  /* end of namespace getfem.                                             */
@@ -200,7 +200,7 @@ namespace getfem {
   void multi_contact_frame::clear_aux_info() {
     boundary_points = std::vector<base_node>();
     boundary_points_info = std::vector<boundary_point>();
-    element_boxes.clear();
+    element_boxes.clear_boxes_only();
     element_boxes_info = std::vector<influence_box>();
     potential_pairs = std::vector<std::vector<face_info> >();
   }
@@ -649,7 +649,7 @@ namespace getfem {
           element_boxes_info.push_back(influence_box(i, cv, v.f(), n_mean));
         }
       }
-    element_boxes.build_tree();
+    element_boxes.update_tree();
   }
 
   void multi_contact_frame::compute_potential_contact_pairs_influence_boxes() {
@@ -661,15 +661,14 @@ namespace getfem {
 
     for (size_type ip = 0; ip < boundary_points.size(); ++ip) {
 
-      bgeot::rtree::pbox_set bset;
+      std::vector<size_type> bset;
       element_boxes.find_boxes_at_point(boundary_points[ip], bset);
       boundary_point *pt_info = &(boundary_points_info[ip]);
       const mesh_fem &mf1 = mfdisp_of_boundary(pt_info->ind_boundary);
       size_type ib1 = pt_info->ind_boundary;
 
-      bgeot::rtree::pbox_set::iterator it = bset.begin();
-      for (; it != bset.end(); ++it) {
-        influence_box &ibx = element_boxes_info[(*it)->id];
+      for (size_type ibox : bset) {
+        influence_box &ibx = element_boxes_info[ibox];
         size_type ib2 = ibx.ind_boundary;
         const mesh_fem &mf2 = mfdisp_of_boundary(ib2);
 
@@ -1374,7 +1373,7 @@ namespace getfem {
 
     std::vector<obstacle> obstacles;
         
-    mutable bgeot::rtree face_boxes;
+    mutable bgeot::box_bvh face_boxes;
     mutable std::vector<face_box_info> face_boxes_info;
 
 
@@ -1382,7 +1381,7 @@ namespace getfem {
       fem_precomp_pool fppool;
       base_matrix G;
       model_real_plain_vector coeff;
-      face_boxes.clear();
+      face_boxes.clear_boxes_only();
       face_boxes_info.resize(0);
 
       for (size_type i = 0; i < contact_boundaries.size(); ++i) {
@@ -1459,7 +1458,7 @@ namespace getfem {
           }
         }
       }
-      face_boxes.build_tree();
+      face_boxes.update_tree();
     }
 
   public:
@@ -1567,7 +1566,7 @@ namespace getfem {
     };
 
     void finalize() const {
-      face_boxes.clear();
+      face_boxes.clear_boxes_only();
       face_boxes_info = std::vector<face_box_info>();
       for (const contact_boundary &cb : contact_boundaries)
         cb.U_unred = model_real_plain_vector();
@@ -1700,7 +1699,7 @@ namespace getfem {
       //
       // Determine the potential contact pairs with deformable bodies
       //
-      bgeot::rtree::pbox_set bset;
+      std::vector<size_type> bset;
       base_node bmin(pt_x), bmax(pt_x);
       for (size_type i = 0; i < N; ++i)
         { bmin[i] -= release_distance; bmax[i] += release_distance; }
@@ -1711,8 +1710,8 @@ namespace getfem {
       // Iteration on potential contact pairs and application
       // of selection criteria
       //
-      for (const auto &pbox : bset) {
-        face_box_info &fbox_y = face_boxes_info[pbox->id];
+      for (size_type ibox : bset) {
+        face_box_info &fbox_y = face_boxes_info[ibox];
         size_type ib_y = fbox_y.ind_boundary;
         const contact_boundary &cb_y = contact_boundaries[ib_y];
         const mesh_fem &mfu_y = *(cb_y.mfu);
@@ -2130,7 +2129,7 @@ namespace getfem {
       //
       // Determine the potential contact pairs with deformable bodies
       //
-      bgeot::rtree::pbox_set bset;
+      std::vector<size_type> bset;
       base_node bmin(pt_x), bmax(pt_x);
       for (size_type i = 0; i < N; ++i)
         { bmin[i] -= release_distance; bmax[i] += release_distance; }
@@ -2140,8 +2139,8 @@ namespace getfem {
       // Iteration on potential contact pairs and application
       // of selection criteria
       //
-      for (const auto &pbox : bset) {
-        face_box_info &fbox_y = face_boxes_info[pbox->id];
+      for (size_type ibox : bset) {
+        face_box_info &fbox_y = face_boxes_info[ibox];
         size_type ib_y = fbox_y.ind_boundary;
         const contact_boundary &cb_y =  contact_boundaries[ib_y];
         const mesh_fem &mfu_y = *(cb_y.mfu);
@@ -19,7 +19,7 @@
 
 ===========================================================================*/
 
-#include "getfem/bgeot_rtree.h"
+#include "getfem/bgeot_bvh.h"
 #include "getfem/getfem_contact_and_friction_integral.h"
 #include "getfem/getfem_contact_and_friction_common.h"
 #include "getfem/getfem_contact_and_friction_large_sliding.h"
@@ -1357,7 +1357,7 @@ namespace getfem {
     contact_frame &cf;   // contact frame description.
 
     // list des enrichissements pour ses points : y0, d0, element ...
-    bgeot::rtree element_boxes;  // influence regions of boundary elements
+    bgeot::box_bvh element_boxes; // influence regions of boundary elements
     // list des enrichissements of boundary elements
     std::vector<size_type> boundary_of_elements;
     std::vector<size_type> ind_of_elements;
@@ -1377,8 +1377,9 @@ namespace getfem {
   void contact_elements::init(void) {
     fem_precomp_pool fppool;
     // compute the influence regions of boundary elements. To be run
-    // before the assembly of contact terms.
-    element_boxes.clear();
+    // before the assembly of contact terms. The topology of the box tree
+    // is kept from an iteration to another, only the boxes are refitted.
+    element_boxes.clear_boxes_only();
     unit_normal_of_elements.resize(0);
     boundary_of_elements.resize(0);
     ind_of_elements.resize(0);
@@ -1479,7 +1480,7 @@ namespace getfem {
         face_of_elements.push_back(v.f());
       }
     }
-    element_boxes.build_tree();
+    element_boxes.update_tree();
   }
 
 
@@ -1536,7 +1537,7 @@ namespace getfem {
     // Selection of influence boxes
     // ----------------------------------------------------------
 
-    bgeot::rtree::pbox_set bset;
+    std::vector<size_type> bset;
     element_boxes.find_boxes_at_point(x, bset);
 
     if (noisy) cout << "Number of boxes found : " << bset.size() << endl;
@@ -1546,12 +1547,12 @@ namespace getfem {
     // criterion : should at least eliminate the original element.
     // ----------------------------------------------------------
 
-    bgeot::rtree::pbox_set::iterator it = bset.begin(), itnext;
-    for (; it != bset.end(); it = itnext) {
-      itnext = it; ++itnext;
-      if (gmm::vect_sp(unit_normal_of_elements[(*it)->id], n)
-          >= -scalar_type(1)/scalar_type(20)) bset.erase(it);
-    }
+    bset.erase(std::remove_if(bset.begin(), bset.end(),
+                              [&](size_type id) {
+                                return gmm::vect_sp(unit_normal_of_elements[id],
+                                                    n)
+                                  >= -scalar_type(1)/scalar_type(20);
+                              }), bset.end());
 
     if (noisy)
       cout << "Number of boxes satisfying the unit normal criterion : "
@@ -1564,7 +1565,7 @@ namespace getfem {
     // situations with a test on |x0-y0|
     // ----------------------------------------------------------
 
-    it = bset.begin();
+    auto it = bset.begin();
     std::vector<base_node> y0s;
     std::vector<base_small_vector> n0_y0s;
     std::vector<scalar_type> d0s;
@@ -1572,9 +1573,9 @@ namespace getfem {
     std::vector<size_type> elt_nums;
     std::vector<fem_interpolation_context> ctx_y0s;
     for (; it != bset.end(); ++it) {
-      size_type boundary_num_y0 = boundary_of_elements[(*it)->id];
-      size_type cv_y0 = ind_of_elements[(*it)->id];
-      short_type face_y0 = short_type(face_of_elements[(*it)->id]);
+      size_type boundary_num_y0 = boundary_of_elements[*it];
+      size_type cv_y0 = ind_of_elements[*it];
+      short_type face_y0 = short_type(face_of_elements[*it]);
       const mesh_fem &mfu_y0 = cf.mfu_of_boundary(boundary_num_y0);
       pfem pf_s_y0 = mfu_y0.fem_of_element(cv_y0);
       const model_real_plain_vector &U_y0
@@ -1678,7 +1679,7 @@ namespace getfem {
       if (noisy) cout << "gmm::vect_norm2(n0_y0) = " << gmm::vect_norm2(n0_y0) << endl;
       // Eliminates wrong auto-contact situations
       if (noisy) cout << "autocontact status : x0 = " << x0 << " y0 = " << y0 << "  " <<  gmm::vect_dist2(y0, x0) << " : " << d0*0.75 << " : " << d1*0.75 << endl;
-      if (noisy) cout << "n = " << n << " unit_normal_of_elements[(*it)->id] = " << unit_normal_of_elements[(*it)->id] << endl;
+      if (noisy) cout << "n = " << n << " unit_normal_of_elements[*it] = " << unit_normal_of_elements[*it] << endl;
 
       if (d0 < scalar_type(0)
           && ((&U_y0 == &U
@@ -1698,7 +1699,7 @@ namespace getfem {
 //       }
 
       y0s.push_back(ctx_y0.xreal()); // useful ?
-      elt_nums.push_back((*it)->id);
+      elt_nums.push_back(*it);
       d0s.push_back(d0);
       d1s.push_back(d1);
       ctx_y0s.push_back(ctx_y0);
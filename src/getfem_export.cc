@@ -20,9 +20,14 @@
 ===========================================================================*/
 
 #include <iomanip>
+#include <functional>
 #include "getfem/dal_singleton.h"
 #include "getfem/bgeot_comma_init.h"
 #include "getfem/getfem_export.h"
+#include "getfem/getfem_omp.h"
+#ifdef GETFEM_HAVE_ZLIB
+# include <zlib.h>
+#endif
 
 namespace getfem
 {
@@ -212,24 +217,32 @@ namespace getfem
     exporting(*pmf);
   }
 
-  void vtk_export::exporting(const mesh_fem& mf) {
-    dim_ = mf.linked_mesh().dim();
-    GMM_ASSERT1(dim_ <= 3, "attempt to export a " << int(dim_)
-              << "D slice (not supported)");
-    if (&mf != pmf.get())
-      pmf = std::make_unique<mesh_fem>(mf.linked_mesh());
-    /* initialize pmf with finite elements suitable for VTK (which only knows
-       isoparametric FEMs of order 1 and 2) */
+  /* initialize pmf with finite elements suitable for VTK (which only knows
+     isoparametric FEMs of order 1 and 2), find out the VTK type of each
+     element and the dofs which will be exported to VTK */
+  static void vtk_mesh_fem_mapping(const mesh_fem &mf, mesh_fem *pmf,
+                                   dal::bit_vector &pmf_dof_used,
+                                   std::vector<unsigned> &pmf_mapping_type) {
+    static const pfem incomplete_fems[6] = {
+      fem_descriptor("FEM_Q2_INCOMPLETE(2)"),
+      fem_descriptor("FEM_Q2_INCOMPLETE(3)"),
+      fem_descriptor("FEM_PYRAMID_Q2_INCOMPLETE"),
+      fem_descriptor("FEM_PYRAMID_Q2_INCOMPLETE_DISCONTINUOUS"),
+      fem_descriptor("FEM_PRISM_INCOMPLETE_P2"),
+      fem_descriptor("FEM_PRISM_INCOMPLETE_P2_DISCONTINUOUS") };
+    /* the choice is the same for consecutive elements having the same fem
+       and geometric transformation (except for fems defined on the real
+       element, whose dofs may depend on the element). */
+    pfem last_pf, last_pf_vtk;
+    bgeot::pgeometric_trans last_pgt;
     for (dal::bv_visitor cv(mf.convex_index()); !cv.finished(); ++cv) {
       bgeot::pgeometric_trans pgt = mf.linked_mesh().trans_of_convex(cv);
       pfem pf = mf.fem_of_element(cv);
 
-      if (pf == fem_descriptor("FEM_Q2_INCOMPLETE(2)") ||
-          pf == fem_descriptor("FEM_Q2_INCOMPLETE(3)") ||
-          pf == fem_descriptor("FEM_PYRAMID_Q2_INCOMPLETE") ||
-          pf == fem_descriptor("FEM_PYRAMID_Q2_INCOMPLETE_DISCONTINUOUS") ||
-          pf == fem_descriptor("FEM_PRISM_INCOMPLETE_P2") ||
-          pf == fem_descriptor("FEM_PRISM_INCOMPLETE_P2_DISCONTINUOUS"))
+      if (pf == last_pf && pgt == last_pgt && !pf->is_on_real_element())
+        pmf->set_finite_element(cv, last_pf_vtk);
+      else if (std::find(incomplete_fems, incomplete_fems+6, pf)
+               != incomplete_fems+6)
         pmf->set_finite_element(cv, pf);
       else {
         bool discontinuous = false;
@@ -250,6 +263,7 @@ namespace getfem
                                 classical_discontinuous_fem(pgt, degree, 0, true) :
                                 classical_fem(pgt, degree, true));
       }
+      last_pf = pf; last_pgt = pgt; last_pf_vtk = pmf->fem_of_element(cv);
     }
     /* find out which dof will be exported to VTK */
 
@@ -306,6 +320,15 @@ namespace getfem
     //      << pmf->nb_dof() << ", dof_used = " << pmf_dof_used.card() << "\n";
   }
 
+  void vtk_export::exporting(const mesh_fem& mf) {
+    dim_ = mf.linked_mesh().dim();
+    GMM_ASSERT1(dim_ <= 3, "attempt to export a " << int(dim_)
+              << "D slice (not supported)");
+    if (&mf != pmf.get())
+      pmf = std::make_unique<mesh_fem>(mf.linked_mesh());
+    vtk_mesh_fem_mapping(mf, pmf.get(), pmf_dof_used, pmf_mapping_type);
+  }
+
 
   const stored_mesh_slice& vtk_export::get_exported_slice() const {
     GMM_ASSERT1(psl, "no slice!");
@@ -450,6 +473,522 @@ namespace getfem
   }
 
 
+  /* -------------------------------------------------------------
+   * VTU export (XML format of VTK with appended binary data)
+   * ------------------------------------------------------------- */
+
+  /* Uncompressed size of the zlib blocks. The blocks are compressed
+     independently, in parallel when possible. */
+  static const size_type vtu_block_size = 65536;
+
+  static bool vtu_little_endian() {
+    static int test_endian = 0x01234567;
+    return (*((char*)&test_endian) == 0x67);
+  }
+
+  /* Append a data array to buf in the format of the appended section of
+     a VTU file with header_type="UInt64": the number of bytes followed by
+     the raw data or, with compression, the number of blocks, the block
+     size, the size of the last partial block and the compressed size of
+     each block, followed by the compressed blocks. */
+  static void vtu_append_block(std::vector<char> &buf, const void *data,
+                               size_type nbytes, bool compressed) {
+    const char *p = static_cast<const char *>(data);
+    std::vector<gmm::uint64_type> h;
+#ifdef GETFEM_HAVE_ZLIB
+    if (compressed) {
+      size_type nb = (nbytes + vtu_block_size - 1) / vtu_block_size;
+      std::vector<std::vector<char> > blocks(nb);
+      std::vector<int> err(nb, Z_OK);
+      size_type nb_th = me_is_multithreaded_now()
+                      ? 1 : true_thread_policy::num_threads();
+      GETFEM_OMP_PARALLEL_NO_PARTITION(
+        size_type th = (nb_th == 1) ? 0 : true_thread_policy::this_thread();
+        for (size_type i = th; i < nb; i += nb_th) {
+          uLong l = uLong(std::min(vtu_block_size, nbytes - i*vtu_block_size));
+          uLongf cl = compressBound(l);
+          blocks[i].resize(cl);
+          err[i] = compress2(reinterpret_cast<Bytef *>(&(blocks[i][0])), &cl,
+                             reinterpret_cast<const Bytef *>(p
+                                                      + i*vtu_block_size),
+                             l, Z_BEST_SPEED);
+          blocks[i].resize(cl);
+        }
+      )
+      h.push_back(nb);
+      h.push_back(vtu_block_size);
+      h.push_back(nbytes % vtu_block_size);
+      for (size_type i = 0; i < nb; ++i) {
+        GMM_ASSERT1(err[i] == Z_OK, "zlib compression error " << err[i]);
+        h.push_back(blocks[i].size());
+      }
+      const char *ph = reinterpret_cast<const char *>(h.data());
+      buf.insert(buf.end(), ph, ph + h.size()*sizeof(gmm::uint64_type));
+      for (size_type i = 0; i < nb; ++i)
+        buf.insert(buf.end(), blocks[i].begin(), blocks[i].end());
+      return;
+    }
+#else
+    GMM_NOPERATION(compressed);
+#endif
+    h.push_back(nbytes);
+    const char *ph = reinterpret_cast<const char *>(h.data());
+    buf.insert(buf.end(), ph, ph + sizeof(gmm::uint64_type));
+    buf.insert(buf.end(), p, p + nbytes);
+  }
+
+  static bool vtu_is_parallel(const std::string &fname) {
+    return (fname.size() > 5
+            && fname.compare(fname.size()-5, 5, ".pvtu") == 0);
+  }
+
+  /* Apply f to each piece, the pieces being distributed on the threads. */
+  template <typename F>
+  static void vtu_for_each_piece(std::vector<F> &pieces,
+                                 std::function<void(F &)> f) {
+    size_type nb_th = me_is_multithreaded_now()
+                    ? 1 : true_thread_policy::num_threads();
+    GETFEM_OMP_PARALLEL_NO_PARTITION(
+      size_type th = (nb_th == 1) ? 0 : true_thread_policy::this_thread();
+      for (size_type i = th; i < pieces.size(); i += nb_th) f(pieces[i]);
+    )
+  }
+
+  vtu_export::vtu_export(const std::string& fname_, bool compressed_,
+                         size_type nb_pieces_)
+    : fname(fname_), compressed(compressed_), nb_pieces(nb_pieces_), psl(0),
+      dim_(dim_type(-1)), nb_points_(0), nb_cells_(0), nb_total_pieces(1),
+      closed(false), pwriter(0) {
+    if (!vtu_is_parallel(fname)) nb_pieces = 1;
+    else if (nb_pieces == 0) nb_pieces = true_thread_policy::num_threads();
+  }
+
+  vtu_export::~vtu_export() {
+    try { close(); } catch (...) {}
+  }
+
+  std::string vtu_export::piece_file_name(size_type num) const {
+    if (!vtu_is_parallel(fname)) return fname;
+    std::stringstream s;
+    s << fname.substr(0, fname.size()-5) << "_" << num << ".vtu";
+    return s.str();
+  }
+
+  void vtu_export::exporting(const stored_mesh_slice& sl) {
+    GMM_ASSERT1(!closed, "the vtu file is already written");
+    psl = &sl; dim_ = dim_type(sl.dim());
+    GMM_ASSERT1(psl->dim() <= 3, "attempt to export a " << int(dim_)
+              << "D slice (not supported)");
+    pmf.reset();
+    init_pieces();
+  }
+
+  void vtu_export::exporting(const mesh& m) {
+    dim_ = m.dim();
+    GMM_ASSERT1(dim_ <= 3, "attempt to export a " << int(dim_)
+              << "D mesh (not supported)");
+    pmf = std::make_unique<mesh_fem>(const_cast<mesh&>(m), dim_type(1));
+    for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+      bgeot::pgeometric_trans pgt = m.trans_of_convex(cv);
+      pfem pf = getfem::classical_fem(pgt, pgt->complexity() > 1 ? 2 : 1);
+      pmf->set_finite_element(cv, pf);
+    }
+    exporting(*pmf);
+  }
+
+  void vtu_export::exporting(const mesh_fem& mf) {
+    GMM_ASSERT1(!closed, "the vtu file is already written");
+    dim_ = mf.linked_mesh().dim();
+    GMM_ASSERT1(dim_ <= 3, "attempt to export a " << int(dim_)
+              << "D mesh_fem (not supported)");
+    if (&mf != pmf.get())
+      pmf = std::make_unique<mesh_fem>(mf.linked_mesh());
+    psl = 0;
+    vtk_mesh_fem_mapping(mf, pmf.get(), pmf_dof_used, pmf_mapping_type);
+    init_pieces();
+  }
+
+  /* Distribution of the exported convexes on the pieces and construction
+     of the points and cells of each piece. */
+  void vtu_export::init_pieces() {
+    point_arrays.resize(0); cell_arrays.resize(0);
+    std::vector<size_type> items;
+    std::vector<float> coords;
+    std::vector<size_type> first_point; // first point of each item.
+    std::vector<size_type> cell_rank;   // rank of the exported convexes.
+    if (psl) {
+      nb_points_ = psl->nb_points(); nb_cells_ = 0;
+      coords.resize(3*nb_points_, 0.0f);
+      first_point.resize(psl->nb_convex()+1, 0);
+      for (size_type ic=0, k=0; ic < psl->nb_convex(); ++ic) {
+        items.push_back(ic);
+        first_point[ic] = k;
+        for (size_type i=0; i < psl->nodes(ic).size(); ++i, ++k) {
+          const base_node &P = psl->nodes(ic)[i].pt;
+          for (size_type j=0; j < P.size(); ++j) coords[3*k+j] = float(P[j]);
+        }
+        first_point[ic+1] = k;
+      }
+    } else {
+      nb_points_ = pmf_dof_used.card();
+      nb_cells_ = pmf->convex_index().card();
+      coords.resize(3*nb_points_, 0.0f);
+      /* first_point contains the global number of the exported dofs,
+         point_of_basic_dof is not called by the threads. */
+      first_point.resize(pmf->nb_basic_dof(), size_type(-1));
+      size_type k = 0;
+      for (dal::bv_visitor d(pmf_dof_used); !d.finished(); ++d, ++k) {
+        first_point[d] = k;
+        base_node P = pmf->point_of_basic_dof(d);
+        for (size_type j=0; j < P.size(); ++j) coords[3*k+j] = float(P[j]);
+      }
+      cell_rank.resize(pmf->convex_index().last_true()+1);
+      for (dal::bv_visitor cv(pmf->convex_index()); !cv.finished(); ++cv) {
+        cell_rank[cv] = items.size();
+        items.push_back(cv);
+      }
+    }
+
+    pieces.resize(0);
+#if GETFEM_PARA_LEVEL > 1
+    int rank, nbp;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &nbp);
+    if (vtu_is_parallel(fname)) {
+      /* one piece per process, made of the convexes of its region. */
+      const mesh &m = psl ? psl->linked_mesh() : pmf->linked_mesh();
+      const dal::bit_vector &rgcv = m.get_mpi_region().index();
+      nb_total_pieces = nbp;
+      pieces.resize(1);
+      pieces[0].num = rank;
+      for (size_type i = 0; i < items.size(); ++i) {
+        size_type cv = psl ? psl->convex_num(items[i]) : items[i];
+        if (rgcv.is_in(cv)) pieces[0].items.push_back(items[i]);
+      }
+    } else {
+      nb_total_pieces = 1;
+      if (rank == 0) { pieces.resize(1); pieces[0].num = 0; }
+      if (pieces.size()) pieces[0].items.swap(items);
+    }
+#else
+    /* contiguous ranges of convexes. */
+    nb_total_pieces = nb_pieces;
+    pieces.resize(nb_pieces);
+    for (size_type i = 0; i < nb_pieces; ++i) {
+      pieces[i].num = i;
+      pieces[i].items.assign(items.begin() + (items.size() * i) / nb_pieces,
+                             items.begin() + (items.size()*(i+1)) / nb_pieces);
+    }
+#endif
+    vtu_for_each_piece<vtu_piece>(pieces, [&](vtu_piece &pc) {
+        build_piece_structure(pc, coords, first_point, cell_rank);
+      });
+  }
+
+  void vtu_export::build_piece_structure
+  (vtu_piece &pc, const std::vector<float> &coords,
+   const std::vector<size_type> &fp, const std::vector<size_type> &cell_rank) {
+    /* element type code for (linear) simplexes of dimensions 0,1,2,3 */
+    static const unsigned char vtk_simplex_code[4]
+      = { vtk_export::VTK_VERTEX, vtk_export::VTK_LINE,
+          vtk_export::VTK_TRIANGLE, vtk_export::VTK_TETRA };
+    std::vector<gmm::int32_type> connectivity, offsets;
+    std::vector<unsigned char> types;
+    pc.points.resize(0); pc.cells.resize(0);
+    pc.structure.resize(0); pc.point_data.resize(0); pc.cell_data.resize(0);
+    pc.appended.resize(0);
+
+    if (psl) {
+      /* points are not merged, as for vtk_export */
+      for (size_type ic : pc.items) {
+        size_type first = pc.points.size();
+        for (size_type k = fp[ic]; k < fp[ic+1]; ++k) pc.points.push_back(k);
+        const getfem::mesh_slicer::cs_simplexes_ct& s = psl->simplexes(ic);
+        for (size_type i=0; i < s.size(); ++i) {
+          for (size_type j=0; j < s[i].dim()+1; ++j)
+            connectivity.push_back(gmm::int32_type(s[i].inodes[j] + first));
+          offsets.push_back(gmm::int32_type(connectivity.size()));
+          types.push_back(vtk_simplex_code[s[i].dim()]);
+        }
+      }
+    } else {
+      std::vector<size_type> local(nb_points_, size_type(-1));
+      for (size_type cv : pc.items) {
+        pc.cells.push_back(cell_rank[cv]);
+        const std::vector<unsigned> &dmap
+          = select_vtk_dof_mapping(pmf_mapping_type[cv]);
+        for (size_type i=0; i < dmap.size(); ++i) {
+          size_type g = fp[pmf->ind_basic_dof_of_element(cv)[dmap[i]]];
+          if (local[g] == size_type(-1)) {
+            local[g] = pc.points.size(); pc.points.push_back(g);
+          }
+          connectivity.push_back(gmm::int32_type(local[g]));
+        }
+        offsets.push_back(gmm::int32_type(connectivity.size()));
+        types.push_back((unsigned char)(select_vtk_type(pmf_mapping_type[cv])));
+      }
+    }
+    pc.nb_cells = types.size();
+
+    std::vector<float> pts(3*pc.points.size());
+    for (size_type i=0; i < pc.points.size(); ++i)
+      for (size_type j=0; j < 3; ++j) pts[3*i+j] = coords[3*pc.points[i]+j];
+    pc.structure += "      <Points>\n";
+    add_array(pc, pc.structure, "Float32", "Points", 3, pts.data(),
+              pts.size()*sizeof(float));
+    pc.structure += "      </Points>\n      <Cells>\n";
+    add_array(pc, pc.structure, "Int32", "connectivity", 1,
+              connectivity.data(), connectivity.size()*sizeof(gmm::int32_type));
+    add_array(pc, pc.structure, "Int32", "offsets", 1,
+              offsets.data(), offsets.size()*sizeof(gmm::int32_type));
+    add_array(pc, pc.structure, "UInt8", "types", 1, types.data(),
+              types.size());
+    pc.structure += "      </Cells>\n";
+  }
+
+  void vtu_export::add_array(vtu_piece &pc, std::string &xml,
+                             const char *type, const std::string &name,
+                             size_type nb_comp, const void *data,
+                             size_type nbytes) {
+    std::stringstream s;
+    s << "        <DataArray type=\"" << type << "\" Name=\""
+      << remove_spaces(name) << "\"";
+    if (nb_comp > 1) s << " NumberOfComponents=\"" << nb_comp << "\"";
+    s << " format=\"appended\" offset=\"" << pc.appended.size() << "\"/>\n";
+    xml += s.str();
+    vtu_append_block(pc.appended, data, nbytes, compressed);
+  }
+
+  void vtu_export::write_float_array(const std::vector<float> &V,
+                                     const std::string &name,
+                                     size_type nb_comp, bool cell_data) {
+    vtu_array_info info; info.name = name; info.nb_comp = nb_comp;
+    (cell_data ? cell_arrays : point_arrays).push_back(info);
+    vtu_for_each_piece<vtu_piece>(pieces, [&](vtu_piece &pc) {
+        const std::vector<size_type> &ind = cell_data ? pc.cells : pc.points;
+        std::vector<float> W(ind.size() * nb_comp);
+        for (size_type i=0; i < ind.size(); ++i)
+          for (size_type k=0; k < nb_comp; ++k)
+            W[i*nb_comp+k] = V[ind[i]*nb_comp+k];
+        add_array(pc, cell_data ? pc.cell_data : pc.point_data, "Float32",
+                  name, nb_comp, W.data(), W.size()*sizeof(float));
+      });
+  }
+
+  void vtu_export::write_piece(std::ostream &o, const vtu_piece &pc) const {
+    o << "<?xml version=\"1.0\"?>\n"
+      << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\""
+      << (vtu_little_endian() ? "LittleEndian" : "BigEndian")
+      << "\" header_type=\"UInt64\"";
+#ifdef GETFEM_HAVE_ZLIB
+    if (compressed) o << " compressor=\"vtkZLibDataCompressor\"";
+#endif
+    o << ">\n  <UnstructuredGrid>\n"
+      << "    <Piece NumberOfPoints=\"" << pc.points.size()
+      << "\" NumberOfCells=\"" << pc.nb_cells << "\">\n"
+      << "      <PointData>\n" << pc.point_data << "      </PointData>\n"
+      << "      <CellData>\n" << pc.cell_data << "      </CellData>\n"
+      << pc.structure
+      << "    </Piece>\n  </UnstructuredGrid>\n"
+      << "  <AppendedData encoding=\"raw\">\n   _";
+    o.write(pc.appended.data(), std::streamsize(pc.appended.size()));
+    o << "\n  </AppendedData>\n</VTKFile>\n";
+  }
+
+  void vtu_export::write_pvtu(std::ostream &o) const {
+    o << "<?xml version=\"1.0\"?>\n"
+      << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" byte_order=\""
+      << (vtu_little_endian() ? "LittleEndian" : "BigEndian")
+      << "\" header_type=\"UInt64\">\n"
+      << "  <PUnstructuredGrid GhostLevel=\"0\">\n    <PPointData>\n";
+    for (const vtu_array_info &a : point_arrays)
+      o << "      <PDataArray type=\"Float32\" Name=\"" << remove_spaces(a.name)
+        << "\" NumberOfComponents=\"" << a.nb_comp << "\"/>\n";
+    o << "    </PPointData>\n    <PCellData>\n";
+    for (const vtu_array_info &a : cell_arrays)
+      o << "      <PDataArray type=\"Float32\" Name=\"" << remove_spaces(a.name)
+        << "\" NumberOfComponents=\"" << a.nb_comp << "\"/>\n";
+    o << "    </PCellData>\n    <PPoints>\n"
+      << "      <PDataArray type=\"Float32\" NumberOfComponents=\"3\"/>\n"
+      << "    </PPoints>\n";
+    for (size_type i = 0; i < nb_total_pieces; ++i) {
+      std::string name = piece_file_name(i);
+      size_type sep = name.find_last_of("/\\");
+      if (sep != std::string::npos) name = name.substr(sep+1);
+      o << "    <Piece Source=\"" << name << "\"/>\n";
+    }
+    o << "  </PUnstructuredGrid>\n</VTKFile>\n";
+  }
+
+  /* Write a file with the function f, or prepare its content and give it
+     to the background writer. */
+  template <typename F>
+  static void vtu_write_file(const std::string &name, async_file_writer *pw,
+                             F f) {
+    if (pw) {
+      std::stringstream s;
+      f(s);
+      pw->write(name, s);
+    } else {
+      std::ofstream o(name.c_str(), std::ios_base::binary|std::ios_base::out);
+      GMM_ASSERT1(o, "impossible to write to vtk file '" << name << "'");
+      f(o);
+      GMM_ASSERT1(o.good(), "error while writing vtk file '" << name << "'");
+    }
+  }
+
+  void vtu_export::close() {
+    if (closed) return;
+    closed = true;
+    GMM_ASSERT1(psl || pmf.get(), "nothing to export in " << fname);
+    vtu_for_each_piece<vtu_piece>(pieces, [&](vtu_piece &pc) {
+        vtu_write_file(piece_file_name(pc.num), pwriter,
+                       [&](std::ostream &o) { write_piece(o, pc); });
+      });
+    if (vtu_is_parallel(fname)) {
+#if GETFEM_PARA_LEVEL > 1
+      if (MPI_IS_MASTER())
+#endif
+        vtu_write_file(fname, pwriter,
+                       [&](std::ostream &o) { write_pvtu(o); });
+    }
+    pieces.clear();
+  }
+
+  const stored_mesh_slice& vtu_export::get_exported_slice() const {
+    GMM_ASSERT1(psl, "no slice!");
+    return *psl;
+  }
+
+  const mesh_fem& vtu_export::get_exported_mesh_fem() const {
+    GMM_ASSERT1(pmf.get(), "no mesh_fem!");
+    return *pmf;
+  }
+
+
+  pvd_export::pvd_export(const std::string& fname_) : fname(fname_)
+  { write(); }
+
+  void pvd_export::add_time_step(scalar_type t, const std::string &file) {
+    std::string name = file;
+    size_type sep = fname.find_last_of("/\\");
+    if (sep != std::string::npos
+        && name.compare(0, sep+1, fname, 0, sep+1) == 0)
+      name = name.substr(sep+1);
+    steps.push_back(std::make_pair(t, name));
+    write();
+  }
+
+  void pvd_export::write() const {
+#if GETFEM_PARA_LEVEL > 1
+    if (!MPI_IS_MASTER()) return;
+#endif
+    std::ofstream o(fname.c_str());
+    GMM_ASSERT1(o, "impossible to write to pvd file '" << fname << "'");
+    gmm::stream_standard_locale sl(o);
+    o << std::setprecision(16);
+    o << "<?xml version=\"1.0\"?>\n"
+      << "<VTKFile type=\"Collection\" version=\"0.1\">\n  <Collection>\n";
+    for (const auto &s : steps)
+      o << "    <DataSet timestep=\"" << s.first
+        << "\" group=\"\" part=\"0\" file=\"" << s.second << "\"/>\n";
+    o << "  </Collection>\n</VTKFile>\n";
+    GMM_ASSERT1(o.good(), "error while writing pvd file '" << fname << "'");
+  }
+
+  /* -------------------------------------------------------------
+   * Background writing of the files
+   * ------------------------------------------------------------- */
+
+  async_file_writer::async_file_writer(size_type max_pending_)
+    : max_pending(std::max(max_pending_, size_type(1))), busy(false),
+      stopping(false) {
+    writer = std::thread([this]() { run(); });
+  }
+
+  async_file_writer::~async_file_writer() {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stopping = true;
+    }
+    cv_queued.notify_all();
+    writer.join();
+  }
+
+  void async_file_writer::run() {
+    for (;;) {
+      pending_file f;
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv_queued.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (queue.empty()) return; // stopping, all the files are written
+        f = std::move(queue.front());
+        queue.pop_front();
+        busy = true;
+      }
+      cv_written.notify_all(); // a place is available in the queue
+      std::exception_ptr err;
+      try {
+        std::ofstream o(f.fname.c_str(),
+                        std::ios_base::binary | std::ios_base::out);
+        GMM_ASSERT1(o, "impossible to write to file '" << f.fname << "'");
+        o.write(f.content.data(), std::streamsize(f.content.size()));
+        o.close();
+        GMM_ASSERT1(!o.fail(), "error while writing file '" << f.fname
+                    << "'");
+      } catch (...) { err = std::current_exception(); }
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        busy = false;
+        if (err && !error) error = err;
+      }
+      cv_written.notify_all();
+    }
+  }
+
+  void async_file_writer::check_error() {
+    std::exception_ptr err;
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      std::swap(err, error);
+    }
+    if (err) std::rethrow_exception(err);
+  }
+
+  void async_file_writer::write(const std::string &fname,
+                                std::string &&content) {
+    check_error();
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      cv_written.wait(lock, [this]() { return queue.size() < max_pending; });
+      pending_file f;
+      f.fname = fname; f.content = std::move(content);
+      queue.push_back(std::move(f));
+    }
+    cv_queued.notify_one();
+  }
+
+  void async_file_writer::write(const std::string &fname,
+                                std::stringstream &s) {
+    std::string content = s.str();
+    s.str(std::string());
+    write(fname, std::move(content));
+  }
+
+  void async_file_writer::flush() {
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      cv_written.wait(lock, [this]() { return queue.empty() && !busy; });
+    }
+    check_error();
+  }
+
+  size_type async_file_writer::nb_pending() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return queue.size() + (busy ? 1 : 0);
+  }
+
+
   /* -------------------------------------------------------------
    * OPENDX export
    * ------------------------------------------------------------- */
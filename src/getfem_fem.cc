@@ -89,20 +89,32 @@ namespace getfem {
     bgeot::mat_tmult(&(*(g.begin())), &(*(B.begin())), &(*(t.begin())),M,N,P);
   }
 
+  // Same operation on the values of the point i of a precomputed table.
+  static inline void spec_mat_tmult_(const bgeot::precomp_table &g,
+                                     size_type i, const base_matrix &B,
+                                     base_tensor &t) {
+    size_type P = B.nrows(), N = B.ncols(), M = g.stride() / N;
+    const bgeot::multi_index &s = g.sizes(), &st = t.sizes();
+    if (t.size() != M*P || st.size() != s.size() || st.back() != P
+        || !std::equal(s.begin(), s.end()-1, st.begin()))
+      { bgeot::multi_index mi = s; mi.back() = P; t.adjust_sizes(mi); }
+    bgeot::mat_tmult(g.data(i), &(*(B.begin())), &(*(t.begin())), M, N, P);
+  }
+
   void fem_interpolation_context::pfp_base_value(base_tensor& t,
                                                  const pfem_precomp &pfp__) {
     const pfem &pf__ = pfp__->get_pfem();
     GMM_ASSERT1(ii_ != size_type(-1), "Internal error");
 
     if (pf__->is_standard())
-      t = pfp__->val(ii());
+      pfp__->val_table().copy_to(ii(), t);
     else {
       if (pf__->is_on_real_element())
         pf__->real_base_value(*this, t);
       else {
         switch(pf__->vectorial_type()) {
         case virtual_fem::VECTORIAL_NOTRANSFORM_TYPE:
-          t = pfp__->val(ii()); break;
+          pfp__->val_table().copy_to(ii(), t); break;
         case virtual_fem::VECTORIAL_PRIMAL_TYPE:
           t.mat_transp_reduction(pfp__->val(ii()), K(), 1); break;
         case virtual_fem::VECTORIAL_DUAL_TYPE:
@@ -120,7 +132,7 @@ namespace getfem {
   void fem_interpolation_context::base_value(base_tensor& t,
                                              bool withM) const {
     if (pfp_ && ii_ != size_type(-1) && pf_->is_standard())
-      t = pfp_->val(ii());
+      pfp_->val_table().copy_to(ii(), t);
     else {
       if (pf_->is_on_real_element())
         pf_->real_base_value(*this, t);
@@ -128,7 +140,7 @@ namespace getfem {
         if (pfp_ && ii_ != size_type(-1)) {
           switch(pf_->vectorial_type()) {
           case virtual_fem::VECTORIAL_NOTRANSFORM_TYPE:
-            t = pfp_->val(ii()); break;
+            pfp_->val_table().copy_to(ii(), t); break;
           case virtual_fem::VECTORIAL_PRIMAL_TYPE:
             t.mat_transp_reduction(pfp_->val(ii()), K(), 1); break;
           case virtual_fem::VECTORIAL_DUAL_TYPE:
@@ -164,7 +176,7 @@ namespace getfem {
 
     if (pf__->is_standard()) {
       // t.mat_transp_reduction(pfp__->grad(ii()), B(), 2);
-      spec_mat_tmult_(pfp__->grad(ii()), B(), t);
+      spec_mat_tmult_(pfp__->grad_table(), ii(), B(), t);
     } else {
       if (pf__->is_on_real_element())
         pf__->real_grad_base_value(*this, t);
@@ -174,7 +186,7 @@ namespace getfem {
           {
             base_tensor u;
             // u.mat_transp_reduction(pfp__->grad(ii()), B(), 2);
-            spec_mat_tmult_(pfp__->grad(ii()), B(), u);
+            spec_mat_tmult_(pfp__->grad_table(), ii(), B(), u);
             t.mat_transp_reduction(u, K(), 1);
           }
           break;
@@ -182,13 +194,13 @@ namespace getfem {
           {
             base_tensor u;
             // u.mat_transp_reduction(pfp__->grad(ii()), B(), 2);
-            spec_mat_tmult_(pfp__->grad(ii()), B(), u);
+            spec_mat_tmult_(pfp__->grad_table(), ii(), B(), u);
             t.mat_transp_reduction(u, B(), 1);
           }
           break;
         default:
           // t.mat_transp_reduction(pfp__->grad(ii()), B(), 2);
-          spec_mat_tmult_(pfp__->grad(ii()), B(), t);
+          spec_mat_tmult_(pfp__->grad_table(), ii(), B(), t);
         }
         if (!(pf__->is_equivalent())) {
           set_pfp(pfp__);
@@ -203,7 +215,7 @@ namespace getfem {
                                                   bool withM) const {
     if (pfp_ && ii_ != size_type(-1) && pf_->is_standard()) {
       // t.mat_transp_reduction(pfp_->grad(ii()), B(), 2);
-      spec_mat_tmult_(pfp_->grad(ii()), B(), t);
+      spec_mat_tmult_(pfp_->grad_table(), ii(), B(), t);
     } else {
       if (pf()->is_on_real_element())
         pf()->real_grad_base_value(*this, t);
@@ -214,7 +226,7 @@ namespace getfem {
             {
               base_tensor u;
               // u.mat_transp_reduction(pfp_->grad(ii()), B(), 2);
-              spec_mat_tmult_(pfp_->grad(ii()), B(), u);
+              spec_mat_tmult_(pfp_->grad_table(), ii(), B(), u);
               t.mat_transp_reduction(u, K(), 1);
             }
             break;
@@ -222,13 +234,13 @@ namespace getfem {
             {
               base_tensor u;
               // u.mat_transp_reduction(pfp_->grad(ii()), B(), 2);
-              spec_mat_tmult_(pfp_->grad(ii()), B(), u);
+              spec_mat_tmult_(pfp_->grad_table(), ii(), B(), u);
               t.mat_transp_reduction(u, B(), 1);
             }
             break;
           default:
             // t.mat_transp_reduction(pfp_->grad(ii()), B(), 2);
-            spec_mat_tmult_(pfp_->grad(ii()), B(), t);
+            spec_mat_tmult_(pfp_->grad_table(), ii(), B(), t);
           }
 
         } else {
@@ -852,8 +864,6 @@ namespace getfem {
 
   thierach_femi::thierach_femi(ppolyfem fi1, ppolyfem fi2)
     : fem<base_poly>(*fi1) {
-    grad_computed_ = false;
-    hess_computed_ = false;
     GMM_ASSERT1(fi2->target_dim()==fi1->target_dim(), "dimensions mismatch.");
     GMM_ASSERT1(fi2->basic_structure(0) == fi1->basic_structure(0),
                 "Incompatible elements.");
@@ -4313,27 +4323,47 @@ namespace getfem {
   }
 
   void fem_precomp_::init_val() const {
+    auto guard = locks_.get_lock();
+    if (c_ok) return;
     c.resize(pspt->size());
-    for (size_type i = 0; i < pspt->size(); ++i)
-      pf->base_value((*pspt)[i], c[i]);
+    if (pf->base_value_at_points(*pspt, c_tab)) {
+      for (size_type i = 0; i < pspt->size(); ++i) c_tab.copy_to(i, c[i]);
+    } else {
+      for (size_type i = 0; i < pspt->size(); ++i)
+        pf->base_value((*pspt)[i], c[i]);
+      if (pspt->size() && c[0].size()) c_tab.init(c, c[0].sizes());
+    }
+    c_ok = true;
   }
 
   void fem_precomp_::init_grad() const {
+    auto guard = locks_.get_lock();
+    if (pc_ok) return;
     pc.resize(pspt->size());
-    for (size_type i = 0; i < pspt->size(); ++i)
-      pf->grad_base_value((*pspt)[i], pc[i]);
+    if (pf->grad_base_value_at_points(*pspt, pc_tab)) {
+      for (size_type i = 0; i < pspt->size(); ++i) pc_tab.copy_to(i, pc[i]);
+    } else {
+      for (size_type i = 0; i < pspt->size(); ++i)
+        pf->grad_base_value((*pspt)[i], pc[i]);
+      if (pspt->size() && pc[0].size()) pc_tab.init(pc, pc[0].sizes());
+    }
+    pc_ok = true;
   }
 
   void fem_precomp_::init_hess() const {
+    auto guard = locks_.get_lock();
+    if (hpc_ok) return;
     hpc.resize(pspt->size());
     for (size_type i = 0; i < pspt->size(); ++i)
       pf->hess_base_value((*pspt)[i], hpc[i]);
+    if (pspt->size() && hpc[0].size()) hpc_tab.init(hpc, hpc[0].sizes());
+    hpc_ok = true;
   }
 
   pfem_precomp fem_precomp(pfem pf, bgeot::pstored_point_tab pspt,
                            dal::pstatic_stored_object dep) {
     dal::pstatic_stored_object_key pk = std::make_shared<pre_fem_key_>(pf,pspt);
-    dal::pstatic_stored_object o = dal::search_stored_object(pk);
+    dal::pstatic_stored_object o = dal::search_stored_object_on_all_threads(pk);
     if (o) return std::dynamic_pointer_cast<const fem_precomp_>(o);
     pfem_precomp p = std::make_shared<fem_precomp_>(pf, pspt);
     dal::add_stored_object(pk, p, pspt, dal::AUTODELETE_STATIC_OBJECT);
@@ -6825,10 +6825,245 @@ namespace getfem {
     }
   }
 
+  //=========================================================================
+  // Estimation of the polynomial degree of the integrands, used to detect
+  // over-integrated terms.
+  //=========================================================================
+
+  // Maximal degree of the fems of mf on the convexes of the region,
+  // -1 if one of them is not polynomial.
+  static int ga_mf_degree_on_region(const mesh_fem &mf, const mesh &m,
+                                    const mesh_region &rg) {
+    int degree = 0;
+    for (mr_visitor v(rg, m); !v.finished(); ++v) {
+      if (!(mf.convex_index().is_in(v.cv()))) continue;
+      pfem pf = mf.fem_of_element(v.cv());
+      if (!pf || !(pf->is_polynomial())) return -1;
+      degree = std::max(degree, int(pf->estimated_degree()));
+    }
+    return degree;
+  }
+
+  // Estimated degree, on the reference element, of the polynomial
+  // represented by a node of a compiled tree, assuming that all the
+  // geometric transformations are linear (constant jacobian). Returns -1
+  // if the degree cannot be estimated (non polynomial expression,
+  // interpolation on another element, data at integration points ...).
+  static int ga_node_polynomial_degree
+  (const pga_tree_node pnode, const ga_workspace &workspace, const mesh &m,
+   const mesh_region &rg, std::map<const mesh_fem *, int> &mf_degrees) {
+
+    size_type nbch = pnode->children.size();
+    std::vector<int> d(nbch);
+    for (size_type i = 0; i < nbch; ++i) {
+      d[i] = ga_node_polynomial_degree(pnode->children[i], workspace, m,
+                                       rg, mf_degrees);
+      if (d[i] < 0 && pnode->node_type != GA_NODE_PARAMS) return -1;
+    }
+
+    switch (pnode->node_type) {
+    case GA_NODE_CONSTANT: case GA_NODE_ZERO: case GA_NODE_ALLINDICES:
+    case GA_NODE_ELT_SIZE: case GA_NODE_ELT_K: case GA_NODE_ELT_B:
+    case GA_NODE_NORMAL: case GA_NODE_SPEC_FUNC:
+    case GA_NODE_RESHAPE: case GA_NODE_SWAP_IND: case GA_NODE_IND_MOVE_LAST:
+    case GA_NODE_CROSS_PRODUCT: case GA_NODE_CONTRACT:
+    case GA_NODE_PREDEF_FUNC: case GA_NODE_OPERATOR:
+      return 0;
+
+    case GA_NODE_X:
+      return 1;
+
+    case GA_NODE_VAL: case GA_NODE_GRAD:
+    case GA_NODE_HESS: case GA_NODE_DIVERG:
+    case GA_NODE_VAL_TEST: case GA_NODE_GRAD_TEST:
+    case GA_NODE_HESS_TEST: case GA_NODE_DIVERG_TEST:
+      {
+        const mesh_fem *mf = workspace.associated_mf(pnode->name);
+        if (!mf) return workspace.associated_im_data(pnode->name) ? -1 : 0;
+        if (&(mf->linked_mesh()) != &m) return -1;
+        auto it = mf_degrees.find(mf);
+        if (it == mf_degrees.end())
+          it = mf_degrees.emplace(mf, ga_mf_degree_on_region(*mf, m, rg))
+                         .first;
+        int der = 0;
+        switch (pnode->node_type) {
+        case GA_NODE_GRAD: case GA_NODE_DIVERG:
+        case GA_NODE_GRAD_TEST: case GA_NODE_DIVERG_TEST: der = 1; break;
+        case GA_NODE_HESS: case GA_NODE_HESS_TEST: der = 2; break;
+        default: break;
+        }
+        return (it->second < 0) ? -1 : std::max(it->second - der, 0);
+      }
+
+    case GA_NODE_INTERPOLATE_FILTER:
+      return d[0];
+
+    case GA_NODE_OP:
+      switch(pnode->op_type) {
+      case GA_PLUS: case GA_MINUS:
+        return std::max(d[0], d[1]);
+      case GA_UNARY_MINUS: case GA_QUOTE: case GA_SYM: case GA_SKEW:
+      case GA_TRACE: case GA_DEVIATOR: case GA_PRINT:
+        return d[0];
+      case GA_DOT: case GA_MULT: case GA_COLON: case GA_TMULT:
+      case GA_DOTMULT:
+        return d[0] + d[1];
+      case GA_DIV: case GA_DOTDIV:
+        return (d[1] == 0) ? d[0] : -1;
+      default: return -1;
+      }
+
+    case GA_NODE_C_MATRIX:
+      return nbch ? *(std::max_element(d.begin(), d.end())) : 0;
+
+    case GA_NODE_PARAMS:
+      for (size_type i = 1; i < nbch; ++i) if (d[i] < 0) return -1;
+      switch (pnode->children[0]->node_type) {
+      case GA_NODE_RESHAPE: case GA_NODE_SWAP_IND: case GA_NODE_IND_MOVE_LAST:
+        return d[1];
+      case GA_NODE_CROSS_PRODUCT:
+        return d[1] + d[2];
+      case GA_NODE_CONTRACT:
+        if (nbch == 4) return d[1];
+        if (nbch == 5) return d[1] + d[3];
+        if (nbch == 7) return d[1] + d[4];
+        return -1;
+      case GA_NODE_PREDEF_FUNC: case GA_NODE_OPERATOR:
+        // Only the square is kept polynomial
+        if (pnode->children[0]->name == "sqr" && nbch == 2) return 2*d[1];
+        for (size_type i = 1; i < nbch; ++i) if (d[i] > 0) return -1;
+        return 0;
+      default:
+        return -1;
+      }
+
+    default:
+      return -1;
+    }
+  }
+
+  // Polynomial degree of the integrand of a compiled assembly tree on a
+  // region, -1 if it cannot be estimated.
+  static int ga_tree_polynomial_degree(const ga_tree &tree,
+                                       const ga_workspace &workspace,
+                                       const mesh &m, const mesh_region &rg) {
+    for (mr_visitor v(rg, m); !v.finished(); ++v)
+      if (v.f() != short_type(-1) ||
+          !(m.trans_of_convex(v.cv())->is_linear())) return -1;
+    std::map<const mesh_fem *, int> mf_degrees;
+    return tree.root ? ga_node_polynomial_degree(tree.root, workspace, m, rg,
+                                                 mf_degrees) : 0;
+  }
+
+  // Integration methods used on a region, with a geometric transformation
+  // of one of the corresponding elements.
+  static void ga_int_methods_on_region
+  (const mesh_im &mim, const mesh &m, const mesh_region &rg,
+   std::map<pintegration_method, bgeot::pgeometric_trans> &pims) {
+    for (mr_visitor v(rg, m); !v.finished(); ++v)
+      if (mim.convex_index().is_in(v.cv())) {
+        pintegration_method pim = mim.int_method_of_element(v.cv());
+        if (pim->type() == IM_APPROX &&
+            !(pim->approx_method()->is_built_on_the_fly()))
+          pims.emplace(pim, m.trans_of_convex(v.cv()));
+      }
+  }
+
+  // Cheapest classical approximate integration method exact for a degree,
+  // if any.
+  static pintegration_method ga_cheapest_exact_im(bgeot::pgeometric_trans pgt,
+                                                  int degree) {
+    try {
+      pintegration_method pim = classical_approx_im(pgt, dim_type(degree));
+      if (pim->type() == IM_APPROX &&
+          approx_im_exactness_degree(pim->approx_method()) >= degree)
+        return pim;
+    } catch (const gmm::gmm_error &) {}
+    return pintegration_method();
+  }
+
+  static void ga_check_quadrature
+  (ga_workspace &workspace, const ga_workspace::tree_description &td,
+   int degree) {
+    std::map<pintegration_method, bgeot::pgeometric_trans> pims;
+    ga_int_methods_on_region(*(td.mim), *(td.m), *(td.rg), pims);
+    std::string expr = ga_tree_to_string(*(td.ptree));
+    for (const auto &p : pims) {
+      papprox_integration pai = p.first->approx_method();
+      ga_workspace::quadrature_info qi;
+      qi.expr = expr;
+      qi.method = name_of_int_method(p.first);
+      qi.nb_points = pai->nb_points_on_convex();
+      qi.method_degree = approx_im_exactness_degree(pai);
+      qi.estimated_degree = degree;
+      qi.nb_suggested_points = 0;
+      if (degree >= 0) {
+        pintegration_method pim = ga_cheapest_exact_im(p.second, degree);
+        if (pim) {
+          qi.suggested_method = name_of_int_method(pim);
+          qi.nb_suggested_points = pim->approx_method()->nb_points_on_convex();
+        }
+        if (qi.nb_suggested_points && qi.nb_suggested_points < qi.nb_points)
+          GMM_WARNING2("Over-integrated term \"" << qi.expr << "\": "
+                       << qi.method << " (" << qi.nb_points << " points) is "
+                       << "used for an estimated degree " << degree << ", "
+                       << qi.suggested_method << " (" << qi.nb_suggested_points
+                       << " points) would be sufficient");
+      }
+      workspace.quadrature_report().push_back(qi);
+    }
+  }
+
+  // Whether the value of a node at the integration points only depends on
+  // the matrix B on the elements having a linear geometric transformation
+  // and tau-equivalent fems: constant coefficients, values and gradients
+  // of test functions only. The mesh_fems of the test functions are
+  // collected and the gradients counted.
+  static bool ga_node_is_element_independent
+  (const pga_tree_node pnode, const ga_workspace &workspace,
+   std::set<const mesh_fem *> &mfs, size_type &nb_grad) {
+    for (const pga_tree_node &child : pnode->children)
+      if (!ga_node_is_element_independent(child, workspace, mfs, nb_grad))
+        return false;
+
+    switch (pnode->node_type) {
+    case GA_NODE_CONSTANT: case GA_NODE_ZERO: case GA_NODE_ALLINDICES:
+    case GA_NODE_SPEC_FUNC: case GA_NODE_PREDEF_FUNC: case GA_NODE_OPERATOR:
+    case GA_NODE_RESHAPE: case GA_NODE_SWAP_IND: case GA_NODE_IND_MOVE_LAST:
+    case GA_NODE_CROSS_PRODUCT: case GA_NODE_CONTRACT:
+    case GA_NODE_OP: case GA_NODE_C_MATRIX: case GA_NODE_PARAMS:
+      return true;
+    case GA_NODE_VAL: // Fixed size variables only
+      return !(workspace.associated_mf(pnode->name)) &&
+             !(workspace.associated_im_data(pnode->name));
+    case GA_NODE_VAL_TEST:
+      {
+        const mesh_fem *mf = workspace.associated_mf(pnode->name);
+        if (mf) { mfs.insert(mf); return true; }
+        return !(workspace.associated_im_data(pnode->name));
+      }
+    case GA_NODE_GRAD_TEST: case GA_NODE_DIVERG_TEST:
+      {
+        const mesh_fem *mf = workspace.associated_mf(pnode->name);
+        if (mf) { mfs.insert(mf); ++nb_grad; }
+        return (mf != 0);
+      }
+    default:
+      return false;
+    }
+  }
+
   void ga_compile(ga_workspace &workspace,
                   ga_instruction_set &gis, size_type order) {
     gis.transformations.clear();
     gis.all_instructions.clear();
+    int quad_reduction = workspace.quadrature_reduction();
+    if (quad_reduction) workspace.quadrature_report().clear();
+    // Max. estimated degree of the terms of each region/mim (-1 if unknown)
+    std::map<ga_instruction_set::region_mim, int> rm_degrees;
+    // Whether all the terms of a region/mim can be integrated on the
+    // reference element
+    std::map<ga_instruction_set::region_mim, bool> rm_reference;
     std::array<ga_workspace::operation_type,3>
       phases{ga_workspace::PRE_ASSIGNMENT,
              ga_workspace::ASSEMBLY,
@@ -6868,6 +7103,32 @@ namespace getfem {
             // cout << "compilation finished "; ga_print_node(root, cout);
             // cout << endl;
 
+            std::set<const mesh_fem *> ref_mfs;
+            size_type nb_grad = 0;
+            bool reference = (phase == ga_workspace::ASSEMBLY && !psd &&
+                              ga_node_is_element_independent(root, workspace,
+                                                             ref_mfs,nb_grad));
+            for (const mesh_fem *mf : ref_mfs)
+              if (&(mf->linked_mesh()) != td.m) reference = false;
+            if (rm_reference.count(rm)) rm_reference[rm] &= reference;
+            else rm_reference[rm] = reference;
+            // Each test function brings at most one factor B
+            rmi.ref_degree = std::max(rmi.ref_degree,
+                                      std::min(nb_grad, order));
+
+            if (quad_reduction) {
+              int degree = -1;
+              if (phase == ga_workspace::ASSEMBLY && !psd) {
+                degree = ga_tree_polynomial_degree(trees.back(), workspace,
+                                                   *(td.m), *(td.rg));
+                ga_check_quadrature(workspace, td, degree);
+              }
+              auto itd = rm_degrees.find(rm);
+              if (itd == rm_degrees.end()) rm_degrees[rm] = degree;
+              else if (itd->second >= 0)
+                itd->second = (degree < 0) ? -1 : std::max(itd->second, degree);
+            }
+
             if (phase != ga_workspace::ASSEMBLY) { // Assignment/interpolation
               if (!td.varname_interpolation.empty()) {
                 auto *imd
@@ -7064,6 +7325,13 @@ namespace getfem {
                   break;
                 }
               }
+              if (pgai && rm_reference[rm]) {
+                rmi.ref_instructions.push_back(pgai);
+                rmi.ref_roots.push_back(&(root->tensor()));
+                for (const mesh_fem *mf : ref_mfs)
+                  if (std::find(rmi.ref_mfs.begin(), rmi.ref_mfs.end(), mf)
+                      == rmi.ref_mfs.end()) rmi.ref_mfs.push_back(mf);
+              } else rm_reference[rm] = false;
               if (pgai)
                 rmi.instructions.push_back(std::move(pgai));
             }
@@ -7071,6 +7339,32 @@ namespace getfem {
         }
       }
     }
+
+    for (const auto &rmr : rm_reference) {
+      auto &rmi = gis.all_instructions[rmr.first];
+      rmi.reference_integration = rmr.second;
+      if (!(rmr.second)) {
+        rmi.ref_instructions.clear(); rmi.ref_roots.clear();
+        rmi.ref_mfs.clear(); rmi.ref_degree = 0;
+      }
+    }
+
+    // Replacement of the integration methods by the cheapest classical
+    // ones being exact for all the terms of a region.
+    if (quad_reduction >= 2)
+      for (const auto &rmd : rm_degrees) {
+        if (rmd.second < 0) continue;
+        auto &rmi = gis.all_instructions[rmd.first];
+        std::map<pintegration_method, bgeot::pgeometric_trans> pims;
+        ga_int_methods_on_region(*(rmd.first.mim()), *(rmi.m),
+                                 *(rmd.first.region()), pims);
+        for (const auto &p : pims) {
+          pintegration_method pim = ga_cheapest_exact_im(p.second, rmd.second);
+          if (pim && pim->approx_method()->nb_points_on_convex()
+                     < p.first->approx_method()->nb_points_on_convex())
+            rmi.reduced_ims[p.first] = pim;
+        }
+      }
   } // ga_compile(...)
 
 
@@ -7178,6 +7472,140 @@ namespace getfem {
     gic.finalize();
   }
 
+  // Integrals on the reference element of the terms of a region/mim, for
+  // the current element. A term of degree d in the components of B is
+  // computed for B = 0, E_m (and -E_m, E_m+E_n if d = 2) with the assembly
+  // disabled, from which the coefficients of the monomials are deduced.
+  static std::vector<ga_instruction_set::region_mim_instructions
+                     ::reference_integral>
+  ga_reference_integrals(ga_instruction_set &gis,
+                         ga_instruction_set::region_mim_instructions &rmi,
+                         bool &first_gp, bgeot::pgeotrans_precomp pgp,
+                         const bgeot::stored_point_tab &spt,
+                         size_type first_ind) {
+    const auto &gilb = rmi.begin_instructions;
+    const auto &gile = rmi.elt_instructions;
+    const auto &gil = rmi.instructions;
+    papprox_integration pai = gis.pai;
+    size_type nr = rmi.ref_roots.size(), d = rmi.ref_degree;
+
+    if (pgp) gis.ctx.set_ii(first_ind);
+    else gis.ctx.set_xref(spt[first_ind]);
+    base_matrix K0, B0;
+    scalar_type J0(0);
+    if (d) { K0 = gis.ctx.K(); B0 = gis.ctx.B(); J0 = gis.ctx.J(); }
+    // Index of the constant monomial and number of sampled components
+    size_type NP = gis.ctx.N() * gis.ctx.pgt()->structure()->dim();
+    size_type NS = d ? NP : 0;
+
+    auto sample = [&](const base_matrix &Bs, std::vector<base_tensor> &T) {
+      T.resize(nr);
+      for (gis.ipt = 0; gis.ipt < gis.nbpt; ++(gis.ipt)) {
+        if (pgp) gis.ctx.set_ii(first_ind+gis.ipt);
+        else gis.ctx.set_xref(spt[first_ind+gis.ipt]);
+        if (d && gis.ipt == 0)
+          gis.ctx.set_K_B_J(&(*(K0.begin())), &(*(Bs.begin())), J0);
+        gis.coeff = scalar_type(0);
+        if (first_gp) {
+          for (size_type j = 0; j < gilb.size(); ++j) j += gilb[j]->exec();
+          first_gp = false;
+        }
+        if (gis.ipt == 0)
+          for (size_type j = 0; j < gile.size(); ++j) j += gile[j]->exec();
+        for (size_type j = 0; j < gil.size(); ++j) j += gil[j]->exec();
+        scalar_type w = pai->coeff(first_ind+gis.ipt);
+        for (size_type i = 0; i < nr; ++i) {
+          const base_tensor &t = *(rmi.ref_roots[i]);
+          if (gis.ipt == 0) {
+            T[i] = t; gmm::scale(T[i].as_vector(), w);
+          } else gmm::add(gmm::scaled(t.as_vector(), w), T[i].as_vector());
+        }
+      }
+    };
+
+    std::vector<base_tensor> T0;
+    std::vector<std::vector<base_tensor>> Tp(NS), Tm(d > 1 ? NS : 0);
+    std::vector<std::vector<std::vector<base_tensor>>> Tpq(d > 1 ? NS : 0);
+    base_matrix Bs(gmm::mat_nrows(B0), gmm::mat_ncols(B0));
+    sample(Bs, T0);
+    for (size_type m = 0; m < NS; ++m) {
+      Bs[m] = scalar_type(1); sample(Bs, Tp[m]);
+      if (d > 1) {
+        Bs[m] = scalar_type(-1); sample(Bs, Tm[m]);
+        Tpq[m].resize(m);
+        for (size_type n = 0; n < m; ++n) {
+          Bs[m] = Bs[n] = scalar_type(1); sample(Bs, Tpq[m][n]);
+          Bs[n] = scalar_type(0);
+        }
+      }
+      Bs[m] = scalar_type(0);
+    }
+    if (d) gis.ctx.set_K_B_J(&(*(K0.begin())), &(*(B0.begin())), J0);
+
+    std::vector<ga_instruction_set::region_mim_instructions
+                ::reference_integral> res(nr);
+    for (size_type i = 0; i < nr; ++i) {
+      auto &ri = res[i];
+      auto add_monomial = [&ri](size_type m, size_type n, base_tensor &&t) {
+        ri.monomials.push_back({{m, n}});
+        ri.coeffs.push_back(std::move(t));
+      };
+      add_monomial(NP, NP, std::move(T0[i]));
+      std::vector<base_tensor> A(NS), Q(d > 1 ? NS : 0);
+      for (size_type m = 0; m < NS; ++m) {
+        const base_tensor &c = ri.coeffs[0];
+        A[m] = Tp[m][i];
+        if (d > 1) { // A = (T(E_m) - T(-E_m))/2, Q = T(E_m) - A - c
+          gmm::add(gmm::scaled(Tm[m][i].as_vector(), scalar_type(-1)),
+                   A[m].as_vector());
+          gmm::scale(A[m].as_vector(), scalar_type(0.5));
+          Q[m] = Tp[m][i];
+          gmm::add(gmm::scaled(A[m].as_vector(), scalar_type(-1)),
+                   Q[m].as_vector());
+          gmm::add(gmm::scaled(c.as_vector(), scalar_type(-1)),
+                   Q[m].as_vector());
+        } else
+          gmm::add(gmm::scaled(c.as_vector(), scalar_type(-1)),
+                   A[m].as_vector());
+      }
+      for (size_type m = 0; m < NS; ++m)
+        for (size_type n = 0; d > 1 && n < m; ++n) {
+          // T(E_m+E_n) - c - A_m - A_n - Q_m - Q_n
+          base_tensor q = Tpq[m][n][i];
+          gmm::add(gmm::scaled(ri.coeffs[0].as_vector(), scalar_type(-1)),
+                   q.as_vector());
+          for (size_type k : {m, n}) {
+            gmm::add(gmm::scaled(A[k].as_vector(), scalar_type(-1)),
+                     q.as_vector());
+            gmm::add(gmm::scaled(Q[k].as_vector(), scalar_type(-1)),
+                     q.as_vector());
+          }
+          add_monomial(m, n, std::move(q));
+        }
+      for (size_type m = 0; m < NS; ++m) {
+        add_monomial(m, NP, std::move(A[m]));
+        if (d > 1) add_monomial(m, m, std::move(Q[m]));
+      }
+
+      // The vanishing monomials (up to the rounding errors) are removed,
+      // except the constant one which gives the sizes of the term.
+      scalar_type tmax(0);
+      for (const base_tensor &t : ri.coeffs)
+        tmax = std::max(tmax, gmm::vect_norminf(t.as_vector()));
+      size_type nb = 1;
+      for (size_type k = 1; k < ri.coeffs.size(); ++k)
+        if (gmm::vect_norminf(ri.coeffs[k].as_vector()) > tmax * 1E-14) {
+          if (nb != k) {
+            ri.monomials[nb] = ri.monomials[k];
+            ri.coeffs[nb] = std::move(ri.coeffs[k]);
+          }
+          ++nb;
+        }
+      ri.monomials.resize(nb); ri.coeffs.resize(nb);
+    }
+    return res;
+  }
+
   void ga_exec(ga_instruction_set &gis, ga_workspace &workspace) {
     base_matrix G1, G2;
     base_small_vector un;
@@ -7208,6 +7636,9 @@ namespace getfem {
       if (!psd) { // standard integration on a single domain
 
         const mesh_region &region = *(instr.first.region());
+        auto &rmi = instr.second;
+        std::pair<papprox_integration, std::vector<pfem>> ref_key;
+        base_vector ref_b;
 
         // iteration on elements (or faces of elements)
         size_type old_cv = size_type(-1);
@@ -7217,12 +7648,24 @@ namespace getfem {
         bgeot::pstored_point_tab pspt = 0, old_pspt = 0;
         bgeot::pgeotrans_precomp pgp = 0;
         bool first_gp = true;
+        // Stored geometric quantities: for each geometric point, J, J1,
+        // K, B and the unit normal on a face.
+        im_geometric_cache *gcache = mim.mutable_geometric_cache();
+        if (gcache) gcache->check_version(mim);
+        bool use_gcache = false;
+        const scalar_type *gvals = 0;
+        scalar_type *gstore = 0;
+        size_type gNP = 0, gstride = 0;
         for (getfem::mr_visitor v(region, m, true); !v.finished(); ++v) {
           if (mim.convex_index().is_in(v.cv())) {
             // cout << "proceed with elt " << v.cv() << " face " << v.f()<<endl;
             if (v.cv() != old_cv) {
               pgt = m.trans_of_convex(v.cv());
               pim = mim.int_method_of_element(v.cv());
+              if (!(instr.second.reduced_ims.empty())) {
+                auto itr = instr.second.reduced_ims.find(pim);
+                if (itr != instr.second.reduced_ims.end()) pim = itr->second;
+              }
               m.points_of_convex(v.cv(), G1);
 
               if (pim->type() == IM_NONE) continue;
@@ -7230,6 +7673,7 @@ namespace getfem {
                           "cannot be used in high level generic assembly");
               pai = pim->approx_method();
               pspt = pai->pintegration_points();
+              use_gcache = gcache && !(pai->is_built_on_the_fly());
               if (pspt->size()) {
                 if (pgp && gis.pai == pai && pgt_old == pgt) {
                   gis.ctx.change(pgp, 0, 0, G1, v.cv(), v.f());
@@ -7243,7 +7687,7 @@ namespace getfem {
                   }
                   pgt_old = pgt; gis.pai = pai;
                 }
-                if (gis.need_elt_size)
+                if (gis.need_elt_size && !use_gcache)
                   gis.elt_size = convex_radius_estimate(pgt, G1)*scalar_type(2);
               }
               old_cv = v.cv();
@@ -7261,22 +7705,129 @@ namespace getfem {
               } else {
                 gis.nbpt = pai->nb_points_on_convex();
               }
+
+              // Terms integrated on the reference element: only the
+              // jacobian and B are computed.
+              bool ref_record = false;
+              auto itr = rmi.ref_integrals.end();
+              if (rmi.reference_integration && v.f() == short_type(-1) &&
+                  pgt->is_linear() && !(pai->is_built_on_the_fly())) {
+                ref_key.first = pai;
+                ref_key.second.resize(rmi.ref_mfs.size());
+                ref_record = true;
+                for (size_type i = 0; i < rmi.ref_mfs.size(); ++i) {
+                  pfem pf = rmi.ref_mfs[i]->fem_of_element(v.cv());
+                  if (!pf || !(pf->is_equivalent()) ||
+                      pf->is_on_real_element() || pf->vectorial_type()
+                      != virtual_fem::VECTORIAL_NOTRANSFORM_TYPE)
+                    { ref_record = false; break; }
+                  ref_key.second[i] = pf;
+                }
+                if (ref_record) itr = rmi.ref_integrals.find(ref_key);
+              }
+              if (itr == rmi.ref_integrals.end() && rmi.ref_roots_modified) {
+                for (size_type i = 0; i < rmi.ref_roots.size(); ++i)
+                  *(rmi.ref_roots[i]) = rmi.ref_saved_roots[i];
+                rmi.ref_roots_modified = false;
+              }
+              if (ref_record && itr == rmi.ref_integrals.end())
+                itr = rmi.ref_integrals.emplace
+                  (ref_key, ga_reference_integrals(gis, rmi, first_gp, pgp,
+                                                   *pspt, first_ind)).first;
+              if (itr != rmi.ref_integrals.end()) {
+                // Components of B followed by 1, for the monomials
+                size_type NP = G1.nrows() * pgt->dim();
+                ref_b.resize(NP+1);
+                ref_b[NP] = scalar_type(1);
+                const scalar_type *gv
+                  = use_gcache ? gcache->values(v.cv(), v.f()) : 0;
+                if (gv) {
+                  J1 = gv[2];
+                  if (rmi.ref_degree)
+                    std::copy(gv+3+NP, gv+3+2*NP, ref_b.begin());
+                } else {
+                  if (pgp) gis.ctx.set_ii(first_ind);
+                  else gis.ctx.set_xref((*pspt)[first_ind]);
+                  J1 = gis.ctx.J();
+                  if (rmi.ref_degree)
+                    std::copy(gis.ctx.B().begin(), gis.ctx.B().end(),
+                              ref_b.begin());
+                }
+                if (!(rmi.ref_roots_modified)) {
+                  rmi.ref_saved_roots.resize(rmi.ref_roots.size());
+                  for (size_type i = 0; i < rmi.ref_roots.size(); ++i)
+                    rmi.ref_saved_roots[i] = *(rmi.ref_roots[i]);
+                  rmi.ref_roots_modified = true;
+                }
+                gis.nbpt = 1; gis.ipt = 0; gis.coeff = J1;
+                for (size_type i = 0; i < rmi.ref_roots.size(); ++i) {
+                  const auto &ri = itr->second[i];
+                  base_tensor &t = *(rmi.ref_roots[i]);
+                  t = ri.coeffs[0];
+                  for (size_type k = 1; k < ri.coeffs.size(); ++k)
+                    gmm::add(gmm::scaled(ri.coeffs[k].as_vector(),
+                                         ref_b[ri.monomials[k][0]]
+                                         * ref_b[ri.monomials[k][1]]),
+                             t.as_vector());
+                  rmi.ref_instructions[i]->exec();
+                }
+                continue;
+              }
+
+              gvals = 0; gstore = 0;
+              if (use_gcache) {
+                gNP = G1.nrows() * pgt->dim();
+                gstride = 2 + 2*gNP + (v.f() != short_type(-1) ? G1.nrows():0);
+                gvals = gcache->values(v.cv(), v.f());
+                if (!gvals)
+                  gstore = gcache->reserve(v.cv(), v.f(), 1 + gstride
+                                           * (pgt->is_linear() ? 1 : gis.nbpt));
+                // The element size is stored even if it is not used, for
+                // the later assemblies which need it.
+                if (gvals) {
+                  if (gis.need_elt_size) gis.elt_size = gvals[0];
+                } else if (gis.need_elt_size || gstore) {
+                  gis.elt_size = convex_radius_estimate(pgt,G1)*scalar_type(2);
+                  if (gstore) gstore[0] = gis.elt_size;
+                }
+              }
               for (gis.ipt = 0; gis.ipt < gis.nbpt; ++(gis.ipt)) {
                 if (pgp) gis.ctx.set_ii(first_ind+gis.ipt);
                 else gis.ctx.set_xref((*pspt)[first_ind+gis.ipt]);
                 if (gis.ipt == 0 || !(pgt->is_linear())) {
-                  J1 = gis.ctx.J();
-                  // Computation of unit normal vector in case of a boundary
-                  if (v.f() != short_type(-1)) {
-                    gis.Normal.resize(G1.nrows());
-                    un.resize(pgt->dim());
-                    gmm::copy(pgt->normals()[v.f()], un);
-                    gmm::mult(gis.ctx.B(), un, gis.Normal);
-                    scalar_type nup = gmm::vect_norm2(gis.Normal);
-                    J1 *= nup;
-                    gmm::scale(gis.Normal, 1.0/nup);
-                    gmm::clean(gis.Normal, 1e-13);
-                  } else gis.Normal.resize(0);
+                  size_type goffset
+                    = 1 + (pgt->is_linear() ? 0 : gis.ipt) * gstride;
+                  if (gvals) {
+                    const scalar_type *p = gvals + goffset;
+                    gis.ctx.set_K_B_J(p+2, p+2+gNP, p[0]);
+                    J1 = p[1];
+                    if (v.f() != short_type(-1)) {
+                      gis.Normal.resize(G1.nrows());
+                      std::copy(p+2+2*gNP, p+gstride, gis.Normal.begin());
+                    } else gis.Normal.resize(0);
+                  } else {
+                    J1 = gis.ctx.J();
+                    // Computation of unit normal vector in case of a boundary
+                    if (v.f() != short_type(-1)) {
+                      gis.Normal.resize(G1.nrows());
+                      un.resize(pgt->dim());
+                      gmm::copy(pgt->normals()[v.f()], un);
+                      gmm::mult(gis.ctx.B(), un, gis.Normal);
+                      scalar_type nup = gmm::vect_norm2(gis.Normal);
+                      J1 *= nup;
+                      gmm::scale(gis.Normal, 1.0/nup);
+                      gmm::clean(gis.Normal, 1e-13);
+                    } else gis.Normal.resize(0);
+                    if (gstore) {
+                      scalar_type *p = gstore + goffset;
+                      p[0] = gis.ctx.J(); p[1] = J1;
+                      std::copy(gis.ctx.K().begin(), gis.ctx.K().end(), p+2);
+                      std::copy(gis.ctx.B().begin(), gis.ctx.B().end(),
+                                p+2+gNP);
+                      std::copy(gis.Normal.begin(), gis.Normal.end(),
+                                p+2+2*gNP);
+                    }
+                  }
                 }
                 auto ipt_coeff = pai->coeff(first_ind+gis.ipt);
                 gis.coeff = J1 * ipt_coeff;
@@ -7295,6 +7846,7 @@ namespace getfem {
                 }
                 GA_DEBUG_INFO("");
               }
+              if (gstore) gcache->validate(v.cv(), v.f());
             }
           }
         }
@@ -23,6 +23,7 @@
 #include "getfem/getfem_generic_assembly_semantic.h"
 #include "getfem/getfem_generic_assembly_compile_and_exec.h"
 #include "getfem/getfem_generic_assembly_functions_and_operators.h"
+#include "getfem/bgeot_bvh.h"
 
 namespace getfem {
 
@@ -480,16 +481,6 @@ namespace getfem {
   // Interpolate transformation with an expression
   //=========================================================================
 
-  struct rated_box_index_compare {
-    bool operator()(
-      const std::pair<scalar_type, const bgeot::box_index*> &x,
-      const std::pair<scalar_type, const bgeot::box_index*> &y) const {
-      GMM_ASSERT2(x.second != nullptr, "x contains nullptr");
-      GMM_ASSERT2(y.second != nullptr, "y contains nullptr");
-      return (x.first < y.first) || (!(y.first < x.first) && (x.second->id < y.second->id));
-    }
-  };
-
   class interpolate_transformation_expression
     : public virtual_interpolate_transformation, public context_dependencies {
 
@@ -502,7 +493,7 @@ namespace getfem {
     const mesh &target_mesh;
     const size_type target_region;
     std::string expr;
-    mutable bgeot::rtree element_boxes;
+    mutable bgeot::box_bvh element_boxes;
     mutable bool recompute_elt_boxes;
     mutable ga_workspace local_workspace;
     mutable ga_instruction_set local_gis;
@@ -592,7 +583,9 @@ namespace getfem {
       if (recompute_elt_boxes) {
 
         box_to_convexes.clear();
-        element_boxes.clear();
+        // The topology of the tree is kept for a refit when the mesh is
+        // only moved (same number of elements).
+        element_boxes.clear_boxes_only();
         base_node bmin(N), bmax(N);
         const dal::bit_vector&
           convex_index = (target_region == mesh_region::all_convexes().id())
@@ -628,7 +621,7 @@ namespace getfem {
 
           box_to_convexes[element_boxes.add_box(bmin, bmax)].push_back(cv);
         }
-        element_boxes.build_tree();
+        element_boxes.update_tree();
         recompute_elt_boxes = false;
       }
     }
@@ -677,21 +670,21 @@ namespace getfem {
 
       *m_t = &target_mesh;
 
-      bgeot::rtree::pbox_cont boxes;
+      std::vector<size_type> boxes;
       {
-        bgeot::rtree::pbox_set bset;
+        std::vector<size_type> bset;
         element_boxes.find_boxes_at_point(P, bset);
 
         // using a std::set as a sorter
-        std::set<std::pair<scalar_type, const bgeot::box_index*>, rated_box_index_compare>
-          rated_boxes;
-        for (const auto &box : bset) {
+        std::set<std::pair<scalar_type, size_type>> rated_boxes;
+        for (size_type box : bset) {
+          const scalar_type *bmin = element_boxes.box_min(box);
+          const scalar_type *bmax = element_boxes.box_max(box);
           scalar_type rating = scalar_type(1);
           for (size_type i = 0; i < m.dim(); ++i) {
-            scalar_type h = box->max->at(i) - box->min->at(i);
+            scalar_type h = bmax[i] - bmin[i];
             if (h > scalar_type(0)) {
-              scalar_type r = std::min(box->max->at(i) - P[i],
-                                       P[i] - box->min->at(i)) / h;
+              scalar_type r = std::min(bmax[i] - P[i], P[i] - bmin[i]) / h;
               rating = std::min(r, rating);
             }
           }
@@ -708,7 +701,7 @@ namespace getfem {
       size_type best_cv(-1);
       base_node best_P_ref;
       for (size_type i = boxes.size(); i > 0; --i) {
-        for (auto convex : box_to_convexes.at(boxes[i-1]->id)) {
+        for (auto convex : box_to_convexes.at(boxes[i-1])) {
           gic.init(target_mesh.points_of_convex(convex),
                    target_mesh.trans_of_convex(convex));
 
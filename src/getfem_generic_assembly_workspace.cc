@@ -871,6 +871,14 @@ namespace getfem {
     return include_empty_int_pts;
   }
 
+  void ga_workspace::set_quadrature_reduction(int level) {
+    quad_reduction_level = level;
+  }
+
+  int ga_workspace::quadrature_reduction() const {
+    return quad_reduction_level;
+  }
+
   void ga_workspace::add_temporary_interval_for_unreduced_variable
     (const std::string &name)
   {
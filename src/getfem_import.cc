@@ -22,10 +22,13 @@
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <sstream>
+#include <cstring>
 
 #include "getfem/getfem_mesh.h"
 #include "getfem/getfem_import.h"
 #include "getfem/getfem_regular_meshes.h"
+#include "getfem/getfem_locale.h"
 
 namespace getfem {
 
@@ -168,6 +171,174 @@ namespace getfem {
       }
     }
 
+    void reorder_nodes() {
+      // Reordering nodes for certain elements (should be completed ?)
+      // http://www.geuz.org/gmsh/doc/texinfo/gmsh.html#Node-ordering
+      std::vector<size_type> tmp_nodes(nodes);
+      switch(type) {
+      case 3 : {
+        nodes[2] = tmp_nodes[3];
+        nodes[3] = tmp_nodes[2];
+      } break;
+      case 5 : { /* First order hexaedron */
+        //nodes[0] = tmp_nodes[0];
+        //nodes[1] = tmp_nodes[1];
+        nodes[2] = tmp_nodes[3];
+        nodes[3] = tmp_nodes[2];
+        //nodes[4] = tmp_nodes[4];
+        //nodes[5] = tmp_nodes[5];
+        nodes[6] = tmp_nodes[7];
+        nodes[7] = tmp_nodes[6];
+      } break;
+      case 7 : { /* first order pyramid */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[2];
+        nodes[2] = tmp_nodes[1];
+        // nodes[3] = tmp_nodes[3];
+        // nodes[4] = tmp_nodes[4];
+      } break;
+      case 8 : { /* Second order line */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[2];
+        nodes[2] = tmp_nodes[1];
+      } break;
+      case 9 : { /* Second order triangle */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[3];
+        nodes[2] = tmp_nodes[1];
+        nodes[3] = tmp_nodes[5];
+        //nodes[4] = tmp_nodes[4];
+        nodes[5] = tmp_nodes[2];
+      } break;
+      case 10 : { /* Second order quadrangle */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[4];
+        nodes[2] = tmp_nodes[1];
+        nodes[3] = tmp_nodes[7];
+        nodes[4] = tmp_nodes[8];
+        //nodes[5] = tmp_nodes[5];
+        nodes[6] = tmp_nodes[3];
+        nodes[7] = tmp_nodes[6];
+        nodes[8] = tmp_nodes[2];
+      } break;
+      case 11: { /* Second order tetrahedron */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[4];
+        nodes[2] = tmp_nodes[1];
+        nodes[3] = tmp_nodes[6];
+        nodes[4] = tmp_nodes[5];
+        nodes[5] = tmp_nodes[2];
+        nodes[6] = tmp_nodes[7];
+        nodes[7] = tmp_nodes[9];
+        //nodes[8] = tmp_nodes[8];
+        nodes[9] = tmp_nodes[3];
+      } break;
+      case 12: { /* Second order hexahedron */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[8];
+        nodes[2] = tmp_nodes[1];
+        nodes[3] = tmp_nodes[9];
+        nodes[4] = tmp_nodes[20];
+        nodes[5] = tmp_nodes[11];
+        nodes[6] = tmp_nodes[3];
+        nodes[7] = tmp_nodes[13];
+        nodes[8] = tmp_nodes[2];
+        nodes[9] = tmp_nodes[10];
+        nodes[10] = tmp_nodes[21];
+        nodes[11] = tmp_nodes[12];
+        nodes[12] = tmp_nodes[22];
+        nodes[13] = tmp_nodes[26];
+        nodes[14] = tmp_nodes[23];
+        //nodes[15] = tmp_nodes[15];
+        nodes[16] = tmp_nodes[24];
+        nodes[17] = tmp_nodes[14];
+        nodes[18] = tmp_nodes[4];
+        nodes[19] = tmp_nodes[16];
+        nodes[20] = tmp_nodes[5];
+        nodes[21] = tmp_nodes[17];
+        nodes[22] = tmp_nodes[25];
+        nodes[23] = tmp_nodes[18];
+        nodes[24] = tmp_nodes[7];
+        nodes[25] = tmp_nodes[19];
+        nodes[26] = tmp_nodes[6];
+      } break;
+      case 16 : { /* Incomplete second order quadrangle */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[4];
+        nodes[2] = tmp_nodes[1];
+        nodes[3] = tmp_nodes[7];
+        nodes[4] = tmp_nodes[5];
+        nodes[5] = tmp_nodes[3];
+        nodes[6] = tmp_nodes[6];
+        nodes[7] = tmp_nodes[2];
+      } break;
+      case 17: { /* Incomplete second order hexahedron */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[8];
+        nodes[2] = tmp_nodes[1];
+        nodes[3] = tmp_nodes[9];
+        nodes[4] = tmp_nodes[11];
+        nodes[5] = tmp_nodes[3];
+        nodes[6] = tmp_nodes[13];
+        nodes[7] = tmp_nodes[2];
+        nodes[8] = tmp_nodes[10];
+        nodes[9] = tmp_nodes[12];
+        nodes[10] = tmp_nodes[15];
+        nodes[11] = tmp_nodes[14];
+        nodes[12] = tmp_nodes[4];
+        nodes[13] = tmp_nodes[16];
+        nodes[14] = tmp_nodes[5];
+        nodes[15] = tmp_nodes[17];
+        nodes[16] = tmp_nodes[18];
+        nodes[17] = tmp_nodes[7];
+        nodes[18] = tmp_nodes[19];
+        nodes[19] = tmp_nodes[6];
+      } break;
+      case 26 : { /* Third order line */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[2];
+        nodes[2] = tmp_nodes[3];
+        nodes[3] = tmp_nodes[1];
+      } break;
+      case 21 : { /* Third order triangle */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[3];
+        nodes[2] = tmp_nodes[4];
+        nodes[3] = tmp_nodes[1];
+        nodes[4] = tmp_nodes[8];
+        nodes[5] = tmp_nodes[9];
+        nodes[6] = tmp_nodes[5];
+        //nodes[7] = tmp_nodes[7];
+        nodes[8] = tmp_nodes[6];
+        nodes[9] = tmp_nodes[2];
+      } break;
+      case 23: { /* Fourth order triangle */
+      //nodes[0]  = tmp_nodes[0];
+        nodes[1]  = tmp_nodes[3];
+        nodes[2]  = tmp_nodes[4];
+        nodes[3]  = tmp_nodes[5];
+        nodes[4]  = tmp_nodes[1];
+        nodes[5]  = tmp_nodes[11];
+        nodes[6]  = tmp_nodes[12];
+        nodes[7]  = tmp_nodes[13];
+        nodes[8]  = tmp_nodes[6];
+        nodes[9]  = tmp_nodes[10];
+        nodes[10] = tmp_nodes[14];
+        nodes[11] = tmp_nodes[7];
+        nodes[12] = tmp_nodes[9];
+        nodes[13] = tmp_nodes[8];
+        nodes[14] = tmp_nodes[2];
+      } break;
+      case 27: { /* Fourth order line */
+      //nodes[0]  = tmp_nodes[0];
+        nodes[1]  = tmp_nodes[2];
+        nodes[2]  = tmp_nodes[3];
+        nodes[3]  = tmp_nodes[4];
+        nodes[4]  = tmp_nodes[1];
+      } break;
+      }
+    }
+
     bool operator<(const gmsh_cv_info& other) const {
       unsigned this_dim = (type == 15) ? 0 : pgt->dim();
       unsigned other_dim = (other.type == 15) ? 0 : other.pgt->dim();
@@ -200,6 +371,439 @@ namespace getfem {
     return region_map;
   }
 
+  /* Add the convexes of cvlst to the mesh, and fill the regions.
+     Return false if there are only nodes in the list. */
+  static bool add_gmsh_convexes(std::vector<gmsh_cv_info> &cvlst, mesh &m,
+                                std::set<size_type> *lower_dim_convex_rg,
+                                bool add_all_element_type,
+                                std::map<size_type, std::set<size_type>>
+                                *nodal_map) {
+    size_type nb_cv = cvlst.size();
+    if (cvlst.size()) {
+      std::sort(cvlst.begin(), cvlst.end());
+      if (cvlst.front().type == 15){
+        GMM_WARNING2("Only nodes defined in the mesh! No elements are added.");
+        return false;
+      }
+
+      unsigned N = cvlst.front().pgt->dim();
+      for (size_type cv=0; cv < nb_cv; ++cv) {
+        bool cvok = false;
+        gmsh_cv_info &ci = cvlst[cv];
+        bool is_node = (ci.type == 15);
+        unsigned ci_dim = (is_node) ? 0 : ci.pgt->dim();
+        //cout << "importing cv dim=" << int(ci.pgt->dim()) << " N=" << N
+        //     << " region: " << ci.region << "\n";
+
+        //main convex import
+        if (ci_dim == N) {
+          size_type ic = m.add_convex(ci.pgt, ci.nodes.begin());
+          cvok = true;
+          m.region(ci.region).add(ic);
+
+        //convexes with lower dimensions
+        }
+        else {
+          //convex that lies within the regions of lower_dim_convex_rg
+          //is imported explicitly as a convex.
+          if (lower_dim_convex_rg != NULL &&
+              lower_dim_convex_rg->find(ci.region) != lower_dim_convex_rg->end() &&
+              !is_node){
+              size_type ic = m.add_convex(ci.pgt, ci.nodes.begin()); cvok = true;
+              m.region(ci.region).add(ic);
+          }
+          //find if the convex is part of a face of higher dimension convex
+          else{
+            bgeot::mesh_structure::ind_cv_ct ct = m.convex_to_point(ci.nodes[0]);
+            for (bgeot::mesh_structure::ind_cv_ct::const_iterator
+                   it = ct.begin(); it != ct.end(); ++it) {
+              for (short_type face=0;
+                   face < m.structure_of_convex(*it)->nb_faces(); ++face) {
+                if (m.is_convex_face_having_points(*it,face,
+                                                   short_type(ci.nodes.size()),
+                                                   ci.nodes.begin())) {
+                  m.region(ci.region).add(*it,face);
+                  cvok = true;
+                }
+              }
+            }
+            if (is_node && (nodal_map != NULL))
+            {
+              for (auto i : ci.nodes) (*nodal_map)[ci.region].insert(i);
+            }
+            //if the convex is not part of the face of others
+            if (!cvok)
+            {
+              if (is_node)
+              {
+                if (nodal_map == NULL){
+                  GMM_WARNING2("gmsh import ignored a node id: "
+                               << ci.id << " region :" << ci.region <<
+                               " point is not added explicitly as an element.");
+                }
+              }
+              else if (add_all_element_type){
+                size_type ic = m.add_convex(ci.pgt, ci.nodes.begin());
+                m.region(ci.region).add(ic);
+                cvok = true;
+              }
+              else{
+                GMM_WARNING2("gmsh import ignored an element of type "
+                  << bgeot::name_of_geometric_trans(ci.pgt) <<
+                  " as it does not belong to the face of another element");
+              }
+            }
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+  /* Reading of the MSH 4.1 format, ASCII or binary, from the content of
+     the file loaded in memory. */
+  struct gmsh41_parser {
+    const char *e;    // end of the buffer
+    bool binary;
+    size_type dsize;  // size of the size_t values of a binary file
+
+    void check(const char *p, size_type n) const
+    { GMM_ASSERT1(size_type(e - p) >= n, "Unexpected end of gmsh file"); }
+    template <typename T> T read_binary(const char *&p) const {
+      T v; check(p, sizeof(T));
+      std::memcpy(&v, p, sizeof(T)); p += sizeof(T);
+      return v;
+    }
+    size_type read_size(const char *&p) const {
+      if (binary)
+        return (dsize == 8) ? size_type(read_binary<gmm::uint64_type>(p))
+                            : size_type(read_binary<gmm::uint32_type>(p));
+      char *q; unsigned long long v = std::strtoull(p, &q, 10);
+      GMM_ASSERT1(q != p, "Syntax error in gmsh file");
+      p = q; return size_type(v);
+    }
+    int read_int(const char *&p) const {
+      if (binary) return read_binary<int>(p);
+      char *q; long v = std::strtol(p, &q, 10);
+      GMM_ASSERT1(q != p, "Syntax error in gmsh file");
+      p = q; return int(v);
+    }
+    scalar_type read_double(const char *&p) const {
+      if (binary) return scalar_type(read_binary<double>(p));
+      char *q; double v = std::strtod(p, &q);
+      GMM_ASSERT1(q != p, "Syntax error in gmsh file");
+      p = q; return scalar_type(v);
+    }
+    void skip_lines(const char *&p, size_type n) const {
+      for (; n > 0; --n) {
+        const void *q = std::memchr(p, '\n', size_type(e - p));
+        GMM_ASSERT1(q, "Unexpected end of gmsh file");
+        p = static_cast<const char *>(q) + 1;
+      }
+    }
+    /* skip n entities of nbv values of size vsize (binary) or n lines */
+    void skip_entities(const char *&p, size_type n, size_type nbv,
+                       size_type vsize) const {
+      if (binary) { check(p, n*nbv*vsize); p += n*nbv*vsize; }
+      else skip_lines(p, n);
+    }
+    /* go after the end of the section */
+    void skip_section(const char *&p, const std::string &name) const {
+      std::string end_name = "$End" + name;
+      const char *q = std::search(p, e, end_name.begin(), end_name.end());
+      GMM_ASSERT1(q != e, "Missing " << end_name << " in gmsh file");
+      p = q + end_name.size();
+    }
+  };
+
+  /* The nodes and elements blocks are divided in chunks of at most
+     GMSH41_CHUNK entities, which are parsed in parallel. */
+  enum { GMSH41_CHUNK = 4096 };
+
+  struct gmsh41_node_chunk {
+    const char *tags, *coords;
+    size_type n, first, npar;
+  };
+
+  struct gmsh41_element_chunk {
+    const char *p;
+    size_type n, first, block;
+  };
+
+  /* Correspondence between the gmsh node tags and the mesh points. */
+  struct gmsh41_node_numbering {
+    size_type min_tag;
+    std::vector<size_type> dense;
+    std::vector<std::pair<size_type, size_type> > sparse;
+
+    size_type operator()(size_type tag) const {
+      if (dense.size())
+        return (tag >= min_tag && tag - min_tag < dense.size())
+          ? dense[tag - min_tag] : size_type(-1);
+      auto it = std::lower_bound(sparse.begin(), sparse.end(),
+                                 std::make_pair(tag, size_type(0)));
+      return (it != sparse.end() && it->first == tag)
+        ? it->second : size_type(-1);
+    }
+
+    void init(const std::vector<size_type> &tags,
+              const std::vector<size_type> &index) {
+      dense.resize(0); sparse.resize(0);
+      if (tags.empty()) return;
+      min_tag = *std::min_element(tags.begin(), tags.end());
+      size_type max_tag = *std::max_element(tags.begin(), tags.end());
+      if (max_tag - min_tag <= 2 * tags.size()) {
+        dense.assign(max_tag - min_tag + 1, size_type(-1));
+        for (size_type i = 0; i < tags.size(); ++i)
+          dense[tags[i] - min_tag] = index[i];
+      } else {
+        sparse.resize(tags.size());
+        for (size_type i = 0; i < tags.size(); ++i)
+          sparse[i] = std::make_pair(tags[i], index[i]);
+        std::sort(sparse.begin(), sparse.end());
+      }
+    }
+  };
+
+  static void parse_gmsh41_nodes(const gmsh41_parser &P,
+                                 const std::vector<gmsh41_node_chunk> &chunks,
+                                 size_type i0, size_type i1,
+                                 std::vector<size_type> &tags,
+                                 std::vector<scalar_type> &coords) {
+    for (size_type ic = i0; ic < i1; ++ic) {
+      const gmsh41_node_chunk &c = chunks[ic];
+      const char *p = c.tags;
+      for (size_type i = 0; i < c.n; ++i) tags[c.first+i] = P.read_size(p);
+      p = c.coords;
+      for (size_type i = 0; i < c.n; ++i) {
+        for (size_type k = 0; k < 3; ++k)
+          coords[3*(c.first+i)+k] = P.read_double(p);
+        for (size_type k = 0; k < c.npar; ++k) P.read_double(p);
+      }
+    }
+  }
+
+  static void
+  parse_gmsh41_elements(const gmsh41_parser &P,
+                        const std::vector<gmsh41_element_chunk> &chunks,
+                        size_type i0, size_type i1,
+                        const std::vector<gmsh_cv_info> &blocks,
+                        const gmsh41_node_numbering &numbering,
+                        std::vector<gmsh_cv_info> &cvlst) {
+    for (size_type ic = i0; ic < i1; ++ic) {
+      const gmsh41_element_chunk &c = chunks[ic];
+      const char *p = c.p;
+      for (size_type i = 0; i < c.n; ++i) {
+        gmsh_cv_info &ci = cvlst[c.first+i];
+        ci = blocks[c.block];
+        ci.id = unsigned(P.read_size(p) - 1); /* gmsh numbering starts at 1 */
+        for (size_type j = 0; j < ci.nodes.size(); ++j) {
+          size_type tag = P.read_size(p);
+          ci.nodes[j] = numbering(tag);
+          GMM_ASSERT1(ci.nodes[j] != size_type(-1), "Invalid node ID " << tag
+                      << " in gmsh element " << (ci.id + 1));
+        }
+        ci.reorder_nodes();
+      }
+    }
+  }
+
+  /*
+     Format version 4.1, ASCII or binary.
+
+     The whole file is loaded in memory. The limits of the node and element
+     blocks are found by a sequential scan of the block headers, then the
+     blocks are parsed in parallel. The nodes are added to the mesh without
+     search of duplicated nodes, the elements referring to them by their
+     tag. If remove_duplicated_nodes is true, the nodes having the same
+     coordinates (up to the tolerance of bgeot::node_tab) are merged by
+     bgeot::node_tab::merge_duplicated_nodes before they are added to the
+     mesh.
+
+     The region of an element is the first physical tag of its entity, or
+     the entity tag if the entity has no physical tag.
+  */
+  static bool import_gmsh41_mesh_file(std::istream& f, mesh& m,
+                          std::map<std::string, size_type> *region_map,
+                          std::set<size_type> *lower_dim_convex_rg,
+                          bool add_all_element_type,
+                          std::map<size_type, std::set<size_type>> *nodal_map,
+                          bool remove_duplicated_nodes) {
+    int file_type;
+    size_type data_size;
+    f >> file_type >> data_size;
+    std::string buf((std::istreambuf_iterator<char>(f)),
+                    std::istreambuf_iterator<char>());
+    gmsh41_parser P;
+    P.e = buf.data() + buf.size();
+    P.binary = (file_type == 1);
+    P.dsize = data_size;
+    GMM_ASSERT1(!P.binary || data_size == 4 || data_size == 8,
+                "Unsupported size of size_t in gmsh file: " << data_size);
+    const char *p = buf.data();
+    P.skip_lines(p, 1);
+    if (P.binary)
+      GMM_ASSERT1(P.read_binary<int>(p) == 1, "The binary gmsh file has "
+                  "been written on a system with a different endianness");
+    P.skip_section(p, "MeshFormat");
+
+    std::map<std::pair<int, int>, size_type> entity_region;
+    std::vector<gmsh41_node_chunk> node_chunks;
+    std::vector<gmsh41_element_chunk> element_chunks;
+    std::vector<gmsh_cv_info> blocks;
+    size_type nb_nodes = 0, nb_elements = 0;
+
+    while (true) {
+      while (p < P.e && isspace(*p)) ++p;
+      if (p >= P.e) break;
+      GMM_ASSERT1(*p == '$', "Syntax error in gmsh file");
+      const char *q = p;
+      P.skip_lines(q, 1);
+      std::string name(p+1, q-1);
+      while (name.size() && isspace(name.back())) name.pop_back();
+      if (name == "PhysicalNames") {
+        const char *p0 = p;
+        P.skip_section(p, name);
+        if (region_map != NULL) {
+          std::istringstream ist(std::string(p0, p));
+          *region_map = read_region_names_from_gmsh_mesh_file(ist);
+        }
+        continue;
+      }
+      p = q;
+      if (name == "Entities") {
+        size_type nb[4];
+        for (size_type d = 0; d < 4; ++d) nb[d] = P.read_size(p);
+        for (int d = 0; d < 4; ++d)
+          for (size_type i = 0; i < nb[d]; ++i) {
+            int tag = P.read_int(p);
+            for (size_type k = 0; k < (d == 0 ? 3 : 6); ++k)
+              P.read_double(p);
+            size_type nbph = P.read_size(p), region = size_type(tag);
+            for (size_type k = 0; k < nbph; ++k) {
+              int ph = P.read_int(p);
+              if (k == 0) region = size_type(gmm::abs(ph));
+            }
+            if (d > 0) {
+              size_type nbb = P.read_size(p);
+              for (size_type k = 0; k < nbb; ++k) P.read_int(p);
+            }
+            entity_region[std::make_pair(d, tag)] = region;
+          }
+      } else if (name == "Nodes") {
+        size_type nb_blocks = P.read_size(p);
+        nb_nodes = P.read_size(p);
+        P.read_size(p); P.read_size(p); // min and max tags
+        if (!P.binary) P.skip_lines(p, 1);
+        size_type first = 0;
+        for (size_type b = 0; b < nb_blocks; ++b) {
+          int edim = P.read_int(p); P.read_int(p);
+          int parametric = P.read_int(p);
+          size_type n = P.read_size(p), i0 = node_chunks.size();
+          if (!P.binary) P.skip_lines(p, 1);
+          for (size_type k = 0; k < n; k += GMSH41_CHUNK) {
+            gmsh41_node_chunk c;
+            c.n = std::min(size_type(GMSH41_CHUNK), n - k);
+            c.first = first + k;
+            c.npar = parametric ? size_type(edim) : 0;
+            c.tags = p;
+            P.skip_entities(p, c.n, 1, P.dsize);
+            node_chunks.push_back(c);
+          }
+          for (size_type ic = i0; ic < node_chunks.size(); ++ic) {
+            node_chunks[ic].coords = p;
+            P.skip_entities(p, node_chunks[ic].n, 3 + node_chunks[ic].npar,
+                            sizeof(double));
+          }
+          first += n;
+        }
+        GMM_ASSERT1(first == nb_nodes, "Wrong number of nodes");
+      } else if (name == "Elements") {
+        size_type nb_blocks = P.read_size(p);
+        nb_elements = P.read_size(p);
+        P.read_size(p); P.read_size(p); // min and max tags
+        if (!P.binary) P.skip_lines(p, 1);
+        size_type first = 0;
+        for (size_type b = 0; b < nb_blocks; ++b) {
+          int edim = P.read_int(p), etag = P.read_int(p);
+          gmsh_cv_info ci;
+          ci.type = unsigned(P.read_int(p));
+          size_type n = P.read_size(p);
+          if (!P.binary) P.skip_lines(p, 1);
+          auto it = entity_region.find(std::make_pair(edim, etag));
+          ci.region = unsigned((it == entity_region.end())
+                               ? size_type(etag) : it->second);
+          ci.set_nb_nodes();
+          if (ci.type != 15) ci.set_pgt();
+          blocks.push_back(ci);
+          for (size_type k = 0; k < n; k += GMSH41_CHUNK) {
+            gmsh41_element_chunk c;
+            c.n = std::min(size_type(GMSH41_CHUNK), n - k);
+            c.first = first + k;
+            c.block = blocks.size() - 1;
+            c.p = p;
+            P.skip_entities(p, c.n, 1 + ci.nodes.size(), P.dsize);
+            element_chunks.push_back(c);
+          }
+          first += n;
+        }
+        GMM_ASSERT1(first == nb_elements, "Wrong number of elements");
+      }
+      P.skip_section(p, name);
+    }
+
+    standard_locale sl; // for strtod in the ASCII case
+    size_type nb_th = me_is_multithreaded_now()
+                    ? 1 : true_thread_policy::num_threads();
+    std::vector<size_type> node_tags(nb_nodes);
+    std::vector<scalar_type> node_coords(3*nb_nodes);
+    GETFEM_OMP_PARALLEL_NO_PARTITION(
+      size_type thn = (nb_th == 1) ? 0 : true_thread_policy::this_thread();
+      parse_gmsh41_nodes(P, node_chunks, (node_chunks.size() * thn) / nb_th,
+                         (node_chunks.size() * (thn+1)) / nb_th,
+                         node_tags, node_coords);
+    )
+
+    // Optional merge of the nodes having the same coordinates.
+    std::vector<size_type> rep(nb_nodes);
+    for (size_type i = 0; i < nb_nodes; ++i) rep[i] = i;
+    if (remove_duplicated_nodes && nb_nodes) {
+      std::vector<base_node> pts(nb_nodes, base_node(3));
+      for (size_type i = 0; i < nb_nodes; ++i)
+        std::copy(&node_coords[3*i], &node_coords[3*i]+3, pts[i].begin());
+      bgeot::node_tab ptab;
+      std::vector<size_type> ids; // ids[i] == i since ptab is empty.
+      ptab.add_nodes(pts, ids);
+      ptab.merge_duplicated_nodes(rep);
+    }
+
+    // Bulk insertion of the nodes, without search of duplicated nodes.
+    std::vector<size_type> node_index(nb_nodes);
+    base_node pt(3);
+    for (size_type i = 0; i < nb_nodes; ++i) {
+      if (rep[i] != i)
+        node_index[i] = node_index[rep[i]];
+      else {
+        std::copy(&node_coords[3*i], &node_coords[3*i]+3, pt.begin());
+        node_index[i] = m.add_point(pt, scalar_type(-1));
+      }
+    }
+    gmsh41_node_numbering numbering;
+    numbering.init(node_tags, node_index);
+
+    std::vector<gmsh_cv_info> cvlst(nb_elements);
+    GETFEM_OMP_PARALLEL_NO_PARTITION(
+      size_type the = (nb_th == 1) ? 0 : true_thread_policy::this_thread();
+      parse_gmsh41_elements(P, element_chunks,
+                            (element_chunks.size() * the) / nb_th,
+                            (element_chunks.size() * (the+1)) / nb_th,
+                            blocks, numbering, cvlst);
+    )
+
+    return add_gmsh_convexes(cvlst, m, lower_dim_convex_rg,
+                             add_all_element_type, nodal_map);
+  }
+
   /*
      Format version 1 [for gmsh version < 2.0].
      structure: $NOD list_of_nodes $ENDNOD $ELT list_of_elt $ENDELT
@@ -256,6 +860,15 @@ namespace getfem {
     else
       GMM_ASSERT1(false, "can't read Gmsh format: " << header);
 
+    if (version >= 4.05) { /* Format version 4.1 */
+      if (import_gmsh41_mesh_file(f, m, region_map, lower_dim_convex_rg,
+                                  add_all_element_type, nodal_map,
+                                  remove_duplicated_nodes)
+          && remove_last_dimension)
+        maybe_remove_last_dimension(m);
+      return;
+    }
+
     /* read the region names */
     if (region_map != NULL) {
       if (version >= 2.) {
@@ -269,9 +882,7 @@ namespace getfem {
     size_type nb_block, nb_node, dummy;
     std::string dummy2;
     // cout << "version = " << version << endl;
-    if (version >= 4.05) {
-      f >> nb_block >> nb_node; bgeot::read_until(f, "\n");
-    } else if (version >= 4.) {
+    if (version >= 4.) {
       f >> nb_block >> nb_node;
     } else {
       nb_block = 1;
@@ -280,24 +891,15 @@ namespace getfem {
 
     // cerr << "reading nodes..[nb=" << nb_node << "]\n";
     std::map<size_type, size_type> msh_node_2_getfem_node;
-     std::vector<size_type> inds(nb_node);
     for (size_type block=0; block < nb_block; ++block) {
       if (version >= 4.)
         f >> dummy >> dummy >> dummy >> nb_node;
       // cout << "nb_nodes = " << nb_node << endl;
 
-      inds.resize(nb_node);
-      if (version >= 4.05) {
-	for (size_type node_cnt=0; node_cnt < nb_node; ++node_cnt)
-	  f >> inds[node_cnt];
-      }
-      
       for (size_type node_cnt=0; node_cnt < nb_node; ++node_cnt) {
         size_type node_id;
         base_node n{0,0,0};
-	if (version < 4.05) f >> node_id; else node_id = inds[node_cnt];
-
-	f >> n[0] >> n[1] >> n[2];
+        f >> node_id >> n[0] >> n[1] >> n[2];
         msh_node_2_getfem_node[node_id]
           = m.add_point(n, remove_duplicated_nodes ? 0. : -1.);
       }
@@ -315,9 +917,7 @@ namespace getfem {
       bgeot::read_until(f, "$ELM");
 
     size_type nb_cv;
-    if (version >= 4.05) {
-      f >> nb_block >> nb_cv; bgeot::read_until(f, "\n");
-    } else if (version >= 4.) { /* Format version 4 */
+    if (version >= 4.) { /* Format version 4 */
       f >> nb_block >> nb_cv;
     } else {
       nb_block = 1;
@@ -374,253 +974,13 @@ namespace getfem {
         }
         if (ci.type != 15)
           ci.set_pgt();
-        // Reordering nodes for certain elements (should be completed ?)
-        // http://www.geuz.org/gmsh/doc/texinfo/gmsh.html#Node-ordering
-        std::vector<size_type> tmp_nodes(ci.nodes);
-        switch(ci.type) {
-        case 3 : {
-          ci.nodes[2] = tmp_nodes[3];
-          ci.nodes[3] = tmp_nodes[2];
-        } break;
-        case 5 : { /* First order hexaedron */
-          //ci.nodes[0] = tmp_nodes[0];
-          //ci.nodes[1] = tmp_nodes[1];
-          ci.nodes[2] = tmp_nodes[3];
-          ci.nodes[3] = tmp_nodes[2];
-          //ci.nodes[4] = tmp_nodes[4];
-          //ci.nodes[5] = tmp_nodes[5];
-          ci.nodes[6] = tmp_nodes[7];
-          ci.nodes[7] = tmp_nodes[6];
-        } break;
-        case 7 : { /* first order pyramid */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[2];
-          ci.nodes[2] = tmp_nodes[1];
-          // ci.nodes[3] = tmp_nodes[3];
-          // ci.nodes[4] = tmp_nodes[4];
-        } break;
-        case 8 : { /* Second order line */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[2];
-          ci.nodes[2] = tmp_nodes[1];
-        } break;
-        case 9 : { /* Second order triangle */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[3];
-          ci.nodes[2] = tmp_nodes[1];
-          ci.nodes[3] = tmp_nodes[5];
-          //ci.nodes[4] = tmp_nodes[4];
-          ci.nodes[5] = tmp_nodes[2];
-        } break;
-        case 10 : { /* Second order quadrangle */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[4];
-          ci.nodes[2] = tmp_nodes[1];
-          ci.nodes[3] = tmp_nodes[7];
-          ci.nodes[4] = tmp_nodes[8];
-          //ci.nodes[5] = tmp_nodes[5];
-          ci.nodes[6] = tmp_nodes[3];
-          ci.nodes[7] = tmp_nodes[6];
-          ci.nodes[8] = tmp_nodes[2];
-        } break;
-        case 11: { /* Second order tetrahedron */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[4];
-          ci.nodes[2] = tmp_nodes[1];
-          ci.nodes[3] = tmp_nodes[6];
-          ci.nodes[4] = tmp_nodes[5];
-          ci.nodes[5] = tmp_nodes[2];
-          ci.nodes[6] = tmp_nodes[7];
-          ci.nodes[7] = tmp_nodes[9];
-          //ci.nodes[8] = tmp_nodes[8];
-          ci.nodes[9] = tmp_nodes[3];
-        } break;
-        case 12: { /* Second order hexahedron */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[8];
-          ci.nodes[2] = tmp_nodes[1];
-          ci.nodes[3] = tmp_nodes[9];
-          ci.nodes[4] = tmp_nodes[20];
-          ci.nodes[5] = tmp_nodes[11];
-          ci.nodes[6] = tmp_nodes[3];
-          ci.nodes[7] = tmp_nodes[13];
-          ci.nodes[8] = tmp_nodes[2];
-          ci.nodes[9] = tmp_nodes[10];
-          ci.nodes[10] = tmp_nodes[21];
-          ci.nodes[11] = tmp_nodes[12];
-          ci.nodes[12] = tmp_nodes[22];
-          ci.nodes[13] = tmp_nodes[26];
-          ci.nodes[14] = tmp_nodes[23];
-          //ci.nodes[15] = tmp_nodes[15];
-          ci.nodes[16] = tmp_nodes[24];
-          ci.nodes[17] = tmp_nodes[14];
-          ci.nodes[18] = tmp_nodes[4];
-          ci.nodes[19] = tmp_nodes[16];
-          ci.nodes[20] = tmp_nodes[5];
-          ci.nodes[21] = tmp_nodes[17];
-          ci.nodes[22] = tmp_nodes[25];
-          ci.nodes[23] = tmp_nodes[18];
-          ci.nodes[24] = tmp_nodes[7];
-          ci.nodes[25] = tmp_nodes[19];
-          ci.nodes[26] = tmp_nodes[6];
-        } break;
-        case 16 : { /* Incomplete second order quadrangle */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[4];
-          ci.nodes[2] = tmp_nodes[1];
-          ci.nodes[3] = tmp_nodes[7];
-          ci.nodes[4] = tmp_nodes[5];
-          ci.nodes[5] = tmp_nodes[3];
-          ci.nodes[6] = tmp_nodes[6];
-          ci.nodes[7] = tmp_nodes[2];
-        } break;
-        case 17: { /* Incomplete second order hexahedron */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[8];
-          ci.nodes[2] = tmp_nodes[1];
-          ci.nodes[3] = tmp_nodes[9];
-          ci.nodes[4] = tmp_nodes[11];
-          ci.nodes[5] = tmp_nodes[3];
-          ci.nodes[6] = tmp_nodes[13];
-          ci.nodes[7] = tmp_nodes[2];
-          ci.nodes[8] = tmp_nodes[10];
-          ci.nodes[9] = tmp_nodes[12];
-          ci.nodes[10] = tmp_nodes[15];
-          ci.nodes[11] = tmp_nodes[14];
-          ci.nodes[12] = tmp_nodes[4];
-          ci.nodes[13] = tmp_nodes[16];
-          ci.nodes[14] = tmp_nodes[5];
-          ci.nodes[15] = tmp_nodes[17];
-          ci.nodes[16] = tmp_nodes[18];
-          ci.nodes[17] = tmp_nodes[7];
-          ci.nodes[18] = tmp_nodes[19];
-          ci.nodes[19] = tmp_nodes[6];
-        } break;
-        case 26 : { /* Third order line */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[2];
-          ci.nodes[2] = tmp_nodes[3];
-          ci.nodes[3] = tmp_nodes[1];
-        } break;
-        case 21 : { /* Third order triangle */
-          //ci.nodes[0] = tmp_nodes[0];
-          ci.nodes[1] = tmp_nodes[3];
-          ci.nodes[2] = tmp_nodes[4];
-          ci.nodes[3] = tmp_nodes[1];
-          ci.nodes[4] = tmp_nodes[8];
-          ci.nodes[5] = tmp_nodes[9];
-          ci.nodes[6] = tmp_nodes[5];
-          //ci.nodes[7] = tmp_nodes[7];
-          ci.nodes[8] = tmp_nodes[6];
-          ci.nodes[9] = tmp_nodes[2];
-        } break;
-        case 23: { /* Fourth order triangle */
-        //ci.nodes[0]  = tmp_nodes[0];
-          ci.nodes[1]  = tmp_nodes[3];
-          ci.nodes[2]  = tmp_nodes[4];
-          ci.nodes[3]  = tmp_nodes[5];
-          ci.nodes[4]  = tmp_nodes[1];
-          ci.nodes[5]  = tmp_nodes[11];
-          ci.nodes[6]  = tmp_nodes[12];
-          ci.nodes[7]  = tmp_nodes[13];
-          ci.nodes[8]  = tmp_nodes[6];
-          ci.nodes[9]  = tmp_nodes[10];
-          ci.nodes[10] = tmp_nodes[14];
-          ci.nodes[11] = tmp_nodes[7];
-          ci.nodes[12] = tmp_nodes[9];
-          ci.nodes[13] = tmp_nodes[8];
-          ci.nodes[14] = tmp_nodes[2];
-        } break;
-        case 27: { /* Fourth order line */
-        //ci.nodes[0]  = tmp_nodes[0];
-          ci.nodes[1]  = tmp_nodes[2];
-          ci.nodes[2]  = tmp_nodes[3];
-          ci.nodes[3]  = tmp_nodes[4];
-          ci.nodes[4]  = tmp_nodes[1];
-        } break;
-        }
+        ci.reorder_nodes();
       }
     }
 
-    nb_cv = cvlst.size();
-    if (cvlst.size()) {
-      std::sort(cvlst.begin(), cvlst.end());
-      if (cvlst.front().type == 15){
-        GMM_WARNING2("Only nodes defined in the mesh! No elements are added.");
-        return;
-      }
-
-      unsigned N = cvlst.front().pgt->dim();
-      for (size_type cv=0; cv < nb_cv; ++cv) {
-        bool cvok = false;
-        gmsh_cv_info &ci = cvlst[cv];
-        bool is_node = (ci.type == 15);
-        unsigned ci_dim = (is_node) ? 0 : ci.pgt->dim();
-        //cout << "importing cv dim=" << int(ci.pgt->dim()) << " N=" << N
-        //     << " region: " << ci.region << "\n";
-
-        //main convex import
-        if (ci_dim == N) {
-          size_type ic = m.add_convex(ci.pgt, ci.nodes.begin());
-          cvok = true;
-          m.region(ci.region).add(ic);
-
-        //convexes with lower dimensions
-        }
-        else {
-          //convex that lies within the regions of lower_dim_convex_rg
-          //is imported explicitly as a convex.
-          if (lower_dim_convex_rg != NULL &&
-              lower_dim_convex_rg->find(ci.region) != lower_dim_convex_rg->end() &&
-              !is_node){
-              size_type ic = m.add_convex(ci.pgt, ci.nodes.begin()); cvok = true;
-              m.region(ci.region).add(ic);
-          }
-          //find if the convex is part of a face of higher dimension convex
-          else{
-            bgeot::mesh_structure::ind_cv_ct ct = m.convex_to_point(ci.nodes[0]);
-            for (bgeot::mesh_structure::ind_cv_ct::const_iterator
-                   it = ct.begin(); it != ct.end(); ++it) {
-              for (short_type face=0;
-                   face < m.structure_of_convex(*it)->nb_faces(); ++face) {
-                if (m.is_convex_face_having_points(*it,face,
-                                                   short_type(ci.nodes.size()),
-                                                   ci.nodes.begin())) {
-                  m.region(ci.region).add(*it,face);
-                  cvok = true;
-                }
-              }
-            }
-            if (is_node && (nodal_map != NULL))
-            {
-              for (auto i : ci.nodes) (*nodal_map)[ci.region].insert(i);
-            }
-            //if the convex is not part of the face of others
-            if (!cvok)
-            {
-              if (is_node)
-              {
-                if (nodal_map == NULL){
-                  GMM_WARNING2("gmsh import ignored a node id: "
-                               << ci.id << " region :" << ci.region <<
-                               " point is not added explicitly as an element.");
-                }
-              }
-              else if (add_all_element_type){
-                size_type ic = m.add_convex(ci.pgt, ci.nodes.begin());
-                m.region(ci.region).add(ic);
-                cvok = true;
-              }
-              else{
-                GMM_WARNING2("gmsh import ignored an element of type "
-                  << bgeot::name_of_geometric_trans(ci.pgt) <<
-                  " as it does not belong to the face of another element");
-              }
-            }
-          }
-        }
-      }
-    }
+    if (!add_gmsh_convexes(cvlst, m, lower_dim_convex_rg,
+                           add_all_element_type, nodal_map))
+      return;
     if (remove_last_dimension) maybe_remove_last_dimension(m);
   }
 
@@ -1448,7 +1808,9 @@ namespace getfem {
       else if (bgeot::casecmp(format,"structured_ball_shell")==0)
         { regular_ball_shell_mesh(m, filename); return; }
 
-      std::ifstream f(filename.c_str());
+      std::ios::openmode mode = std::ios::in;
+      if (bgeot::casecmp(format,"gmsh")==0) mode |= std::ios::binary;
+      std::ifstream f(filename.c_str(), mode);
       GMM_ASSERT1(f.good(), "can't open file " << filename);
       /* throw exceptions when an error occurs */
       f.exceptions(std::ifstream::badbit | std::ifstream::failbit);
@@ -1502,7 +1864,8 @@ namespace getfem {
   {
     m.clear();
     try {
-      std::ifstream f(filename.c_str());
+      /* binary mode for the binary MSH 4.1 files */
+      std::ifstream f(filename.c_str(), std::ios::in | std::ios::binary);
       GMM_ASSERT1(f.good(), "can't open file " << filename);
       /* throw exceptions when an error occurs */
       f.exceptions(std::ifstream::badbit | std::ifstream::failbit);
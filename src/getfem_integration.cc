@@ -1316,6 +1316,44 @@ namespace getfem {
     return bgeot::to_scalar(error);
   }
 
+  int approx_im_exactness_degree(papprox_integration pim, int max_degree) {
+    /* The cache does not keep the methods alive: an entry whose method
+       has been destroyed is ignored, and removed at the next insertion. */
+    using weak_approx_im = std::weak_ptr<const approx_integration>;
+    THREAD_SAFE_STATIC
+      std::map<std::pair<const approx_integration *, int>,
+               std::pair<weak_approx_im, int>> degrees;
+    auto key = std::make_pair(pim.get(), max_degree);
+    auto it = degrees.find(key);
+    if (it != degrees.end() && it->second.first.lock() == pim)
+      return it->second.second;
+
+    short_type dim = pim->dim();
+    pintegration_method exact = classical_exact_im(pim->structure());
+    int degree = max_degree;
+    for (bgeot::power_index idx(dim); int(idx.degree()) <= max_degree; ++idx){
+      opt_long_scalar_type sum(0), asum(0), realsum;
+      for (size_type i=0; i < pim->nb_points_on_convex(); ++i) {
+        opt_long_scalar_type prod = pim->coeff(i);
+        for (size_type d=0; d < dim; ++d)
+          prod *= pow(opt_long_scalar_type(pim->point(i)[d]), idx[d]);
+        sum += prod; asum += gmm::abs(prod);
+      }
+      realsum = exact->exact_method()->int_monomial(idx);
+      // the tolerance is relative to the size of the terms of the sum, the
+      // integral of high degree monomials being very small.
+      if (gmm::abs(realsum-sum) > opt_long_scalar_type(1E-10)
+                                  * (gmm::abs(realsum) + asum)) {
+        degree = int(idx.degree()) - 1;
+        break;
+      }
+    }
+    for (auto itd = degrees.begin(); itd != degrees.end(); )
+      if (itd->second.first.expired()) itd = degrees.erase(itd); else ++itd;
+    degrees[key] = std::make_pair(weak_approx_im(pim), degree);
+    return degree;
+  }
+
   papprox_integration get_approx_im_or_fail(pintegration_method pim) {
     GMM_ASSERT1(pim->type() == IM_APPROX,  "error estimate work only with "
                 "approximate integration methods");
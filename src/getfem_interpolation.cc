@@ -49,6 +49,14 @@ namespace getfem {
     return *it;
   }
 
+  /* Candidate location of a point in a convex, computed in parallel
+     and merged afterwards in the increasing order of the convexes. */
+  struct point_location_candidate {
+    size_type ind, cv;
+    scalar_type isin;
+    base_node pt_ref;
+  };
+
   void mesh_trans_inv::distribute(int extrapolation, mesh_region rg_source) {
 
     rg_source.from_mesh(msh);
@@ -61,70 +69,114 @@ namespace getfem {
     std::vector<double> dist(nbpts);
     std::vector<size_type> cvx_pts(nbpts);
     pts_cvx.clear(); pts_cvx.resize(nbcvx);
-    base_node min, max, pt_ref; /* bound of the box enclosing the convex */
-    bgeot::kdtree_tab_type boxpts;
     dal::bit_vector npt, cv_on_bound;
     npt.add(0, nbpts);
     scalar_type mult = scalar_type(1);
 
     bool projection_into_element(extrapolation == 0);
 
+    std::vector<size_type> cvlst;
+    for (dal::bv_visitor j(rg_source.index()); !j.finished(); ++j) {
+      cvlst.push_back(j);
+      if (extrapolation == 2)
+        for (short_type f = 0; f < msh.nb_faces_of_convex(j); ++f) {
+          size_type neighbour_cv = msh.neighbour_of_convex(j, f);
+          if (!all_convexes && neighbour_cv != size_type(-1)) {
+            // check if the neighbour is also contained in rg_source ...
+            if (!rg_source.is_in(neighbour_cv))
+              cv_on_bound.add(j); // ... if not, treat the element as a boundary one
+          }
+          else // boundary element of the overall mesh
+            cv_on_bound.add(j);
+        }
+    }
+
+    // The tree has to be built before the concurrent queries.
+    tree.build_tree();
+    size_type nb_th = me_is_multithreaded_now()
+                    ? 1 : true_thread_policy::num_threads();
+    std::vector<std::vector<point_location_candidate>> candidates(nb_th);
+
     do {
-      for (dal::bv_visitor j(rg_source.index()); !j.finished(); ++j) {
-        if (mult > scalar_type(1) && !(cv_on_bound.is_in(j))) continue;
-        bgeot::pgeometric_trans pgt = msh.trans_of_convex(j);
-        bounding_box(min, max, msh.points_of_convex(j), pgt);
-        for (size_type k=0; k < min.size(); ++k) { min[k]-=EPS; max[k]+=EPS; }
-        if (extrapolation == 2) {
-          if (mult == scalar_type(1))
-            for (short_type f = 0; f < msh.nb_faces_of_convex(j); ++f) {
-              size_type neighbour_cv = msh.neighbour_of_convex(j, f);
-              if (!all_convexes && neighbour_cv != size_type(-1)) {
-                // check if the neighbour is also contained in rg_source ...
-                if (!rg_source.is_in(neighbour_cv)) 
-                  cv_on_bound.add(j); // ... if not, treat the element as a boundary one
-              }
-              else // boundary element of the overall mesh
-                cv_on_bound.add(j);
-            }
-          if (cv_on_bound.is_in(j)) {
+      // The convexes are shared in contiguous slices between the threads.
+      // Each thread inverts the geometric transformation of its convexes
+      // for all the points in their bounding boxes, reusing the
+      // initialisation of geotrans_inv_convex for all the points of a
+      // convex.
+      GETFEM_OMP_PARALLEL_NO_PARTITION(
+        size_type th = (nb_th == 1) ? 0 : true_thread_policy::this_thread();
+        std::vector<point_location_candidate> &cand = candidates[th];
+        cand.resize(0);
+        bgeot::geotrans_inv_convex gic_th;
+        bgeot::kdtree_tab_type boxpts;
+        bgeot::kdtree_tab_type inv_pts;
+        std::vector<base_node> pts_ref;
+        std::vector<bool> in_cv;
+        std::vector<bool> converged;
+        base_node min; /* bound of the box enclosing the convex */
+        base_node max;
+        dal::bit_vector located; // points found inside a previous convex
+        size_type i0 = (cvlst.size() * th) / nb_th;
+        size_type i1 = (cvlst.size() * (th+1)) / nb_th;
+        for (size_type i = i0; i < i1; ++i) {
+          size_type j = cvlst[i];
+          if (mult > scalar_type(1) && !(cv_on_bound.is_in(j))) continue;
+          bgeot::pgeometric_trans pgt = msh.trans_of_convex(j);
+          bounding_box(min, max, msh.points_of_convex(j), pgt);
+          for (size_type k=0; k < min.size(); ++k) { min[k]-=EPS; max[k]+=EPS; }
+          if (extrapolation == 2 && cv_on_bound.is_in(j)) {
             scalar_type h = scalar_type(0);
             for (size_type k=0; k < min.size(); ++k)
               h = std::max(h, max[k] - min[k]);
             for (size_type k=0; k < min.size(); ++k)
               { min[k]-=mult*h; max[k]+=mult*h; }
           }
+          tree.points_in_box(boxpts, min, max);
+
+          // The points still to be located are inverted all at once.
+          inv_pts.resize(0);
+          for (size_type l = 0; l < boxpts.size(); ++l) {
+            size_type ind = boxpts[l].i;
+            if ((npt[ind] || dist[ind] > 0) && !located.is_in(ind))
+              inv_pts.push_back(boxpts[l]);
+          }
+          if (inv_pts.empty()) continue;
+          gic_th.init(msh.points_of_convex(j), pgt);
+          gic_th.invert_points(inv_pts, pts_ref, in_cv, converged, EPS,
+                               projection_into_element);
+
+          for (size_type l = 0; l < inv_pts.size(); ++l) {
+            if (!(extrapolation || in_cv[l])) continue;
+            point_location_candidate c;
+            c.pt_ref = pts_ref[l];
+            c.isin = pgt->convex_ref()->is_in(c.pt_ref);
+            c.ind = inv_pts[l].i; c.cv = j;
+            if (c.isin <= scalar_type(0)) located.add(c.ind);
+            cand.push_back(c);
+          }
         }
-        points_in_box(boxpts, min, max);
-
-        if (boxpts.size() > 0) gic.init(msh.points_of_convex(j), pgt);
-        
-        for (size_type l = 0; l < boxpts.size(); ++l) {
-          size_type ind = boxpts[l].i;
+      )
+
+      // Merge of the candidates, in the same order as a serial loop on
+      // the convexes, so that the result does not depend on the number
+      // of threads.
+      for (size_type ith = 0; ith < nb_th; ++ith)
+        for (point_location_candidate &c : candidates[ith]) {
+          size_type ind = c.ind;
           if (npt[ind] || dist[ind] > 0) {
-            bool converged;
-            bool gicisin = gic.invert(boxpts[l].n, pt_ref, converged, EPS,
-                                      projection_into_element);
-            bool toadd = extrapolation || gicisin;
-            double isin = pgt->convex_ref()->is_in(pt_ref);
-            
-            if (toadd && !(npt[ind])) {
-              if (isin < dist[ind]) pts_cvx[cvx_pts[ind]].erase(ind);
+            bool toadd = true;
+            if (!(npt[ind])) {
+              if (c.isin < dist[ind]) pts_cvx[cvx_pts[ind]].erase(ind);
               else toadd = false;
             }
             if (toadd) {
-//               if (mult > 1.5) {
-//                 cout << "adding " << ind << "ref_coord = " << pt_ref
-//                      << " cv = " << j << " mult = " << mult << endl;
-//               }
-              ref_coords[ind] = pt_ref;
-              dist[ind] = isin; cvx_pts[ind] = j;
-              pts_cvx[j].insert(ind);
+              ref_coords[ind] = c.pt_ref;
+              dist[ind] = c.isin; cvx_pts[ind] = c.cv;
+              pts_cvx[c.cv].insert(ind);
               npt.sup(ind);
             }
           }
         }
-      }
       mult *= scalar_type(2);
     } while (npt.card() > 0 && extrapolation == 2);
   }
@@ -21,6 +21,7 @@
 
 #include "getfem/getfem_generic_assembly.h"
 #include "getfem/getfem_models.h"
+#include "getfem/bgeot_bvh.h"
 
 namespace getfem {
 
@@ -47,7 +48,8 @@ base_small_vector element_U(const contact_boundary &cb, size_type cv)
 }
 
 //Returns an iterator of a box which centre is closest to the given point
-auto most_central_box(const bgeot::rtree::pbox_set &bset,
+auto most_central_box(const bgeot::box_bvh          &boxes,
+                      const std::vector<size_type> &bset,
                       const bgeot::base_node       &pt) -> decltype(begin(bset))
 {
   using namespace std;
@@ -60,9 +62,10 @@ auto most_central_box(const bgeot::rtree::pbox_set &bset,
     for (; it != end(bset); ++it) {
       auto rate_box = scalar_type{1};
       for (size_type i = 0; i < pt.size(); ++i) {
-        auto h = (*it)->max->at(i) - (*it)->min->at(i);
+        auto bmin = boxes.box_min(*it), bmax = boxes.box_max(*it);
+        auto h = bmax[i] - bmin[i];
         if (h > 0.) {
-          auto rate = min((*it)->max->at(i) - pt[i], pt[i] - (*it)->min->at(i)) / h;
+          auto rate = min(bmax[i] - pt[i], pt[i] - bmin[i]) / h;
           rate_box = min(rate, rate_box);
         }
       }
@@ -84,7 +87,7 @@ class  interpolate_transformation_on_deformed_domains
   contact_boundary master;//also marked with a target or Y prefix/suffix
   contact_boundary slave; //also marked with a source or X prefix/suffix
 
-  mutable bgeot::rtree element_boxes;
+  mutable bgeot::box_bvh element_boxes;
   mutable std::map<size_type, std::vector<size_type>> box_to_convex; //index to obtain a convex
                                                                      //number from a box number
   mutable bgeot::geotrans_inv_convex gic;
@@ -94,7 +97,7 @@ class  interpolate_transformation_on_deformed_domains
   void compute_element_boxes() const { // called by init
     base_matrix G;
     model_real_plain_vector Uelm; //element displacement
-    element_boxes.clear();
+    element_boxes.clear_boxes_only();
 
     auto bnum = master.region;
     auto &mfu = *(master.mfu);
@@ -155,7 +158,9 @@ class  interpolate_transformation_on_deformed_domains
       // Store the bounding box and additional information.
       box_to_convex[element_boxes.add_box(bmin, bmax)].push_back(cv);
     }
-    element_boxes.build_tree();
+    //the deformation between two calls is usually small, the topology
+    //of the tree is kept and only the boxes are updated
+    element_boxes.update_tree();
   }
 
   fem_interpolation_context deformed_master_context(size_type cv) const
@@ -240,7 +245,7 @@ public:
   };
 
   void finalize() const override {
-    element_boxes.clear();
+    element_boxes.clear_boxes_only();
     box_to_convex.clear();
     master.U_unred.clear();
     slave.U_unred.clear();
@@ -287,13 +292,13 @@ public:
     //indices. Compute deformed nodes of the target element. Invert the geometric
     //transformation of the target element with deformed nodes, obtaining this way
     //reference coordinates of the target element
-    auto bset = rtree::pbox_set{};
+    auto bset = std::vector<size_type>{};
     element_boxes.find_boxes_at_point(pt_x, bset);
     while (!bset.empty())
     {
-      auto itmax = most_central_box(bset, pt_x);
+      auto itmax = most_central_box(element_boxes, bset, pt_x);
 
-      for (auto i : box_to_convex.at((*itmax)->id))
+      for (auto i : box_to_convex.at(*itmax))
       {
         auto deformed_nodes_y = deformed_master_nodes(i);
         gic.init(deformed_nodes_y, target_mesh.trans_of_convex(i));
@@ -24,6 +24,7 @@
 #include "gmm/gmm_condition_number.h"
 #include "getfem/getfem_mesh.h"
 #include "getfem/getfem_integration.h"
+#include "getfem/getfem_binary_io.h"
 
 #if GETFEM_HAVE_METIS_OLD_API
 extern "C" void METIS_PartGraphKway(int *, int *, int *, int *, int *, int *,
@@ -157,12 +158,13 @@ namespace getfem {
       mpi_region = mesh_region::all_convexes();
       mpi_region.from_mesh(*this);
     } else {
+      double t_ref = MPI_Wtime();
+
+#if GETFEM_HAVE_METIS_OLD_API || GETFEM_HAVE_METIS
       int ne = int(nb_convex());
       std::vector<int> xadj(ne+1), adjncy, numelt(ne), npart(ne);
       std::vector<int> indelt(nb_allocated_convex());
 
-      double t_ref = MPI_Wtime();
-
       int j = 0, k = 0;
       ind_set s;
       for (dal::bv_visitor ic(convex_index()); !ic.finished(); ++ic, ++j) {
@@ -178,21 +180,43 @@ namespace getfem {
       }
       xadj[j] = k;
 
+      // integer weights of the convexes, if their costs are given
+      std::vector<int> vwgt;
+      int *pvwgt = 0;
+      if (!cvs_weights.empty()) {
+        scalar_type wmax(0);
+        for (j = 0; j < ne; ++j)
+          wmax = std::max(wmax, convex_weight(size_type(numelt[j])));
+        vwgt.resize(ne);
+        for (j = 0; j < ne; ++j)
+          vwgt[j] = 1 + int(scalar_type(1000)
+                            * convex_weight(size_type(numelt[j]))
+                            / std::max(wmax, scalar_type(1E-300)));
+        pvwgt = &(vwgt[0]);
+      }
+
 #ifdef GETFEM_HAVE_METIS_OLD_API
-      int wgtflag = 0, numflag = 0, edgecut;
+      int wgtflag = pvwgt ? 2 : 0, numflag = 0, edgecut;
       int options[5] = {0,0,0,0,0};
-      METIS_PartGraphKway(&ne, &(xadj[0]), &(adjncy[0]), 0, 0, &wgtflag,
+      METIS_PartGraphKway(&ne, &(xadj[0]), &(adjncy[0]), pvwgt, 0, &wgtflag,
                           &numflag, &size, options, &edgecut, &(npart[0]));
 #else
       int ncon = 1, edgecut;
       int options[METIS_NOPTIONS] = { 0 };
       METIS_SetDefaultOptions(options);
-      METIS_PartGraphKway(&ne, &ncon, &(xadj[0]), &(adjncy[0]), 0, 0, 0,
+      METIS_PartGraphKway(&ne, &ncon, &(xadj[0]), &(adjncy[0]), pvwgt, 0, 0,
                           &size, 0, 0, options, &edgecut, &(npart[0]));
 #endif
 
       for (size_type i = 0; i < size_type(ne); ++i)
         if (npart[i] == rank) mpi_region.add(numelt[i]);
+#else
+      // Without METIS, the partition follows a space filling curve
+      std::vector<size_type> part;
+      space_filling_curve_partition(*this, size_type(size), part);
+      for (dal::bv_visitor ic(convex_index()); !ic.finished(); ++ic)
+        if (part[ic] == size_type(rank)) mpi_region.add(ic);
+#endif
 
       if (MPI_IS_MASTER())
         cout << "Partition time "<< MPI_Wtime()-t_ref << endl;
@@ -220,9 +244,26 @@ namespace getfem {
   }
 #endif
 
+  /* Apply the renumbering ord (ord[i] being the old index of the new
+     index i) with swaps. */
+  template <typename SWAP>
+  static void apply_permutation(const std::vector<size_type> &ord, SWAP swp) {
+    size_type n = ord.size();
+    std::vector<size_type> iord(n), iordinv(n);
+    for (size_type i = 0; i < n; ++i) iord[i] = iordinv[i] = i;
+    for (size_type i = 0; i < n; ++i) {
+      size_type j = iordinv[ord[i]];
+      if (i != j) {
+        swp(i, j);
+        std::swap(iord[i], iord[j]);
+        std::swap(iordinv[iord[i]], iordinv[iord[j]]);
+      }
+    }
+  }
+
   void mesh::optimize_structure(bool with_renumbering) {
     pts.resort();
-    size_type i, j = nb_convex(), nbc = j;
+    size_type i, j = nb_convex();
     for (i = 0; i < j; i++)
       if (!convex_tab.index_valid(i))
         swap_convex(i, convex_tab.ind_last());
@@ -234,19 +275,112 @@ namespace getfem {
         if (i < j && j != ST_NIL ) swap_points(i, j);
       }
     if (with_renumbering) { // Could be optimized no using only swap_convex
-      std::vector<size_type> cmk, iord(nbc), iordinv(nbc);
-      for (i = 0; i < nbc; ++i) iord[i] = iordinv[i] = i;
-
+      std::vector<size_type> cmk;
       bgeot::cuthill_mckee_on_convexes(*this, cmk);
-      for (i = 0; i < nbc; ++i) {
-        j = iordinv[cmk[i]];
-        if (i != j) {
-          swap_convex(i, j);
-          std::swap(iord[i], iord[j]);
-          std::swap(iordinv[iord[i]], iordinv[iord[j]]);
-        }
+      apply_permutation(cmk, [this](size_type i1, size_type i2)
+                        { swap_convex(i1, i2); });
+    }
+  }
+
+  void mesh::renumber_along_curve(bool hilbert) {
+    optimize_structure(false);
+    std::vector<size_type> ord;
+    space_filling_curve_ordering(*this, ord, hilbert);
+    apply_permutation(ord, [this](size_type i, size_type j)
+                      { swap_convex(i, j); });
+
+    ord.resize(0);
+    dal::bit_vector seen;
+    for (size_type cv = 0; cv < nb_convex(); ++cv)
+      for (size_type ip : ind_points_of_convex(cv))
+        if (!seen.is_in(ip)) { seen.add(ip); ord.push_back(ip); }
+    for (dal::bv_visitor ip(pts.index()); !ip.finished(); ++ip)
+      if (!seen.is_in(ip)) ord.push_back(ip);
+    apply_permutation(ord, [this](size_type i, size_type j)
+                      { swap_points(i, j); });
+    touch();
+  }
+
+  /* Position along a Hilbert curve (J. Skilling's algorithm, "Programming
+     the Hilbert curve", 2004) or a Morton curve of the point of integer
+     coordinates X[0..n-1] of b bits each. */
+  static gmm::uint64_type curve_key(gmm::uint64_type X[3], unsigned n,
+                                    unsigned b, bool hilbert) {
+    if (hilbert && n > 1) {
+      gmm::uint64_type M = gmm::uint64_type(1) << (b-1), P, Q, t;
+      for (Q = M; Q > 1; Q >>= 1) {
+        P = Q - 1;
+        for (unsigned i = 0; i < n; ++i)
+          if (X[i] & Q) X[0] ^= P;
+          else { t = (X[0] ^ X[i]) & P; X[0] ^= t; X[i] ^= t; }
+      }
+      for (unsigned i = 1; i < n; ++i) X[i] ^= X[i-1];
+      t = 0;
+      for (Q = M; Q > 1; Q >>= 1) if (X[n-1] & Q) t ^= Q - 1;
+      for (unsigned i = 0; i < n; ++i) X[i] ^= t;
+    }
+    gmm::uint64_type key = 0;
+    for (unsigned j = b; j-- > 0; )
+      for (unsigned i = 0; i < n; ++i) key = (key << 1) | ((X[i] >> j) & 1);
+    return key;
+  }
+
+  void space_filling_curve_ordering(const mesh &m,
+                                    std::vector<size_type> &order,
+                                    bool hilbert) {
+    const dal::bit_vector &cvs = m.convex_index();
+    unsigned n = unsigned(std::min(size_type(m.dim()), size_type(3)));
+    unsigned b = (n == 0) ? 1 : 63 / n;
+    std::vector<scalar_type> centers(cvs.card() * n, 0.);
+    std::vector<scalar_type> cmin(n, 0.), cmax(n, 0.);
+    size_type k = 0;
+    for (dal::bv_visitor cv(cvs); !cv.finished(); ++cv, ++k) {
+      const mesh::ind_cv_ct &ipts = m.ind_points_of_convex(cv);
+      for (size_type ip : ipts)
+        for (unsigned i = 0; i < n; ++i) centers[k*n+i] += m.points()[ip][i];
+      for (unsigned i = 0; i < n; ++i) {
+        scalar_type &c = centers[k*n+i];
+        c /= scalar_type(ipts.size());
+        if (k == 0 || c < cmin[i]) cmin[i] = c;
+        if (k == 0 || c > cmax[i]) cmax[i] = c;
       }
     }
+
+    std::vector<std::pair<gmm::uint64_type, size_type> > keys(k);
+    scalar_type maxc = scalar_type((gmm::uint64_type(1) << b) - 1);
+    k = 0;
+    for (dal::bv_visitor cv(cvs); !cv.finished(); ++cv, ++k) {
+      gmm::uint64_type X[3];
+      for (unsigned i = 0; i < n; ++i) {
+        scalar_type l = cmax[i] - cmin[i];
+        X[i] = (l > 0.) ? gmm::uint64_type((centers[k*n+i]-cmin[i])/l * maxc)
+                        : 0;
+      }
+      keys[k] = std::make_pair(curve_key(X, n, b, hilbert), size_type(cv));
+    }
+    std::sort(keys.begin(), keys.end());
+    order.resize(keys.size());
+    for (k = 0; k < keys.size(); ++k) order[k] = keys[k].second;
+  }
+
+  void space_filling_curve_partition(const mesh &m, size_type nb_parts,
+                                     std::vector<size_type> &part,
+                                     bool hilbert) {
+    GMM_ASSERT1(nb_parts > 0, "Wrong number of parts");
+    std::vector<size_type> order;
+    space_filling_curve_ordering(m, order, hilbert);
+    part.assign(m.nb_allocated_convex(), size_type(-1));
+    scalar_type total(0), cumul(0);
+    for (size_type cv : order) total += m.convex_weight(cv);
+    for (size_type k = 0; k < order.size(); ++k) {
+      // a convex goes to the part containing the middle of its weight
+      scalar_type w = m.convex_weight(order[k]);
+      size_type i = (total > scalar_type(0))
+        ? size_type((cumul + w/scalar_type(2)) * scalar_type(nb_parts) / total)
+        : (k * nb_parts) / order.size();
+      part[order[k]] = std::min(i, nb_parts - 1);
+      cumul += w;
+    }
   }
 
   void mesh::translation(const base_small_vector &V)
@@ -275,7 +409,7 @@ namespace getfem {
     pts.clear();
     gtab.clear(); trans_exists.clear();
     cvf_sets.clear(); valid_cvf_sets.clear();
-    cvs_v_num.clear();
+    cvs_v_num.clear(); cvs_weights.clear();
     Bank_info = nullptr;
     touch();
   }
@@ -376,6 +510,11 @@ namespace getfem {
       trans_exists.swap(i, j);
       gtab.swap(i,j);
       swap_convex_in_regions(i, j);
+      if (!cvs_weights.empty()) {
+        size_type n = std::max(i, j) + 1;
+        if (cvs_weights.size() < n) cvs_weights.resize(n, scalar_type(1));
+        std::swap(cvs_weights[i], cvs_weights[j]);
+      }
       if (Bank_info.get()) Bank_swap_convex(i,j);
       cvs_v_num[i] = cvs_v_num[j] = act_counter(); touch();
     }
@@ -494,6 +633,7 @@ namespace getfem {
       cvf_sets[kv.first] = kv.second;
     }
     valid_cvf_sets = m.valid_cvf_sets;
+    cvs_weights = m.cvs_weights;
     cvs_v_num.clear();
     gmm::uint64_type d = act_counter();
     for (dal::bv_visitor i(convex_index()); !i.finished(); ++i)
@@ -715,6 +855,157 @@ namespace getfem {
     o.close();
   }
 
+  void mesh::write_to_binary(binary_ofile &f,
+                             const std::string &prefix) const {
+    std::vector<binary_index_type> ids;
+    std::vector<scalar_type> coords;
+    for (size_type i = 0; i < points_tab.size(); ++i)
+      if (is_point_valid(i)) {
+        ids.push_back(i);
+        coords.insert(coords.end(), pts[i].begin(), pts[i].end());
+      }
+    f.add_section(prefix + ".point_ids", ids);
+    f.add_section(prefix + ".point_coords", coords);
+
+    std::vector<bgeot::pgeometric_trans> gts;
+    std::map<bgeot::pgeometric_trans, size_type> gt_num;
+    std::vector<std::vector<binary_index_type> > cv_ids, cv_pts;
+    for (dal::bv_visitor cv(convex_index()); !cv.finished(); ++cv) {
+      bgeot::pgeometric_trans pgt = trans_of_convex(cv);
+      auto it = gt_num.find(pgt);
+      size_type k = (it == gt_num.end()) ? gts.size() : it->second;
+      if (k == gts.size()) {
+        gt_num[pgt] = k; gts.push_back(pgt);
+        cv_ids.resize(k+1); cv_pts.resize(k+1);
+      }
+      cv_ids[k].push_back(cv);
+      const ind_set &ct = ind_points_of_convex(cv);
+      cv_pts[k].insert(cv_pts[k].end(), ct.begin(), ct.end());
+    }
+    std::vector<std::string> gt_names;
+    for (size_type k = 0; k < gts.size(); ++k) {
+      gt_names.push_back(bgeot::name_of_geometric_trans(gts[k]));
+      f.add_section(prefix + ".gt" + std::to_string(k) + ".convex_ids",
+                    cv_ids[k]);
+      f.add_section(prefix + ".gt" + std::to_string(k) + ".convex_points",
+                    cv_pts[k]);
+    }
+    f.add_string_section(prefix + ".gt_names", gt_names);
+
+    std::vector<binary_index_type> rg_ids;
+    for (dal::bv_visitor bnum(valid_cvf_sets); !bnum.finished(); ++bnum) {
+      rg_ids.push_back(bnum);
+      std::vector<binary_index_type> elts;
+      for (mr_visitor i(region(bnum)); !i.finished(); ++i) {
+        elts.push_back(i.cv());
+        elts.push_back(i.is_face() ? binary_index_type(i.f())
+                                   : binary_index_type(-1));
+      }
+      f.add_section(prefix + ".region" + std::to_string(bnum), elts);
+    }
+    f.add_section(prefix + ".region_ids", rg_ids);
+
+    binary_index_type info[2] = { dim(), gts.size() };
+    f.add_section(prefix + ".info", info, sizeof(info));
+  }
+
+  void mesh::read_from_binary(const binary_ifile &f, const std::string &prefix,
+                              size_type rg) {
+    clear();
+    size_type n, nbpt, nbc, nbr;
+    const binary_index_type *info
+      = f.section<binary_index_type>(prefix + ".info", n);
+    GMM_ASSERT1(n >= 2, "Wrong mesh header in binary file");
+    size_type N = size_type(info[0]), nbgt = size_type(info[1]);
+    std::vector<std::string> gt_names = f.string_section(prefix + ".gt_names");
+    GMM_ASSERT1(gt_names.size() == nbgt, "Wrong mesh header in binary file");
+    std::vector<bgeot::pgeometric_trans> gts(nbgt);
+    for (size_type k = 0; k < nbgt; ++k)
+      gts[k] = bgeot::geometric_trans_descriptor(gt_names[k]);
+
+    // For a partial load, selection of the convexes and their points.
+    bool partial = (rg != size_type(-1));
+    dal::bit_vector sel_cv, sel_pt;
+    if (partial) {
+      const binary_index_type *elts = f.section<binary_index_type>
+        (prefix + ".region" + std::to_string(rg), n);
+      for (size_type i = 0; i+1 < n; i += 2) sel_cv.add(size_type(elts[i]));
+      for (size_type k = 0; k < nbgt; ++k) {
+        std::string gtp = prefix + ".gt" + std::to_string(k);
+        const binary_index_type *ids
+          = f.section<binary_index_type>(gtp + ".convex_ids", nbc);
+        const binary_index_type *ipts
+          = f.section<binary_index_type>(gtp + ".convex_points", n);
+        size_type nb = gts[k]->nb_points();
+        for (size_type j = 0; j < nbc; ++j)
+          if (sel_cv.is_in(size_type(ids[j])))
+            for (size_type l = 0; l < nb; ++l)
+              sel_pt.add(size_type(ipts[j*nb+l]));
+      }
+    }
+
+    // The points are added without search of duplicated points, keeping
+    // the indices of the file.
+    const binary_index_type *pt_ids
+      = f.section<binary_index_type>(prefix + ".point_ids", nbpt);
+    const scalar_type *coords
+      = f.section<scalar_type>(prefix + ".point_coords", n);
+    GMM_ASSERT1(n == nbpt * N, "Wrong number of point coordinates");
+    base_node P(N);
+    for (size_type i = 0; i < nbpt; ++i) {
+      size_type ip = size_type(pt_ids[i]);
+      if (partial && !sel_pt.is_in(ip)) continue;
+      std::copy(coords + i*N, coords + (i+1)*N, P.begin());
+      size_type ipl = add_point(P, scalar_type(-1));
+      if (ipl != ip) swap_points(ipl, ip);
+    }
+
+    std::vector<size_type> ipt;
+    for (size_type k = 0; k < nbgt; ++k) {
+      std::string gtp = prefix + ".gt" + std::to_string(k);
+      const binary_index_type *ids
+        = f.section<binary_index_type>(gtp + ".convex_ids", nbc);
+      const binary_index_type *ipts
+        = f.section<binary_index_type>(gtp + ".convex_points", n);
+      size_type nb = gts[k]->nb_points();
+      GMM_ASSERT1(n == nbc * nb, "Wrong number of convex points");
+      ipt.resize(nb);
+      for (size_type j = 0; j < nbc; ++j) {
+        size_type ic = size_type(ids[j]);
+        if (partial && !sel_cv.is_in(ic)) continue;
+        for (size_type l = 0; l < nb; ++l) ipt[l] = size_type(ipts[j*nb+l]);
+        size_type i = add_convex(gts[k], ipt.begin());
+        if (i != ic) swap_convex(i, ic);
+      }
+    }
+
+    const binary_index_type *rg_ids
+      = f.section<binary_index_type>(prefix + ".region_ids", nbr);
+    for (size_type r = 0; r < nbr; ++r) {
+      size_type bnum = size_type(rg_ids[r]);
+      const binary_index_type *elts = f.section<binary_index_type>
+        (prefix + ".region" + std::to_string(bnum), n);
+      mesh_region &mr = region(bnum);
+      for (size_type i = 0; i+1 < n; i += 2) {
+        size_type ic = size_type(elts[i]);
+        if (partial && !sel_cv.is_in(ic)) continue;
+        if (elts[i+1] == binary_index_type(-1)) mr.add(ic);
+        else mr.add(ic, short_type(elts[i+1]));
+      }
+    }
+  }
+
+  void mesh::write_to_binary_file(const std::string &name) const {
+    binary_ofile f(name);
+    write_to_binary(f);
+    f.close();
+  }
+
+  void mesh::read_from_binary_file(const std::string &name, size_type rg) {
+    binary_ifile f(name);
+    read_from_binary(f, "mesh", rg);
+  }
+
   size_type mesh::memsize(void) const {
     return bgeot::mesh_structure::memsize() - sizeof(bgeot::mesh_structure)
       + pts.memsize() + (pts.index().last_true()+1)*dim()*sizeof(scalar_type)
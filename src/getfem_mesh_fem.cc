@@ -24,6 +24,7 @@
 #include "getfem/dal_singleton.h"
 #include "getfem/getfem_mesh_fem.h"
 #include "getfem/getfem_torus.h"
+#include "getfem/getfem_binary_io.h"
 
 namespace getfem {
 
@@ -273,23 +274,6 @@ namespace getfem {
     GMM_ASSERT1(false, "Inexistent dof");
   }
 
-  struct fem_dof {
-    size_type ind_node;
-    pdof_description pnd;
-    size_type part;
-  };
-
-  struct dof_comp_ {
-    bool operator()(const fem_dof& m, const fem_dof& n) const {
-      if (m.ind_node < n.ind_node) return true;
-      if (m.ind_node > n.ind_node) return false;
-      if (m.part == n.part)
-        return dof_description_compare(m.pnd, n.pnd) < 0;
-      else if (m.part < n.part) return true;
-      else /*if (m.part > n.part)*/ return false;
-    }
-  };
-
   void mesh_fem::get_global_dof_index(std::vector<size_type> &ind) const {
     context_check(); if (!dof_enumeration_made) enumerate_dof();
     ind.resize(nb_total_dof);
@@ -317,9 +301,64 @@ namespace getfem {
     return is_uniformly_vectorized_;
   }
 
+  /* The linkable dofs of an element are identified with the dofs of its
+     neighbours having the same type, the same partition and a node at a
+     distance less than 1e-3 times the diameter of the neighbour. A dof
+     created on an element is transmitted to its neighbours numbered after
+     it (the "pushes"), in the order of the elements, a later transmission
+     overriding a previous one. The dof nodes and the pushes are computed
+     in parallel and the numbering itself is done by a serial pass on the
+     elements, so that it does not depend on the number of threads. */
+  struct dof_enumeration_data {
+    const mesh_fem &mf;
+    const mesh &m;
+    dim_type N;
+    std::vector<size_type> dof_first; // first dof of each element.
+    std::vector<scalar_type> dof_pts, car_sizes;
+
+    const scalar_type *dof_point(size_type cv, size_type i) const
+    { return &(dof_pts[(dof_first[cv]+i)*N]); }
+
+    bool same_dof(size_type cv, size_type i, size_type ncv,
+                  size_type j) const {
+      pfem pf = mf.fem_of_element(cv), npf = mf.fem_of_element(ncv);
+      pdof_description pnd = pf->dof_types()[i], npnd = npf->dof_types()[j];
+      if (!dof_linkable(npnd)) return false;
+      const scalar_type *P = dof_point(cv, i), *Q = dof_point(ncv, j);
+      scalar_type d2 = scalar_type(0);
+      for (dim_type k = 0; k < N; ++k) d2 += gmm::sqr(P[k] - Q[k]);
+      return d2 <= 1e-6*car_sizes[ncv]
+        && (pnd == npnd || dof_description_compare(pnd, npnd) == 0);
+    }
+
+    /* Dofs of the neighbours of cv numbered after it identified with the
+       dof i of cv. If has_earlier is not null, stop and set it to true if
+       a neighbour numbered before cv has such a dof. */
+    void pushes(size_type cv, size_type i, bgeot::mesh_structure::ind_set &s,
+                std::vector<size_type> &targets, bool *has_earlier) const {
+      pfem pf = mf.fem_of_element(cv);
+      unsigned part = mf.get_dof_partition(cv);
+      targets.resize(0);
+      m.neighbours_of_convex(cv, pf->faces_of_dof(cv, i), s);
+      for (size_type ncv : s) {
+        if (!mf.convex_index().is_in(ncv) || mf.get_dof_partition(ncv) != part)
+          continue;
+        if (ncv < cv && !has_earlier) continue;
+        size_type nbd = mf.fem_of_element(ncv)->nb_dof(ncv);
+        for (size_type j = 0; j < nbd; ++j)
+          if (same_dof(cv, i, ncv, j)) {
+            if (ncv < cv) { *has_earlier = true; return; }
+            targets.push_back(dof_first[ncv] + j);
+          }
+      }
+    }
+
+    dof_enumeration_data(const mesh_fem &mf_)
+      : mf(mf_), m(mf_.linked_mesh()), N(m.dim()) {}
+  };
+
   /// Enumeration of dofs
   void mesh_fem::enumerate_dof() const {
-    bgeot::index_node_pair ipt;
     is_uniform_ = true;
     is_uniformly_vectorized_ = (get_qdim() > 1);
     GMM_ASSERT1(linked_mesh_ != 0, "Uninitialized mesh_fem");
@@ -333,66 +372,125 @@ namespace getfem {
     // Dof counter
     size_type nbdof = 0;
 
-    // Information stored per element
+    // Elements of the mesh_fem, in the order of the enumeration
+    std::vector<size_type> cvs;
     size_type nb_max_cv = linked_mesh().nb_allocated_convex();
-    std::vector<bgeot::kdtree> dof_nodes(nb_max_cv);
-    std::vector<scalar_type> elt_car_sizes(nb_max_cv);
-    std::vector<std::map<fem_dof, size_type, dof_comp_>> dof_sorts(nb_max_cv);
+    dof_enumeration_data ed(*this);
+    ed.dof_first.assign(nb_max_cv+1, 0);
+    ed.car_sizes.assign(nb_max_cv, scalar_type(0));
+    bool on_real_element = false;
+    for (size_type cv = 0; cv < nb_max_cv; ++cv) {
+      ed.dof_first[cv+1] = ed.dof_first[cv];
+      if (linked_mesh().convex_index().is_in(cv) && fe_convex.is_in(cv)) {
+        cvs.push_back(cv);
+        ed.dof_first[cv+1] += f_elems[cv]->nb_dof(cv);
+        if (f_elems[cv]->is_on_real_element()) on_real_element = true;
+      }
+    }
+    ed.dof_pts.resize(ed.dof_first.back() * ed.N);
 
     // Information for global dof
-    dal::bit_vector encountered_global_dof, processed_elt;
+    dal::bit_vector encountered_global_dof;
     dal::dynamic_array<size_type> ind_global_dof;
 
-    // Auxilliary variables
-    std::vector<size_type> itab;
-    base_node P(linked_mesh().dim());
-    base_node bmin(linked_mesh().dim()), bmax(linked_mesh().dim());
-    fem_dof fd;
-    bgeot::mesh_structure::ind_set s;
-
-    dof_structure.clear();
-    bgeot::pstored_point_tab pspt_old = 0;
-    bgeot::pgeometric_trans pgt_old = 0;
-    bgeot::pgeotrans_precomp pgp = 0;
-
-    for (dal::bv_visitor cv(linked_mesh().convex_index());
-         !cv.finished(); ++cv) {
-      if (fe_convex.is_in(cv)) {
-        gmm::copy(linked_mesh().points_of_convex(cv)[0], bmin);
+    /* The elements are distributed by contiguous blocks to the threads,
+       which compute the nodes of the linkable dofs and, if there is more
+       than one thread, the pushes of the dofs which are probably created
+       on their element. The fems on the real element are not supposed to
+       be thread safe, the loop is then run outside of the parallel
+       region. */
+    size_type nb_th = (me_is_multithreaded_now() || on_real_element)
+                    ? 1 : true_thread_policy::num_threads();
+    std::vector<std::vector<std::pair<size_type, size_type> > >
+      th_pushes(nb_th);
+    auto dof_nodes = [&](size_type th) {
+      base_node P(ed.N);
+      base_node bmin(ed.N);
+      base_node bmax(ed.N);
+      bgeot::pstored_point_tab pspt_old = 0;
+      bgeot::pgeometric_trans pgt_old = 0;
+      bgeot::pgeotrans_precomp pgp = 0;
+      for (size_type k = (cvs.size() * th) / nb_th;
+           k < (cvs.size() * (th+1)) / nb_th; ++k) {
+        size_type cv = cvs[k];
+        const auto &pts = linked_mesh().points_of_convex(cv);
+        gmm::copy(pts[0], bmin);
         gmm::copy(bmin, bmax);
-        for (size_type i = 0; i < linked_mesh().nb_points_of_convex(cv); ++i) {
-          const base_node &pt = linked_mesh().points_of_convex(cv)[i];
+        for (size_type i = 0; i < pts.size(); ++i) {
           for (size_type d = 1; d < bmin.size(); ++d) {
-            bmin[d] = std::min(bmin[d], pt[d]);
-            bmax[d] = std::max(bmax[d], pt[d]);
+            bmin[d] = std::min(bmin[d], pts[i][d]);
+            bmax[d] = std::max(bmax[d], pts[i][d]);
           }
         }
-        elt_car_sizes[cv] = gmm::vect_dist2_sqr(bmin, bmax);
+        ed.car_sizes[cv] = gmm::vect_dist2_sqr(bmin, bmax);
+
+        pfem pf = f_elems[cv];
+        bgeot::pgeometric_trans pgt = linked_mesh().trans_of_convex(cv);
+        bgeot::pstored_point_tab pspt = pf->node_tab(cv);
+        if (pgt != pgt_old || pspt != pspt_old)
+          pgp = bgeot::geotrans_precomp(pgt, pspt, pf);
+        pgt_old = pgt; pspt_old = pspt;
+        for (size_type i = 0; i < pf->nb_dof(cv); ++i)
+          if (dof_linkable(pf->dof_types()[i])) {
+            pgp->transform(pts, i, P);
+            std::copy(P.begin(), P.end(),
+                      ed.dof_pts.begin() + (ed.dof_first[cv]+i)*ed.N);
+          }
       }
+    };
+    if (nb_th == 1)
+      dof_nodes(0);
+    else {
+      GETFEM_OMP_PARALLEL_NO_PARTITION(
+        dof_nodes(true_thread_policy::this_thread());
+      )
+    }
+    if (nb_th > 1) {
+      GETFEM_OMP_PARALLEL_NO_PARTITION(
+        size_type th2 = true_thread_policy::this_thread();
+        bgeot::mesh_structure::ind_set s;
+        std::vector<size_type> targets;
+        for (size_type k = (cvs.size() * th2) / nb_th;
+             k < (cvs.size() * (th2+1)) / nb_th; ++k) {
+          size_type cv = cvs[k];
+          pfem pf = f_elems[cv];
+          for (size_type i = 0; i < pf->nb_dof(cv); ++i)
+            if (dof_linkable(pf->dof_types()[i])) {
+              bool has_earlier = false;
+              ed.pushes(cv, i, s, targets, &has_earlier);
+              if (!has_earlier)
+                for (size_type t : targets)
+                  th_pushes[th2].push_back
+                    (std::make_pair(ed.dof_first[cv] + i, t));
+            }
+        }
+      )
     }
 
-    dal::bit_vector cv_done;
+    // Serial numbering
+    std::vector<std::pair<size_type, size_type> > &all_pushes = th_pushes[0];
+    for (size_type i = 1; i < nb_th; ++i)
+      all_pushes.insert(all_pushes.end(), th_pushes[i].begin(),
+                        th_pushes[i].end());
+    std::vector<size_type> itab, targets, received(ed.dof_first.back(),
+                                                   size_type(-1));
+    bgeot::mesh_structure::ind_set s;
+    size_type ipush = 0;
+    dof_structure.clear();
 
-    for (dal::bv_visitor cv(linked_mesh().convex_index());
-         !cv.finished(); ++cv) { // Loop on elements
-      if (!fe_convex.is_in(cv)) continue;
+    for (size_type cv : cvs) { // Loop on elements
       pfem pf = fem_of_element(cv);
       if (pf != first_pf) is_uniform_ = false;
       if (pf->target_dim() > 1) is_uniformly_vectorized_ = false;
-      bgeot::pgeometric_trans pgt = linked_mesh().trans_of_convex(cv);
-      bgeot::pstored_point_tab pspt = pf->node_tab(cv);
-      if (pgt != pgt_old || pspt != pspt_old)
-        pgp = bgeot::geotrans_precomp(pgt, pspt, pf);
-      pgt_old = pgt; pspt_old = pspt;
       size_type nbd = pf->nb_dof(cv);
       pdof_description andof = global_dof(pf->dim());
       itab.resize(nbd);
 
       for (size_type i = 0; i < nbd; i++) { // Loop on dofs
-        fd.pnd = pf->dof_types()[i];
-        fd.part = get_dof_partition(cv);
+        pdof_description pnd = pf->dof_types()[i];
+        size_type idof = ed.dof_first[cv] + i;
 
-        if (fd.pnd == andof) {              // If the dof is a global one
+        if (pnd == andof) {              // If the dof is a global one
           size_type num = pf->index_of_global_dof(cv, i);
           if (!(encountered_global_dof[num])) {
             ind_global_dof[num] = nbdof;
@@ -400,46 +498,26 @@ namespace getfem {
             encountered_global_dof[num] = true;
           }
           itab[i] = ind_global_dof[num];
-        } else if (!dof_linkable(fd.pnd)) { // If the dof is not linkable
+        } else if (!dof_linkable(pnd)) { // If the dof is not linkable
           itab[i] = nbdof;
           nbdof += Qdim / pf->target_dim();
-        } else {                            // For a standard linkable dof
-          pgp->transform(linked_mesh().points_of_convex(cv), i, P);
-          size_type idof = nbdof;
-
-          if (dof_nodes[cv].nb_points() > 0) {
-            scalar_type dist = dof_nodes[cv].nearest_neighbor(ipt, P);
-            if (gmm::abs(dist) <= 1e-6*elt_car_sizes[cv]) {
-              fd.ind_node=ipt.i;
-              auto it = dof_sorts[cv].find(fd);
-              if (it != dof_sorts[cv].end()) idof = it->second;
-            }
-          }
-
-          if (idof == nbdof) {
-            nbdof += Qdim / pf->target_dim();
-
-            linked_mesh().neighbours_of_convex(cv, pf->faces_of_dof(cv, i), s);
-            for (size_type ncv : s) { // For each unscanned neighbour
-              if (!cv_done[ncv] && fe_convex.is_in(ncv)) { // add the dof
-
-                fd.ind_node = size_type(-1);
-                if (dof_nodes[ncv].nb_points() > 0) {
-                  scalar_type dist = dof_nodes[ncv].nearest_neighbor(ipt, P);
-                  if (gmm::abs(dist) <= 1e-6*elt_car_sizes[ncv])
-                    fd.ind_node=ipt.i;
-                }
-                if (fd.ind_node == size_type(-1))
-                  fd.ind_node = dof_nodes[ncv].add_point(P);
-                dof_sorts[ncv][fd] = idof;
-              }
-            }
+        } else if (received[idof] != size_type(-1)) {
+          itab[i] = received[idof];      // A linkable dof already created
+        } else {                         // A new linkable dof
+          itab[i] = nbdof;
+          bool found = false;  // Pushes computed in parallel
+          while (ipush < all_pushes.size() && all_pushes[ipush].first < idof)
+            ++ipush;
+          for (; ipush < all_pushes.size() && all_pushes[ipush].first == idof;
+               ++ipush)
+            { received[all_pushes[ipush].second] = nbdof; found = true; }
+          if (!found) {
+            ed.pushes(cv, i, s, targets, 0);
+            for (size_type t : targets) received[t] = nbdof;
           }
-          itab[i] = idof;
+          nbdof += Qdim / pf->target_dim();
         }
       }
-      cv_done.add(cv);
-      dof_sorts[cv].clear(); dof_nodes[cv].clear();
       dof_structure.add_convex_noverif(pf->structure(cv), itab.begin(), cv);
     }
 
@@ -792,6 +870,145 @@ namespace getfem {
     write_to_file(o);
   }
 
+  template <typename MAT> static void
+  write_compressed_matrix_to_binary(binary_ofile &f, const std::string &prefix,
+                                    const MAT &M) {
+    binary_index_type info[2] = { M.nr, M.nc };
+    f.add_section(prefix + ".size", info, sizeof(info));
+    f.add_section(prefix + ".jc",
+                  std::vector<binary_index_type>(M.jc.begin(), M.jc.end()));
+    f.add_section(prefix + ".ir",
+                  std::vector<binary_index_type>(M.ir.begin(), M.ir.end()));
+    f.add_section(prefix + ".pr", M.pr);
+  }
+
+  template <typename MAT> static void
+  read_compressed_matrix_from_binary(const binary_ifile &f,
+                                     const std::string &prefix, MAT &M) {
+    size_type n;
+    const binary_index_type *info
+      = f.section<binary_index_type>(prefix + ".size", n);
+    GMM_ASSERT1(n == 2, "Wrong matrix size in binary file");
+    M = MAT(size_type(info[0]), size_type(info[1]));
+    const binary_index_type *p = f.section<binary_index_type>(prefix+".jc", n);
+    M.jc.assign(p, p+n);
+    p = f.section<binary_index_type>(prefix + ".ir", n);
+    M.ir.assign(p, p+n);
+    const scalar_type *v = f.section<scalar_type>(prefix + ".pr", n);
+    M.pr.assign(v, v+n);
+  }
+
+  void mesh_fem::write_to_binary(binary_ofile &f,
+                                 const std::string &prefix) const {
+    context_check();
+    std::vector<pfem> fems;
+    std::map<pfem, size_type> fem_num;
+    std::vector<binary_index_type> cv_ids, cv_fem, dofs, partition;
+    for (dal::bv_visitor cv(convex_index()); !cv.finished(); ++cv) {
+      pfem pf = fem_of_element(cv);
+      auto it = fem_num.find(pf);
+      if (it == fem_num.end())
+        { it = fem_num.emplace(pf, fems.size()).first; fems.push_back(pf); }
+      cv_ids.push_back(cv);
+      cv_fem.push_back(it->second);
+      if (!dof_partition.empty()) partition.push_back(get_dof_partition(cv));
+      // skip repeated dofs for "pseudo" vector elements
+      size_type step = size_type(get_qdim()) / pf->target_dim();
+      const ind_dof_ct &ct = ind_basic_dof_of_element(cv);
+      for (auto itd = ct.begin(); itd != ct.end(); )
+        { dofs.push_back(*itd); for (size_type i=0; i < step; ++i) ++itd; }
+    }
+    std::vector<std::string> fem_names;
+    for (const pfem &pf : fems) fem_names.push_back(name_of_fem(pf));
+
+    binary_index_type info[3] = { get_qdim(), !partition.empty(),
+                                  use_reduction };
+    f.add_section(prefix + ".info", info, sizeof(info));
+    f.add_string_section(prefix + ".fem_names", fem_names);
+    f.add_section(prefix + ".convex_ids", cv_ids);
+    f.add_section(prefix + ".convex_fem", cv_fem);
+    f.add_section(prefix + ".dofs", dofs);
+    if (!partition.empty()) f.add_section(prefix + ".dof_partition", partition);
+    if (use_reduction) {
+      write_compressed_matrix_to_binary(f, prefix + ".R", R_);
+      write_compressed_matrix_to_binary(f, prefix + ".E", E_);
+    }
+  }
+
+  void mesh_fem::read_from_binary(const binary_ifile &f,
+                                  const std::string &prefix) {
+    GMM_ASSERT1(linked_mesh_ != 0, "Uninitialized mesh_fem");
+    clear();
+    size_type n, nbc;
+    const binary_index_type *info
+      = f.section<binary_index_type>(prefix + ".info", n);
+    GMM_ASSERT1(n >= 3, "Wrong mesh_fem header in binary file");
+    set_qdim(dim_type(info[0]));
+    std::vector<std::string> fem_names
+      = f.string_section(prefix + ".fem_names");
+    std::vector<pfem> fems(fem_names.size());
+    for (size_type k = 0; k < fems.size(); ++k) {
+      fems[k] = fem_descriptor(fem_names[k]);
+      GMM_ASSERT1(fems[k], "could not create the FEM '" << fem_names[k] << "'");
+    }
+    const binary_index_type *cv_ids
+      = f.section<binary_index_type>(prefix + ".convex_ids", nbc);
+    const binary_index_type *cv_fem
+      = f.section<binary_index_type>(prefix + ".convex_fem", n);
+    GMM_ASSERT1(n == nbc, "Wrong number of finite element methods");
+    const binary_index_type *partition = 0;
+    if (info[1]) {
+      partition = f.section<binary_index_type>(prefix + ".dof_partition", n);
+      GMM_ASSERT1(n == nbc, "Wrong size of the dof partition");
+    }
+    bool partial = false;
+    for (size_type j = 0; j < nbc; ++j) {
+      size_type ic = size_type(cv_ids[j]);
+      if (!linked_mesh().convex_index().is_in(ic)) { partial = true; continue; }
+      set_finite_element(ic, fems[size_type(cv_fem[j])]);
+      if (partition) set_dof_partition(ic, unsigned(partition[j]));
+    }
+    if (partial) {
+      GMM_ASSERT1(!info[2], "The reduction matrices cannot be loaded on "
+                  "a partially loaded mesh");
+      return;
+    }
+
+    // Same dof enumeration as the one of the file.
+    const binary_index_type *dofs
+      = f.section<binary_index_type>(prefix + ".dofs", n);
+    dal::bit_vector doflst;
+    dof_structure.clear(); dof_enumeration_made = false;
+    is_uniform_ = true;
+    size_type nbdof_unif = size_type(-1), k = 0;
+    touch(); v_num = act_counter();
+    std::vector<size_type> tab;
+    for (size_type j = 0; j < nbc; ++j) {
+      size_type ic = size_type(cv_ids[j]);
+      pfem pf = fem_of_element(ic);
+      size_type nbd = nb_basic_dof_of_element(ic);
+      if (nbdof_unif == size_type(-1)) nbdof_unif = nbd;
+      else if (nbdof_unif != nbd) is_uniform_ = false;
+      tab.resize(nbd);
+      size_type nbq = size_type(get_qdim()) / pf->target_dim();
+      GMM_ASSERT1(k + pf->nb_dof(ic) <= n, "Wrong number of dofs");
+      for (size_type i = 0; i < pf->nb_dof(ic); ++i) {
+        tab[i] = size_type(dofs[k++]);
+        for (size_type q = 0; q < nbq; ++q) doflst.add(tab[i]+q);
+      }
+      dof_structure.add_convex_noverif(pf->structure(ic), tab.begin(), ic);
+    }
+    dof_enumeration_made = true;
+    touch(); v_num = act_counter();
+    nb_total_dof = doflst.card();
+
+    if (info[2]) {
+      read_compressed_matrix_from_binary(f, prefix + ".R", R_);
+      read_compressed_matrix_from_binary(f, prefix + ".E", E_);
+      use_reduction = true;
+    }
+  }
+
   struct mf__key_ : public context_dependencies {
     const mesh *pmsh;
     dim_type order, qdim;
@@ -20,10 +20,47 @@
 ===========================================================================*/
 
 #include "getfem/getfem_mesh_im.h"
+#include "getfem/getfem_mesh_fem.h"
+#include "getfem/getfem_binary_io.h"
 
 
 namespace getfem {
 
+  void im_geometric_cache::check_version(const mesh_im &mim) {
+    auto guard = locks_.get_lock();
+    gmm::uint64_type v = mim.version_number();
+    if (v == v_num) return;
+    const mesh &m = mim.linked_mesh();
+    nb_slots_cv = 1;
+    for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+      nb_slots_cv = std::max(nb_slots_cv,
+                             size_type(m.structure_of_convex(cv)->nb_faces())+1);
+    slots.clear(); slots.shrink_to_fit();
+    ready.clear(); ready.shrink_to_fit();
+    cur_size = 0;
+    v_num = v;
+    // The index of the slots is counted in the memory limit. Nothing is
+    // stored if it does not fit.
+    size_type nbs = m.nb_allocated_convex() * nb_slots_cv;
+    size_type index_size = (nbs * (sizeof(slots[0]) + sizeof(ready[0]))
+                            + sizeof(scalar_type) - 1) / sizeof(scalar_type);
+    if (index_size >= max_size) return;
+    slots.resize(nbs);
+    ready.assign(nbs, 0);
+    cur_size = index_size;
+  }
+
+  scalar_type *im_geometric_cache::reserve(size_type cv, short_type f,
+                                           size_type n) {
+    size_type i = slot(cv, f);
+    if (i >= slots.size()) return 0;
+    if (!slots[i]) {
+      if (cur_size.fetch_add(n) + n > max_size) { cur_size -= n; return 0; }
+      slots[i].reset(new scalar_type[n]);
+    }
+    return slots[i].get();
+  }
+
   void mesh_im::update_from_context(void) const {
     for (dal::bv_visitor i(im_convexes); !i.finished(); ++i) {
       if (linked_mesh_->convex_index().is_in(i)) {
@@ -134,6 +171,7 @@ namespace getfem {
     v_num = mim.v_num;
     ims = mim.ims;
     auto_add_elt_pim = mim.auto_add_elt_pim;
+    set_geometric_cache(mim.geo_cache ? mim.geo_cache->max_bytes() : 0);
   }
 
   mesh_im::mesh_im(const mesh_im &mim) : context_dependencies() {
@@ -226,6 +264,52 @@ namespace getfem {
     o.close();
   }
 
+  void mesh_im::write_to_binary(binary_ofile &f,
+                                const std::string &prefix) const {
+    context_check();
+    std::vector<pintegration_method> methods;
+    std::map<pintegration_method, size_type> im_num;
+    std::vector<binary_index_type> cv_ids, cv_im;
+    for (dal::bv_visitor cv(convex_index()); !cv.finished(); ++cv) {
+      pintegration_method pim = int_method_of_element(cv);
+      auto it = im_num.find(pim);
+      if (it == im_num.end())
+        { it = im_num.emplace(pim, methods.size()).first; methods.push_back(pim); }
+      cv_ids.push_back(cv);
+      cv_im.push_back(it->second);
+    }
+    std::vector<std::string> im_names;
+    for (const pintegration_method &pim : methods)
+      im_names.push_back(name_of_int_method(pim));
+    f.add_string_section(prefix + ".im_names", im_names);
+    f.add_section(prefix + ".convex_ids", cv_ids);
+    f.add_section(prefix + ".convex_im", cv_im);
+  }
+
+  void mesh_im::read_from_binary(const binary_ifile &f,
+                                 const std::string &prefix) {
+    GMM_ASSERT1(linked_mesh_ != 0, "Uninitialized mesh_im");
+    clear();
+    std::vector<std::string> im_names = f.string_section(prefix+".im_names");
+    std::vector<pintegration_method> methods(im_names.size());
+    for (size_type k = 0; k < methods.size(); ++k) {
+      methods[k] = int_method_descriptor(im_names[k]);
+      GMM_ASSERT1(methods[k], "could not create the integration method '"
+                  << im_names[k] << "'");
+    }
+    size_type n, nbc;
+    const binary_index_type *cv_ids
+      = f.section<binary_index_type>(prefix + ".convex_ids", nbc);
+    const binary_index_type *cv_im
+      = f.section<binary_index_type>(prefix + ".convex_im", n);
+    GMM_ASSERT1(n == nbc, "Wrong number of integration methods");
+    for (size_type j = 0; j < nbc; ++j) {
+      size_type ic = size_type(cv_ids[j]);
+      if (linked_mesh().convex_index().is_in(ic))
+        set_integration_method(ic, methods[size_type(cv_im[j])]);
+    }
+  }
+
   struct dummy_mesh_im_ {
     mesh_im mim;
     dummy_mesh_im_() : mim() {}
@@ -234,6 +318,21 @@ namespace getfem {
   const mesh_im &dummy_mesh_im()
   { return dal::singleton<dummy_mesh_im_>::instance().mim; }
 
+  void element_integration_costs(const mesh_im &mim, const mesh_fem &mf,
+                                 std::vector<scalar_type> &w) {
+    w.assign(mim.linked_mesh().nb_allocated_convex(), scalar_type(0));
+    for (dal::bv_visitor cv(mim.convex_index()); !cv.finished(); ++cv) {
+      pintegration_method pim = mim.int_method_of_element(cv);
+      size_type nbpt = 0;
+      if (pim->type() == IM_APPROX)
+        nbpt = pim->approx_method()->nb_points_on_convex();
+      else if (pim->type() == IM_EXACT) nbpt = 1;
+      size_type nbd = mf.convex_index().is_in(cv)
+        ? mf.nb_basic_dof_of_element(cv) : 1;
+      w[cv] = scalar_type(nbpt * nbd);
+    }
+  }
+
 }  /* end of namespace getfem.                                             */
 
 
@@ -29,8 +29,8 @@ namespace getfem {
   { is_adapted = false; }
 
   void mesh_im_level_set::clear_build_methods() {
-    for (size_type i = 0; i < build_methods.size(); ++i)
-      del_stored_object(build_methods[i]);
+    for (const auto &bm : build_methods)
+      if (bm.second.pim) del_stored_object(bm.second.pim);
     build_methods.clear();
     cut_im.clear();
   }
@@ -57,12 +57,14 @@ namespace getfem {
   mesh_im_level_set::mesh_im_level_set(mesh_level_set &me,
 				       int integrate_where_, 
 				       pintegration_method reg,
-				       pintegration_method sing) {
+				       pintegration_method sing)
+    : incremental(false), incremental_tol(0), nb_rebuilt(0) {
     mls = 0;
     init_with_mls(me, integrate_where_, reg, sing);
   }
 
   mesh_im_level_set::mesh_im_level_set(void)
+    : incremental(false), incremental_tol(0), nb_rebuilt(0)
   { mls = 0; is_adapted = false; }
 
 
@@ -218,7 +220,8 @@ namespace getfem {
     return r;
   }
   
-  void mesh_im_level_set::build_method_of_convex(size_type cv) {
+  papprox_integration
+  mesh_im_level_set::build_method_of_convex(size_type cv) {
     const mesh &msh(mls->mesh_of_convex(cv));
     GMM_ASSERT3(msh.convex_index().card() != 0, "Internal error");
     base_matrix G;
@@ -299,6 +302,7 @@ namespace getfem {
 	      << ", " << ptsing[0];
 	  if (ptsing.size() > 1) sts << ", " <<  ptsing[1];
 	  sts << ")";
+	  GLOBAL_OMP_GUARD
 	  pai = int_method_descriptor(sts.str())->approx_method();
 	}
       }
@@ -394,26 +398,97 @@ namespace getfem {
 
     if (new_approx->nb_points()) {
       new_approx->valid_method();
-      pintegration_method
-	pim = std::make_shared<integration_method>(new_approx);
-      dal::pstatic_stored_object_key
-	pk = std::make_shared<special_imls_key>(new_approx);
-      dal::add_stored_object(pk, pim, new_approx->ref_convex(),
-			     new_approx->pintegration_points());
-      build_methods.push_back(pim);
-      cut_im.set_integration_method(cv, pim);
+      return new_approx;
+    }
+    return papprox_integration();
+  }
+
+  /* values of the level sets (primary and secondary parts) on the dofs
+     of the convex, on which the cut of the convex depends. */
+  void mesh_im_level_set::level_set_values_of_convex
+  (size_type cv, std::vector<scalar_type> &v) const {
+    v.resize(0);
+    for (unsigned i = 0; i < mls->nb_level_sets(); ++i) {
+      const level_set &ls = *(mls->get_level_set(i));
+      const mesh_fem &mf = ls.get_mesh_fem();
+      for (unsigned lsnum = 0; lsnum < (ls.has_secondary() ? 2u : 1u);
+	   ++lsnum)
+	for (size_type dof : mf.ind_basic_dof_of_element(cv))
+	  v.push_back(ls.values(lsnum)[dof]);
+    }
+  }
+
+  bool mesh_im_level_set::same_cut(const std::vector<scalar_type> &v1,
+				   const std::vector<scalar_type> &v2) const {
+    if (v1.size() != v2.size()) return false;
+    for (size_type i = 0; i < v1.size(); ++i) {
+      if ((v1[i] < 0) != (v2[i] < 0) || (v1[i] > 0) != (v2[i] > 0)
+	  || gmm::abs(v1[i] - v2[i]) > incremental_tol)
+	return false;
     }
+    return true;
   }
 
   void mesh_im_level_set::adapt(void) {
     GMM_ASSERT1(linked_mesh_ != 0, "mesh level set uninitialized");
     context_check();
-    clear_build_methods();
     ignored_im.clear();
+
+    /* Cut convexes for which the previous method is kept (incremental
+       mode), and cut convexes whose method has to be built. */
+    std::map<size_type, cut_method> old_methods;
+    if (incremental) old_methods.swap(build_methods);
+    clear_build_methods();
+    std::vector<size_type> cvs;
+    std::vector<cut_method> new_methods;
     for (dal::bv_visitor cv(linked_mesh().convex_index()); 
-	 !cv.finished(); ++cv) {
-      if (mls->is_convex_cut(cv)) build_method_of_convex(cv);
+	 !cv.finished(); ++cv)
+      if (mls->is_convex_cut(cv)) {
+	cut_method cm;
+	level_set_values_of_convex(cv, cm.ls_values);
+	auto it = old_methods.find(cv);
+	if (it != old_methods.end() && same_cut(it->second.ls_values,
+						cm.ls_values)) {
+	  build_methods[cv] = it->second;
+	  old_methods.erase(it);
+	} else {
+	  cvs.push_back(cv);
+	  new_methods.push_back(cm);
+	}
+      }
+    for (const auto &bm : old_methods)
+      if (bm.second.pim) del_stored_object(bm.second.pim);
+
+    /* The cut convexes are distributed by contiguous blocks to the
+       threads. The integration methods are stored afterwards, serially. */
+    std::vector<papprox_integration> pais(cvs.size());
+    size_type nb_th = me_is_multithreaded_now()
+                    ? 1 : true_thread_policy::num_threads();
+    GETFEM_OMP_PARALLEL_NO_PARTITION(
+      size_type th = (nb_th == 1) ? 0 : true_thread_policy::this_thread();
+      for (size_type k = (cvs.size() * th) / nb_th;
+	   k < (cvs.size() * (th+1)) / nb_th; ++k)
+	pais[k] = build_method_of_convex(cvs[k]);
+    )
+    for (size_type k = 0; k < cvs.size(); ++k) {
+      if (pais[k]) {
+	pintegration_method
+	  pim = std::make_shared<integration_method>(pais[k]);
+	dal::pstatic_stored_object_key
+	  pk = std::make_shared<special_imls_key>(pais[k]);
+	dal::add_stored_object(pk, pim, pais[k]->ref_convex(),
+			       pais[k]->pintegration_points());
+	new_methods[k].pim = pim;
+      }
+      build_methods[cvs[k]] = new_methods[k];
+    }
+    nb_rebuilt = cvs.size();
+    for (const auto &bm : build_methods)
+      if (bm.second.pim)
+	cut_im.set_integration_method(bm.first, bm.second.pim);
 
+    for (dal::bv_visitor cv(linked_mesh().convex_index()); 
+	 !cv.finished(); ++cv) {
       if (!cut_im.convex_index().is_in(cv)) {
 	/* not exclusive with mls->is_convex_cut ... sometimes, cut cv
 	   contains no integration points.. */
@@ -306,7 +306,10 @@ struct Chrono {
     double t0=gmm::uclock_sec();
     if (noisy) cout << "running delaunay with " << fixed_points.size()
 		    << " points.." << std::flush;
-    bgeot::qhull_delaunay(fixed_points, simplexes);
+    {
+      GLOBAL_OMP_GUARD // libqhull is not reentrant
+      bgeot::qhull_delaunay(fixed_points, simplexes);
+    }
     if (noisy) cout << " -> " << gmm::mat_ncols(simplexes)
 		    << " simplexes [" << gmm::uclock_sec()-t0 << "sec]\n";
   }
@@ -390,10 +393,10 @@ struct Chrono {
   void mesh_level_set::cut_element(size_type cv,
 				   const dal::bit_vector &primary,
 				   const dal::bit_vector &secondary,
-				   scalar_type radius_cv) {
+				   scalar_type radius_cv,
+				   const std::vector<base_node> &curv_points) {
     
-    cut_cv[cv] = convex_info();
-    cut_cv[cv].pmsh = std::make_shared<mesh>();
+    convex_info &cvi = cut_cv.find(cv)->second; // Created by adapt()
     if (noisy) cout << "cutting element " << cv << endl;
     bgeot::pgeometric_trans pgt = linked_mesh().trans_of_convex(cv);
     pmesher_signed_distance ref_element = new_ref_element(pgt);
@@ -417,9 +420,9 @@ struct Chrono {
     ref_element->register_constraints(list_constraints);
     size_type nbeltconstraints = list_constraints.size();
     mesher_level_sets.reserve(nbtotls);
-    for (size_type ll = 0; ll < level_sets.size(); ++ll) {
+    for (size_type ll = 0, ip = 0; ll < level_sets.size(); ++ll) {
       if (primary[ll]) {
-	base_node X(n); gmm::fill_random(X);
+	const base_node &X = curv_points[ip++];
 	K = std::max(K, (level_sets[ll])->degree());
 	mesher_level_sets.push_back(level_sets[ll]->mls_of_convex(cv, 0));
 	pmesher_signed_distance mls(mesher_level_sets.back());
@@ -525,9 +528,9 @@ struct Chrono {
       
       std::vector<base_node> fixed_points;
       std::vector<dal::bit_vector> fixed_points_constraints;
-      mesh &msh(*(cut_cv[cv].pmsh));
+      mesh &msh(*(cvi.pmsh));
 	
-      mesh_region &ls_border_faces(cut_cv[cv].ls_border_faces);
+      mesh_region &ls_border_faces(cvi.ls_border_faces);
       std::vector<base_node> cvpts;
 
       size_type nb_delaunay = 0;
@@ -871,7 +874,15 @@ struct Chrono {
 
     // noisy = true;
 
+    for (size_type i = 0; i < level_sets.size(); ++i)
+      level_sets[i]->get_mesh_fem().nb_dof(); // dofs enumerated beforehand
+
     std::string z;
+    std::vector<size_type> cvs;
+    std::vector<dal::bit_vector> prims, secs;
+    std::vector<std::string> prezones;
+    std::vector<scalar_type> radii;
+    std::vector<std::vector<base_node> > curv_points;
     for (dal::bv_visitor cv(linked_mesh().convex_index()); 
 	 !cv.finished(); ++cv) {
       scalar_type radius = linked_mesh().convex_radius_estimate(cv);
@@ -881,10 +892,39 @@ struct Chrono {
       if (noisy) cout << "element " << cv << " cut level sets : "
 		      << prim << " zone : " << z << endl;
       if (prim.card()) {
-	cut_element(cv, prim, sec, radius);
-	find_zones_of_element(cv, z, radius);
+	cut_cv[cv].pmsh = std::make_shared<mesh>();
+	cvs.push_back(cv); prims.push_back(prim); secs.push_back(sec);
+	prezones.push_back(z); radii.push_back(radius);
+	// The random points of the curvature estimates are drawn here, in
+	// the order of the convexes, for the result not to depend on the
+	// order in which the threads cut the elements.
+	curv_points.push_back(std::vector<base_node>(prim.card()));
+	size_type n = linked_mesh().structure_of_convex(cv)->dim();
+	for (base_node &X : curv_points.back())
+	  { X = base_node(n); gmm::fill_random(X); }
       }
     }
+
+    /* The sub-meshes of the cut convexes are built independently, by
+       contiguous blocks of convexes for each thread. The zones are then
+       merged serially, in the order of the convexes, since they are shared
+       by all the elements. In noisy mode, the loop is sequential.        */
+    size_type nb_th = (me_is_multithreaded_now() || noisy)
+                    ? 1 : true_thread_policy::num_threads();
+    if (nb_th == 1) {
+      for (size_type k = 0; k < cvs.size(); ++k)
+	cut_element(cvs[k], prims[k], secs[k], radii[k], curv_points[k]);
+    } else {
+      GETFEM_OMP_PARALLEL_NO_PARTITION(
+	size_type th = true_thread_policy::this_thread();
+	for (size_type k = (cvs.size() * th) / nb_th;
+	     k < (cvs.size() * (th+1)) / nb_th; ++k)
+	  cut_element(cvs[k], prims[k], secs[k], radii[k], curv_points[k]);
+      )
+    }
+    for (size_type k = 0; k < cvs.size(); ++k)
+      find_zones_of_element(cvs[k], prezones[k], radii[k]);
+
     if (noisy) {
       getfem::stored_mesh_slice sl;
       sl.build(global_mesh(), getfem::slicer_none(), 6);
@@ -26,6 +26,53 @@
 namespace getfem {
 
   using face_bitset = mesh_region::face_bitset;
+  using map_t = mesh_region::map_t;
+
+  static bool entry_less(const map_t::value_type &a,
+                         const map_t::value_type &b)
+  { return a.first < b.first; }
+
+  /* Sort the entries appended after the nb_sorted first ones, merge them
+     with the sorted ones and fuse the masks of a same convex. */
+  static void merge_entries(map_t &m, size_type &nb_sorted) {
+    std::sort(m.begin() + nb_sorted, m.end(), entry_less);
+    std::inplace_merge(m.begin(), m.begin() + nb_sorted, m.end(), entry_less);
+    size_type j = 0;
+    for (size_type i = 0; i < m.size(); ++i)
+      if (j > 0 && m[j-1].first == m[i].first) m[j-1].second |= m[i].second;
+      else m[j++] = m[i];
+    m.resize(j);
+    nb_sorted = j;
+  }
+
+  const map_t &mesh_region::entries() const {
+    GMM_ASSERT1(p, "Use from_mesh on that region before");
+    const impl &r = rp();
+    if (!r.sorted.load(std::memory_order_acquire)) {
+      GLOBAL_OMP_GUARD
+      if (!r.sorted.load(std::memory_order_relaxed)) {
+        merge_entries(r.m, r.nb_sorted);
+        r.sorted.store(true, std::memory_order_release);
+      }
+    }
+    return r.m;
+  }
+
+  map_t::iterator mesh_region::find_entry(size_type cv) {
+    map_t &m = wentries();
+    auto it = std::lower_bound(m.begin(), m.end(),
+                               map_t::value_type(cv, face_bitset()),
+                               entry_less);
+    return (it != m.end() && it->first == cv) ? it : m.end();
+  }
+
+  mesh_region::const_iterator mesh_region::find_entry(size_type cv) const {
+    const map_t &m = entries();
+    auto it = std::lower_bound(m.begin(), m.end(),
+                               map_t::value_type(cv, face_bitset()),
+                               entry_less);
+    return (it != m.end() && it->first == cv) ? it : m.end();
+  }
 
   mesh_region::mesh_region(const mesh_region &other)
     : p(std::make_shared<impl>()), id_(size_type(-2)), parent_mesh(0) {
@@ -61,7 +108,6 @@ namespace getfem {
 
   void mesh_region::mark_region_changed() const{
     index_updated.all_threads() = false;
-    partitions_updated.all_threads() = false;
     serial_index_updated = false;
   }
 
@@ -83,6 +129,7 @@ namespace getfem {
         *r = m.region(id_);
       }
     }
+    if (p) rp().pmesh = &m;
     mark_region_changed();
     return *this;
   }
@@ -133,72 +180,83 @@ namespace getfem {
     if (p && !(mr.p)) return false;
     if (!p && mr.p) return false;
     if (p)
-      if (p->m != mr.p->m) return false;
+      if (entries() != mr.entries()) return false;
     return true;
   }
 
   face_bitset mesh_region::operator[](size_t cv) const{
-    auto it = rp().m.find(cv);
+    auto it = find_entry(cv);
     if (it != rp().m.end()) return it->second;
     else return {};
   }
 
-  void mesh_region::update_partition_iterators() const{
-    if ((partitions_updated.thrd_cast() == true)) return;
-    itbegin = partition_begin();
-    itend = partition_end  ();
-    partitions_updated = true;
-  }
-  mesh_region::const_iterator
-    mesh_region::partition_begin( ) const{
-    auto region_size = rp().m.size();
-    if (region_size < partitions_updated.num_threads()){
+  /* The partition of the current thread, shared by begin()/end(), hence
+     by index(), size() and the visitors. When the weights of the convexes
+     of the mesh are set (see mesh::set_convex_weights), the partitions have
+     the same total weight, an entry going to the partition containing the
+     middle of its weight. Otherwise they have the same number of entries. */
+  void mesh_region::partition_range(const_iterator &b,
+                                    const_iterator &e) const {
+    const map_t &m = entries();
+    size_type nbt = index_updated.num_threads();
+    size_type th = index_updated.this_thread();
+    const mesh *pm = parent_mesh ? parent_mesh : rp().pmesh;
+    if (pm && !(pm->convex_weights().empty())) {
+      scalar_type total(0), cumul(0);
+      for (const auto &x : m) total += pm->convex_weight(x.first);
+      if (total > scalar_type(0)) {
+        b = e = m.end();
+        for (auto it = m.begin(); it != m.end(); ++it) {
+          scalar_type w = pm->convex_weight(it->first);
+          size_type i = std::min(size_type((cumul + w/scalar_type(2))
+                                           * scalar_type(nbt) / total), nbt-1);
+          if (i >= th && b == m.end()) b = it;
+          if (i > th) { e = it; break; }
+          cumul += w;
+        }
+        return;
+      }
+    }
+    auto region_size = m.size();
+    if (region_size < nbt) {
       //for small regions: put the whole region into zero thread
-      if (partitions_updated.this_thread() == 0) return rp().m.begin();
-      else return rp().m.end();
+      b = (th == 0) ? m.begin() : m.end(); e = m.end();
+      return;
     }
     auto partition_size = static_cast<size_type>
       (std::ceil(static_cast<scalar_type>(region_size)/
-       static_cast<scalar_type >(partitions_updated.num_threads())));
-    auto index_begin = partition_size * partitions_updated.this_thread();
-    if (index_begin >= region_size ) return rp().m.end();
+       static_cast<scalar_type >(nbt)));
+    auto index_begin = partition_size * th;
+    auto index_end = partition_size * (th + 1);
+    b = (index_begin >= region_size) ? m.end() : m.begin() + index_begin;
+    e = (index_end >= region_size) ? m.end() : m.begin() + index_end;
+  }
 
-    auto it = rp().m.begin();
-    for (size_type i = 0; i != index_begin; ++i) ++it;
-    return it;
+  mesh_region::const_iterator
+    mesh_region::partition_begin( ) const{
+    const_iterator b, e;
+    partition_range(b, e);
+    return b;
   }
 
   mesh_region::const_iterator
     mesh_region::partition_end( ) const{
-    auto region_size = rp().m.size();
-    if (region_size< partitions_updated.num_threads()) return rp().m.end();
-
-    auto partition_size = static_cast<size_type>
-      (std::ceil(static_cast<scalar_type>(region_size)/
-       static_cast<scalar_type >(partitions_updated.num_threads())));
-    auto index_end = partition_size * (partitions_updated.this_thread() + 1);
-    if (index_end >= region_size ) return  rp().m.end();
-
-    auto it = rp().m.begin();
-    for (size_type i = 0; i < index_end && it != rp().m.end(); ++i) ++it;
-    return it;
+    const_iterator b, e;
+    partition_range(b, e);
+    return e;
   }
 
   mesh_region::const_iterator mesh_region::begin() const{
     GMM_ASSERT1(p != 0, "Internal error");
-    if (me_is_multithreaded_now() && partitioning_allowed){
-      update_partition_iterators();
-      return itbegin;
-    }
-    else return rp().m.begin();
+    if (me_is_multithreaded_now() && partitioning_allowed)
+      return partition_begin();
+    else return entries().begin();
   }
 
   mesh_region::const_iterator mesh_region::end() const{
-    if (me_is_multithreaded_now() && partitioning_allowed){
-      update_partition_iterators();
-      return itend;
-    }
-    else return rp().m.end();
+    if (me_is_multithreaded_now() && partitioning_allowed)
+      return partition_end();
+    else return entries().end();
   }
 
   void mesh_region::allow_partitioning(){
@@ -252,34 +310,52 @@ namespace getfem {
     }
   }
 
+  /* The entries are appended and merged in bulk at the next access, so
+     that building a region costs O(n log n) whatever the order of the
+     additions, and O(n) when they come by increasing convex numbers. */
   void mesh_region::add(const dal::bit_vector &bv){
-    for (dal::bv_visitor i(bv); !i.finished(); ++i){
-      wp().m[i].set(0, 1);
-    }
+    map_t &m = wp().m;
+    m.reserve(m.size() + bv.card());
+    for (dal::bv_visitor i(bv); !i.finished(); ++i)
+      m.push_back(map_t::value_type(i, face_bitset(1)));
+    wp().sorted_up_to((m.size() == bv.card()) ? m.size() : wp().nb_sorted);
     touch_parent_mesh();
     mark_region_changed();
   }
 
   void mesh_region::add(size_type cv, short_type f){
-    wp().m[cv].set(short_type(f + 1), 1);
+    map_t &m = wp().m;
+    if (wp().nb_sorted == m.size() && !m.empty() && m.back().first == cv)
+      m.back().second.set(short_type(f + 1), 1);
+    else {
+      bool sorted = (wp().nb_sorted == m.size()
+                     && (m.empty() || m.back().first < cv));
+      m.push_back(map_t::value_type(cv, face_bitset()));
+      m.back().second.set(short_type(f + 1), 1);
+      wp().sorted_up_to(sorted ? m.size() : wp().nb_sorted);
+    }
     touch_parent_mesh();
     mark_region_changed();
   }
 
   void mesh_region::sup_all(size_type cv){
-    auto it = wp().m.find(cv);
+    auto it = find_entry(cv);
     if (it != wp().m.end()){
       wp().m.erase(it);
+      wp().sorted_up_to(wp().m.size());
       touch_parent_mesh();
       mark_region_changed();
     }
   }
 
   void mesh_region::sup(size_type cv, short_type f){
-    auto it = wp().m.find(cv);
+    auto it = find_entry(cv);
     if (it != wp().m.end()) {
       it->second.set(short_type(f + 1), 0);
-      if (it->second.none()) wp().m.erase(it);
+      if (it->second.none()) {
+        wp().m.erase(it);
+        wp().sorted_up_to(wp().m.size());
+      }
       touch_parent_mesh();
       mark_region_changed();
     }
@@ -287,47 +363,54 @@ namespace getfem {
 
   void mesh_region::clear(){
     wp().m.clear();
+    wp().sorted_up_to(0);
     touch_parent_mesh();
     mark_region_changed();
   }
 
   void mesh_region::clean(){
-    for (map_t::iterator it = wp().m.begin(), itn;
-         it != wp().m.end(); it = itn) {
-      itn = it;
-      ++itn;
-      if (!(*it).second.any()) wp().m.erase(it);
-    }
+    map_t &m = wentries();
+    m.erase(std::remove_if(m.begin(), m.end(),
+                           [](const map_t::value_type &e)
+                           { return e.second.none(); }), m.end());
+    wp().sorted_up_to(m.size());
     touch_parent_mesh();
     mark_region_changed();
   }
 
   void mesh_region::swap_convex(size_type cv1, size_type cv2){
-    auto it1 = wp().m.find(cv1);
-    auto it2 = wp().m.find(cv2);
-    auto ite = wp().m.end();
-    face_bitset f1, f2;
-
-    if (it1 != ite) f1 = it1->second;
-    if (it2 != ite) f2 = it2->second;
-    if (!f1.none()) wp().m[cv2] = f1;
-    else if (it2 != ite) wp().m.erase(it2);
-    if (!f2.none()) wp().m[cv1] = f2;
-    else if (it1 != ite) wp().m.erase(it1);
+    if (cv1 == cv2) return;
+    map_t &m = wentries();
+    auto it1 = find_entry(cv1), it2 = find_entry(cv2), ite = m.end();
+    if (it1 == ite && it2 == ite) return;
+    if (it1 != ite && it2 != ite)
+      std::swap(it1->second, it2->second);
+    else {
+      /* the single entry changes of convex number: move it to its new
+         place, shifting the entries in between. */
+      auto it = (it1 != ite) ? it1 : it2;
+      size_type cv = (it1 != ite) ? cv2 : cv1;
+      auto itn = std::lower_bound(m.begin(), m.end(),
+                                  map_t::value_type(cv, face_bitset()),
+                                  entry_less);
+      it->first = cv;
+      if (itn > it) std::rotate(it, it+1, itn);
+      else std::rotate(itn, it, it+1);
+    }
     touch_parent_mesh();
     mark_region_changed();
   }
 
   bool mesh_region::is_in(size_type cv, short_type f) const{
     GMM_ASSERT1(p, "Use from mesh on that region before");
-    auto it = rp().m.find(cv);
+    auto it = find_entry(cv);
     if (it == rp().m.end() || short_type(f+1) >= MAX_FACES_PER_CV) return false;
     return ((*it).second)[short_type(f+1)];
   }
 
   bool mesh_region::is_in(size_type cv, short_type f, const mesh &m) const{
     if (p) {
-      auto it = rp().m.find(cv);
+      auto it = find_entry(cv);
       if (it == rp().m.end() || short_type(f+1) >= MAX_FACES_PER_CV)
         return false;
       return ((*it).second)[short_type(f+1)];
@@ -339,7 +422,7 @@ namespace getfem {
   }
 
   bool mesh_region::is_empty() const{
-    return rp().m.empty();
+    return entries().empty();
   }
 
   bool mesh_region::is_only_convexes() const{
@@ -352,38 +435,39 @@ namespace getfem {
   }
 
   face_bitset mesh_region::faces_of_convex(size_type cv) const{
-    auto it = rp().m.find(cv);
+    auto it = find_entry(cv);
     if (it != rp().m.end()) return ((*it).second) >> 1;
     else return face_bitset();
   }
 
   face_bitset mesh_region::and_mask() const{
     face_bitset bs;
-    if (rp().m.empty()) return bs;
+    const map_t &m = entries();
+    if (m.empty()) return bs;
     bs.set();
-    for (auto it = rp().m.begin(); it != rp().m.end(); ++it)
+    for (auto it = m.begin(); it != m.end(); ++it)
       if ( (*it).second.any() )  bs &= (*it).second;
     return bs;
   }
 
   face_bitset mesh_region::or_mask() const{
     face_bitset bs;
-    if (rp().m.empty()) return bs;
-    for (auto it = rp().m.begin(); it != rp().m.end(); ++it)
+    const map_t &m = entries();
+    for (auto it = m.begin(); it != m.end(); ++it)
       if ( (*it).second.any() )  bs |= (*it).second;
     return bs;
   }
 
   size_type mesh_region::size() const{
     size_type sz = 0;
-    for (auto it = begin(); it != end(); ++it)
+    for (auto it = begin(), ite = end(); it != ite; ++it)
       sz += (*it).second.count();
     return sz;
   }
 
   size_type mesh_region::unpartitioned_size() const{
     size_type sz = 0;
-    for (auto it = rp().m.begin(); it != rp().m.end(); ++it)
+    for (auto it = entries().begin(); it != rp().m.end(); ++it)
       sz += (*it).second.count();
     return sz;
   }
@@ -400,11 +484,13 @@ namespace getfem {
                 b.id() != size_type(-1), "the 'all_convexes' regions "
                 "are not supported for set operations");
     if (a.id() == size_type(-1)){
-      for (const_iterator it = b.begin();it != b.end(); ++it) r.wp().m.insert(*it);
+      r.wp().m.assign(b.begin(), b.end());
+      r.wp().sorted_up_to(r.wp().m.size());
       return r;
     }
     else if (b.id() == size_type(-1)){
-      for (const_iterator it = a.begin();it != a.end(); ++it) r.wp().m.insert(*it);
+      r.wp().m.assign(a.begin(), a.end());
+      r.wp().sorted_up_to(r.wp().m.size());
       return r;
     }
 
@@ -419,10 +505,11 @@ namespace getfem {
         if (maska[0] && !maskb[0]) bs = maskb;
         else if (maskb[0] && !maska[0]) bs = maska;
         else bs = maska & maskb;
-        if (bs.any()) r.wp().m.insert(r.wp().m.end(), std::make_pair(ita->first,bs));
+        if (bs.any()) r.wp().m.push_back(std::make_pair(ita->first,bs));
         ++ita; ++itb;
       }
     }
+    r.wp().sorted_up_to(r.wp().m.size());
     return r;
   }
 
@@ -433,12 +520,10 @@ namespace getfem {
     GMM_ASSERT1(a.id() != size_type(-1) &&
       b.id() != size_type(-1), "the 'all_convexes' regions "
       "are not supported for set operations");
-    for (auto it = a.begin();it != a.end(); ++it){
-      r.wp().m.insert(*it);
-    }
-    for (auto it = b.begin();it != b.end(); ++it){
-      r.wp().m[it->first] |= it->second;
-    }
+    r.wp().m.assign(a.begin(), a.end());
+    size_type nb_a = r.wp().m.size();
+    r.wp().m.insert(r.wp().m.end(), b.begin(), b.end());
+    r.wp().sorted_up_to(nb_a);
     return r;
   }
 
@@ -450,17 +535,14 @@ namespace getfem {
     GMM_ASSERT1(a.id() != size_type(-1) &&
       b.id() != size_type(-1), "the 'all_convexes' regions "
       "are not supported for set operations");
-    for (auto ita = a.begin();ita != a.end(); ++ita)
-      r.wp().m.insert(*ita);
-
-    for (auto itb = b.begin();itb != b.end(); ++itb){
-      auto cv = itb->first;
-      auto it = r.wp().m.find(cv);
-      if (it != r.wp().m.end()){
-                it->second &= ~(itb->second);
-                if (it->second.none()) r.wp().m.erase(it);
-          }
+    r.wp().m.assign(a.begin(), a.end());
+    r.wp().sorted_up_to(r.wp().m.size());
+
+    for (auto itb = b.begin(), iteb = b.end(); itb != iteb; ++itb){
+      auto it = r.find_entry(itb->first);
+      if (it != r.wp().m.end()) it->second &= ~(itb->second);
     }
+    r.clean();
     return r;
   }
 
@@ -320,6 +320,7 @@ namespace getfem {
 
     gmm::dense_matrix<scalar_type> W;
     bgeot::mesh_structure edges_mesh;
+    std::vector<size_type> edges; // indices of the edges in edges_mesh
 
     std::vector<size_type> attracted_points;
     std::vector<base_node> attractor_points;
@@ -790,18 +791,30 @@ namespace getfem {
         else if (noisy > 0)
           cout << "Removed duplicate fixed point: "<<fixed_points[i]<<"\n";
       }
-      base_node P(N), Q(N);
+      /* The grid is processed by blocks, the distance being evaluated
+         on a whole block at once. */
+      const size_type block_size = 4096;
+      base_node Q(N);
+      std::vector<base_node> grid;
+      base_vector dgrid;
       for (size_type i=0; i < nbpt; ++i) {
-        for (size_type k=0, r = i; k < N; ++k) {
-          unsigned p =  unsigned(r % gridnx[k]);
-          P[k] = p * (bounding_box_max[k] - bounding_box_min[k]) / 
-            scalar_type((gridnx[k]-1)) + bounding_box_min[k];
-          if (N==2 && k==0 && ((r/gridnx[0])&1)==1) P[k] += h0/2;
-          r /= gridnx[k];
+        size_type ib = i % block_size;
+        if (ib == 0) {
+          grid.resize(std::min(block_size, nbpt - i), base_node(N));
+          for (size_type j=0; j < grid.size(); ++j)
+            for (size_type k=0, r = i+j; k < N; ++k) {
+              unsigned p =  unsigned(r % gridnx[k]);
+              grid[j][k] = p * (bounding_box_max[k] - bounding_box_min[k]) / 
+                scalar_type((gridnx[k]-1)) + bounding_box_min[k];
+              if (N==2 && k==0 && ((r/gridnx[0])&1)==1) grid[j][k] += h0/2;
+              r /= gridnx[k];
+            }
+          if (prefind == 1) dist->values(grid, dgrid);
         }
 
+        const base_node &P = grid[ib];
         dal::bit_vector co;
-        if ((prefind == 1 && (*dist)(P) < 0) || prefind == 2) {
+        if ((prefind == 1 && dgrid[ib] < 0) || prefind == 2) {
           for (size_type k = 0; k < constraints.size() && co.card() < N; ++k) {
             gmm::copy(P, Q);
             if (gmm::abs((*(constraints[k]))(Q)) < h0) {
@@ -821,7 +834,10 @@ namespace getfem {
           try_projection(Q);
         }
 
-        if ((*dist)(Q) < geps) {
+        // Q is still the grid point if no constraint has been found
+        scalar_type dQ = (prefind == 1 && co.card() == 0) ? dgrid[ib]
+                                                         : (*dist)(Q);
+        if (dQ < geps) {
           if (m.search_point(Q) == size_type(-1)) {
             //cout << "adding point : " << Q << endl;
             if (!eff_box_init)
@@ -938,7 +954,21 @@ namespace getfem {
     base_node worst_q_P;
 
     void select_elements(int version) {
-      size_type nbpt = pts.size();
+      size_type nbpt = pts.size(), nbcv = gmm::mat_ncols(t);
+
+      // distance at the barycenters of the simplices, evaluated at once
+      std::vector<base_node> Gs(nbcv, base_node(N));
+      for (size_type i=0; i < nbcv; ++i) {
+        bool ext_simplex = false;
+        for (size_type k=0; k <= N; ++k)
+          if (t(k, i) >= nbpt) ext_simplex = true;
+        if (!ext_simplex) {
+          for (size_type k=0; k <= N; ++k) Gs[i] += pts[t(k,i)];
+          gmm::scale(Gs[i], scalar_type(1)/scalar_type(N+1));
+        }
+      }
+      base_vector dGs;
+      dist->values(Gs, dGs);
 
       worst_q = 1.;
       base_node weights(N+1);
@@ -954,10 +984,8 @@ namespace getfem {
           if (t(k, i) >= nbpt) ext_simplex = true;
 
         if (!ext_simplex) {
-          G = pts[t(0,i)];
-          for (size_type k=1; k <= N; ++k) G += pts[t(k,i)];
-          gmm::scale(G, scalar_type(1)/scalar_type(N+1));
-          dG = (*dist)(G);
+          G = Gs[i];
+          dG = dGs[i];
           gmm::clear(weights);
           
           q = quality_of_element(i);
@@ -982,6 +1010,8 @@ namespace getfem {
               }
         }
         if (ext_simplex || dG > 0 || is_bridge_simplex || q < 1e-14) {
+          size_type last = gmm::mat_ncols(t)-1; // moved to i by deletion
+          Gs[i] = Gs[last]; dGs[i] = dGs[last];
           delete_element(i);
         } else {
           ++i;
@@ -1192,27 +1222,77 @@ namespace getfem {
         for (size_type j=0; j < N+1; ++j)
           for (size_type k=j+1; k < N+1; ++k)
             edges_mesh.add_segment(t(j,i), t(k,i));
+      edges.resize(0);
+      for (dal::bv_visitor ie(edges_mesh.convex_index()); !ie.finished(); ++ie)
+        edges.push_back(ie);
+    }
+
+    /* The edges are distributed by contiguous blocks to the threads. */
+    size_type nb_threads(void) const {
+      return me_is_multithreaded_now() ? 1 : true_thread_policy::num_threads();
+    }
+
+    /* The lengths of the edges are computed in parallel, the desired
+       lengths serially since edge_len is a user function which is not
+       required to be thread safe. */
+    void compute_edge_lengths(void) {
+      size_type nb_th = nb_threads();
+      std::vector<scalar_type> sL(nb_th);
+      GETFEM_OMP_PARALLEL_NO_PARTITION(
+        size_type th = (nb_th == 1) ? 0 : true_thread_policy::this_thread();
+        for (size_type k = (edges.size() * th) / nb_th;
+             k < (edges.size() * (th+1)) / nb_th; ++k) {
+          size_type ie = edges[k];
+          const base_node &A = pts[edges_mesh.ind_points_of_convex(ie)[0]];
+          const base_node &B = pts[edges_mesh.ind_points_of_convex(ie)[1]];
+          L[ie] = gmm::vect_dist2(A, B);
+          sL[th] += pow(L[ie],scalar_type(N));
+        }
+      )
+      scalar_type sLt = 0, sL0t = 0;
+      for (size_type i = 0; i < nb_th; ++i) sLt += sL[i];
+      base_node C(N);
+      for (size_type ie : edges) {
+        const base_node &A = pts[edges_mesh.ind_points_of_convex(ie)[0]];
+        const base_node &B = pts[edges_mesh.ind_points_of_convex(ie)[1]];
+        gmm::add(A, B, C); C /= scalar_type(2);
+        L0[ie] = edge_len(C);
+        sL0t += pow(L0[ie],scalar_type(N));
+      }
+      gmm::scale(L0, L0mult * pow(sLt/sL0t, scalar_type(1)/scalar_type(N)));
     }
 
     void standard_move_strategy(base_vector &X) {
-      for (dal::bv_visitor ie(edges_mesh.convex_index());
-           !ie.finished(); ++ie) {
-        size_type iA = edges_mesh.ind_points_of_convex(ie)[0];
-        size_type iB = edges_mesh.ind_points_of_convex(ie)[1];
-        base_node bar = pts[iB]-pts[iA];
-        scalar_type F = std::max(L0[ie]-L[ie], 0.);
+      /* Each thread accumulates the forces of its edges in its own vector,
+         the vectors are summed afterwards in the order of the threads. */
+      size_type nb_th = nb_threads();
+      std::vector<base_vector> Xth(nb_th-1);
+      GETFEM_OMP_PARALLEL_NO_PARTITION(
+        size_type th = (nb_th == 1) ? 0 : true_thread_policy::this_thread();
+        if (th) gmm::resize(Xth[th-1], gmm::vect_size(X));
+        base_vector &Y = th ? Xth[th-1] : X;
+        base_node Fbar(N);
+        for (size_type k = (edges.size() * th) / nb_th;
+             k < (edges.size() * (th+1)) / nb_th; ++k) {
+          size_type ie = edges[k];
+          size_type iA = edges_mesh.ind_points_of_convex(ie)[0];
+          size_type iB = edges_mesh.ind_points_of_convex(ie)[1];
+          scalar_type F = std::max(L0[ie]-L[ie], 0.);
         
-        if (F) {
-          base_node Fbar = (bar)*(F/L[ie]);
+          if (F) {
+            gmm::add(pts[iB], gmm::scaled(pts[iA], scalar_type(-1)), Fbar);
+            gmm::scale(Fbar, F/L[ie]);
           
-          if (!pts_attr[iA]->fixed) // pts[iA] -= deltat*Fbar; 
-            gmm::add(gmm::scaled(Fbar, -deltat),
-                     gmm::sub_vector(X, gmm::sub_interval(iA*N, N)));
-          if (!pts_attr[iB]->fixed) // pts[iB] += deltat*Fbar;
-            gmm::add(gmm::scaled(Fbar, deltat),
-                     gmm::sub_vector(X, gmm::sub_interval(iB*N, N)));
+            if (!pts_attr[iA]->fixed) // pts[iA] -= deltat*Fbar; 
+              gmm::add(gmm::scaled(Fbar, -deltat),
+                       gmm::sub_vector(Y, gmm::sub_interval(iA*N, N)));
+            if (!pts_attr[iB]->fixed) // pts[iB] += deltat*Fbar;
+              gmm::add(gmm::scaled(Fbar, deltat),
+                       gmm::sub_vector(Y, gmm::sub_interval(iB*N, N)));
+          }
         }
-      }
+      )
+      for (size_type i = 1; i < nb_th; ++i) gmm::add(Xth[i-1], X);
     }
 
     void do_build_mesh(mesh &m,
@@ -1255,18 +1335,7 @@ namespace getfem {
         size_type nbcv = edges_mesh.convex_index().card();
         GMM_ASSERT1(nbcv != 0, "no more edges!");
         L.resize(nbcv); L0.resize(nbcv);
-        scalar_type sL = 0, sL0 = 0;
-        for (dal::bv_visitor ie(edges_mesh.convex_index());
-             !ie.finished(); ++ie) {
-          const base_node &A = pts[edges_mesh.ind_points_of_convex(ie)[0]];
-          const base_node &B = pts[edges_mesh.ind_points_of_convex(ie)[1]];
-          base_node C(A); C+=B; C /= scalar_type(2);
-          L[ie] = gmm::vect_dist2(A, B);
-          L0[ie] = edge_len(C);
-          sL += pow(L[ie],scalar_type(N));
-          sL0 += pow(L0[ie],scalar_type(N));
-        }
-        gmm::scale(L0, L0mult * pow(sL/sL0, scalar_type(1)/scalar_type(N)));
+        compute_edge_lengths();
 
         // Moving the points with standard strategy
         base_vector X(pts.size() * N);
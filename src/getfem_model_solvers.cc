@@ -94,7 +94,8 @@ namespace getfem {
   void compute_init_values(model &md, gmm::iteration &iter,
                            PLSOLVER lsolver,
                            abstract_newton_line_search &ls, const MATRIX &K,
-                           const VECTOR &rhs) {
+                           const VECTOR &rhs,
+                           newton_jacobian_reuse_policy *reuse) {
 
     VECTOR state(md.nb_dof());
     md.from_variables(state);
@@ -107,7 +108,7 @@ namespace getfem {
     // Solve for ddt
     md.set_time_step(ddt);
     gmm::iteration iter1 = iter;
-    standard_solve(md, iter1, lsolver, ls, K, rhs);
+    standard_solve(md, iter1, lsolver, ls, K, rhs, reuse);
     md.copy_init_time_derivative();
 
     // Restore the model state
@@ -125,7 +126,8 @@ namespace getfem {
   void standard_solve(model &md, gmm::iteration &iter,
                       PLSOLVER lsolver,
                       abstract_newton_line_search &ls, const MATRIX &K,
-                      const VECTOR &rhs) {
+                      const VECTOR &rhs,
+                      newton_jacobian_reuse_policy *reuse = 0) {
 
     VECTOR state(md.nb_dof());
     md.from_variables(state); // copy the model variables in the state vector
@@ -133,7 +135,7 @@ namespace getfem {
     int time_integration = md.is_time_integration();
     if (time_integration) {
       if (time_integration == 1 && md.is_init_step()) {
-        compute_init_values(md, iter, lsolver, ls, K, rhs);
+        compute_init_values(md, iter, lsolver, ls, K, rhs, reuse);
         return;
       }
       md.set_time(md.get_time() + md.get_time_step());
@@ -146,7 +148,13 @@ namespace getfem {
     }
     else {
       model_pb<MATRIX, VECTOR> mdpb(md, ls, state, rhs, K);
-      if (dynamic_cast<newton_search_with_step_control *>(&ls))
+      if (reuse) {
+        GMM_ASSERT1(!dynamic_cast<newton_search_with_step_control *>(&ls),
+                    "The reuse of the tangent matrix is not compatible "
+                    "with the Newton algorithm with step control");
+        Newton_with_jacobian_reuse(mdpb, iter, *lsolver, *reuse);
+      }
+      else if (dynamic_cast<newton_search_with_step_control *>(&ls))
         Newton_with_step_control(mdpb, iter, *lsolver);
       else
         classical_Newton(mdpb, iter, *lsolver);
@@ -169,6 +177,22 @@ namespace getfem {
   }
 
 
+  void standard_solve(model &md, gmm::iteration &iter,
+                      rmodel_plsolver_type lsolver,
+                      abstract_newton_line_search &ls,
+                      newton_jacobian_reuse_policy &reuse) {
+    standard_solve(md, iter, lsolver, ls, md.real_tangent_matrix(),
+                   md.real_rhs(), &reuse);
+  }
+
+  void standard_solve(model &md, gmm::iteration &iter,
+                      cmodel_plsolver_type lsolver,
+                      abstract_newton_line_search &ls,
+                      newton_jacobian_reuse_policy &reuse) {
+    standard_solve(md, iter, lsolver, ls, md.complex_tangent_matrix(),
+                   md.complex_rhs(), &reuse);
+  }
+
   void standard_solve(model &md, gmm::iteration &iter,
                       rmodel_plsolver_type lsolver) {
     default_newton_line_search ls;
@@ -263,20 +263,38 @@ namespace getfem
     }
 
     m.clear();
-    /* build a mesh with a geotrans of degree K */
+    /* build a mesh with a geotrans of degree K. The points of all the
+       convexes are collected without search and the duplicated ones are
+       merged at once. */
+    size_type nbpt = pgt->nb_points();
+    std::vector<base_node> pts;
+    pts.reserve(msh.nb_convex() * nbpt);
     for (dal::bv_visitor cv(msh.convex_index()); !cv.finished(); ++cv) {
       if (pgt == msh.trans_of_convex(cv)) {
-        m.add_convex_by_points(msh.trans_of_convex(cv),
-                               msh.points_of_convex(cv).begin());
+        pts.insert(pts.end(), msh.points_of_convex(cv).begin(),
+                   msh.points_of_convex(cv).end());
       } else {
-        std::vector<base_node> pts(pgt->nb_points());
-        for (size_type i=0; i < pgt->nb_points(); ++i) {
-          pts[i] = msh.trans_of_convex(cv)->transform
-            (pgt->convex_ref()->points()[i], msh.points_of_convex(cv));
-        }
-        m.add_convex_by_points(pgt, pts.begin());
+        for (size_type i=0; i < nbpt; ++i)
+          pts.push_back(msh.trans_of_convex(cv)->transform
+                        (pgt->convex_ref()->points()[i],
+                         msh.points_of_convex(cv)));
       }
     }
+    bgeot::node_tab ptab;
+    std::vector<size_type> ids, rep;
+    ptab.add_nodes(pts, ids);
+    ptab.merge_duplicated_nodes(rep);
+    /* the points are numbered in the order of their first occurrence */
+    std::vector<size_type> ind(rep.size(), size_type(-1)), ipts(nbpt);
+    for (size_type i = 0; i < ids.size(); ++i) {
+      size_type ip = rep[ids[i]];
+      if (ind[ip] == size_type(-1))
+        ind[ip] = m.add_point(ptab[ip], scalar_type(-1));
+    }
+    for (size_type k = 0; k < ids.size(); k += nbpt) {
+      for (size_type i = 0; i < nbpt; ++i) ipts[i] = ind[rep[ids[k+i]]];
+      m.add_convex(pgt, ipts.begin());
+    }
 
     /* apply a continuous deformation + some noise */
     if (noised) noise_unit_mesh(m, nsubdiv, pgt);
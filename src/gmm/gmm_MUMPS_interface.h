@@ -251,6 +251,99 @@ namespace gmm {
 
 
 
+  /** Factorization of a sparse matrix with MUMPS. The factors are kept
+   *  alive until the next call to build_with() or the destruction of
+   *  the object, so that several right hand sides can be solved
+   *  without refactorization. Works only with sparse or skyline
+   *  matrices (not distributed).
+   */
+  template <typename T> class MUMPS_factor {
+    typedef typename mumps_interf<T>::value_type MUMPS_T;
+    typedef typename mumps_interf<T>::MUMPS_STRUC_C MUMPS_STRUC_C;
+
+    std::unique_ptr<ij_sparse_matrix<T> > AA;
+    mutable MUMPS_STRUC_C id;
+    mutable std::vector<T> rhs;
+    bool is_init;
+    int rank;
+
+    void free_factor() {
+      if (is_init) {
+        id.job = -2; // JOB_END
+        mumps_interf<T>::mumps_c(id);
+        is_init = false;
+      }
+      AA.reset();
+    }
+
+  public :
+
+    /** Do the analysis and the factorization of A. Return false if the
+        matrix is detected to be singular. */
+    template <typename MAT> bool build_with(const MAT &A, bool sym = false) {
+      GMM_ASSERT2(gmm::mat_nrows(A) == gmm::mat_ncols(A), "Non-square matrix");
+      free_factor();
+      AA = std::make_unique<ij_sparse_matrix<T> >(A, sym);
+      rhs.resize(gmm::mat_nrows(A));
+
+      id.job = -1; // JOB_INIT
+      id.par = 1;
+      id.sym = sym ? 2 : 0;
+      id.comm_fortran = -987654; // USE_COMM_WORLD
+      mumps_interf<T>::mumps_c(id);
+      is_init = true;
+
+      if (rank == 0) {
+        id.n = int(gmm::mat_nrows(A));
+        id.nz = int(AA->irn.size());
+        id.irn = &(AA->irn[0]);
+        id.jcn = &(AA->jcn[0]);
+        id.a = (MUMPS_T*)(&(AA->a[0]));
+      }
+
+      id.ICNTL(1) = -1; // output stream for error messages
+      id.ICNTL(2) = -1; // output stream for other messages
+      id.ICNTL(3) = -1; // output stream for global information
+      id.ICNTL(4) = 0;  // verbosity level
+      id.ICNTL(14) += 80; // small boost to the workspace size (see MUMPS_solve)
+
+      id.job = 4; // analysis (job=1) + factorization (job=2)
+      mumps_interf<T>::mumps_c(id);
+      if (!mumps_error_check(id)) { free_factor(); return false; }
+      return true;
+    }
+
+    /** After factorization, solve AX = B (job=3). */
+    template <typename VECTX, typename VECTB>
+    bool solve(const VECTX &X_, const VECTB &B) const {
+      GMM_ASSERT1(is_init, "MUMPS_factor: no factorization available");
+      VECTX &X = const_cast<VECTX &>(X_);
+      gmm::copy(B, rhs);
+      if (rank == 0) id.rhs = (MUMPS_T*)(&(rhs[0]));
+      id.job = 3;
+      mumps_interf<T>::mumps_c(id);
+      bool ok = mumps_error_check(id);
+#ifdef GMM_USES_MPI
+      MPI_Bcast(&(rhs[0]),id.n,gmm::mpi_type(T()),0,MPI_COMM_WORLD);
+#endif
+      gmm::copy(rhs, X);
+      return ok;
+    }
+
+    bool is_factorized() const { return is_init; }
+    void clear() { free_factor(); }
+
+    MUMPS_factor() : is_init(false), rank(0) {
+#ifdef GMM_USES_MPI
+      MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+    }
+    MUMPS_factor(const MUMPS_factor &) = delete;
+    MUMPS_factor &operator=(const MUMPS_factor &) = delete;
+    ~MUMPS_factor() { free_factor(); }
+  };
+
+
   /** MUMPS solve interface for distributed matrices 
    *  Works only with sparse or skyline matrices
    */
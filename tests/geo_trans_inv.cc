@@ -144,6 +144,158 @@ void test_inversion(bool verbose) {
   test_inversion(bgeot::prism_linear_geotrans(3),verbose);
 }
 
+/* The Newton iterations of a square non-linear transformation use a fixed
+   size computation of the direction. Compare them with the inversion of
+   the same convex embedded in a space of higher dimension, which uses the
+   general computation. */
+void test_newton_direction(bgeot::pgeometric_trans pgt) {
+  size_type P = pgt->dim(), N = P+1;
+  std::vector<base_node> cvpts(pgt->nb_points()), cvpts_e(pgt->nb_points());
+  base_matrix M = random_base(N);
+  for (size_type i=0; i < pgt->nb_points(); ++i) {
+    cvpts[i] = pgt->convex_ref()->points()[i];
+    for (size_type j=0; j < P; ++j) cvpts[i][j] += gmm::random(double())*0.05;
+    base_node pe(N);
+    for (size_type j=0; j < P; ++j) pe[j] = cvpts[i][j];
+    cvpts_e[i] = base_node(N);
+    gmm::mult(M, pe, cvpts_e[i]);
+  }
+  bgeot::geotrans_inv_convex gic(cvpts, pgt), gic_e(cvpts_e, pgt);
+  for (size_type i=0; i < 50; ++i) {
+    base_node Pref(P), Pref1, Pref2, pe(N), Pe(N);
+    do {
+      for (size_type j=0; j < P; ++j) Pref[j] = gmm::random(double());
+    } while (pgt->convex_ref()->is_in(Pref) > -0.05);
+    base_node X = pgt->transform(Pref, cvpts.begin());
+    for (size_type j=0; j < P; ++j) pe[j] = X[j];
+    gmm::mult(M, pe, Pe);
+    bool converged1, converged2;
+    gic.invert(X, Pref1, converged1);
+    gic_e.invert(Pe, Pref2, converged2);
+    GMM_ASSERT1(converged1 && converged2, "Newton iterations of "
+                << bgeot::name_of_geometric_trans(pgt) << " did not converge");
+    GMM_ASSERT1(gmm::vect_dist2(pgt->transform(Pref1, cvpts.begin()), X)
+                < 1e-10 && gmm::vect_dist2(Pref1, Pref2) < 1e-8,
+                "Wrong inversion with " << bgeot::name_of_geometric_trans(pgt)
+                << " : " << Pref1 << " and " << Pref2 << " for "
+                << Pref);
+  }
+}
+
+void test_newton_direction() {
+  for (short_type N=1; N <= 3; ++N) {
+    test_newton_direction(bgeot::simplex_geotrans(N,2));
+    test_newton_direction(bgeot::simplex_geotrans(N,3));
+    test_newton_direction(bgeot::parallelepiped_geotrans(N,1));
+    test_newton_direction(bgeot::parallelepiped_geotrans(N,2));
+  }
+  test_newton_direction(bgeot::prism_geotrans(3,1));
+}
+
+/* The batched inversion of a set of points has to give the same result
+   as the inversion of each point. The convex is embedded in a space of
+   dimension N >= P to check also the residual of the linear case. */
+void test_invert_points(bgeot::pgeometric_trans pgt, size_type N) {
+  size_type P = pgt->dim();
+  std::vector<base_node> cvpts(pgt->nb_points());
+  base_matrix M = random_base(N);
+  for (size_type i=0; i < pgt->nb_points(); ++i) {
+    base_node pe(N);
+    for (size_type j=0; j < P; ++j)
+      pe[j] = pgt->convex_ref()->points()[i][j]
+        + gmm::random(double())*0.05;
+    cvpts[i] = base_node(N);
+    gmm::mult(M, pe, cvpts[i]);
+  }
+  bgeot::geotrans_inv_convex gic(cvpts, pgt);
+  bgeot::kdtree_tab_type ipts;
+  for (size_type i=0; i < 100; ++i) {
+    base_node Pref(P);
+    for (size_type j=0; j < P; ++j) Pref[j] = gmm::random() * 1.5 - 0.25;
+    base_node X = pgt->transform(Pref, cvpts.begin());
+    if (i % 10 == 0 && N > P) // out of the affine hull of the convex
+      gmm::add(gmm::scaled(gmm::mat_col(M, N-1), 0.1), X);
+    ipts.push_back(bgeot::index_node_pair(i, X));
+  }
+  std::vector<base_node> pts_ref;
+  std::vector<bool> in_cv, converged;
+  size_type nb_in = gic.invert_points(ipts, pts_ref, in_cv, converged);
+  GMM_ASSERT1(pts_ref.size() == ipts.size() && in_cv.size() == ipts.size()
+              && converged.size() == ipts.size(), "Wrong output size");
+  size_type nb_in2 = 0;
+  for (size_type i=0; i < ipts.size(); ++i) {
+    base_node Pref;
+    bool conv;
+    bool is_in = gic.invert(ipts[i].n, Pref, conv);
+    if (is_in) ++nb_in2;
+    GMM_ASSERT1(is_in == in_cv[i] && conv == converged[i]
+                && gmm::vect_dist2(Pref, pts_ref[i]) < 1e-12,
+                "Batched inversion differs with "
+                << bgeot::name_of_geometric_trans(pgt) << " : "
+                << pts_ref[i] << " instead of " << Pref);
+  }
+  GMM_ASSERT1(nb_in == nb_in2, "Wrong number of points in the convex");
+}
+
+void test_invert_points() {
+  for (short_type N=1; N <= 3; ++N) {
+    test_invert_points(bgeot::simplex_geotrans(N,1), N);
+    test_invert_points(bgeot::simplex_geotrans(N,1), N+1);
+    test_invert_points(bgeot::simplex_geotrans(N,2), N);
+    test_invert_points(bgeot::parallelepiped_geotrans(N,2), N);
+  }
+  test_invert_points(bgeot::prism_geotrans(3,1), 3);
+}
+
+/* Check of the shape functions of the transformations evaluated with
+   fixed size loops: Lagrange property, reproduction of the affine
+   functions and gradients compared to finite differences. */
+void test_shape_functions(bgeot::pgeometric_trans pgt) {
+  size_type nbp = pgt->nb_points(), N = pgt->dim();
+  base_vector val, val2;
+  base_matrix grad;
+  for (size_type j = 0; j < nbp; ++j) {
+    pgt->poly_vector_val(pgt->convex_ref()->points()[j], val);
+    for (size_type i = 0; i < nbp; ++i)
+      GMM_ASSERT1(gmm::abs(val[i] - ((i == j) ? 1. : 0.)) < 1E-12,
+                  "Wrong shape function " << i << " for "
+                  << bgeot::name_of_geometric_trans(pgt));
+  }
+  base_node pt(N), pt2(N);
+  scalar_type eps = 1E-6;
+  for (size_type k = 0; k < 10; ++k) {
+    gmm::fill_random(pt);
+    for (size_type n = 0; n < N; ++n) pt[n] = 0.1 + gmm::abs(pt[n]) / scalar_type(N);
+    pgt->poly_vector_val(pt, val);
+    base_node x(N);
+    scalar_type s = 0.;
+    for (size_type i = 0; i < nbp; ++i) {
+      s += val[i];
+      gmm::add(gmm::scaled(pgt->convex_ref()->points()[i], val[i]), x);
+    }
+    GMM_ASSERT1(gmm::abs(s - 1.) < 1E-12 && gmm::vect_dist2(x, pt) < 1E-12,
+                "Wrong shape functions for "
+                << bgeot::name_of_geometric_trans(pgt));
+    pgt->poly_vector_grad(pt, grad);
+    for (size_type n = 0; n < N; ++n) {
+      gmm::copy(pt, pt2); pt2[n] += eps;
+      pgt->poly_vector_val(pt2, val2);
+      for (size_type i = 0; i < nbp; ++i)
+        GMM_ASSERT1(gmm::abs((val2[i] - val[i]) / eps - grad(i, n)) < 1E-5,
+                    "Wrong gradient for "
+                    << bgeot::name_of_geometric_trans(pgt));
+    }
+  }
+}
+
+void test_shape_functions() {
+  for (short_type N = 2; N <= 3; ++N)
+    for (short_type K = 1; K <= 2; ++K) {
+      test_shape_functions(bgeot::simplex_geotrans(N,K));
+      test_shape_functions(bgeot::parallelepiped_geotrans(N,K));
+    }
+}
+
 int main(int argc, char *argv[]) {
   dim_type N, MESH_TYPE;
   scalar_type LX, LY, LZ;
@@ -156,6 +308,9 @@ int main(int argc, char *argv[]) {
   try {
     test0();
     test_inversion(true);
+    test_newton_direction();
+    test_invert_points();
+    test_shape_functions();
     PARAM.read_command_line(argc, argv);
     N = bgeot::dim_type(PARAM.int_value("N", "Domaine dimension"));
     NB_POINTS = PARAM.int_value("NB_POINTS", "Nb points");
@@ -23,6 +23,9 @@
 #include "getfem/bgeot_comma_init.h"
 #include "getfem/getfem_mesh_fem.h"
 #include "getfem/getfem_mat_elem.h"
+#include "getfem/getfem_mesh_im_level_set.h"
+#include "getfem/getfem_regular_meshes.h"
+#include "getfem/getfem_assembling.h"
 #include <iomanip>
 #include <map>
 using std::endl; using std::cout; using std::cerr;
@@ -446,6 +449,99 @@ static void print_some_methods() {
   print_method(getfem::classical_approx_im(bgeot::product_geotrans(bgeot::product_geotrans(bgeot::simplex_geotrans(2,2), bgeot::simplex_geotrans(2,2)), bgeot::simplex_geotrans(1,1)), 3));
 }
 
+/* Incremental adaptation of a mesh_im_level_set, in 1D where the cut of
+   the elements does not need qhull: the integration method of the cut
+   element is kept when the level set moves by less than the tolerance,
+   and rebuilt otherwise. */
+static scalar_type inside_measure(const getfem::mesh_im &mim,
+                                  const getfem::mesh_fem &mf) {
+  std::vector<scalar_type> one(mf.nb_dof(), 1.), F(mf.nb_dof());
+  getfem::asm_source_term(F, mim, mf, mf, one);
+  return gmm::vect_sp(F, one);
+}
+
+static void check_incremental_level_set_im() {
+  getfem::mesh m;
+  std::vector<size_type> nsubdiv(1, 10);
+  getfem::regular_unit_mesh(m, nsubdiv, bgeot::simplex_geotrans(1, 1));
+  getfem::level_set ls(m, 1);
+  const getfem::mesh_fem &lsmf = ls.get_mesh_fem();
+  getfem::mesh_level_set mls(m);
+  mls.add_level_set(ls);
+  getfem::pintegration_method
+    pim = getfem::int_method_descriptor("IM_GAUSS1D(4)");
+  getfem::mesh_im_level_set
+    mim(mls, getfem::mesh_im_level_set::INTEGRATE_INSIDE, pim);
+  mim.set_integration_method(m.convex_index(), pim);
+  getfem::mesh_fem mf(m);
+  mf.set_classical_finite_element(1);
+
+  scalar_type tol = 1E-3;
+  mim.set_incremental_adapt(true, tol);
+  /* x0: position of the cut, then number of rebuilt methods expected */
+  std::vector<std::pair<scalar_type, size_type>> steps
+    = { {.33, 1}, {.33, 0}, {.3305, 0}, {.37, 1}, {.57, 1} };
+  for (const auto &st : steps) {
+    for (size_type d = 0; d < lsmf.nb_dof(); ++d)
+      ls.values()[d] = lsmf.point_of_basic_dof(d)[0] - st.first;
+    ls.touch();
+    mls.adapt();
+    mim.adapt();
+    GMM_ASSERT1(mim.nb_rebuilt_methods() == st.second,
+                "Wrong number of rebuilt methods for x0 = " << st.first
+                << " : " << mim.nb_rebuilt_methods());
+    GMM_ASSERT1(gmm::abs(inside_measure(mim, mf) - st.first) <= tol,
+                "Wrong integration method for x0 = " << st.first);
+  }
+  /* without the incremental mode, the method is rebuilt */
+  mim.set_incremental_adapt(false);
+  mim.adapt();
+  GMM_ASSERT1(mim.nb_rebuilt_methods() == 1 &&
+              gmm::abs(inside_measure(mim, mf) - .57) < 1E-12,
+              "Wrong non incremental adaptation");
+}
+
+/* The cut elements are built by several threads in mesh_level_set::adapt.
+   The result has to be the same whatever the number of threads. */
+static void check_parallel_level_set_cut() {
+  getfem::mesh m;
+  std::vector<size_type> nsubdiv(1, 20);
+  getfem::regular_unit_mesh(m, nsubdiv, bgeot::simplex_geotrans(1, 1));
+  getfem::level_set ls(m, 1);
+  const getfem::mesh_fem &lsmf = ls.get_mesh_fem();
+  for (size_type d = 0; d < lsmf.nb_dof(); ++d) {
+    scalar_type x = lsmf.point_of_basic_dof(d)[0];
+    ls.values()[d] = (x - .33) * (x - .57) * (x - .81);
+  }
+  getfem::pintegration_method
+    pim = getfem::int_method_descriptor("IM_GAUSS1D(4)");
+  getfem::mesh_fem mf(m);
+  mf.set_classical_finite_element(1);
+
+  scalar_type meas_ref(0);
+  size_type nb_th[4] = { 1, 2, 3, 5 };
+  for (size_type n : nb_th) {
+    getfem::set_num_threads(int(n));
+    getfem::mesh_level_set mls(m);
+    mls.add_level_set(ls);
+    mls.adapt();
+    getfem::mesh_im_level_set
+      mim(mls, getfem::mesh_im_level_set::INTEGRATE_INSIDE, pim);
+    mim.set_integration_method(m.convex_index(), pim);
+    mim.adapt();
+    size_type nb_cut = 0;
+    for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+      if (mls.is_convex_cut(cv)) ++nb_cut;
+    scalar_type meas = inside_measure(mim, mf);
+    if (n == 1) meas_ref = meas;
+    GMM_ASSERT1(nb_cut == 3 && gmm::abs(meas - meas_ref) < 1E-12
+                && gmm::abs(meas - .57) < 5E-2, "Wrong cut of the elements "
+                "with " << n << " threads : " << nb_cut << " cut elements, "
+                "measure " << meas);
+  }
+  getfem::set_num_threads(int(getfem::max_concurrency()));
+}
+
 int main(/* int argc, char **argv */) {
 
   FE_ENABLE_EXCEPT;        // Enable floating point exception for Nan.
@@ -467,6 +563,8 @@ int main(/* int argc, char **argv */) {
     print_some_methods();
     check_orders();
     check_methods();
+    check_incremental_level_set_im();
+    check_parallel_level_set_cut();
     int failcnt = inspect_results();
     cout << "\nOrders of some approximate integration methods:\n";
     //check_orders();
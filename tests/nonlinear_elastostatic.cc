@@ -296,7 +296,17 @@ bool elastostatic_problem::solve(plain_vector &U) {
                           maxit ? maxit : 40000);
 
     /* let the non-linear solve (Newton) do its job */
-    getfem::standard_solve(model, iter);
+    size_type jacobian_reuse = PARAM.int_value("JACOBIAN_REUSE");
+    if (jacobian_reuse) {
+      getfem::newton_jacobian_reuse_policy reuse
+        (jacobian_reuse == 1 ? getfem::newton_jacobian_reuse_policy::MODIFIED_NEWTON
+                             : getfem::newton_jacobian_reuse_policy::BROYDEN);
+      getfem::default_newton_line_search ls;
+      getfem::standard_solve(model, iter,
+                             getfem::rselect_linear_solver(model, "superlu"),
+                             ls, reuse);
+    } else
+      getfem::standard_solve(model, iter);
 
     gmm::copy(model.real_variable("u"), U);
     //char s[100]; sprintf(s, "step%d", step+1);
@@ -56,19 +56,27 @@ close(TMPF);
 
 
 
-$er = 0;
-open F, "./nonlinear_elastostatic $tmp 2>&1 |" or die;
-while (<F>) {
-  # print $_;
-  if ($_ =~ /error has been detected/)
-  {
-    $er = 1;
-    print "============================================\n";
-    print $_, <F>;
+sub start_program
+{
+  my $def   = $_[0];
+  my $er = 0;
+  open F, "./nonlinear_elastostatic $tmp $def 2>&1 |" or die;
+  while (<F>) {
+    # print $_;
+    if ($_ =~ /error has been detected/)
+    {
+      $er = 1;
+      print "============================================\n";
+      print $_, <F>;
+    }
   }
+  close(F); if ($?) { `rm -f $tmp`; exit(1); }
+  if ($er == 1) { `rm -f $tmp`; exit(1); }
 }
-close(F); if ($?) { `rm -f $tmp`; exit(1); }
-if ($er == 1) { `rm -f $tmp`; exit(1); }
+
+start_program("");
+start_program("-d JACOBIAN_REUSE=1 -d MAXITER=100");
+start_program("-d JACOBIAN_REUSE=2 -d MAXITER=100");
 `rm -f $tmp`;
 
 
@@ -66,10 +66,51 @@ void dump_poly_eval() {
   }
 }
 
+/* Comparison of the compiled evaluation of a family of polynomials at a
+   set of points (a number of points which is not a multiple of the size
+   of the blocks) with the evaluation of each polynomial. */
+void test_polynomial_family() {
+  typedef bgeot::polynomial<bgeot::scalar_type> poly;
+  for (bgeot::short_type dim = 1; dim <= 3; ++dim)
+    for (bgeot::short_type dg = 0; dg <= 4; ++dg) {
+      std::vector<poly> PP(7);
+      for (unsigned k = 0; k < PP.size(); ++k) {
+        PP[k] = poly(dim, bgeot::short_type((dg + k) % (dg + 1)));
+        for (unsigned i = 0; i < PP[k].size(); ++i)
+          if (rand() % 3) PP[k][i] = bgeot::scalar_type(rand())
+                            / bgeot::scalar_type(RAND_MAX) - 0.5;
+      }
+      bgeot::polynomial_family F;
+      GMM_ASSERT1(bgeot::compile_polynomials(F, PP), "compilation failed");
+      bgeot::size_type npt = 19, nbp = PP.size();
+      std::vector<bgeot::scalar_type> X(npt*dim), val(npt*nbp);
+      std::vector<bgeot::scalar_type> grad(npt*nbp*dim);
+      for (unsigned i = 0; i < X.size(); ++i)
+        X[i] = bgeot::scalar_type(rand()) / bgeot::scalar_type(RAND_MAX);
+      F.eval(X.data(), npt, val.data());
+      F.eval_grad(X.data(), npt, grad.data());
+      for (bgeot::size_type i = 0; i < npt; ++i)
+        for (bgeot::size_type k = 0; k < nbp; ++k) {
+          bgeot::scalar_type a = PP[k].eval(X.begin() + i*dim);
+          GMM_ASSERT1(gmm::abs(a - val[i*nbp+k]) < 1e-13, "wrong value "
+                      << val[i*nbp+k] << " instead of " << a);
+          for (bgeot::short_type j = 0; j < dim; ++j) {
+            poly Q = PP[k]; Q.derivative(j);
+            a = Q.eval(X.begin() + i*dim);
+            GMM_ASSERT1(gmm::abs(a - grad[(i*dim+j)*nbp+k]) < 1e-13,
+                        "wrong derivative " << grad[(i*dim+j)*nbp+k]
+                        << " instead of " << a);
+          }
+        }
+    }
+}
+
 int main(void)
 {
   try {
 
+    test_polynomial_family();
+
     bgeot::base_poly W, Z; W[0] = 1.0;
     Z[0] = 2.0;
     cout << "rd = " << W.real_degree() << endl;
@@ -885,6 +885,237 @@ static void test_new_assembly(int N, int NX, int pK) {
 }
 
 
+// Repeated assemblies with the storage of the geometric quantities of the
+// mesh_im, compared to assemblies without it.
+static void test_geometric_cache() {
+  getfem::mesh m;
+  std::vector<size_type> nsubdiv(2, 6);
+  getfem::regular_unit_mesh(m, nsubdiv,
+                            bgeot::geometric_trans_descriptor("GT_QK(2,2)"));
+  base_matrix T(2, 2); T(0, 0) = 1.0; T(0, 1) = 0.3; T(1, 1) = 2.0;
+  m.transformation(T);
+  m.region(1) = getfem::outer_faces_of_mesh(m);
+
+  getfem::mesh_fem mf(m);
+  mf.set_classical_finite_element(2);
+  getfem::mesh_im mim(m);
+  mim.set_integration_method(4);
+  std::vector<scalar_type> U(mf.nb_dof());
+  gmm::fill_random(U);
+
+  getfem::ga_workspace workspace;
+  workspace.add_fem_variable("u", mf, gmm::sub_interval(0, mf.nb_dof()), U);
+  workspace.add_expression("(1+Norm_sqr(X))*Grad_u.Grad_Test_u"
+                           "+element_size*u*Test_u", mim);
+  workspace.add_expression("(Normal.X)*u*Test_u", mim, 1);
+
+  workspace.assembly(1);
+  base_vector V0 = workspace.assembled_vector();
+  // 1: all the elements stored, 2: only a few ones stored, 3: the index
+  // of the stored values does not fit, nothing is stored.
+  for (size_type max_bytes : {size_type(1) << 24, size_type(2000),
+                              size_type(64)}) {
+    mim.set_geometric_cache(max_bytes);
+    for (size_type k = 0; k < 2; ++k) {
+      gmm::clear(workspace.assembled_vector());
+      workspace.assembly(1);
+      base_vector V = workspace.assembled_vector();
+      gmm::add(gmm::scaled(V0, scalar_type(-1)), V);
+      GMM_ASSERT1(gmm::vect_norminf(V) < 1E-12 * gmm::vect_norminf(V0),
+                  "Wrong assembly with the geometric cache");
+    }
+    GMM_ASSERT1(mim.geometric_cache()->memsize()
+                <= max_bytes + sizeof(getfem::im_geometric_cache),
+                "Geometric cache too large");
+  }
+
+  // The modification of the mesh has to be taken into account
+  T(0, 1) = 0.0; T(1, 1) = 0.5;
+  m.transformation(T);
+  gmm::clear(workspace.assembled_vector());
+  workspace.assembly(1);
+  base_vector V1 = workspace.assembled_vector();
+  mim.set_geometric_cache(0);
+  gmm::clear(workspace.assembled_vector());
+  workspace.assembly(1);
+  gmm::add(gmm::scaled(workspace.assembled_vector(), scalar_type(-1)), V1);
+  GMM_ASSERT1(gmm::vect_norminf(V1) < 1E-12 * gmm::vect_norminf(V0),
+              "Geometric cache not updated after a mesh modification");
+
+  // The values stored by an assembly which does not use the element size
+  // are reused by an assembly which uses it.
+  getfem::ga_workspace workspace2, workspace3;
+  workspace2.add_fem_variable("u", mf, gmm::sub_interval(0, mf.nb_dof()), U);
+  workspace2.add_expression("u*Test_u", mim);
+  workspace2.add_expression("u*Test_u", mim, 1);
+  workspace3.add_fem_variable("u", mf, gmm::sub_interval(0, mf.nb_dof()), U);
+  workspace3.add_expression("element_size*u*Test_u", mim);
+  workspace3.add_expression("element_size*u*Test_u", mim, 1);
+  workspace3.assembly(1);
+  base_vector V2 = workspace3.assembled_vector();
+  mim.set_geometric_cache(size_type(1) << 24);
+  workspace2.assembly(1);
+  gmm::clear(workspace3.assembled_vector());
+  workspace3.assembly(1);
+  gmm::add(gmm::scaled(workspace3.assembled_vector(), scalar_type(-1)), V2);
+  GMM_ASSERT1(gmm::vect_norminf(V2)
+              < 1E-12 * gmm::vect_norminf(workspace3.assembled_vector()),
+              "Wrong element size stored in the geometric cache");
+  mim.set_geometric_cache(0);
+}
+
+
+// Estimation of the degree of the integrands and replacement of the
+// integration method by a cheaper one being still exact.
+static void test_quadrature_reduction() {
+  getfem::mesh m;
+  std::vector<size_type> nsubdiv(3, 3);
+  getfem::regular_unit_mesh(m, nsubdiv, bgeot::simplex_geotrans(3, 1));
+
+  getfem::mesh_fem mf(m);
+  mf.set_classical_finite_element(2);
+  getfem::mesh_im mim(m);
+  getfem::pintegration_method pim
+    = getfem::int_method_descriptor("IM_TETRAHEDRON(8)");
+  mim.set_integration_method(pim);
+  getfem::papprox_integration pai = pim->approx_method();
+  long nb_refs = pai.use_count();
+  GMM_ASSERT1(getfem::approx_im_exactness_degree(pai) == 8,
+              "Wrong degree of exactness of IM_TETRAHEDRON(8)");
+  GMM_ASSERT1(pai.use_count() == nb_refs,
+              "The cache of the degrees of exactness keeps the methods");
+  std::vector<scalar_type> U(mf.nb_dof());
+  gmm::fill_random(U);
+
+  getfem::ga_workspace workspace;
+  workspace.add_fem_variable("u", mf, gmm::sub_interval(0, mf.nb_dof()), U);
+  workspace.add_expression("(1+X(1))*u*Test_u + Grad_u.Grad_Test_u", mim);
+  size_type N = mf.nb_dof();
+  getfem::model_real_sparse_matrix K0(N, N), K(N, N);
+  workspace.set_assembled_matrix(K0);
+  workspace.assembly(2);
+
+  workspace.set_quadrature_reduction(2);
+  workspace.set_assembled_matrix(K);
+  workspace.assembly(2);
+  const auto &report = workspace.quadrature_report();
+  GMM_ASSERT1(report.size() == 1 && report[0].estimated_degree == 5 &&
+              report[0].method_degree == 8 &&
+              report[0].nb_suggested_points > 0 &&
+              report[0].nb_suggested_points < report[0].nb_points,
+              "Wrong quadrature report");
+  gmm::add(gmm::scaled(K0, scalar_type(-1)), K);
+  GMM_ASSERT1(gmm::mat_maxnorm(K) < 1E-12 * gmm::mat_maxnorm(K0),
+              "Wrong assembly with a reduced integration method");
+
+  // A non polynomial term prevents the reduction
+  getfem::ga_workspace workspace2;
+  workspace2.add_fem_variable("u", mf, gmm::sub_interval(0, N), U);
+  workspace2.add_expression("exp(u)*Test_u", mim);
+  workspace2.set_quadrature_reduction(1);
+  workspace2.assembly(1);
+  GMM_ASSERT1(workspace2.quadrature_report().size() == 1 &&
+              workspace2.quadrature_report()[0].estimated_degree == -1,
+              "The degree of a non polynomial term cannot be estimated");
+}
+
+
+// Terms with constant coefficients integrated once on the reference element,
+// compared to the same terms made element dependent.
+static void test_reference_integration() {
+  getfem::mesh m;
+  std::vector<size_type> nsubdiv(3, 3);
+  getfem::regular_unit_mesh(m, nsubdiv, bgeot::simplex_geotrans(3, 1));
+  base_matrix T(3, 3); T(0, 0) = 1.0; T(0, 1) = 0.3; T(1, 1) = 2.0;
+  T(2, 2) = 0.5;
+  m.transformation(T);
+
+  getfem::mesh_fem mf(m), mfv(m, 3);
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+    mf.set_finite_element(cv, getfem::classical_fem(m.trans_of_convex(cv),
+                                                    (cv % 3) ? 2 : 1));
+  mfv.set_classical_finite_element(2);
+  getfem::mesh_im mim(m);
+  mim.set_integration_method(4);
+  size_type N = mf.nb_dof(), NV = mfv.nb_dof();
+  std::vector<scalar_type> U(N), V(NV), A(9, 0.5);
+  A[0] = 2.0; A[4] = 3.0; A[8] = 1.0;
+
+  const std::string expr = "(3*u*Test_u + Test_u + u*([0,1,0].Test_v)"
+                           " + (Reshape(A,3,3)*v).Test_v)";
+  getfem::model_real_sparse_matrix K[2]
+    = {getfem::model_real_sparse_matrix(N+NV, N+NV),
+       getfem::model_real_sparse_matrix(N+NV, N+NV)};
+  base_vector F[2] = {base_vector(N+NV), base_vector(N+NV)};
+  for (size_type k = 0; k < 2; ++k) {
+    getfem::ga_workspace workspace;
+    workspace.add_fem_variable("u", mf, gmm::sub_interval(0, N), U);
+    workspace.add_fem_variable("v", mfv, gmm::sub_interval(N, NV), V);
+    workspace.add_fixed_size_constant("A", A);
+    workspace.add_expression(k ? expr + "*(element_size/element_size)" : expr,
+                             mim);
+    workspace.set_assembled_matrix(K[k]);
+    workspace.set_assembled_vector(F[k]);
+    workspace.assembly(2);
+    workspace.assembly(1);
+  }
+  gmm::add(gmm::scaled(K[1], scalar_type(-1)), K[0]);
+  gmm::add(gmm::scaled(F[1], scalar_type(-1)), F[0]);
+  GMM_ASSERT1(gmm::mat_maxnorm(K[0]) < 1E-12 * gmm::mat_maxnorm(K[1]) &&
+              gmm::vect_norminf(F[0]) < 1E-12 * gmm::vect_norminf(F[1]),
+              "Wrong assembly with the reference element integration");
+
+  // Pure source terms, scalar and vector: all the terms of the order 1
+  // assembly are integrated on the reference element.
+  const std::string rhs = "(3*Test_u + [1,2,3].Test_v"
+                          " + (Reshape(A,3,3)*[1,0,2]).Test_v)";
+  base_vector G[2] = {base_vector(N+NV), base_vector(N+NV)};
+  for (size_type k = 0; k < 2; ++k) {
+    getfem::ga_workspace workspace;
+    workspace.add_fem_variable("u", mf, gmm::sub_interval(0, N), U);
+    workspace.add_fem_variable("v", mfv, gmm::sub_interval(N, NV), V);
+    workspace.add_fixed_size_constant("A", A);
+    workspace.add_expression(k ? rhs + "*(element_size/element_size)" : rhs,
+                             mim);
+    workspace.set_assembled_vector(G[k]);
+    workspace.assembly(1);
+  }
+  gmm::add(gmm::scaled(G[1], scalar_type(-1)), G[0]);
+  GMM_ASSERT1(gmm::vect_norminf(G[0]) < 1E-12 * gmm::vect_norminf(G[1]),
+              "Wrong source term with the reference element integration");
+
+  // Gradient terms: Laplacian, advection, isotropic elasticity and source
+  // terms, integrated as polynomials in the components of B.
+  const std::string grad = "(Grad_u.Grad_Test_u + 2*u*Test_u"
+    " + ([1,2,0].Grad_u)*Test_u + 2*Sym(Grad_v):Grad_Test_v"
+    " + 3*Div_v*Div_Test_v + ([1,0,1].Grad_Test_u)*([0,1,1].v))";
+  const std::string grad_rhs = "([1,2,3].Grad_Test_u + 2*Div_Test_v"
+    " + Trace(Reshape(A,3,3)*Grad_Test_v))";
+  getfem::model_real_sparse_matrix KG[2]
+    = {getfem::model_real_sparse_matrix(N+NV, N+NV),
+       getfem::model_real_sparse_matrix(N+NV, N+NV)};
+  base_vector FG[2] = {base_vector(N+NV), base_vector(N+NV)};
+  for (size_type k = 0; k < 2; ++k) {
+    std::string ext = k ? "*(element_size/element_size)" : "";
+    getfem::ga_workspace workspace, workspace_rhs;
+    for (getfem::ga_workspace *w : {&workspace, &workspace_rhs}) {
+      w->add_fem_variable("u", mf, gmm::sub_interval(0, N), U);
+      w->add_fem_variable("v", mfv, gmm::sub_interval(N, NV), V);
+      w->add_fixed_size_constant("A", A);
+    }
+    workspace.add_expression(grad + ext, mim);
+    workspace.set_assembled_matrix(KG[k]);
+    workspace.assembly(2);
+    workspace_rhs.add_expression(grad_rhs + ext, mim);
+    workspace_rhs.set_assembled_vector(FG[k]);
+    workspace_rhs.assembly(1);
+  }
+  gmm::add(gmm::scaled(KG[1], scalar_type(-1)), KG[0]);
+  gmm::add(gmm::scaled(FG[1], scalar_type(-1)), FG[0]);
+  GMM_ASSERT1(gmm::mat_maxnorm(KG[0]) < 1E-12 * gmm::mat_maxnorm(KG[1]) &&
+              gmm::vect_norminf(FG[0]) < 1E-12 * gmm::vect_norminf(FG[1]),
+              "Wrong gradient terms with the reference element integration");
+}
 
 
 int main(int argc, char *argv[]) {
@@ -894,6 +1125,9 @@ int main(int argc, char *argv[]) {
   
   test_new_assembly(2, 25, 2);
   test_new_assembly(3, 7, 2);
+  test_geometric_cache();
+  test_quadrature_reduction();
+  test_reference_integration();
 
 
   // testbug();
@@ -282,6 +282,65 @@ void test_different_mesh(int mat_version, size_type dim, size_type N, size_type
   //mf1.write_to_file("toto.mf",true);
 }
 
+/* Compare the location of the points by mesh_trans_inv::distribute, which
+   shares the convexes between the threads, with a serial location made
+   convex by convex in increasing order. */
+void test_distribute(int extrapolation) {
+  mesh m;
+  build_mesh(m, 0, 2, 2, quick ? 6 : 12, 2, true);
+  scalar_type EPS = 1E-12;
+  getfem::mesh_trans_inv mti(m, EPS);
+  std::vector<base_node> pts(quick ? 500 : 3000);
+  for (size_type i = 0; i < pts.size(); ++i) {
+    pts[i] = base_node(2);
+    for (size_type k = 0; k < 2; ++k)
+      pts[i][k] = gmm::random(double()) * 1.2 - 0.1;
+    mti.add_point(pts[i]);
+  }
+  mti.distribute(extrapolation);
+
+  std::vector<size_type> cv_of_pt(pts.size(), size_type(-1));
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+    for (size_type i = 0; i < mti.nb_points_on_convex(cv); ++i) {
+      size_type ipt = mti.point_on_convex(cv, i);
+      GMM_ASSERT1(cv_of_pt[ipt] == size_type(-1), "point located twice");
+      cv_of_pt[ipt] = cv;
+    }
+
+  bgeot::geotrans_inv_convex gic;
+  base_node pt_ref, pmin, pmax;
+  for (size_type i = 0; i < pts.size(); ++i) {
+    size_type cv_ref = size_type(-1);
+    scalar_type dist(0);
+    base_node pt_ref_ref;
+    for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+      bgeot::pgeometric_trans pgt = m.trans_of_convex(cv);
+      bounding_box(pmin, pmax, m.points_of_convex(cv), pgt);
+      bool inbox = true;
+      for (size_type k = 0; k < 2; ++k)
+        if (pts[i][k] < pmin[k] - EPS || pts[i][k] > pmax[k] + EPS)
+          inbox = false;
+      if (!inbox) continue;
+      gic.init(m.points_of_convex(cv), pgt);
+      bool converged;
+      bool gicisin = gic.invert(pts[i], pt_ref, converged, EPS,
+                                extrapolation == 0);
+      if (!(extrapolation || gicisin)) continue;
+      scalar_type isin = pgt->convex_ref()->is_in(pt_ref);
+      if (cv_ref == size_type(-1) || isin < dist)
+        { cv_ref = cv; dist = isin; pt_ref_ref = pt_ref; }
+      if (dist <= scalar_type(0)) break;
+    }
+    GMM_ASSERT1(cv_of_pt[i] == cv_ref, "point " << i << " located in "
+                << cv_of_pt[i] << " instead of " << cv_ref);
+    if (cv_ref != size_type(-1))
+      GMM_ASSERT1(gmm::vect_dist2(mti.reference_coords()[i], pt_ref_ref)
+                  < 1E-10, "wrong reference coordinates of point " << i);
+  }
+  cout << "mesh_trans_inv::distribute with extrapolation " << extrapolation
+       << " : ok\n";
+}
+
 void test0() {
   mesh m1, m2;
   std::stringstream ss1("BEGIN POINTS LIST\n"
@@ -411,6 +470,8 @@ int main(int argc, char *argv[]) {
   
   testDim_3D();
   test0();
+  test_distribute(0);
+  test_distribute(1);
   for (int mat_version = 0; mat_version < 5; ++mat_version) {
     const char *msg[] = {"Testing interpolation", 
 			 "Testing stored interpolator in rsc matrix",
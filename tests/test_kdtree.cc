@@ -19,13 +19,14 @@
 
 ===========================================================================*/
 #include "getfem/bgeot_kdtree.h"
-#include "getfem/bgeot_kdtree.h"
 #include "getfem/dal_bit_vector.h"
+#include "getfem/getfem_omp.h"
 using std::endl; using std::cout; using std::cerr;
 using std::ends; using std::cin;
 using bgeot::base_node;
 using bgeot::size_type;
 using bgeot::dim_type;
+using bgeot::scalar_type;
 
 bool quick = false;
 
@@ -58,6 +59,88 @@ void verify_points_in_box(const std::vector<base_node>& v, bgeot::kdtree& tree,
   assert(bv1 == bv2);
 }
 
+void verify_neighbors(const std::vector<base_node>& v, bgeot::kdtree& tree,
+                      const base_node &pos, size_type k, scalar_type r) {
+  std::vector<scalar_type> d2(v.size()), d2s;
+  for (size_type i=0; i < v.size(); ++i) d2[i] = gmm::vect_dist2_sqr(v[i], pos);
+  d2s = d2; std::sort(d2s.begin(), d2s.end());
+
+  bgeot::index_node_pair ipt;
+  scalar_type dmin = tree.nearest_neighbor(ipt, pos);
+  assert(v.size() == 0 || (dmin == d2s[0] && d2[ipt.i] == dmin));
+
+  bgeot::kdtree_tab_type ipts;
+  std::vector<scalar_type> dist2;
+  tree.k_nearest_neighbors(ipts, dist2, pos, k);
+  assert(ipts.size() == std::min(k, v.size()));
+  for (size_type i=0; i < ipts.size(); ++i)
+    assert(dist2[i] == d2s[i] && d2[ipts[i].i] == dist2[i]);
+
+  dal::bit_vector bv1, bv2;
+  for (size_type i=0; i < v.size(); ++i) if (d2[i] <= r*r) bv1.add(i);
+  tree.points_in_ball(ipts, pos, r);
+  for (size_type i=0; i < ipts.size(); ++i) bv2.add(ipts[i].i);
+  assert(bv1 == bv2);
+}
+
+void check_neighbors() {
+  bgeot::kdtree tree;
+  std::vector<base_node> pts;
+  for (size_type i=0; i < 500; ++i) {
+    pts.push_back(base_node(gmm::random(), gmm::random(), gmm::random()));
+    if (i % 10 == 0) pts.push_back(pts.back()); // duplicated points
+  }
+  for (size_type i=0; i < pts.size(); ++i) tree.add_point(pts[i]);
+  for (size_type i=0; i < 100; ++i) {
+    base_node pos(gmm::random()*1.2, gmm::random()*1.2, gmm::random()*1.2);
+    verify_neighbors(pts, tree, pos, 1 + (i % 20), gmm::random()*0.3);
+  }
+  for (size_type i=0; i < 20; ++i)
+    verify_neighbors(pts, tree, pts[i], 600, 0.);
+
+  std::vector<bgeot::kdtree_tab_type> ipts;
+  tree.k_nearest_neighbors(ipts, pts, 3);
+  for (size_type i=0; i < pts.size(); ++i)
+    assert(ipts[i].size() == 3 &&
+           gmm::vect_dist2(ipts[i][0].n, pts[i]) == 0.);
+
+  std::vector<bgeot::kdtree_tab_type> bpts;
+  tree.points_in_ball(bpts, pts, 0.1);
+  assert(bpts.size() == pts.size());
+  for (size_type i=0; i < pts.size(); ++i) {
+    bgeot::kdtree_tab_type ipts1;
+    tree.points_in_ball(ipts1, pts[i], 0.1);
+    assert(ipts1.size() == bpts[i].size());
+    for (size_type j=0; j < ipts1.size(); ++j)
+      assert(ipts1[j].i == bpts[i][j].i);
+  }
+  cout << "the kdtree neighbor searches are ok!\n";
+}
+
+/* The lower levels of the tree are built concurrently. The tree has to
+   be the same whatever the number of threads. */
+void check_parallel_build() {
+  std::vector<base_node> pts;
+  for (size_type i=0; i < 2000; ++i)
+    pts.push_back(base_node(gmm::random(), gmm::random()));
+  bgeot::kdtree tree_ref;
+  for (size_type i=0; i < pts.size(); ++i) tree_ref.add_point(pts[i]);
+  tree_ref.build_tree();
+  size_type nb_th[4] = { 1, 2, 3, 5 };
+  for (size_type n : nb_th) {
+    getfem::set_num_threads(int(n));
+    bgeot::kdtree tree;
+    for (size_type i=0; i < pts.size(); ++i) tree.add_point(pts[i]);
+    tree.build_tree();
+    assert(tree.nb_points() == pts.size());
+    for (size_type i=0; i < pts.size(); ++i)
+      assert(tree.points()[i].i == tree_ref.points()[i].i);
+    verify_points_in_box(pts, tree, base_node(.2,.3), base_node(.6,.5));
+  }
+  getfem::set_num_threads(int(getfem::max_concurrency()));
+  cout << "\nthe parallel construction of the kdtree is ok!\n";
+}
+
 void check_tree() {
   bgeot::kdtree tree;
   std::vector<size_type> ipts;
@@ -144,6 +227,8 @@ void speed_test(unsigned N, unsigned NPT, unsigned nrepeat) {
 int main(int argc, char **argv) {
   if (argc == 2 && strcmp(argv[1],"-quick")==0) quick = true;
   check_tree();
+  check_neighbors();
+  check_parallel_build();
   if (!quick)
     speed_test(3,300000,20000);
   else speed_test(2,10000,100);
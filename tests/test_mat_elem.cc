@@ -324,6 +324,131 @@ void test2_mat_elem(const getfem::mesh_im &mim, const getfem::mesh_fem &mf,
 }
 
 
+/* The precomputations of the base functions on a set of points are found
+   in the shared index of the stored objects by all the threads: each
+   thread gets the object built serially, with the same values. */
+void test_shared_precomp() {
+  const char *fems[] = { "FEM_PK(2,1)", "FEM_PK(2,2)", "FEM_QK(2,2)",
+                         "FEM_PK(3,3)", "FEM_PK_DISCONTINUOUS(2,2)" };
+  size_type nbf = sizeof(fems) / sizeof(fems[0]);
+  std::vector<getfem::pfem> pfs(nbf);
+  std::vector<std::vector<base_node> > pts(nbf);
+  std::vector<getfem::pfem_precomp> pfps(nbf);
+  std::vector<bgeot::base_tensor> vals(nbf);
+  // The table of the stored point tabs is thread local, so they are
+  // created once, before the parallel region.
+  std::vector<bgeot::pstored_point_tab> pspts(nbf);
+  for (size_type i = 0; i < nbf; ++i) {
+    pfs[i] = getfem::fem_descriptor(fems[i]);
+    for (size_type j = 0; j < 7; ++j) {
+      base_node P(pfs[i]->dim());
+      gmm::fill_random(P); P *= 0.3;
+      pts[i].push_back(P);
+    }
+    pspts[i] = bgeot::store_point_tab(pts[i]);
+    pfps[i] = getfem::fem_precomp(pfs[i], pspts[i], 0);
+    pfs[i]->base_value(pts[i][3], vals[i]);
+  }
+
+  size_type nb_th = getfem::me_is_multithreaded_now()
+                  ? 1 : getfem::true_thread_policy::num_threads();
+  std::vector<int> errors(nb_th, 0);
+  GETFEM_OMP_PARALLEL_NO_PARTITION(
+    size_type th = (nb_th == 1) ? 0 : getfem::true_thread_policy::this_thread();
+    for (size_type k = 0; k < 10 * nbf; ++k) {
+      size_type i = (k + th) % nbf;
+      getfem::pfem_precomp pfp
+        = getfem::fem_precomp(pfs[i], pspts[i], 0);
+      if (pfp != pfps[i]) ++errors[th];
+      else if (gmm::vect_dist2(pfp->val(3).as_vector(), vals[i].as_vector())
+               > 1E-12) ++errors[th];
+    }
+  )
+  for (size_type i = 0; i < nb_th; ++i)
+    GMM_ASSERT1(errors[i] == 0, "Thread " << i << " did not find the "
+                "shared fem precomputations");
+  cout << "Shared fem precomputations : ok\n";
+}
+
+/* Distance between the values of a point in a precomp_table and the
+   components of v. */
+template <typename VECT>
+static scalar_type table_dist(const bgeot::precomp_table &t, size_type i,
+                              const VECT &v) {
+  if (t.stride() != v.size()) return scalar_type(1);
+  scalar_type d(0);
+  const scalar_type *p = t.data(i);
+  for (auto it = v.begin(); it != v.end(); ++it, ++p)
+    d = std::max(d, gmm::abs(*p - *it));
+  return d;
+}
+
+/* A few points in the reference convex, around its center. */
+static std::vector<base_node>
+points_around_center(const bgeot::convex_of_reference &cvr) {
+  base_node C(cvr.structure()->dim());
+  for (const base_node &P : cvr.points()) C += P;
+  C /= scalar_type(cvr.points().size());
+  std::vector<base_node> pts(5, C);
+  for (base_node &P : pts) {
+    base_node D(C.size());
+    gmm::fill_random(D);
+    P += D * 0.1;
+  }
+  return pts;
+}
+
+/* The contiguous tables of fem_precomp_ and geotrans_precomp_ compared to
+   the values computed point by point (polynomial, vectorial and rational
+   fems, simplex and product transformations). */
+void test_precomp_tables() {
+  const char *fems[] = { "FEM_PK(2,2)", "FEM_QK(3,2)", "FEM_HERMITE(2)",
+                         "FEM_RT0(2)", "FEM_PYRAMID_LAGRANGE(1)" };
+  for (const char *fem : fems) {
+    getfem::pfem pf = getfem::fem_descriptor(fem);
+    std::vector<base_node> pts = points_around_center(*(pf->ref_convex(0)));
+    getfem::pfem_precomp pfp
+      = getfem::fem_precomp(pf, bgeot::store_point_tab(pts), 0);
+    bgeot::base_tensor t;
+    for (size_type i = 0; i < pts.size(); ++i) {
+      pf->base_value(pts[i], t);
+      GMM_ASSERT1(table_dist(pfp->val_table(), i, t) < 1E-12
+                  && table_dist(pfp->val_table(), i, pfp->val(i)) == 0,
+                  "Wrong table of values for " << fem);
+      pf->grad_base_value(pts[i], t);
+      GMM_ASSERT1(table_dist(pfp->grad_table(), i, t) < 1E-12
+                  && table_dist(pfp->grad_table(), i, pfp->grad(i)) == 0,
+                  "Wrong table of gradients for " << fem);
+      pf->hess_base_value(pts[i], t);
+      GMM_ASSERT1(table_dist(pfp->hess_table(), i, t) < 1E-12
+                  && table_dist(pfp->hess_table(), i, pfp->hess(i)) == 0,
+                  "Wrong table of hessians for " << fem);
+    }
+  }
+
+  const char *gts[] = { "GT_PK(2,2)", "GT_QK(3,1)", "GT_PRISM(3,1)" };
+  for (const char *gt : gts) {
+    bgeot::pgeometric_trans pgt = bgeot::geometric_trans_descriptor(gt);
+    std::vector<base_node> pts = points_around_center(*(pgt->convex_ref()));
+    bgeot::pgeotrans_precomp pgp
+      = bgeot::geotrans_precomp(pgt, bgeot::store_point_tab(pts), 0);
+    base_vector v;
+    bgeot::base_matrix G;
+    for (size_type i = 0; i < pts.size(); ++i) {
+      pgt->poly_vector_val(pts[i], v);
+      GMM_ASSERT1(table_dist(pgp->val_table(), i, v) < 1E-12
+                  && table_dist(pgp->val_table(), i, pgp->val(i)) == 0,
+                  "Wrong table of values for " << gt);
+      pgt->poly_vector_grad(pts[i], G);
+      GMM_ASSERT1(table_dist(pgp->grad_table(), i, G.as_vector()) < 1E-12
+                  && table_dist(pgp->grad_table(), i,
+                                pgp->grad(i).as_vector()) == 0,
+                  "Wrong table of gradients for " << gt);
+    }
+  }
+  cout << "Tables of precomputations : ok\n";
+}
+
 /**************************************************************************/
 /*  main program.                                                         */
 /**************************************************************************/
@@ -344,6 +469,9 @@ int main(int argc, char *argv[]) {
     
     
     
+    test_shared_precomp();
+    test_precomp_tables();
+
     exectime = gmm::uclock_sec();
     test1_mat_elem(p.mim, p.mef, p.mef_data);
     cout << "Mat elem computation time 1 : "
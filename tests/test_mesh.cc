@@ -23,9 +23,14 @@
 #include "getfem/bgeot_comma_init.h"
 #include "getfem/getfem_export.h"
 #include "getfem/bgeot_node_tab.h"
+#include "getfem/getfem_models.h"
+#include "getfem/getfem_binary_io.h"
+#include "getfem/getfem_import.h"
+#include "getfem/getfem_mesher.h"
 using std::endl; using std::cout; using std::cerr;
 using std::ends; using std::cin;
 using getfem::size_type;
+using getfem::scalar_type;
 using getfem::base_node;
 using getfem::base_small_vector;
 
@@ -303,6 +308,143 @@ void test_region() {
   cout << "a=" << a << "\nb=" << b << "a inter b=" << r << "\n";
 }
 
+void check_region(const getfem::mesh_region &r,
+                  const std::map<size_type, getfem::mesh_region::face_bitset>
+                  &ref) {
+  auto it = ref.begin();
+  for (getfem::mr_visitor i(r); !i.finished(); ++it) {
+    assert(it != ref.end() && i.cv() == it->first);
+    getfem::mesh_region::face_bitset mask;
+    for (size_type cv = i.cv(); !i.finished() && i.cv() == cv; ++i)
+      mask.set(i.is_face() ? i.f()+1 : 0);
+    assert(mask == it->second && r[it->first] == it->second);
+  }
+  assert(it == ref.end() && r.index().card() == ref.size());
+}
+
+void test_region_storage() {
+  getfem::mesh_region r;
+  std::map<size_type, getfem::mesh_region::face_bitset> ref;
+  for (size_type k = 0; k < 2000; ++k) {
+    size_type cv = (k * 7919) % 997;
+    bgeot::short_type f = bgeot::short_type(k % 5);
+    if (k % 3 == 0) { r.add(cv); ref[cv].set(0); }
+    else { r.add(cv, f); ref[cv].set(f+1); }
+    if (k % 500 == 0) check_region(r, ref);
+  }
+  check_region(r, ref);
+  for (size_type cv = 0; cv < 997; cv += 11) {
+    r.sup(cv); ref[cv].reset(0);
+    if (ref[cv].none()) ref.erase(cv);
+  }
+  check_region(r, ref);
+  assert(r.is_in(1, 0) == (ref.count(1) && ref[1][1]));
+
+  /* swap with only one or both convexes in the region */
+  getfem::mesh_region s;
+  s.add(10); s.add(20, 1); s.add(30); s.add(40, 2);
+  s.swap_convex(10, 35);
+  s.swap_convex(40, 5);
+  s.swap_convex(20, 30);
+  std::map<size_type, getfem::mesh_region::face_bitset> refs;
+  refs[35].set(0); refs[30].set(2); refs[20].set(0); refs[5].set(3);
+  check_region(s, refs);
+
+  getfem::mesh_region t;
+  t.add(5, 2); t.add(35); t.add(50);
+  getfem::mesh_region m = getfem::mesh_region::merge(s, t);
+  refs[5].set(3); refs[50].set(0);
+  check_region(m, refs);
+  getfem::mesh_region d = getfem::mesh_region::subtract(m, t);
+  refs.erase(35); refs.erase(50); refs.erase(5);
+  check_region(d, refs);
+
+  dal::bit_vector bv; bv.add(3); bv.add(100);
+  d.add(bv);
+  refs[3].set(0); refs[100].set(0);
+  check_region(d, refs);
+}
+
+void test_curve_renumbering(bool hilbert) {
+  getfem::mesh m;
+  std::vector<size_type> nsubdiv(3, 6);
+  getfem::regular_unit_mesh(m, nsubdiv, bgeot::simplex_geotrans(3, 1));
+  getfem::mesh_region border = getfem::outer_faces_of_mesh(m);
+  m.region(1) = border;
+  size_type nbcv = m.nb_convex(), nbpt = m.nb_points(), nbf = border.size();
+  scalar_type vol = 0;
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+    vol += m.convex_area_estimate(cv);
+
+  m.renumber_along_curve(hilbert);
+  assert(m.nb_convex() == nbcv && m.nb_points() == nbpt);
+  assert(m.convex_index().last_true()+1 == nbcv);
+  scalar_type vol2 = 0;
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+    vol2 += m.convex_area_estimate(cv);
+  assert(gmm::abs(vol - vol2) < 1E-10);
+  /* the boundary region follows the convexes */
+  getfem::mesh_region border2 = getfem::outer_faces_of_mesh(m);
+  assert(m.region(1).size() == nbf && border2.size() == nbf);
+  for (getfem::mr_visitor i(border2); !i.finished(); ++i)
+    assert(m.region(1).is_in(i.cv(), i.f()));
+  /* the convexes are in the curve order, the points numbered by first
+     appearance */
+  std::vector<size_type> ord;
+  getfem::space_filling_curve_ordering(m, ord, hilbert);
+  for (size_type i = 0; i < ord.size(); ++i) assert(ord[i] == i);
+  size_type next_pt = 0;
+  for (size_type cv = 0; cv < nbcv; ++cv)
+    for (size_type ip : m.ind_points_of_convex(cv)) {
+      assert(ip <= next_pt);
+      if (ip == next_pt) ++next_pt;
+    }
+  assert(next_pt == nbpt);
+}
+
+static scalar_type x_of_center(const getfem::mesh &m, size_type cv) {
+  scalar_type x = 0;
+  for (size_type ip : m.ind_points_of_convex(cv)) x += m.points()[ip][0];
+  return 1. + x / scalar_type(m.nb_points_of_convex(cv));
+}
+
+void test_curve_partition() {
+  getfem::mesh m;
+  std::vector<size_type> nsubdiv(3, 6);
+  getfem::regular_unit_mesh(m, nsubdiv, bgeot::simplex_geotrans(3, 1));
+  std::vector<scalar_type> w(m.nb_allocated_convex());
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+    w[cv] = x_of_center(m, cv);
+  getfem::mesh_fem mf(m);
+  mf.set_classical_finite_element(1);
+  m.set_convex_weights(w);
+  /* setting the weights does not modify the mesh */
+  assert(!mf.is_context_changed());
+  /* the weights follow the renumbering of the convexes */
+  m.renumber_along_curve();
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+    assert(gmm::abs(m.convex_weight(cv) - x_of_center(m, cv)) < 1E-12);
+
+  for (size_type nbp = 1; nbp <= 5; ++nbp) {
+    std::vector<size_type> part, ord;
+    getfem::space_filling_curve_partition(m, nbp, part);
+    getfem::space_filling_curve_ordering(m, ord);
+    std::vector<scalar_type> pw(nbp, 0.);
+    scalar_type total = 0, wmax = 0;
+    for (size_type k = 0; k < ord.size(); ++k) {
+      /* consecutive parts along the curve */
+      assert(part[ord[k]] < nbp);
+      if (k > 0) assert(part[ord[k]] >= part[ord[k-1]]);
+      pw[part[ord[k]]] += m.convex_weight(ord[k]);
+      total += m.convex_weight(ord[k]);
+      wmax = std::max(wmax, m.convex_weight(ord[k]));
+    }
+    /* balanced weights */
+    for (size_type i = 0; i < nbp; ++i)
+      assert(gmm::abs(pw[i] - total / scalar_type(nbp)) <= wmax);
+  }
+}
+
 void test_convex_ref() {
   for (bgeot::short_type k=1; k <= 2; ++k) {
     bgeot::pconvex_ref cvr  = bgeot::simplex_of_reference(1,k);
@@ -630,6 +772,552 @@ void test_incomplete_Q2(void) {
 
 
 
+void test_binary_io() {
+  getfem::mesh m;
+  std::vector<size_type> nsubdiv(2, 4);
+  getfem::regular_unit_mesh(m, nsubdiv, bgeot::parallelepiped_geotrans(2,1));
+  base_node A(2), B(2), C(2);
+  A[0] = 1.; B[0] = 1.5; B[1] = 0.5; C[0] = 1.; C[1] = 1.;
+  size_type ipt[3] = { m.add_point(A), m.add_point(B), m.add_point(C) };
+  size_type ict = m.add_convex(bgeot::simplex_geotrans(2,1), &ipt[0]);
+  m.sup_convex(5, true);
+  m.region(1).add(0, 1); m.region(1).add(3, 0); m.region(1).add(ict, 2);
+  m.region(2).add(1); m.region(2).add(6); m.region(2).add(ict);
+
+  getfem::mesh_fem mf(m, 2);
+  mf.set_classical_finite_element(2);
+  getfem::mesh_im mim(m);
+  mim.set_integration_method(4);
+  getfem::model md;
+  md.add_fem_variable("u", mf);
+  md.add_initialized_scalar_data("alpha", 3.);
+  for (size_type i = 0; i < mf.nb_dof(); ++i)
+    md.set_real_variable("u")[i] = double(i) / 7.;
+
+  {
+    getfem::binary_ofile f("test_mesh.gfb");
+    m.write_to_binary(f);
+    mf.write_to_binary(f);
+    mim.write_to_binary(f);
+    getfem::write_model_variables_to_binary(f, md, {"u", "alpha"});
+  }
+
+  getfem::binary_ifile f("test_mesh.gfb");
+  getfem::mesh m2;
+  m2.read_from_binary(f);
+  assert(m2.convex_index() == m.convex_index());
+  assert(m2.points().index() == m.points().index());
+  for (dal::bv_visitor ip(m.points().index()); !ip.finished(); ++ip)
+    assert(gmm::vect_dist2(m.points()[ip], m2.points()[ip]) == 0.);
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+    assert(m.trans_of_convex(cv) == m2.trans_of_convex(cv));
+    for (size_type i = 0; i < m.nb_points_of_convex(cv); ++i)
+      assert(m.ind_points_of_convex(cv)[i] == m2.ind_points_of_convex(cv)[i]);
+  }
+  assert(m2.regions_index() == m.regions_index());
+  assert(m2.region(1).is_in(0, 1) && m2.region(1).is_in(3, 0));
+  assert(m2.region(1).is_in(ict, 2) && !m2.region(1).is_in(0));
+  assert(m2.region(2).index() == m.region(2).index());
+
+  getfem::mesh_fem mf2(m2);
+  mf2.read_from_binary(f);
+  assert(mf2.get_qdim() == 2 && mf2.nb_dof() == mf.nb_dof());
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+    assert(mf2.fem_of_element(cv) == mf.fem_of_element(cv));
+    for (size_type i = 0; i < mf.nb_basic_dof_of_element(cv); ++i)
+      assert(mf2.ind_basic_dof_of_element(cv)[i]
+             == mf.ind_basic_dof_of_element(cv)[i]);
+  }
+  getfem::mesh_im mim2(m2);
+  mim2.read_from_binary(f);
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+    assert(mim2.int_method_of_element(cv) == mim.int_method_of_element(cv));
+
+  getfem::model md2;
+  md2.add_fem_variable("u", mf2);
+  md2.add_initialized_scalar_data("alpha", 0.);
+  getfem::read_model_variables_from_binary(f, md2);
+  assert(gmm::vect_dist2(md2.real_variable("u"), md.real_variable("u")) == 0.);
+  assert(md2.real_variable("alpha")[0] == 3.);
+
+  // partial load of the region 2
+  getfem::mesh m3;
+  m3.read_from_binary(f, "mesh", 2);
+  assert(m3.convex_index() == m.region(2).index());
+  for (dal::bv_visitor cv(m3.convex_index()); !cv.finished(); ++cv)
+    for (size_type i = 0; i < m.nb_points_of_convex(cv); ++i) {
+      size_type ip = m3.ind_points_of_convex(cv)[i];
+      assert(ip == m.ind_points_of_convex(cv)[i]);
+      assert(gmm::vect_dist2(m.points()[ip], m3.points()[ip]) == 0.);
+    }
+  assert(m3.region(1).is_in(ict, 2) && !m3.region(1).is_in(0, 1));
+  getfem::mesh_fem mf3(m3);
+  mf3.read_from_binary(f);
+  assert(mf3.convex_index() == m3.convex_index());
+  std::remove("test_mesh.gfb");
+}
+
+/* The same 2D mesh written in the ASCII and binary MSH 4.1 formats, with
+   a duplicated node (tag 5) and non-contiguous node tags. */
+template <typename T> void write_bin(std::ostream &f, T v)
+{ f.write(reinterpret_cast<const char *>(&v), sizeof(T)); }
+
+void write_gmsh41_file(const std::string &name, bool binary) {
+  std::ofstream f(name.c_str(), std::ios::out | std::ios::binary);
+  double X[5][3] = {{0,0,0}, {1,0,0}, {1,1,0}, {0,1,0}, {0,0,0}};
+  size_type tags[5] = {1, 9, 3, 4, 5};
+  f << "$MeshFormat\n4.1 " << (binary ? 1 : 0) << " 8\n";
+  if (binary) { write_bin(f, int(1)); f << "\n"; }
+  f << "$EndMeshFormat\n$PhysicalNames\n2\n1 3 \"bottom\"\n"
+    << "2 7 \"domain\"\n$EndPhysicalNames\n$Entities\n";
+  if (binary) {
+    write_bin(f, size_type(0)); write_bin(f, size_type(1));
+    write_bin(f, size_type(1)); write_bin(f, size_type(0));
+    for (int d = 1; d <= 2; ++d) {
+      write_bin(f, int(3-d));
+      for (int k = 0; k < 6; ++k) write_bin(f, double(k > 2));
+      write_bin(f, size_type(1)); write_bin(f, int(d == 1 ? 3 : 7));
+      write_bin(f, size_type(0));
+    }
+    f << "\n$EndEntities\n$Nodes\n";
+    write_bin(f, size_type(2)); write_bin(f, size_type(5));
+    write_bin(f, size_type(1)); write_bin(f, size_type(9));
+    for (int b = 0; b < 2; ++b) {
+      write_bin(f, int(b+1)); write_bin(f, int(2-b)); write_bin(f, int(0));
+      write_bin(f, size_type(b ? 3 : 2));
+      for (size_type i = (b ? 2 : 0); i < (b ? 5 : 2); ++i)
+        write_bin(f, tags[i]);
+      for (size_type i = (b ? 2 : 0); i < (b ? 5 : 2); ++i)
+        for (size_type k = 0; k < 3; ++k) write_bin(f, X[i][k]);
+    }
+    f << "\n$EndNodes\n$Elements\n";
+    size_type elts[3][4] = {{1, 1, 9, 0}, {2, 1, 9, 3}, {3, 3, 4, 5}};
+    write_bin(f, size_type(2)); write_bin(f, size_type(3));
+    write_bin(f, size_type(1)); write_bin(f, size_type(3));
+    for (int b = 0; b < 2; ++b) {
+      write_bin(f, int(b+1)); write_bin(f, int(2-b));
+      write_bin(f, int(b+1)); write_bin(f, size_type(b ? 2 : 1));
+      for (size_type i = (b ? 1 : 0); i < (b ? 3 : 1); ++i)
+        for (size_type k = 0; k < size_type(b ? 4 : 3); ++k)
+          write_bin(f, elts[i][k]);
+    }
+    f << "\n$EndElements\n";
+  } else {
+    f << "0 1 1 0\n2 0 0 0 1 1 0 1 3 0\n1 0 0 0 1 1 0 1 7 0\n"
+      << "$EndEntities\n$Nodes\n2 5 1 9\n1 2 0 2\n1\n9\n0 0 0\n1 0 0\n"
+      << "2 1 0 3\n3\n4\n5\n1 1 0\n0 1 0\n0 0 0\n$EndNodes\n"
+      << "$Elements\n2 3 1 3\n1 2 1 1\n1 1 9\n2 1 2 2\n2 1 9 3\n"
+      << "3 3 4 5\n$EndElements\n";
+  }
+}
+
+void test_gmsh41_import() {
+  for (int binary = 0; binary < 2; ++binary) {
+    write_gmsh41_file("test_mesh.msh", binary != 0);
+    for (int merge = 0; merge < 2; ++merge) {
+      getfem::mesh m;
+      std::map<std::string, size_type> region_map;
+      getfem::import_mesh_gmsh("test_mesh.msh", m, region_map, true, NULL,
+                               merge != 0);
+      assert(m.dim() == 2 && m.convex_index().card() == 2);
+      assert(m.points().index().card() == size_type(merge ? 4 : 5));
+      assert(region_map["bottom"] == 3 && region_map["domain"] == 7);
+      assert(m.region(7).index().card() == 2);
+      size_type nbf = 0;
+      for (getfem::mr_visitor i(m.region(3), m); !i.finished(); ++i, ++nbf) {
+        assert(i.is_face());
+        for (size_type k = 0; k < 2; ++k)
+          assert(m.points_of_face_of_convex(i.cv(), i.f())[k][1] == 0.);
+      }
+      assert(nbf == 1);
+      std::set<size_type> ipts;
+      for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+        for (size_type ip : m.ind_points_of_convex(cv)) ipts.insert(ip);
+      assert(ipts.size() == size_type(merge ? 4 : 5));
+    }
+  }
+}
+
+void test_node_tab_merge() {
+  /* random points, each one duplicated with a tiny perturbation */
+  std::vector<base_node> pts;
+  for (size_type i = 0; i < 1000; ++i) {
+    base_node P(3); gmm::fill_random(P);
+    pts.push_back(P);
+    if (i % 3 == 0) { P[i%3] += 1E-14; pts.push_back(P); }
+    if (i % 7 == 0) pts.push_back(pts[(i*13)%pts.size()]);
+  }
+  bgeot::node_tab t1, t2;
+  std::vector<size_type> ids1(pts.size()), ids2, rep;
+  for (size_type i = 0; i < pts.size(); ++i) ids1[i] = t1.add_node(pts[i]);
+  t2.add_nodes(pts, ids2);
+  assert(t2.card() == pts.size());
+  size_type nbm = t2.merge_duplicated_nodes(rep);
+  assert(t2.card() == t1.card() && nbm + t1.card() == pts.size());
+  for (size_type i = 0; i < pts.size(); ++i) {
+    size_type j = rep[ids2[i]];
+    assert(t2.index().is_in(j) && rep[j] == j);
+    assert(gmm::vect_dist2(t2[j], t1[ids1[i]]) < 1E-10);
+    assert(t2.search_node(pts[i]) == j);
+  }
+}
+
+/* Neighbours of cv having the points ipts, in the order of the list of
+   convexes of ipts[0], as the queries on a structure which is not
+   frozen. */
+static bgeot::mesh_structure::ind_set
+listed_neighbours(const getfem::mesh &m, size_type cv,
+                  const std::vector<size_type> &ipts, bool same_dim) {
+  bgeot::mesh_structure::ind_set s;
+  for (size_type icv : m.convex_to_point(ipts[0])) {
+    if (icv == cv || (same_dim && m.structure_of_convex(icv)->dim()
+                      != m.structure_of_convex(cv)->dim())) continue;
+    const bgeot::mesh_structure::ind_cv_ct &p = m.ind_points_of_convex(icv);
+    bool has_all = true;
+    for (size_type ip : ipts)
+      if (std::find(p.begin(), p.end(), ip) == p.end()) has_all = false;
+    if (has_all) s.push_back(icv);
+  }
+  return s;
+}
+
+/* The compact copy of the connectivity is built by the neighbour queries
+   themselves, then by freeze(). The queries have to give the same
+   results, in the same order, with and without it. */
+void check_frozen_neighbours(getfem::mesh &m) {
+  std::vector<bgeot::mesh_structure::ind_set> nf, na, ne;
+  std::vector<size_type> n1;
+  bgeot::mesh_structure::ind_set s;
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+    na.push_back(bgeot::mesh_structure::ind_set());
+    for (bgeot::short_type f = 0; f < m.nb_faces_of_convex(cv); ++f) {
+      bgeot::mesh_structure::ind_pt_face_ct
+        pt = m.ind_points_of_face_of_convex(cv, f);
+      std::vector<size_type> ipts(pt.begin(), pt.end());
+      nf.push_back(listed_neighbours(m, cv, ipts, true));
+      ne.push_back(listed_neighbours(m, cv, ipts, false));
+      n1.push_back(nf.back().empty() ? size_type(-1) : nf.back()[0]);
+      for (size_type icv : nf.back())
+        if (std::find(na.back().begin(), na.back().end(), icv)
+            == na.back().end()) na.back().push_back(icv);
+    }
+  }
+  for (size_type k = 0; k < 2; ++k) {
+    if (k == 1) { m.unfreeze(); m.freeze(); assert(m.is_frozen()); }
+    size_type i = 0, j = 0;
+    for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+      m.neighbours_of_convex(cv, s); assert(s == na[j++]);
+      for (bgeot::short_type f = 0; f < m.nb_faces_of_convex(cv); ++f, ++i) {
+        assert(m.neighbour_of_convex(cv, f) == n1[i]);
+        m.neighbours_of_convex(cv, f, s); assert(s == nf[i]);
+        m.neighbours_of_convex(cv, std::vector<bgeot::short_type>(1, f), s);
+        assert(s == ne[i]);
+        if (m.is_frozen()) {
+          const bgeot::mesh_structure_compact &c = m.compact_structure();
+          assert(c.structure_of_convex(cv) == m.structure_of_convex(cv));
+          assert(std::equal(m.ind_points_of_convex(cv).begin(),
+                            m.ind_points_of_convex(cv).end(),
+                            c.points_of_convex(cv)));
+        }
+      }
+    }
+    assert(m.is_frozen()); // for k == 0, frozen by the queries
+  }
+}
+
+void test_frozen_structure() {
+  getfem::mesh m;
+  std::vector<size_type> nsubdiv(2, 5);
+  getfem::regular_unit_mesh(m, nsubdiv, bgeot::simplex_geotrans(2, 1));
+  /* a quadrilateral and some segments to mix the structures */
+  base_node A(1., 0.), B(1.5, 0.), C(1., 0.2), D(1.5, 0.2);
+  std::vector<base_node> pts = {A, B, C, D};
+  m.add_parallelepiped_by_points(2, pts.begin());
+  m.add_segment_by_points(base_node(0., 0.), base_node(0.2, 0.));
+  m.add_segment_by_points(A, C);
+  check_frozen_neighbours(m);
+
+  m.add_segment_by_points(B, D);
+  assert(!m.is_frozen());
+  check_frozen_neighbours(m);
+  m.sup_convex(0);
+  assert(!m.is_frozen());
+  check_frozen_neighbours(m);
+  m.unfreeze();
+  assert(!m.is_frozen());
+
+  getfem::mesh m3;
+  std::vector<size_type> nsubdiv3(3, 3);
+  getfem::regular_unit_mesh(m3, nsubdiv3, bgeot::simplex_geotrans(3, 1));
+  check_frozen_neighbours(m3);
+  m3.clear();
+  assert(!m3.is_frozen());
+}
+
+std::string read_file(const std::string &name) {
+  std::ifstream f(name.c_str(), std::ios::in | std::ios::binary);
+  assert(f);
+  std::stringstream s; s << f.rdbuf();
+  return s.str();
+}
+
+size_type xml_attribute_sum(const std::string &s, const std::string &att) {
+  size_type sum = 0;
+  for (size_type p = s.find(att+"=\""); p != std::string::npos;
+       p = s.find(att+"=\"", p+1))
+    sum += size_type(atol(s.c_str() + p + att.size() + 2));
+  return sum;
+}
+
+void test_vtu_export() {
+  getfem::mesh m;
+  std::vector<size_type> nsubdiv(2, 6);
+  getfem::regular_unit_mesh(m, nsubdiv, bgeot::parallelepiped_geotrans(2, 1));
+  getfem::mesh_fem mf(m, 2);
+  mf.set_classical_finite_element(1);
+  std::vector<scalar_type> U(mf.nb_dof()), C(m.convex_index().card());
+  for (size_type i = 0; i < U.size(); ++i) U[i] = scalar_type(i);
+  for (size_type i = 0; i < C.size(); ++i) C[i] = scalar_type(i);
+
+  /* uncompressed file: the size of each array is given before its data */
+  {
+    getfem::vtu_export exp("test_mesh.vtu", false);
+    exp.exporting(mf);
+    exp.write_point_data(mf, U, "u");
+    exp.write_cell_data(C, "c");
+  }
+  std::string s = read_file("test_mesh.vtu");
+  assert(xml_attribute_sum(s, "NumberOfPoints") == 49);
+  assert(xml_attribute_sum(s, "NumberOfCells") == 36);
+  size_type start = s.find("<AppendedData encoding=\"raw\">\n   _") + 34;
+  size_type end = s.rfind("\n  </AppendedData>");
+  size_type off = 0, nb_arrays = 0;
+  for (; start + off < end; ++nb_arrays) {
+    gmm::uint64_type nbytes;
+    memcpy(&nbytes, s.data() + start + off, sizeof(nbytes));
+    off += sizeof(nbytes) + size_type(nbytes);
+  }
+  assert(start + off == end && nb_arrays == 6);
+  gmm::uint64_type nbytes; float pt[6];
+  memcpy(&nbytes, s.data() + start, sizeof(nbytes));
+  assert(nbytes == 49*3*sizeof(float));
+  memcpy(pt, s.data() + start + sizeof(nbytes), sizeof(pt));
+  assert(pt[0] == 0.f && pt[1] == 0.f && pt[2] == 0.f && pt[5] == 0.f);
+
+  /* pieces written in parallel, with compression when it is available */
+  getfem::pvd_export pvd("test_mesh.pvd");
+  for (size_type it = 0; it < 2; ++it) {
+    std::stringstream name; name << "test_mesh_" << it << ".pvtu";
+    {
+      getfem::vtu_export exp(name.str(), true, 3);
+      exp.exporting(mf);
+      exp.write_point_data(mf, U, "u");
+      exp.write_cell_data(C, "c");
+    }
+    pvd.add_time_step(0.5*scalar_type(it), name.str());
+  }
+  s = read_file("test_mesh_1.pvtu");
+  assert(s.find("<Piece Source=\"test_mesh_1_2.vtu\"/>") != std::string::npos);
+  assert(s.find("Name=\"u\" NumberOfComponents=\"3\"") != std::string::npos);
+  size_type nbc = 0;
+  for (size_type i = 0; i < 3; ++i) {
+    std::stringstream name; name << "test_mesh_1_" << i << ".vtu";
+    std::string sp = read_file(name.str());
+    nbc += xml_attribute_sum(sp, "NumberOfCells");
+#ifdef GETFEM_HAVE_ZLIB
+    assert(sp.find("compressor=\"vtkZLibDataCompressor\"")
+           != std::string::npos);
+#endif
+  }
+  assert(nbc == 36);
+  s = read_file("test_mesh.pvd");
+  assert(s.find("timestep=\"0.5\" group=\"\" part=\"0\" "
+                "file=\"test_mesh_1.pvtu\"") != std::string::npos);
+
+  /* slice of the mesh */
+  getfem::stored_mesh_slice sl;
+  sl.build(m, getfem::slicer_none(), 2);
+  {
+    getfem::vtu_export exp("test_mesh_slice.pvtu", true, 2);
+    exp.exporting(sl);
+    exp.write_point_data(mf, U, "u");
+  }
+  s = read_file("test_mesh_slice_0.vtu") + read_file("test_mesh_slice_1.vtu");
+  assert(xml_attribute_sum(s, "NumberOfPoints") == sl.nb_points());
+  assert(xml_attribute_sum(s, "NumberOfCells") == sl.nb_simplexes(2));
+}
+
+void test_async_export() {
+  getfem::mesh m;
+  std::vector<size_type> nsubdiv(2, 5);
+  getfem::regular_unit_mesh(m, nsubdiv, bgeot::simplex_geotrans(2, 1));
+  getfem::mesh_fem mf(m);
+  mf.set_classical_finite_element(2);
+  std::vector<scalar_type> U(mf.nb_dof());
+  {
+    getfem::vtk_export exp("test_mesh_sync.vtk");
+    exp.exporting(mf);
+    exp.write_point_data(mf, U, "u");
+  }
+  {
+    getfem::vtu_export exp("test_mesh_sync.pvtu", true, 2);
+    exp.exporting(mf);
+    exp.write_point_data(mf, U, "u");
+  }
+
+  getfem::async_file_writer writer(1);
+  for (size_type it = 0; it < 3; ++it) {
+    std::stringstream s, name;
+    getfem::vtk_export exp(s);
+    exp.exporting(mf);
+    exp.write_point_data(mf, U, "u");
+    name << "test_mesh_async_" << it << ".vtk";
+    writer.write(name.str(), s);
+    assert(writer.nb_pending() <= 2);
+  }
+  {
+    getfem::vtu_export exp("test_mesh_async.pvtu", true, 2);
+    exp.write_in_background(writer);
+    exp.exporting(mf);
+    exp.write_point_data(mf, U, "u");
+  }
+  writer.flush();
+  assert(writer.nb_pending() == 0);
+  std::string s = read_file("test_mesh_sync.vtk");
+  for (size_type it = 0; it < 3; ++it) {
+    std::stringstream name; name << "test_mesh_async_" << it << ".vtk";
+    assert(read_file(name.str()) == s);
+  }
+  for (size_type i = 0; i < 2; ++i) {
+    std::stringstream n1, n2;
+    n1 << "test_mesh_sync_" << i << ".vtu";
+    n2 << "test_mesh_async_" << i << ".vtu";
+    assert(read_file(n1.str()) == read_file(n2.str()));
+  }
+
+  /* an error in the background thread is thrown by flush() */
+  writer.write("test_mesh_no_such_dir/test.vtk", std::string("error"));
+  bool error = false;
+  try { writer.flush(); } catch (const gmm::gmm_error &) { error = true; }
+  assert(error);
+  writer.flush();
+}
+
+// Evaluation of the signed distances of the mesher on a set of points,
+// compared to the evaluation point by point.
+static void check_mesher_values(const getfem::pmesher_signed_distance &dist,
+                                size_type N) {
+  std::vector<base_node> pts(200, base_node(N));
+  for (size_type i = 0; i < pts.size(); ++i)
+    for (size_type k = 0; k < N; ++k)
+      pts[i][k] = -2. + 4. * gmm::random();
+  getfem::base_vector d;
+  dist->values(pts, d);
+  assert(d.size() == pts.size());
+  for (size_type i = 0; i < pts.size(); ++i)
+    GMM_ASSERT1(gmm::abs(d[i] - (*dist)(pts[i])) < 1E-12,
+                "Wrong evaluation of the distance at " << pts[i]);
+}
+
+void test_mesher_values() {
+  getfem::pmesher_signed_distance
+    B1 = getfem::new_mesher_ball(base_node(0., 0.), 1.),
+    B2 = getfem::new_mesher_ball(base_node(1., 0.), .7),
+    R1 = getfem::new_mesher_rectangle(base_node(-.5, -1.5),
+                                      base_node(.8, .2)),
+    H1 = std::make_shared<getfem::mesher_half_space>
+         (base_node(0., .3), base_small_vector(1., 1.));
+  for (const auto &dist :
+         {B1, R1, H1, getfem::new_mesher_union(B1, B2, R1),
+          getfem::new_mesher_intersection(B1, H1),
+          getfem::new_mesher_setminus(getfem::new_mesher_union(B1, B2), R1)})
+    check_mesher_values(dist, 2);
+
+  base_node O(0., 0., 0.);
+  getfem::pmesher_signed_distance
+    R2 = getfem::new_mesher_rectangle(base_node(-1., -1., -1.),
+                                      base_node(1., 1., 1.)),
+    C1 = getfem::new_mesher_cylinder(base_node(0., 0., -1.5),
+                                     base_node(0., 0., 1.), 3., .4),
+    C2 = getfem::new_mesher_cone(O, base_small_vector(1., 0., 0.), 1., .6),
+    T1 = getfem::new_mesher_tube(O, base_node(0., 1., 0.), .3),
+    B3 = getfem::new_mesher_ball(base_node(.5, .5, .5), .8),
+    T2 = getfem::new_mesher_torus(1., .3);
+  for (const auto &dist :
+         {R2, C1, C2, T1, T2,
+          getfem::new_mesher_setminus(getfem::new_mesher_union(R2, B3, C2),
+                                      C1),
+          getfem::new_mesher_intersection(getfem::new_mesher_union(R2, T2),
+                                          T1)})
+    check_mesher_values(dist, 3);
+}
+
+// Enumeration of the dofs of a mixed mesh (Q2 quadrilaterals, P2 triangles,
+// two dof partitions) compared to a reference numbering: the linkable dofs
+// are identified when they have the same node, type and partition, and are
+// numbered in the order of their first appearance. The enumeration being
+// done in parallel, it is checked with several numbers of threads.
+void test_enumerate_dof() {
+  getfem::mesh m;
+  bgeot::pgeometric_trans pgtq = bgeot::parallelepiped_geotrans(2, 1);
+  bgeot::pgeometric_trans pgtt = bgeot::simplex_geotrans(2, 1);
+  for (size_type j = 0; j < 3; ++j)
+    for (size_type i = 0; i < 4; ++i) {
+      scalar_type x = scalar_type(i), y = scalar_type(j);
+      base_node A(x, y), B(x+1., y), C(x, y+1.), D(x+1., y+1.);
+      if (i < 2) {
+        std::vector<base_node> pts = {A, B, C, D};
+        m.add_convex_by_points(pgtq, pts.begin());
+      } else {
+        std::vector<base_node> pts1 = {A, B, D}, pts2 = {A, D, C};
+        m.add_convex_by_points(pgtt, pts1.begin());
+        m.add_convex_by_points(pgtt, pts2.begin());
+      }
+    }
+  m.sup_convex(5); // a hole in the numbering of the elements
+
+  for (size_type nbth : {1, 2, 3, 5}) {
+    getfem::set_num_threads(int(nbth));
+    getfem::mesh_fem mf(m, 2);
+    for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+      mf.set_finite_element(cv, m.structure_of_convex(cv)->nb_points() == 4
+                            ? getfem::QK_fem(2, 2) : getfem::PK_fem(2, 2));
+      if (m.points_of_convex(cv)[0][1] >= 2.) mf.set_dof_partition(cv, 1);
+    }
+
+    std::vector<base_node> nodes;
+    std::vector<getfem::pdof_description> types;
+    std::vector<unsigned> parts;
+    std::vector<size_type> nums;
+    size_type nbdof = 0;
+    for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+      getfem::pfem pf = mf.fem_of_element(cv);
+      auto dofs = mf.ind_basic_dof_of_element(cv);
+      assert(dofs.size() == pf->nb_dof(cv) * 2);
+      for (size_type i = 0; i < pf->nb_dof(cv); ++i) {
+        base_node P = m.trans_of_convex(cv)->transform(pf->node_of_dof(cv, i),
+                                                       m.points_of_convex(cv));
+        size_type k = 0;
+        for (; k < nodes.size(); ++k)
+          if (gmm::vect_dist2(nodes[k], P) < 1E-10
+              && getfem::dof_description_compare(types[k],
+                                                 pf->dof_types()[i]) == 0
+              && parts[k] == mf.get_dof_partition(cv)) break;
+        if (k == nodes.size()) {
+          nodes.push_back(P); types.push_back(pf->dof_types()[i]);
+          parts.push_back(mf.get_dof_partition(cv));
+          nums.push_back(nbdof); nbdof += 2;
+        }
+        GMM_ASSERT1(dofs[2*i] == nums[k] && dofs[2*i+1] == nums[k]+1,
+                    "Wrong dof numbering on element " << cv << " with "
+                    << nbth << " threads");
+      }
+    }
+    GMM_ASSERT1(mf.nb_basic_dof() == nbdof, "Wrong number of dofs");
+  }
+  getfem::set_num_threads(int(getfem::max_concurrency()));
+}
+
 int main(void) {
 
   test_mesh_building(2, 100); 
@@ -643,6 +1331,7 @@ int main(void) {
   test_convex_quality(-0.2,0);
   test_convex_quality(-0.01,-0.2);
   test_region();
+  test_region_storage();
 
   test_search_point();
   
@@ -657,6 +1346,18 @@ int main(void) {
   test_refinable(3, 3);
 
   test_incomplete_Q2();
+
+  test_binary_io();
+  test_gmsh41_import();
+  test_node_tab_merge();
+  test_frozen_structure();
+  test_curve_renumbering(true);
+  test_curve_renumbering(false);
+  test_curve_partition();
+  test_mesher_values();
+  test_enumerate_dof();
+  test_vtu_export();
+  test_async_export();
   
   return 0;
 }
@@ -170,6 +170,72 @@ void test_3d() {
     GMM_ASSERT1(false, "Cutting integration method has failed");
 }
 
+/* Incremental adaptation: a level set made of two circles, the second
+   one being moved. Only the convexes cut by the second circle have to be
+   rebuilt, and the result has to be the same as for a full adaptation. */
+static scalar_type two_circles(const getfem::base_node &P, scalar_type x2) {
+  scalar_type R = .2;
+  return std::min(gmm::vect_dist2_sqr(P, getfem::base_node(-.5, 0)) - R*R,
+                  gmm::vect_dist2_sqr(P, getfem::base_node(x2, 0)) - R*R);
+}
+
+static scalar_type area_of_circle(const getfem::mesh_im &mim,
+                                  const getfem::base_node &C, scalar_type R) {
+  const getfem::mesh &m = mim.linked_mesh();
+  scalar_type area(0);
+  base_matrix G;
+  for (dal::bv_visitor i(m.convex_index()); !i.finished(); ++i) {
+    getfem::papprox_integration pai
+      = mim.int_method_of_element(i)->approx_method();
+    bgeot::vectors_to_base_matrix(G, m.points_of_convex(i));
+    bgeot::geotrans_interpolation_context c(m.trans_of_convex(i),
+                                            pai->point(0), G);
+    for (size_type j = 0; j < pai->nb_points_on_convex(); ++j) {
+      c.set_xref(pai->point(j));
+      if (gmm::vect_dist2(c.xreal(), C) <= R) area += pai->coeff(j) * c.J();
+    }
+  }
+  return area;
+}
+
+void test_incremental_2d() {
+  getfem::mesh m; m.read_from_file("meshes/disc_2D_degree3.mesh");
+  getfem::mesh_level_set mls(m);
+  getfem::level_set ls(m, 2);
+  const getfem::mesh_fem &lsmf = ls.get_mesh_fem();
+  for (size_type i = 0; i < lsmf.nb_dof(); ++i)
+    ls.values()[i] = two_circles(lsmf.point_of_basic_dof(i), .4);
+  mls.add_level_set(ls);
+  getfem::pintegration_method
+    pim = getfem::int_method_descriptor("IM_TRIANGLE(6)");
+  getfem::mesh_im_level_set mim(mls, getfem::mesh_im_level_set::INTEGRATE_ALL,
+                                pim);
+  getfem::mesh_im_level_set mim2(mls, getfem::mesh_im_level_set::INTEGRATE_ALL,
+                                 pim);
+  mim.set_integration_method(m.convex_index(), pim);
+  mim2.set_integration_method(m.convex_index(), pim);
+  mim.set_incremental_adapt(true);
+  mls.adapt(); mim.adapt();
+  size_type nb_cut = mim.nb_rebuilt_methods();
+
+  for (size_type i = 0; i < lsmf.nb_dof(); ++i)
+    ls.values()[i] = two_circles(lsmf.point_of_basic_dof(i), .45);
+  mls.adapt(); mim.adapt(); mim2.adapt();
+  cout << "Incremental adaptation: " << mim.nb_rebuilt_methods()
+       << " methods rebuilt over " << mim2.nb_rebuilt_methods() << endl;
+  GMM_ASSERT1(mim.nb_rebuilt_methods() > 0 &&
+              mim.nb_rebuilt_methods() < mim2.nb_rebuilt_methods() &&
+              mim2.nb_rebuilt_methods() <= 2*nb_cut, "Wrong incremental "
+              "adaptation");
+  for (scalar_type x : {-.5, .45}) {
+    getfem::base_node C(x, 0);
+    scalar_type a1 = area_of_circle(mim, C, .2);
+    scalar_type a2 = area_of_circle(mim2, C, .2);
+    GMM_ASSERT1(gmm::abs(a1 - a2) < 1E-12 && gmm::abs(a1 - M_PI*.04) < 1E-3,
+                "Incremental adaptation has failed: " << a1 << ", " << a2);
+  }
+}
+
 int main(/* int argc, char **argv */) {
 
   GMM_SET_EXCEPTION_DEBUG; // Exceptions make a memory fault, to debug.
@@ -178,6 +244,7 @@ int main(/* int argc, char **argv */) {
   try {
     // getfem::getfem_mesh_level_set_noisy();
     test_2d();
+    test_incremental_2d();
   }
   GMM_STANDARD_CATCH_ERROR;
   return 0;
@@ -19,7 +19,7 @@
 
 ===========================================================================*/
 #include "getfem/bgeot_rtree.h"
-#include "getfem/bgeot_rtree.h"
+#include "getfem/bgeot_bvh.h"
 #include "getfem/dal_bit_vector.h"
 using std::endl; using std::cout; using std::cerr;
 using std::ends; using std::cin;
@@ -113,7 +113,8 @@ static void brute_force_check(const std::vector<base_node>& rmin,
   }
 }
 
-static void verify(const std::vector<base_node>& rmin, const std::vector<base_node>& rmax, bgeot::rtree& tree) {
+template <typename TREE>
+static void verify(const std::vector<base_node>& rmin, const std::vector<base_node>& rmax, TREE& tree, bool build = true) {
   size_type N=rmin.front().size();
   std::vector<size_type> pbset;
   //tree.dump();
@@ -124,7 +125,7 @@ static void verify(const std::vector<base_node>& rmin, const std::vector<base_no
       extent[k] = std::max(extent[k], rmax[i][k]-rmin[i][k]);
     }
 
-  tree.build_tree();
+  if (build) tree.build_tree();
 
   for (size_type i=0; i < 100; ++i) {
     base_node min(N), max(N);
@@ -236,10 +237,60 @@ static void check_tree() {
   cout << "\nthe rtree is ok!\n";
 }
 
+static void check_bvh() {
+  bgeot::box_bvh tree;
+  std::vector<base_node> rmin, rmax;
+  cout << "2D random check of the bvh\n";
+  for (size_type i=0; i < 600; ++i) {
+    rmin.push_back(base_node(gmm::random(double()), gmm::random(double())));
+    rmax.push_back(rmin.back() + base_node(1.+gmm::random(), 1.+gmm::random())/10.);
+    tree.add_box(rmin.back(),rmax.back());
+  }
+  verify(rmin, rmax, tree);
+
+  cout << "2D check of the bvh after a refit\n";
+  for (size_type i=0; i < rmin.size(); ++i) {
+    base_node d(gmm::random(double())/20., gmm::random(double())/20.);
+    rmin[i] += d; rmax[i] += d;
+    tree.set_box(i, rmin[i], rmax[i]);
+  }
+  tree.refit();
+  assert(tree.is_refitted());
+  verify(rmin, rmax, tree, false);
+
+  cout << "2D check of the bvh after large displacements\n";
+  tree.clear_boxes_only();
+  for (size_type i=0; i < rmin.size(); ++i) {
+    base_node d(gmm::random(double())*2., gmm::random(double())*2.);
+    rmin[i] += d; rmax[i] += d;
+    tree.add_box(rmin[i], rmax[i]);
+  }
+  tree.update_tree();
+  verify(rmin, rmax, tree, false);
+
+  cout << "2D check of the bvh emptied after a fill\n";
+  tree.clear_boxes_only();
+  tree.update_tree();
+  std::vector<size_type> found;
+  tree.find_boxes_at_point(base_node(0.5, 0.5), found);
+  assert(found.empty());
+
+  cout << "3D/2D random check of the bvh\n";
+  tree.clear(); rmin.clear(); rmax.clear();
+  for (size_type i=0; i < 600; ++i) {
+    rmin.push_back(base_node(gmm::random(double()), 0, gmm::random(double())));
+    rmax.push_back(rmin.back() + base_node(.1+gmm::random(), 0.1, .1+gmm::random())/10.);
+    tree.add_box(rmin.back(),rmax.back());
+  }
+  verify(rmin, rmax, tree);
+  cout << "\nthe bvh is ok!\n";
+}
+
 int main(int argc, char **argv) {
   if (argc == 2 && strcmp(argv[1],"-quick")==0) quick = true;
   try {
     check_tree();
+    check_bvh();
     /*if (!quick)
       speed_test(3,300000,20000);
       else speed_test(2,10000,100);*/